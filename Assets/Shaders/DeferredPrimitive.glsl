@@ -4,11 +4,13 @@
 #pragma VERTEX
 #version 450
 
+// 座標ストリーム
 layout (location = 0) in vec3 inPos;
-layout (location = 1) in vec3 inNormal;
+
+// 属性ストリーム (法線・接線は八面体エンコード / 接線 x の符号は従法線の向き)
+layout (location = 1) in vec2 inNormal;
 layout (location = 2) in vec2 inTexCoord;
-layout (location = 3) in vec3 inTangent;
-layout (location = 4) in vec3 inBitangent;
+layout (location = 3) in vec2 inTangent;
 
 layout (location = 0) out vec3     outNormal;
 layout (location = 1) out vec2     outTexCoord;
@@ -19,20 +21,50 @@ layout (location = 2) out flat int outID;
 //------------------------------------------------------------------
 layout (set = 0, binding = 0) uniform Transform
 {
-    mat4 world;
     mat4 view;
     mat4 projection;
 };
 
+//------------------------------------------------------------------
+// インスタンスバッファ
+//------------------------------------------------------------------
+struct InstanceParameter
+{
+    mat4  transformMatrix;
+    mat4  normalMatrix;
+    ivec4 pixelID;
+};
+
+layout (std430, set = 0, binding = 1) readonly buffer InstanceParameterStorage
+{
+    InstanceParameter parameter[];
+};
+
+
+vec3 DecodeOctahedron(vec2 e)
+{
+    vec3  n = vec3(e.xy, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+
+    return normalize(n);
+}
+
+// 接線と従法線の復元 (法線マップの使用時に参照する)
+// vec3  tangent   = DecodeOctahedron(vec2(abs(inTangent.x) * 2.0 - 1.0, inTangent.y));
+// vec3  bitangent = cross(normal, tangent) * (inTangent.x < 0.0 ? -1.0 : 1.0);
 
 void main()
 {
-    vec4 worldPos     = world * vec4(inPos, 1.0);
-    mat3 normalMatrix = mat3(transpose(inverse(world)));
+    // gl_InstanceIndex は描画引数の firstInstance を含む
+    InstanceParameter instance = parameter[gl_InstanceIndex];
+
+    vec4 worldPos     = instance.transformMatrix * vec4(inPos, 1.0);
+    mat3 normalMatrix = mat3(instance.normalMatrix);
 
-    outNormal       = normalize(normalMatrix * inNormal);
+    outNormal       = normalize(normalMatrix * DecodeOctahedron(inNormal));
     outTexCoord     = inTexCoord;
-    outID           = 9999;
+    outID           = instance.pixelID.x;
 
     gl_Position = projection * view * worldPos;
 }
@@ -42,6 +74,7 @@ void main()
 //===================================================================================
 #pragma FRAGMENT
 #version 450
+#extension GL_EXT_nonuniform_qualifier : require
 
 layout (location = 0) in vec3     inNormal;
 layout (location = 1) in vec2     inTexCoord;
@@ -60,23 +93,32 @@ layout (location = 3) out int  outID;       // エンティティID
 
 
 //------------------------------------------------------------------
-// マテリアル
+// マテリアル参照 (描画毎に更新)
 //------------------------------------------------------------------
-layout (set = 1, binding = 0) uniform Material
+layout (push_constant) uniform Constant
 {
-    vec3  albedo;
-    float metallic;
-    vec3  emission;
-    float roughness;
-    vec2  textureTiling;
-} u_material;
+    uint materialTable; // マテリアルテーブルのバッファインデックス
+    uint materialIndex; // テーブル内のインデックス
+};
 
 //------------------------------------------------------------------
-// テクスチャ
+// バインドレス (set 1 はレンダラー共通のセットに置き換えられる)
 //------------------------------------------------------------------
-  layout (set = 1, binding = 1) uniform sampler2D u_albedo;
-//layout (set = 1, binding = 2) uniform sampler2D u_normal;
-//layout (set = 1, binding = 3) uniform sampler2D u_emission;
+struct MaterialParameter
+{
+    vec4 albedo;        // w: メタリック
+    vec4 emission;      // w: ラフネス
+    vec2 textureTiling;
+    uint albedoTexture;
+    uint padding;
+};
+
+layout (set = 1, binding = 0) uniform sampler2D bindlessTextures[];
+
+layout (std430, set = 1, binding = 1) readonly buffer MaterialTable
+{
+    MaterialParameter materials[];
+} materialTables[];
 
 
 vec3 Ganmma(vec3 color, float ganmma)
@@ -87,13 +129,16 @@ vec3 Ganmma(vec3 color, float ganmma)
 
 void main()
 {
+    // インデックスはプッシュ定数から求めるので、描画内で一様 (nonuniformEXT は不要)
+    MaterialParameter material = materialTables[materialTable].materials[materialIndex];
+
     //----------------------------------------------------------------------------
     // RT[0]
     //----------------------------------------------------------------------------
 
     // ベースカラー
-    vec4 albedo    = vec4(u_material.albedo, 1.0);
-    vec4 albedomap = texture(u_albedo, inTexCoord);
+    vec4 albedo    = vec4(material.albedo.rgb, 1.0);
+    vec4 albedomap = texture(bindlessTextures[material.albedoTexture], inTexCoord * material.textureTiling);
 
     // 透明は書き込まない (完全に0.0ではない場合があるので 0.01に)
     if (albedomap.a < 0.01)
@@ -104,7 +149,7 @@ void main()
 
     // カラー・ラフネス
     outAlbedo.rgb = albedomap.rgb; // Ganmma(albedomap.rgb, 2.2);
-    outAlbedo.a   = u_material.roughness;
+    outAlbedo.a   = material.emission.w;
 
     //----------------------------------------------------------------------------
     // RT[1]
@@ -121,7 +166,7 @@ void main()
     vec3 normal        = convertNormal;
 
     outNormal.rgb = normal;
-    outNormal.a   = u_material.metallic;
+    outNormal.a   = material.albedo.w;
 
     //----------------------------------------------------------------------------
     // RT[2]
@@ -132,7 +177,7 @@ void main()
     //vec3 emission    = emissionmap.rgb;
 
     // エミッション
-    vec3 emission = u_material.emission;
+    vec3 emission = material.emission.rgb;
     outEmission   = emission; //Ganmma(emission, 2.2);
 
     //----------------------------------------------------------------------------
@@ -140,6 +185,4 @@ void main()
     //----------------------------------------------------------------------------
 
     outID = inID; // エンティティID
-
-    outID = int(normal.x * 10.0) + int(normal.y * 10.0) + int(normal.z * 10.0);
 }
@@ -5,46 +5,27 @@
 #version 450
 
 layout(location = 0) in vec3 inPos;
-layout(location = 1) in vec3 inNormal;
-layout(location = 2) in vec2 inTexCoord;
-layout(location = 3) in vec3 inTangent;
-layout(location = 4) in vec3 inBitangent;
 
 
-//uniform mat4 model;
-//uniform int  instanceOffset;
-
-//struct InstanceParameter
-//{
-//    mat4  transformMatrix;
-//    mat4  normalMatrix;
-//    ivec4 pixelID;
-//};
+struct InstanceParameter
+{
+    mat4  transformMatrix;
+    mat4  normalMatrix;
+    ivec4 pixelID;
+};
 
 // インスタンスバッファ
-//layout (std430, binding = 0) buffer InstanceParameterStorage
-//{
-//    InstanceParameter parameter[];
-//;
-
-
-layout (set = 0, binding = 0) uniform Transform
+layout (std430, set = 0, binding = 0) readonly buffer InstanceParameterStorage
 {
-    mat4 world;
+    InstanceParameter parameter[];
 };
 
 
 void main()
 {
-    // SSBOを使う場合
-    //mat4 worldMatrix = parameter[instanceOffset + gl_InstanceID].transformMatrix;
-    //gl_Position = worldMatrix * vec4(inPos, 1.0);
-
-    // 頂点インスタンスを使った場合
-    //gl_Position = aTransform0 * vec4(aPos, 1.0);
-    //gl_Position = model * vec4(aPos, 1.0);
-
-    gl_Position = world * vec4(inPos, 1.0);
+    // gl_InstanceIndex は描画引数の firstInstance を含むので、インスタンスオフセットを別途渡す必要はない
+    mat4 worldMatrix = parameter[gl_InstanceIndex].transformMatrix;
+    gl_Position = worldMatrix * vec4(inPos, 1.0);
 }
 
 
@@ -0,0 +1,67 @@
+
+//===================================================================================
+// コンピュートシェーダ
+//-----------------------------------------------------------------------------------
+// 深度バッファから階層深度 (Hi-Z) のミップチェーンを構築する
+// 各テクセルは 下位ミップの対応領域の 最大深度 (最も奥) を保持するので、
+// ある領域の深度がこの値より手前にあれば、その領域内で必ずどこかが可視となる
+//===================================================================================
+#pragma COMPUTE
+#version 450
+
+layout (local_size_x = 8, local_size_y = 8) in;
+
+layout (push_constant) uniform Constant
+{
+    ivec2 srcSize;  // 読み取り元のサイズ
+    ivec2 dstSize;  // 書き込み先のサイズ
+    int   level;    // 書き込み先のミップレベル (0 の場合は深度バッファからコピー)
+};
+
+layout (set = 0, binding = 0)       uniform           sampler2D depthTexture;
+layout (set = 0, binding = 1, r32f) uniform readonly  image2D   srcImage;
+layout (set = 0, binding = 2, r32f) uniform writeonly image2D   dstImage;
+
+float LoadSource(ivec2 coord)
+{
+    return imageLoad(srcImage, min(coord, srcSize - 1)).r;
+}
+
+void main()
+{
+    ivec2 coord = ivec2(gl_GlobalInvocationID.xy);
+    if (coord.x >= dstSize.x || coord.y >= dstSize.y)
+        return;
+
+    if (level == 0)
+    {
+        imageStore(dstImage, coord, vec4(texelFetch(depthTexture, coord, 0).r));
+        return;
+    }
+
+    ivec2 src = coord * 2;
+
+    float depth = max(max(LoadSource(src + ivec2(0, 0)), LoadSource(src + ivec2(1, 0))),
+                      max(LoadSource(src + ivec2(0, 1)), LoadSource(src + ivec2(1, 1))));
+
+    // 読み取り元が奇数サイズの場合、端のテクセルは 3列 (行) 分を含めないと保守的にならない
+    bool extraX = ((srcSize.x & 1) != 0) && (coord.x == dstSize.x - 1);
+    bool extraY = ((srcSize.y & 1) != 0) && (coord.y == dstSize.y - 1);
+
+    if (extraX)
+    {
+        depth = max(depth, max(LoadSource(src + ivec2(2, 0)), LoadSource(src + ivec2(2, 1))));
+    }
+
+    if (extraY)
+    {
+        depth = max(depth, max(LoadSource(src + ivec2(0, 2)), LoadSource(src + ivec2(1, 2))));
+    }
+
+    if (extraX && extraY)
+    {
+        depth = max(depth, LoadSource(src + ivec2(2, 2)));
+    }
+
+    imageStore(dstImage, coord, vec4(depth));
+}
@@ -5,10 +5,6 @@
 #version 450
 
 layout (location = 0) in vec3 inPos;
-layout (location = 1) in vec3 inNormal;
-layout (location = 2) in vec2 inTexCoord;
-layout (location = 3) in vec3 inTangent;
-layout (location = 4) in vec3 inBitangent;
 
 layout (location = 0) out vec3 outPosAsUV;
 
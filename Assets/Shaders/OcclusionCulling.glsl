@@ -0,0 +1,186 @@
+
+//===================================================================================
+// コンピュートシェーダ
+//-----------------------------------------------------------------------------------
+// 2フェーズ オクルージョンカリング
+//
+// [フェーズ0] 前フレームで可視だったオブジェクトのうち、視錐台内のものを描画引数に追加する
+// [フェーズ1] フェーズ0 の描画から構築した Hi-Z で全オブジェクトを判定し、
+//            フェーズ0 で描画されなかった可視オブジェクトを描画引数に追加する (判定結果は次フレームで使用)
+//
+// compact が有効な場合は可視オブジェクトのみを詰めて書き込み、描画数をアトミックに加算する
+// 無効な場合 (DrawIndirectCount 非対応) は オブジェクト毎の位置に書き込み、不可視は instanceCount = 0 とする
+// (描画数は どちらの場合も加算するので、統計として読み戻せる)
+//===================================================================================
+#pragma COMPUTE
+#version 450
+
+layout (local_size_x = 64) in;
+
+layout (push_constant) uniform Constant
+{
+    mat4 viewProjection;
+    vec4 hizSize;     // xy: Hi-Z ミップ0 のサイズ, z: ミップ数
+    uint numObject;
+    uint phase;
+    uint compact;
+};
+
+struct ObjectBounds
+{
+    vec4 center;
+    vec4 extent;
+};
+
+struct DrawCommand
+{
+    uint indexCount;
+    uint instanceCount;
+    uint firstIndex;
+    int  vertexOffset;
+    uint firstInstance;
+};
+
+layout (std430, set = 0, binding = 0) readonly buffer BoundsStorage
+{
+    ObjectBounds bounds[];
+};
+
+layout (std430, set = 0, binding = 1) readonly buffer DrawStorage
+{
+    DrawCommand draws[];
+};
+
+layout (std430, set = 0, binding = 2) buffer VisibilityStorage
+{
+    uint visibility[];
+};
+
+// 先頭 16 バイトに描画数 (CPU 側の IndirectDrawCountOffset と同じ配置)
+layout (std430, set = 0, binding = 3) buffer EarlyCommandStorage
+{
+    uint        earlyCount;
+    uint        earlyPadding[3];
+    DrawCommand earlyCommands[];
+};
+
+layout (std430, set = 0, binding = 4) buffer LateCommandStorage
+{
+    uint        lateCount;
+    uint        latePadding[3];
+    DrawCommand lateCommands[];
+};
+
+layout (set = 0, binding = 5) uniform sampler2D hizTexture;
+
+
+// スクリーン空間の矩形 (uv) と 最も手前の深度を求める / 近平面と交差する場合は false
+bool ProjectBounds(ObjectBounds object, out vec4 out_rect, out float out_minDepth)
+{
+    vec2  rectMin  = vec2( 1.0);
+    vec2  rectMax  = vec2(-1.0);
+    float minDepth = 1.0;
+
+    for (int i = 0; i < 8; i++)
+    {
+        vec3 corner = object.center.xyz + object.extent.xyz * vec3((i & 1) != 0? 1.0 : -1.0, (i & 2) != 0? 1.0 : -1.0, (i & 4) != 0? 1.0 : -1.0);
+        vec4 clip   = viewProjection * vec4(corner, 1.0);
+
+        if (clip.w <= 0.0)
+            return false;
+
+        vec3 ndc = clip.xyz / clip.w;
+        rectMin  = min(rectMin, ndc.xy);
+        rectMax  = max(rectMax, ndc.xy);
+        minDepth = min(minDepth, ndc.z);
+    }
+
+    // ビューポートの Y 軸は反転しているので、NDC の +Y がテクスチャの上端になる
+    out_rect     = clamp(vec4(rectMin.x, -rectMax.y, rectMax.x, -rectMin.y) * 0.5 + 0.5, 0.0, 1.0);
+    out_minDepth = minDepth;
+    return true;
+}
+
+bool IsInsideFrustum(ObjectBounds object)
+{
+    // 各行を平面として使用 (Frustum::FromMatrix と同じ抽出)
+    mat4 m = transpose(viewProjection);
+    vec4 planes[6] = vec4[6](m[3] + m[0], m[3] - m[0], m[3] + m[1], m[3] - m[1], m[3] + m[2], m[3] - m[2]);
+
+    for (int i = 0; i < 6; i++)
+    {
+        float distance = dot(planes[i].xyz, object.center.xyz) + planes[i].w;
+        float radius   = dot(abs(planes[i].xyz), object.extent.xyz);
+
+        if (distance + radius < 0.0)
+            return false;
+    }
+
+    return true;
+}
+
+bool IsOccluded(ObjectBounds object)
+{
+    vec4  rect;
+    float minDepth;
+    if (!ProjectBounds(object, rect, minDepth))
+        return false;
+
+    // 矩形が 2x2 テクセル以内に収まるミップを選択
+    vec2  size  = (rect.zw - rect.xy) * hizSize.xy;
+    float level = clamp(ceil(log2(max(max(size.x, size.y), 1.0))), 0.0, hizSize.z - 1.0);
+
+    ivec2 mipSize = textureSize(hizTexture, int(level));
+    ivec2 minTexel = clamp(ivec2(rect.xy * vec2(mipSize)), ivec2(0), mipSize - 1);
+    ivec2 maxTexel = clamp(ivec2(rect.zw * vec2(mipSize)), ivec2(0), mipSize - 1);
+
+    float maxDepth = max(max(texelFetch(hizTexture, ivec2(minTexel.x, minTexel.y), int(level)).r,
+                             texelFetch(hizTexture, ivec2(maxTexel.x, minTexel.y), int(level)).r),
+                         max(texelFetch(hizTexture, ivec2(minTexel.x, maxTexel.y), int(level)).r,
+                             texelFetch(hizTexture, ivec2(maxTexel.x, maxTexel.y), int(level)).r));
+
+    return minDepth > maxDepth;
+}
+
+void WriteCommand(uint index, bool draw, bool late)
+{
+    if (!draw && compact != 0)
+        return;
+
+    DrawCommand command = draws[index];
+    command.instanceCount = draw? 1 : 0;
+
+    // 描画数は compact が無効な場合も統計用に加算する
+    uint slot = index;
+    if (draw)
+    {
+        uint count = late? atomicAdd(lateCount, 1) : atomicAdd(earlyCount, 1);
+        slot = (compact != 0)? count : index;
+    }
+
+    if (late) lateCommands[slot]  = command;
+    else      earlyCommands[slot] = command;
+}
+
+void main()
+{
+    uint index = gl_GlobalInvocationID.x;
+    if (index >= numObject)
+        return;
+
+    ObjectBounds object = bounds[index];
+    bool inFrustum      = IsInsideFrustum(object);
+    bool prevVisible    = visibility[index] != 0;
+
+    if (phase == 0)
+    {
+        WriteCommand(index, inFrustum && prevVisible, false);
+    }
+    else
+    {
+        bool visible = inFrustum && !IsOccluded(object);
+
+        WriteCommand(index, visible && !prevVisible, true);
+        visibility[index] = visible? 1 : 0;
+    }
+}
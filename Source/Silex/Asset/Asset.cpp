@@ -3,8 +3,9 @@
 
 #include "Core/Random.h"
 #include "Asset/Asset.h"
-#include "Editor/EditorSplashImage.h"
+#include "Asset/AssetLoader.h"
 #include "Rendering/Mesh.h"
+#include "Rendering/Material.h"
 #include "Rendering/Environment.h"
 #include "Rendering/RenderingStructures.h"
 #include "Rendering/Renderer.h"
@@ -52,24 +53,32 @@ namespace Silex
     //
     //==================================================================================
     // 検討中: アセットを実際にメモリに乗せるタイミングは　シーン読み込み時 / エディター起動時 ？
+    //----------------------------------------------------------------------------------
+    // → 起動時はハンドルのみを生成し、シーン等から参照された時点 (GetAssetAs) で非同期に読み込む
+    //   メモリ予算を超えた場合は、マネージャー以外から参照されていないテクスチャ・メッシュを古い順に解放する
     //==================================================================================
 
 
+    // ハンドルのみ (未読み込み) の場合はデータが nullptr になる
     MeshAsset::MeshAsset() {}
     MeshAsset::MeshAsset(Mesh* asset) : mesh(asset) {}
-    MeshAsset::~MeshAsset() { sldelete(mesh); }
+    MeshAsset::~MeshAsset() { ReleaseData(); }
+    void MeshAsset::ReleaseData() { if (mesh) sldelete(mesh); mesh = nullptr; }
 
     MaterialAsset::MaterialAsset() {}
     MaterialAsset::MaterialAsset(Material* asset) : material(asset) {}
-    MaterialAsset::~MaterialAsset() { sldelete(material); }
+    MaterialAsset::~MaterialAsset() { ReleaseData(); }
+    void MaterialAsset::ReleaseData() { if (material) sldelete(material); material = nullptr; }
 
     Texture2DAsset::Texture2DAsset() {}
     Texture2DAsset::Texture2DAsset(Texture2D* asset) : texture(asset) {}
-    Texture2DAsset::~Texture2DAsset() { Renderer::Get()->DestroyTexture(texture); }
+    Texture2DAsset::~Texture2DAsset() { ReleaseData(); }
+    void Texture2DAsset::ReleaseData() { if (texture) Renderer::Get()->DestroyTexture(texture); texture = nullptr; }
 
     EnvironmentAsset::EnvironmentAsset() {}
     EnvironmentAsset::EnvironmentAsset(Environment* asset) : environment(asset) {}
-    EnvironmentAsset::~EnvironmentAsset() { sldelete(environment); }
+    EnvironmentAsset::~EnvironmentAsset() { ReleaseData(); }
+    void EnvironmentAsset::ReleaseData() { if (environment) sldelete(environment); environment = nullptr; }
 
 
 
@@ -102,8 +111,9 @@ namespace Silex
         // データベースファイルのメタデータを更新する
         instance->_WriteDatabaseToFile(assetDatabasePath);
 
-        // メタデータを元に実際にアセットをメモリにロードする
-        instance->_LoadAssetToMemory(assetDatabasePath);
+        // メタデータを元にアセットのハンドルを生成する (データは参照時に読み込む)
+        instance->loader = slnew(AssetLoader);
+        instance->_CreateAssetHandles();
     }
 
     void AssetManager::Finalize()
@@ -111,6 +121,9 @@ namespace Silex
         // データベースファイルのメタデータを更新する
         instance->_WriteDatabaseToFile(assetDatabasePath);
 
+        // 読み込み中のジョブの完了を待機
+        sldelete(instance->loader);
+
         instance->_DestroyBuiltinAssets();
 
         if (instance)
@@ -146,6 +159,176 @@ namespace Silex
         return assetData.contains(id);
     }
 
+    Ref<Asset> AssetManager::GetAsset(const AssetID id)
+    {
+        auto it = assetData.find(id);
+        if (it == assetData.end())
+            return nullptr;
+
+        const Ref<Asset>& asset = it->second;
+        if (asset && asset->residency == AssetResidency::Unloaded)
+        {
+            _RequestLoad(asset);
+        }
+
+        return asset;
+    }
+
+    void AssetManager::Update()
+    {
+        SL_SCOPE_PROFILE("AssetManager::Update");
+
+        currentFrame++;
+
+        loader->Update([this](const Ref<Asset>& asset, uint64 bytes, bool succeeded)
+        {
+            _OnAssetUploaded(asset, bytes, succeeded);
+        });
+
+        // 一連の読み込みが完了した時点で処理時間を出力
+        if (loader->IsIdle())
+        {
+            loader->Report();
+        }
+
+        _EvictAssets();
+    }
+
+    AssetStreamingStats AssetManager::GetStreamingStats() const
+    {
+        AssetStreamingStats stats = {};
+        stats.residentBytes = residentBytes;
+        stats.budgetBytes   = memoryBudget;
+        stats.numLoad       = numLoad;
+        stats.numEviction   = numEviction;
+        stats.evictedBytes  = evictedBytes;
+
+        for (const auto& [id, asset] : assetData)
+        {
+            if (!asset)
+                continue;
+
+            stats.numResident += asset->residency == AssetResidency::Resident? 1 : 0;
+            stats.numLoading  += asset->residency == AssetResidency::Loading?  1 : 0;
+        }
+
+        return stats;
+    }
+
+    void AssetManager::_RequestLoad(const Ref<Asset>& asset)
+    {
+        asset->residency = AssetResidency::Loading;
+        loader->Add(asset);
+    }
+
+    void AssetManager::_OnAssetUploaded(const Ref<Asset>& asset, uint64 bytes, bool succeeded)
+    {
+        // 読み込み中に削除されたアセットは追い出しの対象にならないので、常駐量に加算せずにデータを解放する
+        auto it = assetData.find(asset->GetAssetID());
+        if (it == assetData.end() || it->second.Get() != asset.Get())
+        {
+            asset->ReleaseData();
+            asset->residency     = AssetResidency::Unloaded;
+            asset->residentBytes = 0;
+            return;
+        }
+
+        asset->residency     = succeeded? AssetResidency::Resident : AssetResidency::Failed;
+        asset->residentBytes = bytes;
+        asset->lastUsedFrame = currentFrame;
+
+        residentBytes += bytes;
+        numLoad++;
+    }
+
+    void AssetManager::_EvictAssets()
+    {
+        // マネージャーのみが参照しているマテリアルからのテクスチャ参照 (テクスチャ → 参照しているマテリアル)
+        // これらの参照はテクスチャを解放する時にマテリアルごと手放せるので、使用中の参照として数えない
+        std::unordered_map<const Asset*, std::vector<Asset*>> idleMaterialRefs;
+        for (auto& [id, asset] : assetData)
+        {
+            if (!asset || !asset->IsAssetOf(AssetType::Material) || !asset->IsResident() || asset->GetRefCount() != 1 || IsBuiltInAssetID(id))
+                continue;
+
+            Material* material = asset.As<MaterialAsset>()->Get();
+            if (material && material->albedoMap)
+            {
+                idleMaterialRefs[material->albedoMap.Get()].push_back(asset.Get());
+            }
+        }
+
+        auto getIdleRefCount = [&](const Asset* asset) -> uint64
+        {
+            auto it = idleMaterialRefs.find(asset);
+            return it != idleMaterialRefs.end()? it->second.size() : 0;
+        };
+
+        // 参照されているアセットは使用中として扱う (参照が外れた時点から古くなっていく)
+        for (auto& [id, asset] : assetData)
+        {
+            if (asset && asset->GetRefCount() > 1 + getIdleRefCount(asset.Get()))
+            {
+                asset->lastUsedFrame = currentFrame;
+            }
+        }
+
+        if (residentBytes <= memoryBudget)
+            return;
+
+        // マネージャー (と未使用のマテリアル) のみが参照しているテクスチャ・メッシュを、最後に使用されたフレームが古い順に解放
+        std::vector<Asset*> candidates;
+        for (auto& [id, asset] : assetData)
+        {
+            if (!asset || !asset->IsResident() || IsBuiltInAssetID(id))
+                continue;
+
+            if (asset->GetRefCount() != 1 + getIdleRefCount(asset.Get()))
+                continue;
+
+            if (asset->IsAssetOf(AssetType::Texture) || asset->IsAssetOf(AssetType::Mesh))
+            {
+                candidates.push_back(asset.Get());
+            }
+        }
+
+        std::sort(candidates.begin(), candidates.end(), [](const Asset* a, const Asset* b)
+        {
+            return a->lastUsedFrame < b->lastUsedFrame;
+        });
+
+        auto evict = [this](Asset* asset)
+        {
+            // GPU リソースの破棄はレンダラー側でフレームの完了まで遅延される
+            asset->ReleaseData();
+            asset->residency = AssetResidency::Unloaded;
+
+            residentBytes -= asset->residentBytes;
+            evictedBytes  += asset->residentBytes;
+            numEviction++;
+
+            asset->residentBytes = 0;
+        };
+
+        for (Asset* asset : candidates)
+        {
+            if (residentBytes <= memoryBudget)
+                break;
+
+            // テクスチャへの最後の参照を持つマテリアルを先に解放する (解放対象にならないテクスチャのマテリアルは残す)
+            auto it = idleMaterialRefs.find(asset);
+            if (it != idleMaterialRefs.end())
+            {
+                for (Asset* material : it->second)
+                {
+                    evict(material);
+                }
+            }
+
+            evict(asset);
+        }
+    }
+
     AssetMetadata AssetManager::GetMetadata(AssetID id)
     {
         return metadata[id];
@@ -336,6 +519,11 @@ namespace Silex
     {
         if (assetData.contains(id))
         {
+            if (const Ref<Asset>& asset = assetData[id])
+            {
+                residentBytes -= asset->residentBytes;
+            }
+
             assetData.erase(id);
         }
     }
@@ -367,72 +555,25 @@ namespace Silex
         fout << out.c_str();
     }
 
-    //===========================================================================
-    // マテリアルがテクスチャに依存するので、アセットタイプごとにイテレーションするようにする
-    // 必要があれば、アセットタイプごとのデータ群を返す関数を追加する
-    //===========================================================================
-    void AssetManager::_LoadAssetToMemory(const std::filesystem::path& filePath)
+    void AssetManager::_CreateAssetHandles()
     {
-        INIT_PROCESS("Load Texture", 20);
-
-        // テクスチャ2D: マテリアルから参照されるので、最初に読み込むこと!
-        for (auto& [aid, md] : metadata)
+        for (auto& [id, md] : metadata)
         {
-            if (md.type == AssetType::Texture && !IsBuiltInAssetID(aid))
-            {
-                AssetID id       = md.id;
-                std::string path = md.path.string();
-
-                Ref<Asset> asset = nullptr;
-                asset = LoadAssetFromFile<Texture2DAsset>(path);
-
-                instance->_AddToAssetAndID(id, asset);
-            }
-        }
-
-        INIT_PROCESS("Load EnvironmentMap", 40);
-
-        // 環境マップ
-        for (auto& [aid, md] : metadata)
-        {
-            if (md.type == AssetType::Environment && !IsBuiltInAssetID(aid))
-            {
-                AssetID id       = md.id;
-                std::string path = md.path.string();
-
-                Ref<Asset> asset = LoadAssetFromFile<EnvironmentAsset>(path);
-                instance->_AddToAssetAndID(id, asset);
-            }
-        }
-
-        INIT_PROCESS("Load Material", 60);
+            if (IsBuiltInAssetID(id))
+                continue;
 
-        // マテリアル
-        for (auto& [aid, md] : metadata)
-        {
-            if (md.type == AssetType::Material && !IsBuiltInAssetID(aid))
+            Ref<Asset> asset = nullptr;
+            switch (md.type)
             {
-                AssetID id       = md.id;
-                std::string path = md.path.string();
-
-                Ref<Asset> asset = LoadAssetFromFile<MaterialAsset>(path);
-                instance->_AddToAssetAndID(id, asset);
+                case AssetType::Texture:     asset = CreateRef<Texture2DAsset>();   break;
+                case AssetType::Material:    asset = CreateRef<MaterialAsset>();    break;
+                case AssetType::Mesh:        asset = CreateRef<MeshAsset>();        break;
+                case AssetType::Environment: asset = CreateRef<EnvironmentAsset>(); break;
+                default: continue;
             }
-        }
-
-        INIT_PROCESS("Load Mesh", 80);
-
-        // メッシュ
-        for (auto& [aid, md] : metadata)
-        {
-            if (md.type == AssetType::Mesh && !IsBuiltInAssetID(aid))
-            {
-                AssetID id       = md.id;
-                std::string path = md.path.string();
 
-                Ref<Asset> asset = LoadAssetFromFile<MeshAsset>(path);
-                instance->_AddToAssetAndID(id, asset);
-            }
+            asset->SetupAssetProperties(md.path.string(), md.type);
+            _AddToAssetAndID(id, asset);
         }
     }
 }
@@ -10,6 +10,7 @@
 namespace Silex
 {
     class Mesh;
+    class AssetLoader;
     class Material;
     class Texture2D;
     class Environment;
@@ -27,6 +28,15 @@ namespace Silex
         None = 0,
     };
 
+    // ストリーミングの常駐状態
+    enum class AssetResidency : uint32
+    {
+        Unloaded, // ハンドルのみ (データ未読み込み / 解放済み)
+        Loading,  // 読み込み中
+        Resident, // 読み込み済み
+        Failed,   // 読み込み失敗 (再要求しない)
+    };
+
     struct AssetMetadata
     {
         AssetID               id;
@@ -34,6 +44,12 @@ namespace Silex
         std::filesystem::path path;
     };
 
+    //=========================================
+    // アセット (ハンドル)
+    //-----------------------------------------
+    // データベースに登録された全アセットのハンドルは常に存在し、データ (メッシュ・テクスチャ等) のみを
+    // 参照時に読み込み、メモリ予算を超えた場合に解放する (ハンドルを保持している参照先はそのまま使用できる)
+    //=========================================
     class Asset : public Object
     {
         SL_CLASS(Asset, Object)
@@ -60,6 +76,14 @@ namespace Silex
         void               SetName(const std::string& name) { assetName = name; }
         const std::string& GetName() const                  { return assetName; }
 
+        // 常駐状態
+        AssetResidency GetResidency()     const { return residency;     }
+        bool           IsResident()       const { return residency == AssetResidency::Resident; }
+        uint64         GetResidentBytes() const { return residentBytes; }
+
+        // 読み込んだデータを解放し、ハンドルのみの状態に戻す
+        virtual void ReleaseData() {}
+
         // プロパティ設定
         void SetupAssetProperties(const std::string& filePath, AssetType flag)
         {
@@ -91,6 +115,13 @@ namespace Silex
         AssetType   assetFlag      = AssetType::None;
         std::string assetFilePath  = {};
         std::string assetName      = {};
+
+        // ストリーミング (AssetManager が管理する)
+        AssetResidency residency     = AssetResidency::Unloaded;
+        uint64         residentBytes = 0;
+        uint64         lastUsedFrame = 0;
+
+        friend class AssetManager;
     };
 
 
@@ -107,9 +138,11 @@ namespace Silex
         Mesh* Get() const      { return mesh;  }
         void  Set(Mesh* asset) { mesh = asset; }
 
+        void ReleaseData() override;
+
     private:
 
-        Mesh* mesh;
+        Mesh* mesh = nullptr;
     };
 
     class MaterialAsset : public Asset
@@ -125,9 +158,11 @@ namespace Silex
         Material* Get() const          { return material;  }
         void      Set(Material* asset) { material = asset; }
 
+        void ReleaseData() override;
+
     private:
 
-        Material* material;
+        Material* material = nullptr;
     };
 
     class Texture2DAsset : public Asset
@@ -143,9 +178,11 @@ namespace Silex
         Texture2D* Get() const           { return texture;  }
         void       Set(Texture2D* asset) { texture = asset; }
 
+        void ReleaseData() override;
+
     private:
 
-        Texture2D* texture;
+        Texture2D* texture = nullptr;
     };
 
 
@@ -162,9 +199,11 @@ namespace Silex
         Environment* Get() const             { return environment;  }
         void         Set(Environment* asset) { environment = asset; }
 
+        void ReleaseData() override;
+
     private:
 
-        Environment* environment;
+        Environment* environment = nullptr;
     };
 
 
@@ -173,6 +212,18 @@ namespace Silex
 
 
 
+    struct AssetStreamingStats
+    {
+        uint64 residentBytes = 0; // 常駐しているテクスチャ・メッシュの GPU メモリ (見積もり)
+        uint64 budgetBytes   = 0;
+        uint32 numResident   = 0;
+        uint32 numLoading    = 0;
+        uint64 numLoad       = 0; // 起動からの累計
+        uint64 numEviction   = 0; // 起動からの累計
+        uint64 evictedBytes  = 0; // 起動からの累計
+    };
+
+
     class AssetManager
     {
     public:
@@ -205,16 +256,26 @@ namespace Silex
         bool IsLoaded(const AssetID id);
         std::unordered_map<AssetID, Ref<Asset>>& GetAllAssets();
 
+        // ハンドルを返し、データが未読み込みであれば非同期に読み込む (読み込み完了までは Get() が nullptr を返す)
         template<class T>
         Ref<T> GetAssetAs(const AssetID id)
         {
-            return assetData[id].As<T>();
+            return GetAsset(id).As<T>();
         }
 
-        Ref<Asset> GetAsset(const AssetID id)
-        {
-            return assetData[id];
-        }
+        Ref<Asset> GetAsset(const AssetID id);
+
+        //=================================
+        // ストリーミング
+        //=================================
+        // 毎フレーム呼び出す (読み込み完了分のアップロードと、予算超過分の解放)
+        void Update();
+
+        // 予算を超えた場合に、マネージャー以外から参照されていないテクスチャ・メッシュを古い順に解放する
+        void   SetMemoryBudget(uint64 bytes) { memoryBudget = bytes; }
+        uint64 GetMemoryBudget() const       { return memoryBudget;  }
+
+        AssetStreamingStats GetStreamingStats() const;
 
         template<class T, class... Args>
         Ref<T> CreateAsset(const std::filesystem::path& directory, Args&&... args)
@@ -224,6 +285,7 @@ namespace Silex
 
             AssetMetadata metadata = instance->_AddToMetadata(directory);
             Ref<T> asset = AssetCreator::Create<T>(directory, Traits::Forward<Args>(args)...);
+            asset->residency = AssetResidency::Resident;
 
             instance->_AddToAssetAndID(metadata.id, asset);
             instance->_WriteDatabaseToFile(assetDatabasePath);
@@ -269,6 +331,7 @@ namespace Silex
             Ref<T> asset = AssetImporter::Import<T>(filePath);
             asset->SetAssetType(type);
             asset->SetName(name);
+            asset->residency = AssetResidency::Resident;
             instance->_AddToAssetAndID(currentBuiltinAssetCount, asset);
 
             AssetMetadata md = {};
@@ -303,8 +366,13 @@ namespace Silex
         // アセットデータベースファイルにメタデータを書き込む
         void _WriteDatabaseToFile(const std::filesystem::path& directory);
 
-        // メモリにアセットをロードする
-        void _LoadAssetToMemory(const std::filesystem::path& filePath);
+        // メタデータからアセットのハンドルを生成する (データは参照時に読み込む)
+        void _CreateAssetHandles();
+
+        // ストリーミング
+        void _RequestLoad(const Ref<Asset>& asset);
+        void _OnAssetUploaded(const Ref<Asset>& asset, uint64 residentBytes, bool succeeded);
+        void _EvictAssets();
 
     private:
 
@@ -314,6 +382,14 @@ namespace Silex
         std::unordered_map<AssetID, Ref<Asset>>    assetData;
         std::unordered_map<AssetID, AssetMetadata> metadata;
 
+        AssetLoader* loader        = nullptr;
+        uint64       memoryBudget  = 1024ull * 1024 * 1024;
+        uint64       currentFrame  = 0;
+        uint64       residentBytes = 0;
+        uint64       numLoad       = 0;
+        uint64       numEviction   = 0;
+        uint64       evictedBytes  = 0;
+
         static inline const char* assetDatabasePath = "Assets/AssetDatabase.meta";
         static inline const char* assetDiectoryPath = "Assets";
 
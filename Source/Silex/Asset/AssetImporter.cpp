@@ -7,8 +7,8 @@
 #include "Rendering/Environment.h"
 #include "Rendering/RenderingStructures.h"
 #include "Rendering/Renderer.h"
+#include "Rendering/TextureCooker.h"
 #include "Core/Random.h"
-#include "Asset/TextureReader.h"
 
 
 namespace Silex
@@ -28,19 +28,8 @@ namespace Silex
     template<>
     Ref<Texture2DAsset> AssetImporter::Import<Texture2DAsset>(const std::string& filePath)
     {
-        Texture2D* texture = nullptr;
-
-        TextureReader reader;
-        if (reader.IsHDR(filePath.c_str()))
-        {
-            float* pixelData = reader.ReadHDR(filePath.c_str());
-            texture = Renderer::Get()->CreateTextureFromMemory(pixelData, reader.data.byteSize, reader.data.width, reader.data.height, true);
-        }
-        else
-        {
-            byte* pixelData = reader.Read(filePath.c_str());
-            texture = Renderer::Get()->CreateTextureFromMemory(pixelData, reader.data.byteSize, reader.data.width, reader.data.height, true);
-        }
+        // インポート時にクックし、以降の読み込みではクック済みファイルを使用する
+        Texture2D* texture = TextureCooker::Load(filePath);
 
         Ref<Texture2DAsset> asset = CreateRef<Texture2DAsset>(texture);
         asset->SetupAssetProperties(filePath, AssetType::Texture);
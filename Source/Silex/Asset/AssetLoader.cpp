@@ -0,0 +1,397 @@
+#include "PCH.h"
+
+#include "Asset/AssetLoader.h"
+#include "Rendering/Mesh.h"
+#include "Rendering/Material.h"
+#include "Rendering/Environment.h"
+#include "Rendering/Renderer.h"
+#include "Rendering/CookedFile.h"
+#include "Serialize/AssetSerializer.h"
+
+#include <yaml-cpp/yaml.h>
+
+
+namespace Silex
+{
+    // 同時に処理するアセット数 (ワーカー数あたり)
+    static const uint32 MaxInFlightPerWorker = 2;
+
+    static bool ReadFileData(const std::string& path, std::vector<byte>& out_data)
+    {
+        std::ifstream stream(path, std::ios::binary | std::ios::ate);
+        if (!stream)
+            return false;
+
+        uint64 size = stream.tellg();
+        stream.seekg(0, std::ios::beg);
+
+        out_data.resize(size);
+        return (bool)stream.read((char*)out_data.data(), size);
+    }
+
+    // GPU メモリ使用量の見積もり (クック済みデータは全ミップを含む)
+    static uint64 CalcTextureBytes(const CookedTextureView& view)
+    {
+        return view.header->dataSize;
+    }
+
+    static uint64 CalcMeshBytes(const CookedMeshView& view)
+    {
+        return (uint64)(VertexPositionStride + VertexAttributeStride) * view.header->numVertex + sizeof(uint32) * view.header->numIndex;
+    }
+
+
+    AssetLoader::~AssetLoader()
+    {
+        // ジョブがエントリを参照しているので、完了を待ってから破棄する
+        for (Entry* entry : inFlight)
+        {
+            ThreadPool::Wait(entry->decodeJob);
+            TextureCooker::Close(entry->texture);
+            MeshCooker::Close(entry->mesh);
+            sldelete(entry);
+        }
+
+        for (Entry* entry : pending)
+        {
+            sldelete(entry);
+        }
+    }
+
+    void AssetLoader::Add(const Ref<Asset>& asset)
+    {
+        // 新しいバッチの開始
+        if (IsIdle() && records.empty())
+        {
+            clock.Reset();
+        }
+
+        Entry* entry = slnew(Entry);
+        entry->asset = asset;
+        entry->path  = asset->GetFilePath();
+        entry->type  = asset->GetAssetType();
+
+        pending.push_back(entry);
+    }
+
+    void AssetLoader::Update(const UploadedCallback& onUploaded)
+    {
+        SL_SCOPE_PROFILE("AssetLoader::Update");
+
+        // 依存先の常駐を待っているエントリは枠を消費しない (依存先の発行を妨げないように)
+        const uint32 maxInFlight = std::max(ThreadPool::GetThreadCount(), 1u) * MaxInFlightPerWorker;
+        while (!pending.empty() && inFlight.size() - numBlocked < maxInFlight)
+        {
+            Entry* entry = pending.front();
+            pending.pop_front();
+
+            _Schedule(entry);
+            inFlight.push_back(entry);
+        }
+
+        // デコードが完了し、依存先も常駐しているものを発行順にアップロード
+        numBlocked = 0;
+        for (uint32 i = 0; i < inFlight.size();)
+        {
+            Entry* entry = inFlight[i];
+            if (!ThreadPool::IsCompleted(entry->decodeJob))
+            {
+                i++;
+                continue;
+            }
+
+            if (!_IsDependencyResident(entry))
+            {
+                numBlocked++;
+                i++;
+                continue;
+            }
+
+            _Upload(entry, onUploaded);
+            inFlight.erase(inFlight.begin() + i);
+            sldelete(entry);
+        }
+    }
+
+    void AssetLoader::Flush(const UploadedCallback& onUploaded)
+    {
+        while (!IsIdle())
+        {
+            Update(onUploaded);
+
+            // 最も古い未完了のジョブを待機
+            for (Entry* entry : inFlight)
+            {
+                if (!ThreadPool::IsCompleted(entry->decodeJob))
+                {
+                    ThreadPool::Wait(entry->decodeJob);
+                    break;
+                }
+            }
+        }
+    }
+
+    void AssetLoader::_Schedule(Entry* entry)
+    {
+        JobHandle readJob = ThreadPool::Schedule([this, entry]()
+        {
+            _Read(entry);
+        });
+
+        entry->decodeJob = ThreadPool::Schedule([this, entry]()
+        {
+            _Decode(entry);
+        },
+        { readJob });
+    }
+
+    void AssetLoader::_Read(Entry* entry)
+    {
+        entry->startTime = clock.ElapsedMilli();
+
+        switch (entry->type)
+        {
+            case AssetType::Texture:
+            {
+                // クック済みファイルが無い・古い場合は、デコード段階でクックする
+                entry->textureMapped = TextureCooker::Map(entry->path, entry->texture);
+                break;
+            }
+
+            case AssetType::Material:
+            {
+                entry->failed = !ReadFileData(entry->path, entry->fileData);
+                break;
+            }
+
+            case AssetType::Mesh:
+            {
+                // クック済みファイルが無い・古い場合は、デコード段階でクックする
+                entry->meshMapped = MeshCooker::Map(entry->path, entry->mesh);
+                break;
+            }
+
+            default: break;
+        }
+
+        if (entry->failed)
+        {
+            SL_LOG_ERROR("ファイルの読み込みに失敗しました: {}", entry->path);
+        }
+
+        entry->stageTime[(uint32)AssetLoadStage::Read] = clock.ElapsedMilli() - entry->startTime;
+    }
+
+    void AssetLoader::_Decode(Entry* entry)
+    {
+        if (entry->failed)
+            return;
+
+        float start = clock.ElapsedMilli();
+
+        switch (entry->type)
+        {
+            case AssetType::Texture:
+            {
+                if (entry->textureMapped) CookedFile::Prefetch(entry->texture.mapped);
+                else                      entry->failed = !TextureCooker::CookToMemory(entry->path, entry->texture);
+
+                break;
+            }
+
+            case AssetType::Material:
+            {
+                // ハンドルにはアップロード時に設定する (参照の解決前のデータを描画から参照させない)
+                try
+                {
+                    std::string text(entry->fileData.begin(), entry->fileData.end());
+                    entry->decoded = AssetSerializer<MaterialAsset>::DeserializeFromText(text, entry->dependencies);
+                }
+                catch (const YAML::Exception& e)
+                {
+                    SL_LOG_ERROR("{}: {}", entry->path, e.what());
+                    entry->failed = true;
+                }
+
+                entry->fileData = {};
+                break;
+            }
+
+            case AssetType::Mesh:
+            {
+                if (entry->meshMapped) CookedFile::Prefetch(entry->mesh.mapped);
+                else                   entry->failed = !MeshCooker::CookToMemory(entry->path, entry->mesh);
+
+                break;
+            }
+
+            default: break;
+        }
+
+        entry->stageTime[(uint32)AssetLoadStage::Decode] = clock.ElapsedMilli() - start;
+    }
+
+    void AssetLoader::_Upload(Entry* entry, const UploadedCallback& onUploaded)
+    {
+        float  start         = clock.ElapsedMilli();
+        uint64 residentBytes = 0;
+
+        if (!entry->failed)
+        {
+            switch (entry->type)
+            {
+                case AssetType::Texture:
+                {
+                    // 全ミップを圧縮済みのままアップロードする
+                    Texture2D* texture = TextureCooker::CreateTexture(entry->texture.view);
+
+                    residentBytes = CalcTextureBytes(entry->texture.view);
+                    entry->asset.As<Texture2DAsset>()->Set(texture);
+                    break;
+                }
+
+                case AssetType::Material:
+                {
+                    // デコード時に生成したアセットからデータを移す
+                    Ref<MaterialAsset> decoded = entry->decoded.As<MaterialAsset>();
+                    AssetSerializer<MaterialAsset>::ResolveDependencies(decoded, entry->dependencies);
+
+                    entry->asset.As<MaterialAsset>()->Set(decoded->Get());
+                    decoded->Set(nullptr);
+                    break;
+                }
+
+                case AssetType::Mesh:
+                {
+                    Mesh* mesh = slnew(Mesh);
+                    mesh->Load(entry->mesh.view);
+
+                    residentBytes = CalcMeshBytes(entry->mesh.view);
+                    entry->asset.As<MeshAsset>()->Set(mesh);
+                    break;
+                }
+
+                case AssetType::Environment:
+                {
+                    entry->asset.As<EnvironmentAsset>()->Set(slnew(Environment));
+                    break;
+                }
+
+                default: break;
+            }
+        }
+
+        TextureCooker::Close(entry->texture);
+        MeshCooker::Close(entry->mesh);
+
+        onUploaded(entry->asset, residentBytes, !entry->failed);
+
+        Record& record = records.emplace_back();
+        record.id           = entry->asset->GetAssetID();
+        record.path         = entry->path;
+        record.dependencies = entry->dependencies;
+        record.stageTime[0] = entry->stageTime[0];
+        record.stageTime[1] = entry->stageTime[1];
+        record.stageTime[2] = clock.ElapsedMilli() - start;
+        record.startTime    = entry->startTime;
+        record.endTime      = clock.ElapsedMilli();
+        record.failed       = entry->failed;
+    }
+
+    bool AssetLoader::_IsDependencyResident(Entry* entry)
+    {
+        // デコードで判明した依存先の読み込みを要求する (初回のみ)
+        if (entry->dependencyAssets.size() != entry->dependencies.size())
+        {
+            for (uint64 id : entry->dependencies)
+            {
+                entry->dependencyAssets.push_back(AssetManager::Get()->GetAsset(id));
+            }
+        }
+
+        for (const Ref<Asset>& asset : entry->dependencyAssets)
+        {
+            // 存在しないアセット・読み込みに失敗したアセットは待機しない
+            if (asset && (asset->GetResidency() == AssetResidency::Loading || asset->GetResidency() == AssetResidency::Unloaded))
+                return false;
+        }
+
+        return true;
+    }
+
+    void AssetLoader::Report()
+    {
+        if (records.empty() || !IsIdle())
+            return;
+
+        // 段階ごとの合計 (逐次実行した場合の見積もり)
+        float totalTime = 0.0f;
+        float stageTotal[(uint32)AssetLoadStage::Count] = {};
+        for (const Record& record : records)
+        {
+            for (uint32 i = 0; i < (uint32)AssetLoadStage::Count; i++)
+            {
+                stageTotal[i] += record.stageTime[i];
+            }
+
+            totalTime = std::max(totalTime, record.endTime);
+        }
+
+        float sequentialTime = stageTotal[0] + stageTotal[1] + stageTotal[2];
+
+        // クリティカルパス: 依存関係を辿った 読み込み + デコード + アップロード の合計が最大となる経路
+        // (依存先はアップロードが先に完了するので、記録順に走査すれば依存先の値は計算済み)
+        std::unordered_map<AssetID, uint32> recordIndices;
+        std::vector<float>  pathTime(records.size(), 0.0f);
+        std::vector<uint32> pathPrev(records.size(), ~0u);
+
+        uint32 criticalRecord = 0;
+        for (uint32 i = 0; i < records.size(); i++)
+        {
+            for (uint64 id : records[i].dependencies)
+            {
+                auto it = recordIndices.find(id);
+                if (it != recordIndices.end() && pathTime[it->second] > pathTime[i])
+                {
+                    pathTime[i] = pathTime[it->second];
+                    pathPrev[i] = it->second;
+                }
+            }
+
+            pathTime[i] += records[i].GetTotalTime();
+            recordIndices[records[i].id] = i;
+
+            if (pathTime[i] > pathTime[criticalRecord])
+            {
+                criticalRecord = i;
+            }
+        }
+
+        std::string criticalPath;
+        for (uint32 i = criticalRecord; i != ~0u; i = pathPrev[i])
+        {
+            const Record& record = records[i];
+            std::string node = std::format("{} ({:.2f} ms)", std::filesystem::path(record.path).filename().string(), record.GetTotalTime());
+            criticalPath = criticalPath.empty()? node : node + " -> " + criticalPath;
+        }
+
+        SL_LOG_INFO("[AssetLoader] {} assets: {:.2f} ms (sequential {:.2f} ms, x{:.2f}), read {:.2f} ms, decode {:.2f} ms, upload {:.2f} ms",
+            records.size(), totalTime, sequentialTime, sequentialTime / std::max(totalTime, 0.001f), stageTotal[0], stageTotal[1], stageTotal[2]);
+
+        SL_LOG_INFO("[AssetLoader] critical path {:.2f} ms: {}", pathTime[criticalRecord], criticalPath);
+
+        // アセットごとの処理時間 (遅い順)
+        std::sort(records.begin(), records.end(), [](const Record& a, const Record& b)
+        {
+            return a.GetTotalTime() > b.GetTotalTime();
+        });
+
+        for (const Record& record : records)
+        {
+            SL_LOG_INFO("[AssetLoader] {:8.2f} ms (read {:7.2f}, decode {:7.2f}, upload {:7.2f}, {:8.2f} - {:8.2f}){} {}",
+                record.GetTotalTime(), record.stageTime[0], record.stageTime[1], record.stageTime[2], record.startTime, record.endTime, record.failed? " [failed]" : "", record.path);
+        }
+
+        records.clear();
+    }
+}
@@ -0,0 +1,114 @@
+
+#pragma once
+
+#include "Asset/Asset.h"
+#include "Core/ThreadPool.h"
+#include "Core/Timer.h"
+#include "Rendering/MeshCooker.h"
+#include "Rendering/TextureCooker.h"
+#include <deque>
+
+
+namespace Silex
+{
+    enum class AssetLoadStage : uint32
+    {
+        Read,    // ファイル読み込み (ワーカー)
+        Decode,  // デコード・パース (ワーカー)
+        Upload,  // GPU リソース生成・ハンドルへの設定 (メインスレッド)
+
+        Count,
+    };
+
+
+    //=========================================
+    // アセットの並列読み込み
+    //-----------------------------------------
+    // 各アセットを ファイル読み込み → デコード → アップロード の段階に分け、
+    // 読み込み・デコードはスレッドプールのジョブとして、アップロードはメインスレッドで実行する
+    // (レンダラーのリソース生成はスレッドセーフではないため)
+    //
+    // マテリアルは参照するテクスチャの読み込みを要求し、常駐してからアップロードする
+    // 同時に処理するアセット数を制限し、デコード済みのデータがメモリに溜まり過ぎないようにする
+    //=========================================
+    class AssetLoader
+    {
+    public:
+
+        // アップロード完了時 (失敗時も含む) にメインスレッドから呼び出される
+        using UploadedCallback = std::function<void(const Ref<Asset>& asset, uint64 residentBytes, bool succeeded)>;
+
+        ~AssetLoader();
+
+        // 読み込み要求 (ハンドルにデータを読み込む)
+        void Add(const Ref<Asset>& asset);
+
+        // ジョブの発行と、デコード済みのアセットのアップロードを行う (待機しない)
+        void Update(const UploadedCallback& onUploaded);
+
+        // 全ての要求が完了するまで待機する (待機中は他のジョブを肩代わりする)
+        void Flush(const UploadedCallback& onUploaded);
+
+        bool IsIdle() const { return pending.empty() && inFlight.empty(); }
+
+        // 前回のレポート以降に読み込んだアセットごとの処理時間とクリティカルパスをログに出力
+        void Report();
+
+    private:
+
+        struct Entry
+        {
+            Ref<Asset>  asset = nullptr;
+            std::string path  = {};
+            AssetType   type  = AssetType::None;
+
+            // 段階間で受け渡すデータ
+            std::vector<byte>       fileData         = {};
+            CookedTextureFile       texture          = {};
+            bool                    textureMapped    = false;
+            CookedMeshFile          mesh             = {};
+            bool                    meshMapped       = false;
+            Ref<Asset>              decoded          = nullptr;
+            std::vector<uint64>     dependencies     = {};
+            std::vector<Ref<Asset>> dependencyAssets = {};
+            bool                    failed           = false;
+
+            JobHandle decodeJob = {};
+
+            // バッチ開始からの時刻 (ms)
+            float stageTime[(uint32)AssetLoadStage::Count] = {};
+            float startTime = 0.0f;
+        };
+
+        // レポート用の記録
+        struct Record
+        {
+            AssetID             id;
+            std::string         path;
+            std::vector<uint64> dependencies;
+            float               stageTime[(uint32)AssetLoadStage::Count];
+            float               startTime;
+            float               endTime;
+            bool                failed;
+
+            float GetTotalTime() const { return stageTime[0] + stageTime[1] + stageTime[2]; }
+        };
+
+        void _Schedule(Entry* entry);
+        void _Read(Entry* entry);
+        void _Decode(Entry* entry);
+        void _Upload(Entry* entry, const UploadedCallback& onUploaded);
+
+        bool _IsDependencyResident(Entry* entry);
+
+    private:
+
+        std::deque<Entry*>  pending;
+        std::vector<Entry*> inFlight;
+        uint32              numBlocked = 0;
+
+        // 読み込み中のアセットが無い状態から開始した一連の読み込み (バッチ) の記録
+        std::vector<Record> records;
+        Timer               clock;
+    };
+}
@@ -20,7 +20,7 @@ namespace Silex
             return nullptr;
         }
 
-        stbi_set_flip_vertically_on_load(flipOnRead);
+        stbi_set_flip_vertically_on_load_thread(flipOnRead);
 
         reader->data.pixels = isHDR?
             (void*)stbi_loadf(path, &reader->data.width, &reader->data.height, &reader->data.channels, 4):
@@ -32,6 +32,7 @@ namespace Silex
         }
 
         reader->data.byteSize = reader->data.width * reader->data.height * 4 * (isHDR? sizeof(float) : sizeof(byte));
+        reader->data.isHDR    = isHDR;
         return reader->data.pixels;
     }
 
@@ -60,11 +61,39 @@ namespace Silex
         return (float*)_Read(path, true, flipOnRead, this);
     }
 
+    void* TextureReader::ReadFromMemory(const byte* fileData, uint64 fileSize, bool flipOnRead)
+    {
+        bool isHDR = IsHDR(fileData, fileSize);
+
+        // 反転設定はスレッド毎に保持する (stbi_set_flip_vertically_on_load は全スレッドで共有されるため)
+        stbi_set_flip_vertically_on_load_thread(flipOnRead);
+
+        data.pixels = isHDR?
+            (void*)stbi_loadf_from_memory(fileData, (int)fileSize, &data.width, &data.height, &data.channels, 4):
+            (void*)stbi_load_from_memory(fileData,  (int)fileSize, &data.width, &data.height, &data.channels, 4);
+
+        if (!data.pixels)
+        {
+            SL_LOG_ERROR("テクスチャのデコードに失敗しました: {}", stbi_failure_reason());
+            return nullptr;
+        }
+
+        data.byteSize = data.width * data.height * 4 * (isHDR? sizeof(float) : sizeof(byte));
+        data.isHDR    = isHDR;
+
+        return data.pixels;
+    }
+
     bool TextureReader::IsHDR(const char* path)
     {
         return stbi_is_hdr(path);
 
     }
+
+    bool TextureReader::IsHDR(const byte* fileData, uint64 fileSize)
+    {
+        return stbi_is_hdr_from_memory(fileData, (int)fileSize);
+    }
     void TextureReader::Unload(void* pixelData)
     {
         if (pixelData)
@@ -12,6 +12,7 @@ namespace Silex
         int32 height   = 0;
         int32 channels = 0;
         int64 byteSize = 0;
+        bool  isHDR    = false;
 
         void* pixels  = nullptr;
     };
@@ -24,7 +25,11 @@ namespace Silex
         byte*  Read(const char* path, bool flipOnRead = false);
         float* ReadHDR(const char* path, bool flipOnRead = false);
 
+        // ファイルから読み込み済みのデータをデコード (任意のスレッドから呼び出し可能)
+        void* ReadFromMemory(const byte* fileData, uint64 fileSize, bool flipOnRead = false);
+
         bool IsHDR(const char* path);
+        bool IsHDR(const byte* fileData, uint64 fileSize);
         void Unload(void* data);
 
         TextureSourceData data;
@@ -0,0 +1,450 @@
+
+#include "PCH.h"
+#include "Core/Benchmark.h"
+#include "Core/ThreadPool.h"
+#include "Core/ParallelFor.h"
+#include "Core/TaskGraph.h"
+#include "Core/OS.h"
+#include "Rendering/ShaderCompiler.h"
+#include "Rendering/CookedFile.h"
+#include "Rendering/MeshCooker.h"
+#include "Rendering/Mesh.h"
+#include "Rendering/TextureCooker.h"
+#include "Asset/TextureReader.h"
+
+
+namespace Silex
+{
+    // ナノ秒精度の計測用 (OS::GetTickSeconds はマイクロ秒単位なので、ジョブ単位の計測には粗い)
+    using BenchmarkClock = std::chrono::steady_clock;
+
+    static double ElapsedMilli(BenchmarkClock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(BenchmarkClock::now() - start).count();
+    }
+
+
+    void Benchmark::RunCoreBenchmarks()
+    {
+        SL_LOG_INFO("==================== Core Benchmark ====================");
+
+        ThreadPoolScheduling();
+        ThreadPoolScaling();
+        MemoryContention();
+        ShaderCompilation();
+        MeshLoading();
+        VertexCompression();
+        TextureLoading();
+
+        SL_LOG_INFO("========================================================");
+    }
+
+    void Benchmark::ThreadPoolScheduling()
+    {
+        constexpr uint32 numJobs       = 100'000;
+        constexpr uint32 numRoundTrips = 10'000;
+
+        // 空ジョブの一括発行 → 全完了 (スループット)
+        {
+            std::atomic<uint32> counter = 0;
+
+            auto start = BenchmarkClock::now();
+            for (uint32 i = 0; i < numJobs; i++)
+            {
+                ThreadPool::Schedule([&counter]() { counter.fetch_add(1, std::memory_order_relaxed); });
+            }
+
+            ThreadPool::WaitAll();
+            double ms = ElapsedMilli(start);
+
+            SL_LOG_INFO("[ThreadPool] schedule+wait {} jobs: {:.3f} ms ({:.1f} ns/job)", numJobs, ms, ms * 1'000'000.0 / numJobs);
+        }
+
+        // 1ジョブ発行 → 即待機 (fork / join レイテンシ)
+        {
+            auto start = BenchmarkClock::now();
+            for (uint32 i = 0; i < numRoundTrips; i++)
+            {
+                JobHandle handle = ThreadPool::Schedule([]() {});
+                ThreadPool::Wait(handle);
+            }
+
+            double ms = ElapsedMilli(start);
+            SL_LOG_INFO("[ThreadPool] fork/join round trip: {:.1f} ns", ms * 1'000'000.0 / numRoundTrips);
+        }
+
+        // タスクグラフ (ダイヤモンド型 4ノード) の毎フレーム実行
+        {
+            constexpr uint32 numFrames = 1000;
+
+            TaskGraph graph;
+            auto a = graph.AddNode("A", []() {});
+            auto b = graph.AddNode("B", []() {});
+            auto c = graph.AddNode("C", []() {});
+            auto d = graph.AddNode("D", []() {});
+            graph.AddEdge(a, b);
+            graph.AddEdge(a, c);
+            graph.AddEdge(b, d);
+            graph.AddEdge(c, d);
+
+            auto start = BenchmarkClock::now();
+            for (uint32 i = 0; i < numFrames; i++)
+            {
+                graph.Reset();
+                graph.Execute();
+                graph.Wait();
+            }
+
+            double ms = ElapsedMilli(start);
+            SL_LOG_INFO("[ThreadPool] task graph (4 nodes) per frame: {:.1f} ns", ms * 1'000'000.0 / numFrames);
+        }
+    }
+
+    void Benchmark::ThreadPoolScaling()
+    {
+        constexpr uint32 numElements = 1 << 20;
+        constexpr uint32 grain       = 1024;
+
+        std::vector<float> data(numElements);
+
+        // 1要素あたり数百サイクル程度の計算負荷
+        auto kernel = [&data](uint32 index)
+        {
+            float v = (float)index;
+            for (uint32 i = 0; i < 32; i++)
+            {
+                v = std::sqrt(v * 1.0001f + 1.0f);
+            }
+
+            data[index] = v;
+        };
+
+        const uint32 maxWorkers = ThreadPool::GetThreadCount() + 1;
+        double baseline = 0.0;
+
+        for (uint32 workers = 1; workers <= maxWorkers; workers++)
+        {
+            auto start = BenchmarkClock::now();
+            ParallelFor(numElements, grain, kernel, workers);
+            double ms = ElapsedMilli(start);
+
+            if (workers == 1)
+                baseline = ms;
+
+            SL_LOG_INFO("[ThreadPool] ParallelFor {} threads: {:.3f} ms (x{:.2f})", workers, ms, baseline / ms);
+        }
+    }
+
+    void Benchmark::MemoryContention()
+    {
+        constexpr uint32 numOperations = 200'000;
+        constexpr uint32 numLiveBlocks = 64;
+        constexpr uint32 threadCounts[] = { 1, 2, 4, 8, 16 };
+
+        // 各スレッドが一定数のブロックを保持したまま、ランダムなサイズ (16 ~ 1024 byte) で解放・確保を繰り返す
+        auto run = [&](uint32 numThreads, auto&& allocate, auto&& deallocate)
+        {
+            std::vector<std::thread> workers;
+            workers.reserve(numThreads);
+
+            auto start = BenchmarkClock::now();
+            for (uint32 t = 0; t < numThreads; t++)
+            {
+                workers.emplace_back([&, t]()
+                {
+                    void*  live[numLiveBlocks] = {};
+                    uint32 random = 2463534242u + t;
+
+                    for (uint32 i = 0; i < numOperations; i++)
+                    {
+                        random ^= random << 13;
+                        random ^= random >> 17;
+                        random ^= random << 5;
+
+                        uint32 slot = random % numLiveBlocks;
+                        uint32 size = 16 + (random >> 8) % (1024 - 16);
+
+                        if (live[slot])
+                            deallocate(live[slot]);
+
+                        live[slot] = allocate(size);
+                        static_cast<byte*>(live[slot])[0] = (byte)i;
+                    }
+
+                    for (void* ptr : live)
+                    {
+                        if (ptr)
+                            deallocate(ptr);
+                    }
+                });
+            }
+
+            for (auto& worker : workers)
+                worker.join();
+
+            return ElapsedMilli(start);
+        };
+
+        for (uint32 numThreads : threadCounts)
+        {
+            double poolMs   = run(numThreads, [](uint64 size) { return PoolAllocator::Allocate(size); }, [](void* ptr) { PoolAllocator::Deallocate(ptr); });
+            double mallocMs = run(numThreads, [](uint64 size) { return std::malloc(size);             }, [](void* ptr) { std::free(ptr);                   });
+
+            double totalOps = (double)numOperations * numThreads;
+            SL_LOG_INFO("[Memory] {:>2} threads: pool {:.2f} Mops/s, malloc {:.2f} Mops/s (x{:.2f})", numThreads, totalOps / (poolMs * 1000.0), totalOps / (mallocMs * 1000.0), mallocMs / poolMs);
+        }
+    }
+
+    void Benchmark::ShaderCompilation()
+    {
+        std::vector<std::string> filePaths;
+        for (const auto& entry : std::filesystem::recursive_directory_iterator("Assets/Shaders"))
+        {
+            if (entry.is_regular_file() && entry.path().extension() == ".glsl")
+            {
+                filePaths.push_back(entry.path().generic_string());
+            }
+        }
+
+        // ディレクトリの列挙順に依存しないように
+        std::sort(filePaths.begin(), filePaths.end());
+
+        ShaderCompiler* compiler = ShaderCompiler::Get();
+        std::vector<ShaderCompiledData> results;
+
+        // キャッシュ無し: 逐次
+        compiler->SetCacheEnabled(false);
+
+        auto start = BenchmarkClock::now();
+        for (const std::string& path : filePaths)
+        {
+            ShaderCompiledData data;
+            compiler->Compile(path, data);
+        }
+
+        double sequentialMs = ElapsedMilli(start);
+
+        // キャッシュ無し: 並列
+        start = BenchmarkClock::now();
+        compiler->CompileAll(filePaths, results);
+        double parallelMs = ElapsedMilli(start);
+
+        compiler->SetCacheEnabled(true);
+
+        // キャッシュ有り: 並列 (1回目でキャッシュを生成し、2回目を計測)
+        compiler->CompileAll(filePaths, results);
+
+        start = BenchmarkClock::now();
+        compiler->CompileAll(filePaths, results);
+        double cachedMs = ElapsedMilli(start);
+
+        SL_LOG_INFO("[Shader] {} files: sequential {:.2f} ms, parallel {:.2f} ms (x{:.2f}), cached {:.2f} ms", filePaths.size(), sequentialMs, parallelMs, sequentialMs / parallelMs, cachedMs);
+    }
+
+    void Benchmark::MeshLoading()
+    {
+        const std::string sourcePath = "Assets/Models/Sponza/Sponza.fbx";
+        const std::string cookedPath = MeshCooker::GetCookedPath(sourcePath);
+        const uint64      sourceKey  = MeshCooker::GetSourceKey(sourcePath);
+
+        // GPU へのアップロード (ステージングへのコピー以降) はどちらも同じなので、ステージングへのコピーまでを計測する
+        // Assimp: インポート + 後処理 + 頂点の詰め直し (クックに相当)
+        std::vector<byte> data;
+
+        auto start = BenchmarkClock::now();
+        bool cooked = MeshCooker::Cook(sourcePath, sourceKey, data);
+        double assimpMs = ElapsedMilli(start);
+
+        if (!cooked || !CookedFile::Write(cookedPath, data))
+        {
+            SL_LOG_WARN("[Mesh] {} の読み込みに失敗したため、計測をスキップします", sourcePath);
+            return;
+        }
+
+        CookedMeshView view = {};
+        MeshCooker::Parse(data.data(), data.size(), sourceKey, view);
+
+        const uint64 positionSize  = VertexPositionStride  * view.header->numVertex;
+        const uint64 attributeSize = VertexAttributeStride * view.header->numVertex;
+        const uint64 indexSize     = sizeof(uint32) * view.header->numIndex;
+        std::vector<byte> staging(positionSize + attributeSize + indexSize);
+
+        // クック済み: マップ + 検証 + ステージングへのコピー
+        start = BenchmarkClock::now();
+
+        CookedMeshView mappedView = {};
+        MappedFile mapped = {};
+        bool loaded = OS::Get()->MapFile(cookedPath, mapped) && MeshCooker::Parse(mapped.data, mapped.size, sourceKey, mappedView);
+        if (loaded)
+        {
+            std::memcpy(staging.data(),                                mappedView.positions,  positionSize);
+            std::memcpy(staging.data() + positionSize,                 mappedView.attributes, attributeSize);
+            std::memcpy(staging.data() + positionSize + attributeSize, mappedView.indices,    indexSize);
+        }
+
+        OS::Get()->UnmapFile(mapped);
+        double cookedMs = ElapsedMilli(start);
+
+        if (!loaded)
+        {
+            SL_LOG_WARN("[Mesh] クック済みファイルの読み込みに失敗しました: {}", cookedPath);
+            return;
+        }
+
+        SL_LOG_INFO("[Mesh] {} ({:.2f} MB, {} submeshes): assimp {:.2f} ms, cooked {:.2f} ms (x{:.2f})", sourcePath, data.size() / (1024.0 * 1024.0), view.header->numSubMesh, assimpMs, cookedMs, assimpMs / cookedMs);
+    }
+
+    void Benchmark::VertexCompression()
+    {
+        const std::string sourcePath = "Assets/Models/Sponza/Sponza.fbx";
+
+        CookedMeshFile file;
+        if (!MeshCooker::Map(sourcePath, file) && !MeshCooker::CookToMemory(sourcePath, file))
+        {
+            SL_LOG_WARN("[Vertex] {} の読み込みに失敗したため、計測をスキップします", sourcePath);
+            MeshCooker::Close(file);
+            return;
+        }
+
+        const CookedMeshHeader* header = file.view.header;
+
+        // 頂点フェッチ量 (頂点キャッシュで各頂点が 1回ずつ読み込まれる場合)
+        // 従来はインターリーブした 1ストリームなので、座標のみを参照するシャドウパスでも頂点全体のキャッシュラインを読み込む
+        const uint64 legacyStride   = sizeof(Vertex);
+        const uint64 geometryStride = VertexPositionStride + VertexAttributeStride;
+        const uint64 shadowStride   = VertexPositionStride;
+
+        const double legacyMB   = legacyStride   * header->numVertex / (1024.0 * 1024.0);
+        const double geometryMB = geometryStride * header->numVertex / (1024.0 * 1024.0);
+        const double shadowMB   = shadowStride   * header->numVertex / (1024.0 * 1024.0);
+
+        SL_LOG_INFO("[Vertex] {} ({} vertices): gbuffer {} B/vertex {:.2f} MB (legacy {} B {:.2f} MB, x{:.2f}), shadow {} B/vertex {:.2f} MB (x{:.2f})", sourcePath, header->numVertex,
+            geometryStride, geometryMB, legacyStride, legacyMB, legacyMB / geometryMB, shadowStride, shadowMB, legacyMB / shadowMB);
+
+        // UV の精度 (half は絶対値の最大値の桁で精度が決まる)
+        float maxTexCoord = 0.0f;
+        for (uint64 i = 0; i < header->numVertex; i++)
+        {
+            glm::vec3 normal, tangent;
+            glm::vec2 texcoord;
+            float     sign;
+            VertexFormat::DecodeAttribute(file.view.attributes[i], normal, texcoord, tangent, sign);
+
+            maxTexCoord = std::max({ maxTexCoord, std::abs(texcoord.x), std::abs(texcoord.y) });
+        }
+
+        const float texcoordStep = maxTexCoord > 0.0f? std::exp2(std::floor(std::log2(maxTexCoord)) - 10.0f) : 0.0f;
+
+        // 座標の精度 (量子化時は 量子化範囲 / 32767 が 1ステップ)
+        const glm::vec3 extent       = header->positionExtent;
+        const float     positionStep = QuantizeVertexPosition? std::max({ extent.x, extent.y, extent.z }) / 32767.0f : 0.0f;
+
+        MeshCooker::Close(file);
+
+        // 法線・接線の八面体エンコードの誤差 (一様分布の方向で計測)
+        constexpr uint32 numSample = 100'000;
+
+        std::mt19937 random(0);
+        std::normal_distribution<float> distribution;
+
+        std::vector<Vertex> samples(numSample);
+        for (Vertex& vertex : samples)
+        {
+            glm::vec3 n = glm::vec3(distribution(random), distribution(random), distribution(random));
+            glm::vec3 t = glm::cross(n, glm::vec3(distribution(random), distribution(random), distribution(random)));
+
+            vertex           = {};
+            vertex.Normal    = glm::normalize(n);
+            vertex.Tangent   = glm::normalize(t);
+            vertex.Bitangent = glm::cross(vertex.Normal, vertex.Tangent) * (distribution(random) < 0.0f? -1.0f : 1.0f);
+        }
+
+        std::vector<VertexAttribute> encoded(numSample);
+        VertexFormat::EncodeAttributes(samples.data(), numSample, encoded.data());
+
+        float  maxNormalError  = 0.0f;
+        float  maxTangentError = 0.0f;
+        uint32 signMismatch    = 0;
+        for (uint32 i = 0; i < numSample; i++)
+        {
+            glm::vec3 normal, tangent;
+            glm::vec2 texcoord;
+            float     sign;
+            VertexFormat::DecodeAttribute(encoded[i], normal, texcoord, tangent, sign);
+
+            maxNormalError  = std::max(maxNormalError,  std::acos(std::clamp(glm::dot(normal,  samples[i].Normal),  -1.0f, 1.0f)));
+            maxTangentError = std::max(maxTangentError, std::acos(std::clamp(glm::dot(tangent, samples[i].Tangent), -1.0f, 1.0f)));
+
+            const glm::vec3 bitangent = glm::cross(samples[i].Normal, samples[i].Tangent) * sign;
+            signMismatch += glm::dot(bitangent, samples[i].Bitangent) < 0.0f;
+        }
+
+        SL_LOG_INFO("[Vertex] error: normal {:.4f} deg, tangent {:.4f} deg, bitangent sign {} / {}, uv step {:.6f} (max |uv| {:.2f}), position step {:.4f}",
+            glm::degrees(maxNormalError), glm::degrees(maxTangentError), signMismatch, numSample, texcoordStep, maxTexCoord, positionStep);
+    }
+
+    void Benchmark::TextureLoading()
+    {
+        const std::string sourcePath = "Assets/Models/Sponza/textures/Sponza_Floor_diffuse.png";
+        const std::string cookedPath = TextureCooker::GetCookedPath(sourcePath);
+
+        // レンダラーの初期化前に実行されるので、デバイスの対応状況に関係なく BC 圧縮で計測する
+        // (実行時に非対応の場合はキーが一致しないので、読み込み時に非圧縮で再クックされる)
+        const bool        compress   = true;
+        const uint64      sourceKey  = TextureCooker::GetSourceKey(sourcePath, compress);
+
+        // クック: デコード + ミップチェーン生成 + ブロック圧縮
+        std::vector<byte> data;
+
+        auto start = BenchmarkClock::now();
+        bool cooked = TextureCooker::Cook(sourcePath, sourceKey, compress, data);
+        double cookMs = ElapsedMilli(start);
+
+        if (!cooked || !CookedFile::Write(cookedPath, data))
+        {
+            SL_LOG_WARN("[Texture] {} の読み込みに失敗したため、計測をスキップします", sourcePath);
+            return;
+        }
+
+        // stb: デコード + ステージングへのコピー (ミップマップは GPU で生成していた)
+        start = BenchmarkClock::now();
+
+        TextureReader reader;
+        byte* pixels = reader.Read(sourcePath.c_str());
+        std::vector<byte> staging(reader.data.byteSize);
+        std::memcpy(staging.data(), pixels, reader.data.byteSize);
+        reader.Unload(pixels);
+
+        double stbMs = ElapsedMilli(start);
+
+        // 非圧縮 (RGBA8) の GPU メモリ使用量 (ミップマップを含む)
+        const uint64 uncompressedSize = reader.data.byteSize * 4 / 3;
+
+        CookedTextureView view = {};
+        TextureCooker::Parse(data.data(), data.size(), sourceKey, view);
+
+        // クック済み: マップ + 検証 + ステージングへのコピー (全ミップ)
+        staging.resize(view.header->dataSize);
+        start = BenchmarkClock::now();
+
+        CookedTextureView mappedView = {};
+        MappedFile mapped = {};
+        bool loaded = OS::Get()->MapFile(cookedPath, mapped) && TextureCooker::Parse(mapped.data, mapped.size, sourceKey, mappedView);
+        if (loaded)
+        {
+            std::memcpy(staging.data(), mappedView.data, mappedView.header->dataSize);
+        }
+
+        OS::Get()->UnmapFile(mapped);
+        double cookedMs = ElapsedMilli(start);
+
+        if (!loaded)
+        {
+            SL_LOG_WARN("[Texture] クック済みファイルの読み込みに失敗しました: {}", cookedPath);
+            return;
+        }
+
+        SL_LOG_INFO("[Texture] {} ({}x{}): stb {:.2f} ms ({:.2f} MB), cooked {:.2f} ms ({:.2f} MB, x{:.2f} smaller), cook {:.2f} ms", sourcePath, view.header->width, view.header->height,
+            stbMs, uncompressedSize / (1024.0 * 1024.0), cookedMs, view.header->dataSize / (1024.0 * 1024.0), (double)uncompressedSize / view.header->dataSize, cookMs);
+    }
+}
@@ -0,0 +1,41 @@
+
+#pragma once
+#include "Core/CoreType.h"
+
+
+namespace Silex
+{
+    //=========================================
+    // エンジン内ベンチマーク
+    //-----------------------------------------
+    // SL_ENABLE_BENCHMARK が有効な場合に起動時に実行され、結果をログに出力する
+    //=========================================
+    class Benchmark
+    {
+    public:
+
+        // コア機能 (スレッドプール, アロケータ等) のベンチマークを全て実行
+        static void RunCoreBenchmarks();
+
+        // ジョブ 1つあたりの発行・完了待機のオーバーヘッド
+        static void ThreadPoolScheduling();
+
+        // ParallelFor の参加スレッド数 (1 ~ N) に対するスケーリング
+        static void ThreadPoolScaling();
+
+        // プールアロケータと std::malloc の複数スレッド (1 ~ 16) 競合時のスループット比較
+        static void MemoryContention();
+
+        // Assets/Shaders 以下の全シェーダーのコンパイル時間 (逐次 / 並列, キャッシュ無し / 有り)
+        static void ShaderCompilation();
+
+        // Sponza の読み込み時間 (Assimp によるインポート / クック済みファイルのマップ)
+        static void MeshLoading();
+
+        // Sponza の頂点フェッチ量 (従来の 56 バイト頂点 / 圧縮頂点の座標・属性ストリーム) とエンコード誤差
+        static void VertexCompression();
+
+        // Sponza のテクスチャの読み込み時間とサイズ (stb によるデコード / クック済みファイルのマップ)
+        static void TextureLoading();
+    };
+}
@@ -3,9 +3,12 @@
 
 #include "Core/Engine.h"
 #include "Core/ThreadPool.h"
+#include "Core/Benchmark.h"
 #include "Asset/Asset.h"
 #include "Editor/EditorSplashImage.h"
 #include "Rendering/RenderingContext.h"
+#include "Rendering/RenderingAPI.h"
+#include "Rendering/ShaderCompiler.h"
 #include "Script/Script.h"
 
 
@@ -21,10 +24,15 @@ namespace Silex
 
         // コア機能初期化
         Logger::Initialize();
+        PerformanceProfiler::Initialize();
         Memory::Initialize();
         Input::Initialize();
         ThreadPool::Initialize();
 
+#if SL_ENABLE_BENCHMARK
+        Benchmark::RunCoreBenchmarks();
+#endif
+
         // スプラッシュイメージ表示
         EditorSplashImage::Show();
 
@@ -53,6 +61,7 @@ namespace Silex
         ThreadPool::Finalize();
         Input::Finalize();
         Memory::Finalize();
+        PerformanceProfiler::Finalize();
         Logger::Finalize();
 
         OS::Get()->Finalize();
@@ -107,6 +116,13 @@ namespace Silex
         editor = slnew(Editor);
         editor->Initialize();
 
+        // 起動時のパイプライン生成時間 (キャッシュ無し / 有りでの比較用)
+        PipelineCacheStats cacheStats = renderer->GetAPI()->GetPipelineCacheStats();
+        SL_LOG_INFO("パイプライン生成: {} 個 {:.2f} ms (キャッシュ: {})", cacheStats.numPipeline, cacheStats.creationTimeMs, cacheStats.loadedFromDisk? std::format("{} KB", cacheStats.loadedDataSize / 1024) : "なし");
+
+        ShaderCacheStats shaderCacheStats = ShaderCompiler::Get()->GetCacheStats();
+        SL_LOG_INFO("シェーダーキャッシュ: ヒット {} / ミス {}", shaderCacheStats.numHit, shaderCacheStats.numMiss);
+
         // ウィンドウ表示
         mainWindow->Show();
 
@@ -139,6 +155,9 @@ namespace Silex
             renderer->BeginFrame();
             editorUI->BeginFrame();
 
+            // アセットのストリーミング (読み込み完了分のアップロード・予算超過分の解放)
+            AssetManager::Get()->Update();
+
             // update
             editor->Update(deltaTime);
             editor->UpdateUI();
@@ -159,7 +178,8 @@ namespace Silex
             Input::Flush();
         }
 
-        PerformanceProfiler::Get().GetFrameData(&performanceData, true);
+        PerformanceProfiler::EndFrame();
+        PerformanceProfiler::GetFrameData(&performanceData);
 
         // メインループ抜け出し確認
         return isRunning;
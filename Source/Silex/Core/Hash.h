@@ -42,6 +42,22 @@ namespace Silex
             return value;
         }
 
+        // 任意のバイト列のハッシュ (seed に前回の結果を渡すと、複数のデータを連結したハッシュになる)
+        template<typename T = uint64>
+        static T FNV(const void* data, uint64 byteSize, T seed = fnv1a_constant<T>::offset)
+        {
+            const uint8* bytes = static_cast<const uint8*>(data);
+            T value = seed;
+
+            for (uint64 i = 0; i < byteSize; ++i)
+            {
+                value ^= bytes[i];
+                value *= fnv1a_constant<T>::prime;
+            }
+
+            return value;
+        }
+
         // コンパイル時定数な文字列リテラルのハッシュ
         template<typename T = uint64>
         static consteval T StaticFNV(const char* str)
@@ -0,0 +1,68 @@
+
+#pragma once
+
+#include "Core/Core.h"
+
+
+namespace Silex
+{
+    //==================================================================================
+    // フリーリスト インデックスアロケータ
+    //----------------------------------------------------------------------------------
+    // [0, capacity) のインデックスを払い出し、解放されたインデックスは次の確保で再利用する
+    // バインドレスのスロットなど、固定長テーブル内の位置を割り当てるために使用する
+    //==================================================================================
+    class IndexAllocator
+    {
+    public:
+
+        static constexpr uint32 InvalidIndex = UINT32_MAX;
+
+        void Initialize(uint32 capacityCount)
+        {
+            capacity     = capacityCount;
+            next         = 0;
+            numAllocated = 0;
+            freeList.clear();
+        }
+
+        // 空きがない場合は InvalidIndex を返す
+        uint32 Allocate()
+        {
+            uint32 index = InvalidIndex;
+
+            if (!freeList.empty())
+            {
+                index = freeList.back();
+                freeList.pop_back();
+            }
+            else if (next < capacity)
+            {
+                index = next++;
+            }
+
+            if (index != InvalidIndex)
+                numAllocated++;
+
+            return index;
+        }
+
+        void Free(uint32 index)
+        {
+            SL_ASSERT(index < next);
+
+            freeList.push_back(index);
+            numAllocated--;
+        }
+
+        uint32 GetCapacity()       const { return capacity;     }
+        uint32 GetAllocatedCount() const { return numAllocated; }
+
+    private:
+
+        std::vector<uint32> freeList;
+        uint32              capacity     = 0;
+        uint32              next         = 0;
+        uint32              numAllocated = 0;
+    };
+}
@@ -0,0 +1,116 @@
+
+#include "PCH.h"
+#include "Core/LinearAllocator.h"
+
+
+namespace Silex
+{
+    LinearAllocator::~LinearAllocator()
+    {
+        Finalize();
+    }
+
+    void LinearAllocator::Initialize(uint64 capacityByte)
+    {
+        buffer        = (byte*)Memory::Malloc(capacityByte);
+        capacity      = capacityByte;
+        offset        = 0;
+        highWaterMark = 0;
+    }
+
+    void LinearAllocator::Finalize()
+    {
+        _ReleaseOverflow();
+
+        if (buffer)
+        {
+            Memory::Free(buffer);
+            buffer   = nullptr;
+            capacity = 0;
+            offset   = 0;
+        }
+    }
+
+    void* LinearAllocator::Allocate(uint64 sizeByte, uint64 alignment)
+    {
+        // アライメント調整分を含めて CAS でオフセットを進める
+        uint64 current = offset.load(std::memory_order_relaxed);
+        while (true)
+        {
+            uint64 address = (uint64)buffer + current;
+            uint64 aligned = (address + (alignment - 1)) & ~(alignment - 1);
+            uint64 next    = (aligned - (uint64)buffer) + sizeByte;
+
+            if (next > capacity) SL_UNLIKELY
+            {
+                return _AllocateOverflow(sizeByte, alignment);
+            }
+
+            if (offset.compare_exchange_weak(current, next, std::memory_order_relaxed))
+            {
+                return (void*)aligned;
+            }
+        }
+    }
+
+    void LinearAllocator::Reset()
+    {
+        uint64 used   = offset.load(std::memory_order_relaxed) + overflowSize.load(std::memory_order_relaxed);
+        highWaterMark = std::max(highWaterMark, used);
+
+        if (overflowCount.load(std::memory_order_relaxed) != 0)
+        {
+            SL_LOG_WARN("LinearAllocator: 容量不足によりヒープにフォールバックしました ({} / {} byte, {} 回)", used, capacity, overflowCount.load());
+            _ReleaseOverflow();
+        }
+
+        offset = 0;
+    }
+
+    LinearAllocator::Marker LinearAllocator::GetMarker() const
+    {
+        return offset.load(std::memory_order_relaxed);
+    }
+
+    void LinearAllocator::ResetToMarker(Marker marker)
+    {
+        // 巻き戻す前の使用量も最高使用量として記録しておく
+        uint64 used   = offset.load(std::memory_order_relaxed) + overflowSize.load(std::memory_order_relaxed);
+        highWaterMark = std::max(highWaterMark, used);
+
+        offset.store(marker, std::memory_order_relaxed);
+    }
+
+    void* LinearAllocator::_AllocateOverflow(uint64 sizeByte, uint64 alignment)
+    {
+        // malloc のアライメントを超える要求にも応じられるように、調整分を余分に確保して先頭を揃える
+        // (解放は確保した先頭アドレスで行うので、ブロックには調整前のポインタを保持する)
+        uint64 allocationSize = sizeByte + (alignment - 1);
+        void*  block          = Memory::Malloc(allocationSize);
+
+        {
+            std::lock_guard lock(overflowLock);
+            overflowBlocks.push_back(block);
+        }
+
+        overflowSize.fetch_add(allocationSize, std::memory_order_relaxed);
+        overflowCount.fetch_add(1, std::memory_order_relaxed);
+
+        uint64 aligned = ((uint64)block + (alignment - 1)) & ~(alignment - 1);
+        return (void*)aligned;
+    }
+
+    void LinearAllocator::_ReleaseOverflow()
+    {
+        std::lock_guard lock(overflowLock);
+
+        for (void* ptr : overflowBlocks)
+        {
+            Memory::Free(ptr);
+        }
+
+        overflowBlocks.clear();
+        overflowSize  = 0;
+        overflowCount = 0;
+    }
+}
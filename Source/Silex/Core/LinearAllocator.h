@@ -0,0 +1,151 @@
+
+#pragma once
+
+#include "Core/CoreType.h"
+#include "Core/Memory.h"
+
+
+namespace Silex
+{
+    //==================================================================================
+    // リニア (バンプ) アロケータ
+    //----------------------------------------------------------------------------------
+    // 確保はオフセットを進めるだけで、個別の解放は行わない (Reset で一括解放)
+    // フレーム内でのみ有効な一時データ (描画リスト等) のヒープ確保を無くすために使用する
+    //
+    // ・Allocate はアトミックにオフセットを進めるので、複数スレッドから同時に確保できる
+    // ・容量が足りない場合はヒープにフォールバックし、Reset 時にまとめて解放する
+    //   (フォールバックが発生した場合は、最高使用量から必要な容量を調整すること)
+    // ・マーカー (GetMarker / ResetToMarker) はシングルスレッドでの入れ子の一時確保用
+    //==================================================================================
+    class LinearAllocator
+    {
+    public:
+
+        using Marker = uint64;
+
+        LinearAllocator() = default;
+        ~LinearAllocator();
+
+        void Initialize(uint64 capacityByte);
+        void Finalize();
+
+        void* Allocate(uint64 sizeByte, uint64 alignment = 16);
+
+        template<typename T>
+        T* AllocateArray(uint64 count)
+        {
+            return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+        }
+
+        // 全解放 (最高使用量を更新)
+        void Reset();
+
+        // マーカー位置まで巻き戻す
+        Marker GetMarker() const;
+        void   ResetToMarker(Marker marker);
+
+        uint64 GetCapacity()       const { return capacity;                                        }
+        uint64 GetUsedSize()       const { return offset.load(std::memory_order_relaxed);          }
+        uint64 GetHighWaterMark()  const { return highWaterMark;                                   }
+        uint64 GetOverflowSize()   const { return overflowSize.load(std::memory_order_relaxed);    }
+        uint64 GetOverflowCount()  const { return overflowCount.load(std::memory_order_relaxed);   }
+
+    private:
+
+        void* _AllocateOverflow(uint64 sizeByte, uint64 alignment);
+        void  _ReleaseOverflow();
+
+    private:
+
+        byte*               buffer   = nullptr;
+        uint64              capacity = 0;
+        std::atomic<uint64> offset   = 0;
+
+        // 最高使用量 (フォールバック分を含む)
+        uint64 highWaterMark = 0;
+
+        // 容量超過時のヒープ確保
+        SpinLock            overflowLock;
+        std::vector<void*>  overflowBlocks;
+        std::atomic<uint64> overflowSize  = 0;
+        std::atomic<uint64> overflowCount = 0;
+    };
+
+
+    //==================================================================================
+    // スコープ終了時にマーカー位置まで巻き戻す
+    //==================================================================================
+    class ScopedLinearMarker
+    {
+    public:
+
+        ScopedLinearMarker(LinearAllocator* allocator)
+            : allocator(allocator)
+            , marker(allocator->GetMarker())
+        {
+        }
+
+        ~ScopedLinearMarker()
+        {
+            allocator->ResetToMarker(marker);
+        }
+
+    private:
+
+        LinearAllocator*        allocator;
+        LinearAllocator::Marker marker;
+    };
+
+
+    //==================================================================================
+    // STL コンテナ用アダプタ
+    //----------------------------------------------------------------------------------
+    // deallocate は何もしないので、アロケータが Reset されるまでにコンテナを破棄 (または再構築) すること
+    //==================================================================================
+    template<typename T>
+    class LinearSTLAllocator
+    {
+    public:
+
+        using value_type = T;
+
+        // コンテナの代入・交換時にアロケータも移す (フレーム毎に別のアロケータで再構築するため)
+        using propagate_on_container_copy_assignment = std::true_type;
+        using propagate_on_container_move_assignment = std::true_type;
+        using propagate_on_container_swap            = std::true_type;
+
+        LinearSTLAllocator() = default;
+        LinearSTLAllocator(LinearAllocator* allocator) : allocator(allocator) {}
+
+        template<typename U>
+        LinearSTLAllocator(const LinearSTLAllocator<U>& other) : allocator(other.allocator) {}
+
+        T* allocate(size_t n)
+        {
+            // アロケータ未指定の場合はヒープから確保 (デフォルト構築されたコンテナ用)
+            if (!allocator)
+                return static_cast<T*>(Memory::Malloc(sizeof(T) * n));
+
+            return allocator->AllocateArray<T>(n);
+        }
+
+        void deallocate(T* ptr, [[maybe_unused]] size_t n)
+        {
+            if (!allocator)
+                Memory::Free(ptr);
+        }
+
+        template<typename U>
+        bool operator==(const LinearSTLAllocator<U>& other) const { return allocator == other.allocator; }
+
+        template<typename U>
+        bool operator!=(const LinearSTLAllocator<U>& other) const { return allocator != other.allocator; }
+
+        LinearAllocator* allocator = nullptr;
+    };
+
+    // フレームアロケータを使用するコンテナ
+    template<typename T>
+    using LinearVector = std::vector<T, LinearSTLAllocator<T>>;
+}
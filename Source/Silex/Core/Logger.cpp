@@ -27,20 +27,28 @@ namespace Silex
 
     void Logger::Log(LogLevel level, const std::string& msg)
     {
+        static constexpr const char* prefix[] =
+        {
+            "[FATAL] ",
+            "[ERROR] ",
+            "[WARN ] ",
+            "[INFO ] ",
+            "[TRACE] ",
+            "[DEBUG] ",
+        };
+
         // ログレベルのフィルタリング
-        if (level <= logFilter)
+        if (level <= logFilter && level < LogLevel::Count)
         {
-            switch (level)
-            {
-                case LogLevel::Fatal : OS::Get()->OutputDebugConsole("[FATAL] " + msg + "\n"); ConsoleLogger::Get().Log(level, "[FATAL] " + msg + "\n"); break;
-                case LogLevel::Error : OS::Get()->OutputDebugConsole("[ERROR] " + msg + "\n"); ConsoleLogger::Get().Log(level, "[ERROR] " + msg + "\n"); break;
-                case LogLevel::Warn  : OS::Get()->OutputDebugConsole("[WARN ] " + msg + "\n"); ConsoleLogger::Get().Log(level, "[WARN ] " + msg + "\n"); break;
-                case LogLevel::Info  : OS::Get()->OutputDebugConsole("[INFO ] " + msg + "\n"); ConsoleLogger::Get().Log(level, "[INFO ] " + msg + "\n"); break;
-                case LogLevel::Trace : OS::Get()->OutputDebugConsole("[TRACE] " + msg + "\n"); ConsoleLogger::Get().Log(level, "[TRACE] " + msg + "\n"); break;
-                case LogLevel::Debug : OS::Get()->OutputDebugConsole("[DEBUG] " + msg + "\n"); ConsoleLogger::Get().Log(level, "[DEBUG] " + msg + "\n"); break;
-
-                default: break;
-            }
+            // 出力文字列はスレッド毎のバッファを使い回し、ログ毎の一時文字列のヒープ確保を避ける
+            thread_local std::string line;
+            line.clear();
+            line.append(prefix[(uint32)level]);
+            line.append(msg);
+            line.append("\n");
+
+            OS::Get()->OutputDebugConsole(line);
+            ConsoleLogger::Get().Log(level, line);
         }
     }
 }
@@ -4,6 +4,8 @@
 // デバッグ
 #define SL_ENABLE_ALLOCATION_TRACKER 1
 #define SL_ENABLE_ASSERTS            1
+#define SL_ENABLE_BENCHMARK          0
+#define SL_ENABLE_PROFILER           1
 
 // レンダリング
 #define SL_RENDERER_INVERT_Y_AXIS 1
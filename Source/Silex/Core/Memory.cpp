@@ -36,11 +36,13 @@ namespace Silex
 
     void MemoryTracker::RecordAllocate(void* ptr, uint64 size, const char* desc, const char* file, uint64 line)
     {
+        std::lock_guard lock(allocationLock);
         allocationMap[ptr] = {size, desc, file, line};
     }
 
     void MemoryTracker::RecordDeallocate(void* ptr)
     {
+        std::lock_guard lock(allocationLock);
         allocationMap.erase(ptr);
     }
 
@@ -135,6 +135,7 @@ namespace Silex
         };
 
         static inline std::unordered_map<void*, AllocationElement> allocationMap;
+        static inline SpinLock                                     allocationLock;
     };
 
 
@@ -151,11 +152,16 @@ namespace Silex
         static void* Allocate(uint64 sizeByte);
         static void  Deallocate(void* pointer);
 
-        static const std::array<MemoryPoolStatus, 6>& GetStatus()
+        static std::array<MemoryPoolStatus, MemoryPool::NumSizeClass> GetStatus()
         {
             return pool.GetStatus();
         }
 
+        static MemoryPoolStatus GetLargeAllocationStatus()
+        {
+            return pool.GetLargeAllocationStatus();
+        }
+
     private:
 
         static inline MemoryPool pool;
@@ -206,9 +212,12 @@ namespace Silex
         template<typename T, typename... Args>
         static T* Allocate(const char* desc, const char* file, uint64 line, Args&& ... args)
         {
-            static_assert(sizeof(T) <= 1024);
-
+            // 1024 byte を超える型はプール内部で malloc にフォールバックする
             void* ptr = PoolAllocator::Allocate(sizeof(T));
+            SL_ASSERT(ptr != nullptr);
+            if (!ptr) SL_UNLIKELY
+                return nullptr;
+
             MemoryTracker::RecordAllocate(ptr, sizeof(T), desc, file, line);
 
             return Memory::Construct<T>(ptr, Traits::Forward<Args>(args)...);
@@ -226,9 +235,12 @@ namespace Silex
         template<typename T, typename... Args>
         static T* Allocate(Args&& ... args)
         {
-            static_assert(sizeof(T) <= 1024);
-
+            // 1024 byte を超える型はプール内部で malloc にフォールバックする
             void* ptr = PoolAllocator::Allocate(sizeof(T));
+            SL_ASSERT(ptr != nullptr);
+            if (!ptr) SL_UNLIKELY
+                return nullptr;
+
             return Memory::Construct<T>(ptr, Traits::Forward<Args>(args)...);
     }
 
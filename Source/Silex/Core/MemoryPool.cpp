@@ -74,39 +74,208 @@ namespace Silex
     }
 
 
+    static constexpr uint32 MinBlockByteSize  = 32;
+    static constexpr uint32 MaxBlockByteSize  = MinBlockByteSize << (MemoryPool::NumSizeClass - 1);
+    static constexpr uint32 ChunkByteSize     = 1024 * 1024;
+    static constexpr uint32 LargeBlockIndex   = ~0u;
+    static constexpr uint64 AddressMask       = (1ull << 48) - 1;
+    static constexpr uint64 TagIncrement      = 1ull << 48;
+
+    // 共有リストとやり取りするバッチのブロック数 (小さいブロックほど多く)
+    static constexpr uint32 BatchCount(uint32 blockByteSize)
+    {
+        return std::clamp(8192u / blockByteSize, 8u, 64u);
+    }
+
+
     //============================================================================
-    // プールデータ
+    // スレッドキャッシュ
+    //----------------------------------------------------------------------------
+    // 確保・解放はこのキャッシュ内で完結し、不足・過剰時のみ共有リストとバッチ単位でやり取りする
+    // 統計値はキャッシュ内に貯めておき、バッチのやり取り時にまとめてアトミックに反映する
     //============================================================================
-    void MemoryPool::Pool::Create(const uint32 chunkSize, const uint32 poolSize)
+    struct ThreadCache
     {
-        blockByteSize = chunkSize;
-        numBlocks     = poolSize / blockByteSize;
-        ptr           = Memory::Malloc(poolSize + (numBlocks * sizeof(Header)));
+        MemoryPool* owner = nullptr;
+        uint32      epoch = 0;
+
+        MemoryPool::Header* head[MemoryPool::NumSizeClass]         = {};
+        uint32              count[MemoryPool::NumSizeClass]        = {};
+        int64               pendingBytes[MemoryPool::NumSizeClass] = {};
 
-        for (uint32 i = 0; i < numBlocks; i++)
+        ~ThreadCache()
         {
-            uint64 address = (uint64)ptr + (i * sizeof(Header)) + (i * blockByteSize);
-            PushFront(reinterpret_cast<Header*>(address));
+            Release();
         }
+
+        bool IsValid() const
+        {
+            // 奇数世代のみ有効 (Initialize / Finalize で世代が1つずつ進む)
+            return owner && owner->GetEpoch() == epoch && (epoch & 1);
+        }
+
+        void FlushStatus(uint32 index)
+        {
+            if (pendingBytes[index] != 0)
+            {
+                owner->GetPool(index).totalAllocated.fetch_add((uint64)pendingBytes[index], std::memory_order_relaxed);
+                pendingBytes[index] = 0;
+            }
+        }
+
+        // キャッシュ内のブロックを全て共有リストに返却 (スレッド終了時)
+        void Release()
+        {
+            if (!IsValid())
+                return;
+
+            for (uint32 i = 0; i < MemoryPool::NumSizeClass; i++)
+            {
+                if (head[i])
+                {
+                    owner->GetPool(i).PushBatch(head[i], count[i]);
+                }
+
+                FlushStatus(i);
+
+                head[i]  = nullptr;
+                count[i] = 0;
+            }
+        }
+
+        void Reset(MemoryPool* pool)
+        {
+            owner = pool;
+            epoch = pool->GetEpoch();
+
+            for (uint32 i = 0; i < MemoryPool::NumSizeClass; i++)
+            {
+                head[i]         = nullptr;
+                count[i]        = 0;
+                pendingBytes[i] = 0;
+            }
+        }
+    };
+
+    static thread_local ThreadCache threadCache;
+
+
+    //============================================================================
+    // プールデータ
+    //============================================================================
+    void MemoryPool::Pool::Create(const uint32 blockSize, const uint32 chunkSize)
+    {
+        blockByteSize = blockSize;
+        chunkByteSize = chunkSize;
+        batchHead     = 0;
+        chunks        = nullptr;
+
+        totalAllocated = 0;
+        totalSize      = 0;
+
+        // 初回分のチャンクを確保しておく
+        Grow();
     }
 
     void MemoryPool::Pool::Destroy()
     {
-        Memory::Free(ptr);
-        ptr = nullptr;
+        void* chunk = chunks;
+        while (chunk)
+        {
+            void* next = *static_cast<void**>(chunk);
+            Memory::Free(chunk);
+            chunk = next;
+        }
+
+        chunks    = nullptr;
+        batchHead = 0;
     }
 
-    MemoryPool::Header* MemoryPool::Pool::PopFront()
+    void MemoryPool::Pool::PushBatch(Header* head, uint32 count)
     {
-        Header* top = head;
-        head = head->next;
-        return top;
+        Batch* batch = reinterpret_cast<Batch*>(head + 1);
+        batch->count = count;
+
+        uint64 oldHead = batchHead.load(std::memory_order_relaxed);
+        while (true)
+        {
+            batch->nextBatch = reinterpret_cast<Header*>(oldHead & AddressMask);
+            uint64 newHead   = ((oldHead + TagIncrement) & ~AddressMask) | (uint64)head;
+
+            if (batchHead.compare_exchange_weak(oldHead, newHead, std::memory_order_release, std::memory_order_relaxed))
+                return;
+        }
     }
 
-    void MemoryPool::Pool::PushFront(Header* header)
+    MemoryPool::Header* MemoryPool::Pool::PopBatch(uint32& out_count)
     {
-        header->next = head;
-        head = header;
+        uint64 oldHead = batchHead.load(std::memory_order_acquire);
+        while (true)
+        {
+            Header* head = reinterpret_cast<Header*>(oldHead & AddressMask);
+            if (!head)
+                return nullptr;
+
+            // チャンクは Finalize まで解放されないので、他スレッドに取られた後の読み取りでも安全
+            // (その場合はタグが変わっているので CAS が失敗する)
+            Batch*  batch   = reinterpret_cast<Batch*>(head + 1);
+            Header* next    = batch->nextBatch;
+            uint32  count   = batch->count;
+            uint64  newHead = ((oldHead + TagIncrement) & ~AddressMask) | (uint64)next;
+
+            if (batchHead.compare_exchange_weak(oldHead, newHead, std::memory_order_acquire, std::memory_order_acquire))
+            {
+                out_count = count;
+                return head;
+            }
+        }
+    }
+
+    bool MemoryPool::Pool::Grow()
+    {
+        while (growLock.test_and_set(std::memory_order_acquire)) {}
+
+        // 待機中に他スレッドが拡張済みであれば何もしない
+        if ((batchHead.load(std::memory_order_acquire) & AddressMask) != 0)
+        {
+            growLock.clear(std::memory_order_release);
+            return true;
+        }
+
+        // [次チャンクへのポインタ (16byte)][Header|Block][Header|Block]...
+        const uint32 stride    = blockByteSize + sizeof(Header);
+        const uint32 numBlocks = (chunkByteSize - 16) / stride;
+        const uint32 batchSize = BatchCount(blockByteSize);
+
+        byte* chunk = (byte*)Memory::Malloc(chunkByteSize);
+        if (!chunk)
+        {
+            growLock.clear(std::memory_order_release);
+            return false;
+        }
+
+        *reinterpret_cast<void**>(chunk) = chunks;
+        chunks = chunk;
+
+        byte* blocks = chunk + 16;
+        for (uint32 first = 0; first < numBlocks; first += batchSize)
+        {
+            uint32 count = std::min(batchSize, numBlocks - first);
+
+            // バッチ内のブロックを連結
+            for (uint32 i = 0; i < count; i++)
+            {
+                Header* header = reinterpret_cast<Header*>(blocks + (first + i) * stride);
+                header->next = (i + 1 < count)? reinterpret_cast<Header*>(blocks + (first + i + 1) * stride) : nullptr;
+            }
+
+            PushBatch(reinterpret_cast<Header*>(blocks + first * stride), count);
+        }
+
+        totalSize.fetch_add((uint64)numBlocks * blockByteSize, std::memory_order_relaxed);
+
+        growLock.clear(std::memory_order_release);
+        return true;
     }
 
 
@@ -115,20 +284,24 @@ namespace Silex
     //============================================================================
     void MemoryPool::Initialize()
     {
-        const uint64 minPoolBlockByteSize = 32;
-        const uint64 poolByteSize         = 10 * 1024 * 1024;
-
         for (uint32 i = 0; i < pools.size(); i++)
         {
-            uint64 blockSize = minPoolBlockByteSize << i;
-            pools[i].Create(blockSize, poolByteSize);
-
-            status[i] = MemoryPoolStatus(blockSize, 0, poolByteSize);
+            uint32 blockSize = MinBlockByteSize << i;
+            pools[i].Create(blockSize, ChunkByteSize);
         }
+
+        largeAllocated = 0;
+        largeCount     = 0;
+
+        // 有効な世代に進める (奇数)
+        epoch.fetch_add(1, std::memory_order_release);
     }
 
     void MemoryPool::Finalize()
     {
+        // 全スレッドキャッシュを無効化してから解放する
+        epoch.fetch_add(1, std::memory_order_release);
+
         for (uint32 i = 0; i < pools.size(); i++)
         {
             pools[i].Destroy();
@@ -137,14 +310,61 @@ namespace Silex
 
     void* MemoryPool::Allocate(const uint64 allocationSize)
     {
+        // Finalize 後に確保すると、解放されないチャンクでプールが拡張されてしまう
+        SL_ASSERT(IsInitialized());
+        if (!IsInitialized())
+            return nullptr;
+
+        // プールの最大ブロックサイズを超える場合は malloc にフォールバック
+        if (allocationSize > MaxBlockByteSize)
+        {
+            Header* header = static_cast<Header*>(Memory::Malloc(allocationSize + sizeof(Header)));
+            if (!header)
+                return nullptr;
+
+            header->blockIndex = LargeBlockIndex;
+            header->byteSize   = allocationSize;
+
+            largeAllocated.fetch_add(allocationSize, std::memory_order_relaxed);
+            largeCount.fetch_add(1, std::memory_order_relaxed);
+
+            return ++header;
+        }
+
+        ThreadCache& cache = threadCache;
+        if (!cache.IsValid()) SL_UNLIKELY
+        {
+            cache.Reset(this);
+        }
+
         // バイトサイズからプールを選択
         uint32 index = Internal::SelectPoolIndex(allocationSize);
+        Pool&  pool  = pools[index];
+
+        // キャッシュが空なら共有リストからバッチで補充 (共有リストも空ならプールを拡張)
+        if (!cache.head[index]) SL_UNLIKELY
+        {
+            Header* batch = pool.PopBatch(cache.count[index]);
+            while (!batch)
+            {
+                // 拡張に失敗した場合の扱いは呼び出し側で決める
+                if (!pool.Grow())
+                    return nullptr;
+
+                batch = pool.PopBatch(cache.count[index]);
+            }
+
+            cache.head[index] = batch;
+            cache.FlushStatus(index);
+        }
 
         // ヘッダーにプールインデックスを格納
-        Header* header = pools[index].PopFront();
-        header->blockIndex = index;
+        Header* header = cache.head[index];
+        cache.head[index] = header->next;
+        cache.count[index]--;
+        cache.pendingBytes[index] += pool.blockByteSize;
 
-        status[index].totalAllocated += pools[index].blockByteSize;
+        header->blockIndex = index;
 
         // ヘッダー分ポインタをずらす
         return ++header;
@@ -157,7 +377,73 @@ namespace Silex
         --header;
 
         uint32 index = header->blockIndex;
-        pools[index].PushFront(header);
-        status[index].totalAllocated -= pools[index].blockByteSize;
+        if (index == LargeBlockIndex)
+        {
+            largeAllocated.fetch_sub(header->byteSize, std::memory_order_relaxed);
+            largeCount.fetch_sub(1, std::memory_order_relaxed);
+
+            Memory::Free(header);
+            return;
+        }
+
+        // Finalize 後はチャンクが解放済みなので、プールのブロックは返却できない
+        SL_ASSERT(IsInitialized());
+        if (!IsInitialized())
+            return;
+
+        ThreadCache& cache = threadCache;
+        if (!cache.IsValid()) SL_UNLIKELY
+        {
+            cache.Reset(this);
+        }
+
+        Pool& pool = pools[index];
+
+        header->next = cache.head[index];
+        cache.head[index] = header;
+        cache.count[index]++;
+        cache.pendingBytes[index] -= pool.blockByteSize;
+
+        // キャッシュが溢れたら、1バッチ分を共有リストに返却
+        const uint32 batchSize = BatchCount(pool.blockByteSize);
+        if (cache.count[index] >= batchSize * 2) SL_UNLIKELY
+        {
+            Header* batch = cache.head[index];
+            Header* last  = batch;
+            for (uint32 i = 1; i < batchSize; i++)
+            {
+                last = last->next;
+            }
+
+            cache.head[index]   = last->next;
+            cache.count[index] -= batchSize;
+            last->next = nullptr;
+
+            pool.PushBatch(batch, batchSize);
+            cache.FlushStatus(index);
+        }
+    }
+
+    std::array<MemoryPoolStatus, MemoryPool::NumSizeClass> MemoryPool::GetStatus() const
+    {
+        std::array<MemoryPoolStatus, NumSizeClass> status;
+        for (uint32 i = 0; i < NumSizeClass; i++)
+        {
+            status[i].chunkSize      = pools[i].blockByteSize;
+            status[i].totalAllocated = pools[i].totalAllocated.load(std::memory_order_relaxed);
+            status[i].totalSize      = pools[i].totalSize.load(std::memory_order_relaxed);
+        }
+
+        return status;
+    }
+
+    MemoryPoolStatus MemoryPool::GetLargeAllocationStatus() const
+    {
+        MemoryPoolStatus status;
+        status.chunkSize      = largeCount.load(std::memory_order_relaxed);
+        status.totalAllocated = largeAllocated.load(std::memory_order_relaxed);
+        status.totalSize      = status.totalAllocated;
+
+        return status;
     }
 }
@@ -2,58 +2,115 @@
 #pragma once
 
 #include "Core/CoreType.h"
+#include <array>
+#include <atomic>
 
 
 namespace Silex
 {
     struct MemoryPoolStatus
     {
-        uint32 chunkSize      = 0;
-        uint32 totalAllocated = 0;
-        uint32 totalSize      = 0;
+        uint64 chunkSize      = 0;
+        uint64 totalAllocated = 0;
+        uint64 totalSize      = 0;
     };
 
 
+    //==================================================================================
+    // サイズクラス別 メモリプール
+    //----------------------------------------------------------------------------------
+    // 32 ~ 1024 byte の 6つのサイズクラスを持つスレッドセーフなプール
+    //
+    // ・スレッド毎のキャッシュ (thread_local) から確保・解放するので、通常はアトミック操作も不要
+    // ・キャッシュが空 / 溢れた場合は、共有のロックフリーリストとバッチ単位でやり取りする
+    // ・共有リストも空の場合は、チャンク単位でプールを拡張する (この経路のみスピンロック)
+    // ・1024 byte を超える要求は malloc にフォールバックする
+    //==================================================================================
     class MemoryPool
     {
     public:
 
+        static constexpr uint32 NumSizeClass = 6;
+
         MemoryPool()  = default;
         ~MemoryPool() = default;
 
         void Initialize();
         void Finalize();
 
+        // 確保に失敗した場合は nullptr を返す (Finalize 後の呼び出しはアサート)
         void* Allocate(const uint64 allocationSize);
         void  Deallocate(void* pointer);
 
-        const std::array<MemoryPoolStatus, 6>& GetStatus() const { return status; }
+        // 各サイズクラスの使用状況 (スレッドキャッシュ内の未反映分だけ誤差が生じる)
+        std::array<MemoryPoolStatus, NumSizeClass> GetStatus() const;
+
+        // malloc にフォールバックした確保の使用状況
+        MemoryPoolStatus GetLargeAllocationStatus() const;
 
     private:
 
         struct Header
         {
-            uint32  blockIndex;
-            Header* next;
+            uint32 blockIndex;
+            uint32 padding;
+
+            // 空きリスト内では次のブロック、フォールバック確保時はバイトサイズ (同時には使用しない)
+            union
+            {
+                Header* next;
+                uint64  byteSize;
+            };
         };
 
-        struct Pool
+        // 共有リストに積まれるバッチ (空きブロックのペイロード領域を利用する)
+        struct Batch
         {
-            Header* head = nullptr;
-            void*   ptr  = nullptr;
+            Header* nextBatch;
+            uint32  count;
+        };
+
+        struct alignas(64) Pool
+        {
+            // 上位16bit: ABA対策タグ, 下位48bit: バッチ先頭ブロックのアドレス
+            std::atomic<uint64> batchHead = 0;
+
+            // 拡張用チャンクリスト (拡張時のみロック)
+            std::atomic_flag growLock = ATOMIC_FLAG_INIT;
+            void*            chunks   = nullptr;
 
             uint32 blockByteSize = 0;
-            uint32 numBlocks     = 0;
+            uint32 chunkByteSize = 0;
+
+            std::atomic<uint64> totalAllocated = 0;
+            std::atomic<uint64> totalSize      = 0;
 
-            void Create(const uint32 chunkSize, const uint32 poolSize);
+            void Create(const uint32 blockSize, const uint32 chunkSize);
             void Destroy();
 
-            void    PushFront(Header* header);
-            Header* PopFront();
+            // バッチ単位の受け渡し
+            void    PushBatch(Header* head, uint32 count);
+            Header* PopBatch(uint32& out_count);
+
+            // チャンクを確保してバッチとして共有リストに積む
+            bool Grow();
         };
 
-        std::array<Pool,             6> pools;
-        std::array<MemoryPoolStatus, 6> status;
+        // 現在のプールの世代 (Finalize 後に残ったスレッドキャッシュを無効化するため)
+        uint32 GetEpoch() const { return epoch.load(std::memory_order_acquire); }
+
+        // Initialize ~ Finalize の間か (奇数世代)
+        bool IsInitialized() const { return GetEpoch() & 1; }
+
+        Pool& GetPool(uint32 index) { return pools[index]; }
+
+    private:
+
+        std::array<Pool, NumSizeClass> pools;
+        std::atomic<uint32>            epoch = 0;
+
+        std::atomic<uint64> largeAllocated = 0;
+        std::atomic<uint64> largeCount     = 0;
 
     private:
 
@@ -63,5 +120,6 @@ namespace Silex
         MemoryPool& operator=(MemoryPool&&) = delete;
 
         friend class Allocator;
+        friend struct ThreadCache;
     };
 }
@@ -12,6 +12,16 @@ namespace Silex
     };
 
 
+    // 読み取り専用のファイルマッピング (ハンドルはプラットフォーム固有)
+    struct MappedFile
+    {
+        const byte* data          = nullptr;
+        uint64      size          = 0;
+        void*       fileHandle    = nullptr;
+        void*       mappingHandle = nullptr;
+    };
+
+
     class OS
     {
     public:
@@ -37,12 +47,18 @@ namespace Silex
 
         // 時間
         virtual uint64 GetTickSeconds()       = 0;
+        virtual uint64 GetTickCount()         = 0;
+        virtual uint64 GetTickFrequency()     = 0;
         virtual void   Sleep(uint32 millisec) = 0;
 
         // ファイル
         virtual std::string OpenFile(const char* filter = "All\0*.*\0")                                  = 0;
         virtual std::string SaveFile(const char* filter = "All\0*.*\0", const char* extention = nullptr) = 0;
 
+        // ファイルマッピング (ページはアクセス時に読み込まれる / 空のファイルはマップできない)
+        virtual bool MapFile(const std::string& filePath, MappedFile& out_mappedFile) = 0;
+        virtual void UnmapFile(MappedFile& mappedFile)                                = 0;
+
         // コンソール
         virtual void SetConsoleAttribute(uint16 color)                      = 0;
         virtual void OutputConsole(uint8 color, const std::string& message) = 0;
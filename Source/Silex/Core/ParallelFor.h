@@ -0,0 +1,79 @@
+
+#pragma once
+#include "Core/ThreadPool.h"
+
+
+namespace Silex
+{
+    //=========================================
+    // 並列 for
+    //-----------------------------------------
+    // [begin, end) を grain 個ずつのチャンクに分割し、スレッドプール上で実行する
+    // チャンクは共有カウンタから早い者勝ちで取得するので、処理時間にばらつきがあっても偏りにくい
+    // 呼び出しスレッドも処理に参加し、全チャンクの完了まで戻らない
+    //
+    // fn          : void(uint32 index)
+    // maxWorkers  : 処理に参加するスレッド数の上限 (呼び出しスレッドを含む, 0 で制限なし)
+    //=========================================
+    template<typename Func>
+    void ParallelFor(uint32 begin, uint32 end, uint32 grain, Func&& fn, uint32 maxWorkers = 0)
+    {
+        if (begin >= end)
+            return;
+
+        grain = std::max(grain, 1u);
+
+        const uint32 count     = end - begin;
+        const uint32 numChunks = (count + grain - 1) / grain;
+
+        // 並列化する必要がなければ、そのまま実行
+        uint32 numWorkers = std::min(numChunks, ThreadPool::GetThreadCount() + 1);
+        if (maxWorkers != 0)
+        {
+            numWorkers = std::min(numWorkers, maxWorkers);
+        }
+
+        if (numWorkers <= 1)
+        {
+            for (uint32 i = begin; i < end; i++)
+                fn(i);
+
+            return;
+        }
+
+        std::atomic<uint32> nextChunk = 0;
+
+        auto worker = [&]()
+        {
+            while (true)
+            {
+                uint32 chunk = nextChunk.fetch_add(1, std::memory_order_relaxed);
+                if (chunk >= numChunks)
+                    break;
+
+                uint32 chunkBegin = begin + chunk * grain;
+                uint32 chunkEnd   = std::min(chunkBegin + grain, end);
+
+                for (uint32 i = chunkBegin; i < chunkEnd; i++)
+                    fn(i);
+            }
+        };
+
+        // 呼び出しスレッド以外の分だけジョブを発行
+        JobHandle* handles = SL_STACK(JobHandle, numWorkers - 1);
+        for (uint32 i = 0; i < numWorkers - 1; i++)
+        {
+            handles[i] = ThreadPool::Schedule(worker);
+        }
+
+        worker();
+
+        ThreadPool::Wait(handles, numWorkers - 1);
+    }
+
+    template<typename Func>
+    void ParallelFor(uint32 count, uint32 grain, Func&& fn, uint32 maxWorkers = 0)
+    {
+        ParallelFor(0, count, grain, Traits::Forward<Func>(fn), maxWorkers);
+    }
+}
@@ -0,0 +1,212 @@
+
+#include "PCH.h"
+#include "Core/Profiler.h"
+
+#include <fstream>
+
+
+namespace Silex
+{
+    static std::mutex                                        registerMutex;
+    static std::vector<std::unique_ptr<ProfileThreadBuffer>> threadBuffers;
+
+    // 集計対象 (Initialize を呼び出したスレッド = メインスレッド)
+    static ProfileThreadBuffer*                   mainThreadBuffer = nullptr;
+    static uint64                                 frameStartIndex  = 0;
+    static std::unordered_map<const char*, float> frameData;
+
+
+    void PerformanceProfiler::Initialize()
+    {
+        SetThreadName("Main");
+
+        mainThreadBuffer = _GetThreadBuffer();
+        frameStartIndex  = mainThreadBuffer->writeIndex.load(std::memory_order_relaxed);
+    }
+
+    void PerformanceProfiler::Finalize()
+    {
+        // 他スレッドは終了済みであること
+        std::lock_guard lock(registerMutex);
+
+        threadBuffers.clear();
+        mainThreadBuffer = nullptr;
+
+        // 全スレッドの thread_local のバッファポインタを無効にする (次の記録時に再登録される)
+        generation.fetch_add(1, std::memory_order_relaxed);
+        threadBuffer     = nullptr;
+        threadGeneration = 0;
+    }
+
+    ProfileThreadBuffer* PerformanceProfiler::_RegisterThread()
+    {
+        std::lock_guard lock(registerMutex);
+
+        auto& buffer = threadBuffers.emplace_back(std::make_unique<ProfileThreadBuffer>());
+        buffer->threadIndex = (uint32)threadBuffers.size() - 1;
+        buffer->threadName  = std::format("Thread {}", buffer->threadIndex);
+
+        return buffer.get();
+    }
+
+    void PerformanceProfiler::SetThreadName(const char* name)
+    {
+        ProfileThreadBuffer* buffer = _GetThreadBuffer();
+
+        std::lock_guard lock(registerMutex);
+        buffer->threadName = name;
+    }
+
+    void PerformanceProfiler::EndFrame()
+    {
+        if (!mainThreadBuffer)
+            return;
+
+        ProfileThreadBuffer* buffer = mainThreadBuffer;
+        _WriteEvent(buffer, "Frame", PROFILE_EVENT_FRAME, buffer->depth);
+
+        // 直前フレームで記録されたイベントから、区間毎の合計時間を求める
+        // (リングバッファが一周している場合は、残っている範囲のみ)
+        uint64 end   = buffer->writeIndex.load(std::memory_order_relaxed);
+        uint64 begin = std::max(frameStartIndex, end > ProfileThreadBuffer::Capacity? end - ProfileThreadBuffer::Capacity : 0);
+
+        const double tickToMilli = 1'000.0 / (double)OS::Get()->GetTickFrequency();
+
+        const ProfileEvent* stack[64];
+        uint32              stackSize = 0;
+
+        frameData.clear();
+
+        for (uint64 i = begin; i < end; i++)
+        {
+            const ProfileEvent& event = buffer->events[i & ProfileThreadBuffer::Mask];
+
+            if (event.type == PROFILE_EVENT_BEGIN)
+            {
+                if (stackSize < std::size(stack))
+                    stack[stackSize] = &event;
+
+                stackSize++;
+            }
+            else if (event.type == PROFILE_EVENT_END && stackSize > 0)
+            {
+                stackSize--;
+
+                if (stackSize < std::size(stack))
+                {
+                    const ProfileEvent* beginEvent = stack[stackSize];
+                    frameData[beginEvent->name] += (float)((double)(event.tick - beginEvent->tick) * tickToMilli);
+                }
+            }
+        }
+
+        frameStartIndex = end;
+    }
+
+    void PerformanceProfiler::GetFrameData(std::unordered_map<const char*, float>* outData)
+    {
+        *outData = frameData;
+    }
+
+    bool PerformanceProfiler::ExportChromeTrace(const std::string& filePath)
+    {
+        std::ofstream stream(filePath, std::ios::out | std::ios::trunc);
+        if (!stream)
+        {
+            SL_LOG_ERROR("プロファイル出力ファイルを開けませんでした: {}", filePath);
+            return false;
+        }
+
+        const double tickToMicro = 1'000'000.0 / (double)OS::Get()->GetTickFrequency();
+
+        // 名前に含まれる JSON のエスケープが必要な文字を置き換える
+        auto escape = [](const char* name)
+        {
+            std::string result;
+            for (const char* c = name; c && *c; c++)
+            {
+                if      (*c == '"' ) result += "\\\"";
+                else if (*c == '\\') result += "\\\\";
+                else                 result += *c;
+            }
+
+            return result;
+        };
+
+        std::lock_guard lock(registerMutex);
+
+        uint64 numEvents  = 0;
+        bool   firstEntry = true;
+
+        std::vector<ProfileEvent> snapshot;
+        snapshot.reserve(ProfileThreadBuffer::Capacity);
+
+        stream << "{\"traceEvents\":[\n";
+
+        for (const auto& buffer : threadBuffers)
+        {
+            const uint32 tid = buffer->threadIndex;
+
+            // スレッド名メタデータ
+            stream << (firstEntry? "" : ",\n");
+            stream << std::format("{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":{},\"args\":{{\"name\":\"{}\"}}}}", tid, escape(buffer->threadName.c_str()));
+            firstEntry = false;
+
+            // 記録中のスレッドのリングを直接読まないように、公開済みの範囲をスナップショットに複製する
+            uint64 end   = buffer->writeIndex.load(std::memory_order_acquire);
+            uint64 begin = end > ProfileThreadBuffer::Capacity? end - ProfileThreadBuffer::Capacity : 0;
+
+            snapshot.resize(end - begin);
+            for (uint64 i = begin; i < end; i++)
+            {
+                snapshot[i - begin] = buffer->events[i & ProfileThreadBuffer::Mask];
+            }
+
+            // 複製中に書き込みが進んだ場合、上書きされた (書き込み中を含む) 先頭側のイベントは破棄する
+            std::atomic_thread_fence(std::memory_order_acquire);
+            uint64 written = buffer->writeIndex.load(std::memory_order_relaxed);
+            uint64 valid   = written + 1 > ProfileThreadBuffer::Capacity? written + 1 - ProfileThreadBuffer::Capacity : 0;
+            uint64 first   = std::min(std::max(begin, valid), end);
+
+            // 上書きされて開始イベントが残っていない終了イベントは出力しない
+            uint32 depth = 0;
+
+            for (uint64 i = first; i < end; i++)
+            {
+                const ProfileEvent& event = snapshot[i - begin];
+                const double        ts    = (double)event.tick * tickToMicro;
+
+                switch (event.type)
+                {
+                    case PROFILE_EVENT_BEGIN:
+                    {
+                        stream << std::format(",\n{{\"name\":\"{}\",\"ph\":\"B\",\"ts\":{:.3f},\"pid\":0,\"tid\":{}}}", escape(event.name), ts, tid);
+                        depth++;
+                        break;
+                    }
+                    case PROFILE_EVENT_END:
+                    {
+                        if (depth == 0)
+                            continue;
+
+                        stream << std::format(",\n{{\"ph\":\"E\",\"ts\":{:.3f},\"pid\":0,\"tid\":{}}}", ts, tid);
+                        depth--;
+                        break;
+                    }
+                    case PROFILE_EVENT_FRAME:
+                    {
+                        stream << std::format(",\n{{\"name\":\"{}\",\"ph\":\"i\",\"s\":\"g\",\"ts\":{:.3f},\"pid\":0,\"tid\":{}}}", escape(event.name), ts, tid);
+                        break;
+                    }
+                }
+
+                numEvents++;
+            }
+        }
+
+        stream << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+        SL_LOG_INFO("プロファイルを出力しました: {} ({} events)", filePath, numEvents);
+        return true;
+    }
+}
@@ -0,0 +1,150 @@
+
+#pragma once
+
+#include "Core/Macros.h"
+#include "Core/CoreType.h"
+#include "Core/OS.h"
+#include <unordered_map>
+#include <string>
+#include <atomic>
+
+
+namespace Silex
+{
+    enum ProfileEventType : uint32
+    {
+        PROFILE_EVENT_BEGIN,
+        PROFILE_EVENT_END,
+        PROFILE_EVENT_FRAME,
+    };
+
+    // プロファイルイベント (名前は文字列リテラル等、寿命が続くポインタのみ受け付ける)
+    struct ProfileEvent
+    {
+        uint64           tick;
+        const char*      name;
+        ProfileEventType type;
+        uint32           depth;
+    };
+
+    //=========================================
+    // スレッド毎のイベントリングバッファ
+    //-----------------------------------------
+    // 書き込みは所有スレッドのみが行うので、ロックは不要
+    // 古いイベントは上書きされる
+    //=========================================
+    struct ProfileThreadBuffer
+    {
+        static constexpr uint32 Capacity = 1 << 15;
+        static constexpr uint32 Mask     = Capacity - 1;
+
+        ProfileEvent        events[Capacity];
+        std::atomic<uint64> writeIndex  = 0;
+        uint32              depth       = 0;
+        uint32              threadIndex = 0;
+        std::string         threadName;
+    };
+
+
+    //=========================================
+    // 階層 CPU プロファイラ
+    //-----------------------------------------
+    // SL_SCOPE_PROFILE で区間の開始・終了イベントを記録し、以下の用途に使用する
+    // ・メインスレッドのフレーム毎の区間集計 (エディターの統計表示)
+    // ・全スレッドのイベントを Chrome trace_event 形式 (chrome://tracing, Perfetto) で出力
+    //
+    // イベント記録はクロック取得とリングバッファへの書き込みのみなので、リリースビルドでも有効にしておける
+    //=========================================
+    class PerformanceProfiler
+    {
+    public:
+
+        static void Initialize();
+        static void Finalize();
+
+        // 区間の開始・終了
+        static void BeginZone(const char* name)
+        {
+            ProfileThreadBuffer* buffer = _GetThreadBuffer();
+            _WriteEvent(buffer, name, PROFILE_EVENT_BEGIN, buffer->depth++);
+        }
+
+        static void EndZone()
+        {
+            ProfileThreadBuffer* buffer = _GetThreadBuffer();
+            _WriteEvent(buffer, nullptr, PROFILE_EVENT_END, --buffer->depth);
+        }
+
+        // フレーム境界 (メインスレッドから呼び出し、直前フレームの区間を集計する)
+        static void EndFrame();
+
+        // 直前フレームのメインスレッド区間集計 [名前, ミリ秒]
+        static void GetFrameData(std::unordered_map<const char*, float>* outData);
+
+        // スレッド名の登録 (トレース出力時に使用)
+        static void SetThreadName(const char* name);
+
+        // Chrome trace_event 形式の JSON で出力
+        static bool ExportChromeTrace(const std::string& filePath);
+
+    private:
+
+        static ProfileThreadBuffer* _RegisterThread();
+
+        SL_FORCEINLINE static ProfileThreadBuffer* _GetThreadBuffer()
+        {
+            // Finalize (再初期化) 後は、以前のバッファを参照しないように登録し直す
+            if (threadGeneration != generation.load(std::memory_order_relaxed)) SL_UNLIKELY
+            {
+                threadBuffer     = _RegisterThread();
+                threadGeneration = generation.load(std::memory_order_relaxed);
+            }
+
+            return threadBuffer;
+        }
+
+        SL_FORCEINLINE static void _WriteEvent(ProfileThreadBuffer* buffer, const char* name, ProfileEventType type, uint32 depth)
+        {
+            uint64 index = buffer->writeIndex.load(std::memory_order_relaxed);
+
+            ProfileEvent& event = buffer->events[index & ProfileThreadBuffer::Mask];
+            event.tick  = OS::Get()->GetTickCount();
+            event.name  = name;
+            event.type  = type;
+            event.depth = depth;
+
+            buffer->writeIndex.store(index + 1, std::memory_order_release);
+        }
+
+    private:
+
+        // 各スレッドのバッファは、登録時の世代が現在の世代と一致する場合のみ有効 (Finalize で世代を進める)
+        static inline std::atomic<uint32>                generation       = 1;
+        static inline thread_local uint32               threadGeneration = 0;
+        static inline thread_local ProfileThreadBuffer* threadBuffer     = nullptr;
+    };
+
+
+    // デストラクタを利用した、スコープ寿命のプロファイル区間
+    class ProfileScope
+    {
+    public:
+
+        ProfileScope(const char* name)
+        {
+            PerformanceProfiler::BeginZone(name);
+        }
+
+        ~ProfileScope()
+        {
+            PerformanceProfiler::EndZone();
+        }
+    };
+}
+
+
+#if SL_ENABLE_PROFILER
+    #define SL_SCOPE_PROFILE(name) Silex::ProfileScope SL_COMBINE(profileScope, __LINE__)(name);
+#else
+    #define SL_SCOPE_PROFILE(name)
+#endif
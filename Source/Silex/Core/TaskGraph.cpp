@@ -0,0 +1,130 @@
+
+#include "PCH.h"
+#include "Core/TaskGraph.h"
+
+
+namespace Silex
+{
+    TaskGraph::NodeID TaskGraph::AddNode(const char* name, Task&& task)
+    {
+        Node& node = nodes.emplace_back();
+        node.name = name;
+        node.task = Traits::Move(task);
+
+        dirty = true;
+        return (NodeID)(nodes.size() - 1);
+    }
+
+    void TaskGraph::AddEdge(NodeID before, NodeID after)
+    {
+        SL_ASSERT(before < nodes.size() && after < nodes.size());
+        SL_ASSERT(before != after);
+
+        nodes[after].predecessors.push_back(before);
+        dirty = true;
+    }
+
+    bool TaskGraph::Build()
+    {
+        // カーン法によるトポロジカルソート
+        // ジョブの依存登録には先行ノードのハンドルが必要なので、先行ノードから順に発行できる順序を求める
+        const uint32 numNodes = (uint32)nodes.size();
+
+        std::vector<uint32>              inDegree(numNodes, 0);
+        std::vector<std::vector<NodeID>> successors(numNodes);
+
+        for (NodeID id = 0; id < numNodes; id++)
+        {
+            for (NodeID pred : nodes[id].predecessors)
+            {
+                successors[pred].push_back(id);
+                inDegree[id]++;
+            }
+        }
+
+        executionOrder.clear();
+        executionOrder.reserve(numNodes);
+
+        for (NodeID id = 0; id < numNodes; id++)
+        {
+            if (inDegree[id] == 0)
+                executionOrder.push_back(id);
+        }
+
+        for (uint32 i = 0; i < executionOrder.size(); i++)
+        {
+            for (NodeID next : successors[executionOrder[i]])
+            {
+                if (--inDegree[next] == 0)
+                    executionOrder.push_back(next);
+            }
+        }
+
+        if (executionOrder.size() != numNodes)
+        {
+            SL_LOG_ERROR("TaskGraph: 循環依存が存在します ({} / {} ノードのみ解決)", executionOrder.size(), numNodes);
+            executionOrder.clear();
+            return false;
+        }
+
+        dirty = false;
+        return true;
+    }
+
+    bool TaskGraph::Execute()
+    {
+        if (dirty && !Build())
+            return false;
+
+        JobHandle dependencies[32];
+        std::vector<JobHandle> overflow;
+
+        for (NodeID id : executionOrder)
+        {
+            Node& node = nodes[id];
+
+            // 先行ノードのハンドルを収集 (通常は固定長配列に収まる)
+            const uint32 numPredecessors = (uint32)node.predecessors.size();
+            JobHandle* handles = dependencies;
+
+            if (numPredecessors > std::size(dependencies))
+            {
+                overflow.resize(numPredecessors);
+                handles = overflow.data();
+            }
+
+            for (uint32 i = 0; i < numPredecessors; i++)
+            {
+                handles[i] = nodes[node.predecessors[i]].handle;
+            }
+
+            // ノードのタスク自体はコピーせず、グラフを参照して実行する
+            node.handle = ThreadPool::Schedule([this, id]() { nodes[id].task(); }, handles, numPredecessors);
+        }
+
+        return true;
+    }
+
+    void TaskGraph::Wait()
+    {
+        for (Node& node : nodes)
+        {
+            ThreadPool::Wait(node.handle);
+        }
+    }
+
+    void TaskGraph::Reset()
+    {
+        for (Node& node : nodes)
+        {
+            node.handle = JobHandle();
+        }
+    }
+
+    void TaskGraph::Clear()
+    {
+        nodes.clear();
+        executionOrder.clear();
+        dirty = true;
+    }
+}
@@ -0,0 +1,69 @@
+
+#pragma once
+#include "Core/ThreadPool.h"
+#include <vector>
+
+
+namespace Silex
+{
+    //=========================================
+    // タスクグラフ
+    //-----------------------------------------
+    // ノード (タスク) とエッジ (実行順序) を宣言的に登録し、依存関係を満たす順にスレッドプールで実行する
+    // グラフ構造は保持されるので、毎フレーム Reset → Execute → Wait で再利用できる
+    //
+    // TaskGraph graph;
+    // auto a = graph.AddNode("Animation", [](){ ... });
+    // auto b = graph.AddNode("Culling",   [](){ ... });
+    // graph.AddEdge(a, b);   // a の完了後に b を実行
+    //
+    // graph.Execute();
+    // graph.Wait();
+    //=========================================
+    class TaskGraph
+    {
+    public:
+
+        using NodeID = uint32;
+        static constexpr NodeID InvalidNode = ~0u;
+
+    public:
+
+        // ノード追加 / 依存関係追加 (before の完了後に after を実行)
+        NodeID AddNode(const char* name, Task&& task);
+        void   AddEdge(NodeID before, NodeID after);
+
+        // 実行順序の構築 (循環がある場合は false)
+        // Execute 時に未構築なら自動的に呼ばれる
+        bool Build();
+
+        // 全ノードをスレッドプールに発行 (ノードが完了するまで Execute を再度呼んではいけない)
+        bool Execute();
+
+        // 全ノードの完了待機 (待機中はジョブを肩代わりする)
+        void Wait();
+
+        // 毎フレームの実行状態をリセット (グラフ構造は保持)
+        void Reset();
+
+        // ノード・エッジを全て破棄
+        void Clear();
+
+        uint32      GetNodeCount()         const { return (uint32)nodes.size(); }
+        const char* GetNodeName(NodeID id) const { return nodes[id].name;       }
+
+    private:
+
+        struct Node
+        {
+            const char*         name = nullptr;
+            Task                task;
+            std::vector<NodeID> predecessors;
+            JobHandle           handle;
+        };
+
+        std::vector<Node>   nodes;
+        std::vector<NodeID> executionOrder;
+        bool                dirty = true;
+    };
+}
@@ -1,59 +1,393 @@
 
 #include "PCH.h"
 #include "ThreadPool.h"
+#include "Core/Profiler.h"
+
+#include <deque>
 
 
 namespace Silex
 {
+    //--------------------------------------------------------------------------------
+    // ジョブ
+    //--------------------------------------------------------------------------------
+    // 固定長プールから確保し、完了時に世代番号を進めてフリーリストに戻す
+    // 後続ジョブ (continuations) は、このジョブの完了時に依存カウントが減算される
+    //--------------------------------------------------------------------------------
+    struct Job
+    {
+        Task                task;
+        std::atomic<uint32> generation      = 0;
+        std::atomic<int32>  dependencyCount = 0;
+        std::atomic<uint32> nextFree        = JobHandle::InvalidIndex;
+        bool                isLongRunning   = false;
+
+        SpinLock            continuationLock;
+        std::vector<uint32> continuations;
+    };
+
+    //--------------------------------------------------------------------------------
+    // Chase-Lev ワークスティーリング両端キュー
+    //--------------------------------------------------------------------------------
+    // Push / Pop は所有スレッドのみが bottom 側から、Steal は任意のスレッドが top 側から行う
+    // 容量はジョブプールと同数なので、溢れることはない
+    // 参考: "Correct and Efficient Work-Stealing for Weak Memory Models" (Lê, et al. 2013)
+    //--------------------------------------------------------------------------------
+    template<uint32 Capacity>
+    class WorkStealingQueue
+    {
+        static_assert((Capacity & (Capacity - 1)) == 0, "容量は2の累乗である必要があります");
+        static constexpr int64 Mask = Capacity - 1;
+
+    public:
+
+        bool Push(uint32 job)
+        {
+            int64 b = bottom.load(std::memory_order_relaxed);
+            int64 t = top.load(std::memory_order_acquire);
+
+            if (b - t >= Capacity)
+                return false;
+
+            buffer[b & Mask].store(job, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            bottom.store(b + 1, std::memory_order_relaxed);
+
+            return true;
+        }
+
+        bool Pop(uint32& out_job)
+        {
+            int64 b = bottom.load(std::memory_order_relaxed) - 1;
+            bottom.store(b, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64 t = top.load(std::memory_order_relaxed);
+
+            // 空
+            if (t > b)
+            {
+                bottom.store(b + 1, std::memory_order_relaxed);
+                return false;
+            }
+
+            out_job = buffer[b & Mask].load(std::memory_order_relaxed);
+
+            // 最後の1要素は Steal と競合するので CAS で取り合う
+            if (t == b)
+            {
+                bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+                bottom.store(b + 1, std::memory_order_relaxed);
+                return won;
+            }
+
+            return true;
+        }
+
+        bool Steal(uint32& out_job)
+        {
+            int64 t = top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64 b = bottom.load(std::memory_order_acquire);
+
+            if (t >= b)
+                return false;
+
+            out_job = buffer[t & Mask].load(std::memory_order_relaxed);
+            return top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+        }
+
+        bool IsEmpty() const
+        {
+            return bottom.load(std::memory_order_relaxed) <= top.load(std::memory_order_relaxed);
+        }
+
+    private:
+
+        alignas(64) std::atomic<int64> top    = 0;
+        alignas(64) std::atomic<int64> bottom = 0;
+        std::atomic<uint32>            buffer[Capacity];
+    };
+
+
+
+    static constexpr uint32 MaxJobCount = 4096;
+    using JobQueue = WorkStealingQueue<MaxJobCount>;
+
+    // ワーカー数 (メインスレッドを除く)
     static uint32                   threadCount        = 0;
     static std::atomic<uint32>      workingThreadCount = 0;
-    static std::mutex               taskMutex;
-    static std::condition_variable  condition;
+    static std::atomic<uint32>      pendingJobCount    = 0;
     static std::vector<std::thread> threads;
-    static std::deque<Task>         taskQueue;
-    static bool                     isStopping;
+    static std::atomic<bool>        isStopping         = false;
+
+    // ジョブプール / フリーリスト (上位32bit: ABA対策タグ, 下位32bit: インデックス)
+    static Job                 jobs[MaxJobCount];
+    static std::atomic<uint64> freeListHead = 0;
+
+    // スレッド毎のキュー (0: メインスレッド, 1~: ワーカースレッド)
+    static std::vector<std::unique_ptr<JobQueue>> queues;
+
+    // ワーカー以外のスレッドから発行されたジョブ、及び 長時間タスク用の共有キュー
+    static SpinLock          globalQueueLock;
+    static std::deque<uint32> globalQueue;
+
+    // スリープ中のワーカー起床用シグナル
+    static std::atomic<uint32> wakeSignal    = 0;
+    static std::atomic<uint32> sleepingCount = 0;
+
+    thread_local uint32 workerIndex = JobHandle::InvalidIndex;
+    thread_local uint32 randomState = 0;
 
-    thread_local uint32        threadID        = 0;
-    static std::atomic<uint32> threadIDCounter = 0;
 
     //--------------------------------------------------------------------------------
-    // std::condition_variable::wait()
+    // ジョブプール
     //--------------------------------------------------------------------------------
-    // 条件が指定されているなら、満たされるまで(whileでビジーループ & 待機)
-    // そうでないならなら、notify_one() / notify_all() が呼び出されるまで 待機する
+    static void PushFreeJob(uint32 index)
+    {
+        uint64 head = freeListHead.load(std::memory_order_relaxed);
+        while (true)
+        {
+            jobs[index].nextFree.store((uint32)head, std::memory_order_relaxed);
+            uint64 newHead = (((head >> 32) + 1) << 32) | index;
+
+            if (freeListHead.compare_exchange_weak(head, newHead, std::memory_order_release, std::memory_order_relaxed))
+                return;
+        }
+    }
+
+    static uint32 PopFreeJob()
+    {
+        uint64 head = freeListHead.load(std::memory_order_acquire);
+        while (true)
+        {
+            uint32 index = (uint32)head;
+            if (index == JobHandle::InvalidIndex)
+                return JobHandle::InvalidIndex;
+
+            uint32 next    = jobs[index].nextFree.load(std::memory_order_relaxed);
+            uint64 newHead = (((head >> 32) + 1) << 32) | next;
+
+            if (freeListHead.compare_exchange_weak(head, newHead, std::memory_order_acquire, std::memory_order_acquire))
+                return index;
+        }
+    }
+
+    //--------------------------------------------------------------------------------
+    // キュー操作
     //--------------------------------------------------------------------------------
+    static void WakeWorker()
+    {
+        wakeSignal.fetch_add(1, std::memory_order_seq_cst);
+
+        if (sleepingCount.load(std::memory_order_seq_cst) > 0)
+            wakeSignal.notify_one();
+    }
+
+    static void PushJob(uint32 index)
+    {
+        bool pushed = false;
+
+        // 長時間タスクは Wait 中のスレッドに拾われないように、共有キューに積む
+        if (workerIndex != JobHandle::InvalidIndex && !jobs[index].isLongRunning)
+        {
+            pushed = queues[workerIndex]->Push(index);
+        }
+
+        if (!pushed)
+        {
+            std::lock_guard lock(globalQueueLock);
+            globalQueue.push_back(index);
+        }
+
+        WakeWorker();
+    }
+
+    static bool PopGlobalJob(uint32& out_job)
+    {
+        std::lock_guard lock(globalQueueLock);
+        if (globalQueue.empty())
+            return false;
 
-    static void ThreadLoop()
+        out_job = globalQueue.front();
+        globalQueue.pop_front();
+        return true;
+    }
+
+    // allowGlobal: 共有キュー (長時間タスクを含む) からの取得を許可するか (ワーカーループのみ)
+    static bool FindJob(uint32& out_job, bool allowGlobal)
     {
-        threadID = threadIDCounter++;
+        uint32 self = workerIndex;
+
+        // 自スレッドのキュー (LIFO: キャッシュ効率を優先)
+        if (self != JobHandle::InvalidIndex && queues[self]->Pop(out_job))
+            return true;
+
+        if (allowGlobal && PopGlobalJob(out_job))
+            return true;
+
+        // 他スレッドから盗む (開始位置を疑似乱数で分散させ、特定キューへの集中を避ける)
+        uint32 numQueues = (uint32)queues.size();
+        randomState = randomState * 1664525u + 1013904223u;
+        uint32 start = randomState % numQueues;
+
+        for (uint32 i = 0; i < numQueues; i++)
+        {
+            uint32 victim = (start + i) % numQueues;
+            if (victim == self)
+                continue;
+
+            if (queues[victim]->Steal(out_job))
+                return true;
+        }
+
+        return false;
+    }
+
+    //--------------------------------------------------------------------------------
+    // ジョブ実行
+    //--------------------------------------------------------------------------------
+    static void FinishJob(uint32 index)
+    {
+        Job& job = jobs[index];
+
+        // 世代を進めた時点で "完了" 扱いになり、以降は後続ジョブが追加されない
+        job.continuationLock.lock();
+        job.generation.fetch_add(1, std::memory_order_release);
+        job.continuationLock.unlock();
+
+        for (uint32 next : job.continuations)
+        {
+            if (jobs[next].dependencyCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                PushJob(next);
+            }
+        }
+
+        job.continuations.clear();
+        PushFreeJob(index);
+
+        pendingJobCount.fetch_sub(1, std::memory_order_release);
+    }
+
+    static void ExecuteJob(uint32 index)
+    {
+        Job& job = jobs[index];
+
+        job.task();
+        job.task = nullptr;
+
+        FinishJob(index);
+    }
+
+    // 待機中のスレッドがジョブを1つ肩代わりする
+    static bool HelpOneJob()
+    {
+        uint32 index;
+        if (!FindJob(index, false))
+            return false;
+
+        ExecuteJob(index);
+        return true;
+    }
+
+    static JobHandle ScheduleInternal(Task&& task, const JobHandle* dependencies, uint32 numDependencies, bool isLongRunning)
+    {
+        // プールが枯渇している場合は、空きができるまでジョブを消化して待つ
+        uint32 index = PopFreeJob();
+        while (index == JobHandle::InvalidIndex)
+        {
+            if (!HelpOneJob())
+                std::this_thread::yield();
+
+            index = PopFreeJob();
+        }
+
+        Job& job = jobs[index];
+        job.task          = Traits::Move(task);
+        job.isLongRunning = isLongRunning;
+
+        // 依存関係の登録が終わるまで実行されないように、ガードとして +1 しておく
+        job.dependencyCount.store(1, std::memory_order_relaxed);
+
+        JobHandle handle;
+        handle.index      = index;
+        handle.generation = job.generation.load(std::memory_order_relaxed);
+
+        pendingJobCount.fetch_add(1, std::memory_order_relaxed);
+
+        for (uint32 i = 0; i < numDependencies; i++)
+        {
+            const JobHandle& dependency = dependencies[i];
+            if (!dependency.IsValid())
+                continue;
+
+            Job& dep = jobs[dependency.index];
+            std::lock_guard lock(dep.continuationLock);
+
+            // 既に完了している依存ジョブは無視
+            if (dep.generation.load(std::memory_order_acquire) == dependency.generation)
+            {
+                job.dependencyCount.fetch_add(1, std::memory_order_relaxed);
+                dep.continuations.push_back(index);
+            }
+        }
+
+        // ガード解除 (依存が無い、または全て完了済みなら即実行可能)
+        if (job.dependencyCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            PushJob(index);
+        }
+
+        return handle;
+    }
+
+    //--------------------------------------------------------------------------------
+    // ワーカースレッド
+    //--------------------------------------------------------------------------------
+    static void ThreadLoop(uint32 index)
+    {
+        workerIndex = index;
+        randomState = index * 2654435761u + 1;
+
+        PerformanceProfiler::SetThreadName(std::format("Worker {}", index).c_str());
 
         while (true)
         {
-            Task task;
+            uint32 signal = wakeSignal.load(std::memory_order_seq_cst);
 
+            uint32 jobIndex;
+            if (FindJob(jobIndex, true))
             {
-                std::unique_lock<std::mutex> lock(taskMutex);
+                workingThreadCount++;
+                ExecuteJob(jobIndex);
+                workingThreadCount--;
+                continue;
+            }
 
-                // タスクが空の場合は wait する
-                while (!isStopping && taskQueue.empty())
-                {
-                    condition.wait(lock);
-                }
+            if (isStopping.load(std::memory_order_acquire))
+                return;
 
-                if (isStopping && taskQueue.empty())
-                    return;
+            // スリープ前に再確認し、発行と待機の間でシグナルを取りこぼさないようにする
+            sleepingCount.fetch_add(1, std::memory_order_seq_cst);
 
-                task = taskQueue.front();
-                taskQueue.pop_front();
+            if (FindJob(jobIndex, true))
+            {
+                sleepingCount.fetch_sub(1, std::memory_order_seq_cst);
+
+                workingThreadCount++;
+                ExecuteJob(jobIndex);
+                workingThreadCount--;
+                continue;
             }
 
-            // タスク実行
-            workingThreadCount++;
-            task();
-            workingThreadCount--;
+            // 新たなジョブが発行されるまで待機 (signal から値が変わるまでブロック)
+            wakeSignal.wait(signal, std::memory_order_seq_cst);
+            sleepingCount.fetch_sub(1, std::memory_order_seq_cst);
         }
     }
 
+
+
     void ThreadPool::Initialize()
     {
         //---------------------------
@@ -61,12 +395,29 @@ namespace Silex
         //---------------------------
 
         isStopping  = false;
-        threadCount = std::thread::hardware_concurrency() - 1;
+        threadCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+
+        // フリーリスト構築
+        freeListHead = JobHandle::InvalidIndex;
+        for (uint32 i = MaxJobCount; i > 0; i--)
+        {
+            PushFreeJob(i - 1);
+        }
+
+        // メインスレッド + ワーカー分のキューを確保
+        for (uint32 i = 0; i < threadCount + 1; i++)
+        {
+            queues.emplace_back(std::make_unique<JobQueue>());
+        }
+
+        // 呼び出しスレッド (メインスレッド) をインデックス 0 として登録
+        workerIndex = 0;
+        randomState = 1;
 
         // スレッドループを予約
         for (uint32 i = 0; i < threadCount; i++)
         {
-            threads.emplace_back(std::thread(&Silex::ThreadLoop));
+            threads.emplace_back(std::thread(&Silex::ThreadLoop, i + 1));
         }
     }
 
@@ -78,38 +429,66 @@ namespace Silex
 
         // 実行中のタスクを完了させる
         WaitAll();
-        taskQueue.clear();
 
-        {
-            // 終了フラグを立てる
-            std::unique_lock<std::mutex> lock(taskMutex);
-            isStopping = true;
-        }
-
-        // 全ての wait スレッド起動
-        condition.notify_all();
+        // 終了フラグを立てて、全ての待機スレッドを起動
+        isStopping.store(true, std::memory_order_release);
+        wakeSignal.fetch_add(1, std::memory_order_seq_cst);
+        wakeSignal.notify_all();
 
         // 全スレッドが終了するまで待機
         for (auto& thread : threads)
             thread.join();
 
         threads.clear();
+        queues.clear();
+        globalQueue.clear();
+
+        workerIndex = JobHandle::InvalidIndex;
     }
 
-    void ThreadPool::AddTask(Task&& task)
+    JobHandle ThreadPool::Schedule(Task&& task)
     {
-        //---------------------------
-        // SL_ASSERT(IsMainThread());
-        //---------------------------
+        return ScheduleInternal(Traits::Move(task), nullptr, 0, false);
+    }
+
+    JobHandle ThreadPool::Schedule(Task&& task, const JobHandle* dependencies, uint32 numDependencies)
+    {
+        return ScheduleInternal(Traits::Move(task), dependencies, numDependencies, false);
+    }
 
+    JobHandle ThreadPool::Schedule(Task&& task, std::initializer_list<JobHandle> dependencies)
+    {
+        return ScheduleInternal(Traits::Move(task), dependencies.begin(), (uint32)dependencies.size(), false);
+    }
+
+    bool ThreadPool::IsCompleted(JobHandle handle)
+    {
+        if (!handle.IsValid())
+            return true;
+
+        return jobs[handle.index].generation.load(std::memory_order_acquire) != handle.generation;
+    }
+
+    void ThreadPool::Wait(JobHandle handle)
+    {
+        while (!IsCompleted(handle))
         {
-            // キューにタスクを追加
-            std::unique_lock<std::mutex> lock(taskMutex);
-            taskQueue.emplace_back(std::bind(std::forward<Task>(task)));
+            if (!HelpOneJob())
+                std::this_thread::yield();
         }
+    }
 
-        // 待機中のスレッドを1つだけ起動させる
-        condition.notify_one();
+    void ThreadPool::Wait(const JobHandle* handles, uint32 numHandles)
+    {
+        for (uint32 i = 0; i < numHandles; i++)
+        {
+            Wait(handles[i]);
+        }
+    }
+
+    void ThreadPool::AddTask(Task&& task)
+    {
+        ScheduleInternal(Traits::Move(task), nullptr, 0, true);
     }
 
     void ThreadPool::WaitAll()
@@ -119,7 +498,8 @@ namespace Silex
         //---------------------------
         while (HasRunningTask())
         {
-            OS::Get()->Sleep(16);
+            if (!HelpOneJob())
+                std::this_thread::yield();
         }
     }
 
@@ -127,22 +507,27 @@ namespace Silex
 
 
     uint32 ThreadPool::GetThreadCount()
-    { 
+    {
         return threadCount;
     }
 
     uint32 ThreadPool::GetWorkingThreadCount()
-    { 
+    {
         return workingThreadCount;
     }
 
     uint32 ThreadPool::GetIdleThreadCount()
-    { 
+    {
         return threadCount - workingThreadCount;
     }
 
     bool ThreadPool::HasRunningTask()
-    { 
-        return GetIdleThreadCount() != GetThreadCount();
+    {
+        return pendingJobCount.load(std::memory_order_acquire) != 0;
+    }
+
+    uint32 ThreadPool::GetCurrentWorkerIndex()
+    {
+        return workerIndex;
     }
 }
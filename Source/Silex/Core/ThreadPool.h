@@ -2,12 +2,40 @@
 #pragma once
 #include "Core/CoreType.h"
 #include <functional>
+#include <initializer_list>
 
 
 namespace Silex
 {
     using Task = std::function<void()>;
 
+    //=========================================
+    // ジョブハンドル
+    //-----------------------------------------
+    // ジョブプール内のインデックスと世代番号の組
+    // ジョブが完了すると世代番号が進むので、再利用後も古いハンドルは "完了" として扱われる
+    //=========================================
+    struct JobHandle
+    {
+        static constexpr uint32 InvalidIndex = ~0u;
+
+        uint32 index      = InvalidIndex;
+        uint32 generation = 0;
+
+        bool IsValid() const { return index != InvalidIndex; }
+    };
+
+
+    //=========================================
+    // スレッドプール (ワークスティーリング ジョブシステム)
+    //-----------------------------------------
+    // ワーカー毎にロックフリーの両端キュー (Chase-Lev) を持ち、
+    // 自スレッドのキューが空になると他スレッドのキューからジョブを盗んで実行する
+    //
+    // Schedule: 依存関係付きのジョブを発行し、ハンドルを返す (fork / join 用)
+    // AddTask : 戻り値なしのタスクを発行する (スプラッシュスクリーンのような長時間タスク用)
+    //           ワーカースレッドのみが実行し、Wait 中のスレッドが肩代わりすることはない
+    //=========================================
     class ThreadPool
     {
     public:
@@ -15,6 +43,16 @@ namespace Silex
         static void Initialize();
         static void Finalize();
 
+        // ジョブ発行 (依存ジョブが全て完了してから実行される)
+        static JobHandle Schedule(Task&& task);
+        static JobHandle Schedule(Task&& task, const JobHandle* dependencies, uint32 numDependencies);
+        static JobHandle Schedule(Task&& task, std::initializer_list<JobHandle> dependencies);
+
+        // 完了待機 (待機中は、キューに積まれているジョブを実行して待機時間を埋める)
+        static void Wait(JobHandle handle);
+        static void Wait(const JobHandle* handles, uint32 numHandles);
+        static bool IsCompleted(JobHandle handle);
+
         static void AddTask(Task&& task);
         static void WaitAll();
 
@@ -22,6 +60,9 @@ namespace Silex
         static uint32 GetWorkingThreadCount();
         static uint32 GetIdleThreadCount();
         static bool   HasRunningTask();
+
+        // 呼び出しスレッドがジョブを実行可能なスレッド (メイン or ワーカー) であれば、そのインデックスを返す
+        // それ以外のスレッドでは JobHandle::InvalidIndex を返す
+        static uint32 GetCurrentWorkerIndex();
     };
 }
-
@@ -2,11 +2,17 @@
 #pragma once
 
 #include "Core/OS.h"
-#include <unordered_map>
+#include "Core/Profiler.h"
 
 
 namespace Silex
 {
+    //=========================================
+    // タイマー
+    //-----------------------------------------
+    // 開始時点のクロック数を 64bit 整数のまま保持し、経過時間のみを浮動小数点に変換する
+    // (経過時刻そのものを float で保持すると、起動からの時間が長くなるほど精度が落ちるため)
+    //=========================================
     class Timer
     {
     public:
@@ -18,90 +24,29 @@ namespace Silex
 
         void Reset()
         {
-            start = OS::Get()->GetTickSeconds() / (float)1'000'000;
+            start = OS::Get()->GetTickCount();
         }
 
         float Elapsed()
         {
-            return OS::Get()->GetTickSeconds() / (float)1'000'000 - start;
+            uint64 elapsed = OS::Get()->GetTickCount() - start;
+            return (float)((double)elapsed / (double)OS::Get()->GetTickFrequency());
         }
 
         float ElapsedMilli()
         {
-            return Elapsed() * 1000.0f;
+            uint64 elapsed = OS::Get()->GetTickCount() - start;
+            return (float)((double)elapsed * 1'000.0 / (double)OS::Get()->GetTickFrequency());
         }
 
         float ElapsedMicro()
         {
-            return Elapsed();
+            uint64 elapsed = OS::Get()->GetTickCount() - start;
+            return (float)((double)elapsed * 1'000'000.0 / (double)OS::Get()->GetTickFrequency());
         }
 
     private:
 
-        float start;
+        uint64 start;
     };
-
-
-    class PerformanceProfiler
-    {
-    public:
-
-        static PerformanceProfiler& Get()
-        {
-            static PerformanceProfiler profiler;
-            return profiler;
-        }
-
-        void AddProfile(const char* name, float time)
-        {
-            perFrameData[name] = time;
-        }
-
-        void Reset()
-        {
-            perFrameData.clear();
-        }
-
-        void GetFrameData(std::unordered_map<const char*, float>* outData, bool shouldReset = false)
-        {
-            *outData = perFrameData;
-
-            if (shouldReset)
-            {
-                Reset();
-            }
-        }
-
-    private:
-
-        static inline std::unordered_map<const char*, float> perFrameData;
-    };
-
-
-    // デストラクタを利用した、スコープ寿命のタイマー
-    // 生成されてから破棄されるまでの時間を計測し、プロファイラーに登録する
-    class ScopePerformanceTimer
-    {
-    public:
-
-        ScopePerformanceTimer(const char* name, const PerformanceProfiler& profiler)
-            : name(name)
-            , profiler(profiler)
-        {
-        }
-
-        ~ScopePerformanceTimer()
-        {
-            float time = timer.ElapsedMilli();
-            profiler.AddProfile(name, time);
-        }
-
-    private:
-
-        const char*         name;
-        PerformanceProfiler profiler;
-        Timer               timer;
-    };
-
-#define SL_SCOPE_PROFILE(name)  ScopePerformanceTimer timer__LINE__(name, PerformanceProfiler::Get());
-}
\ No newline at end of file
+}
@@ -325,6 +325,13 @@ namespace Silex
         if (selectAsset->GetAssetType() != AssetType::Material)
             return;
 
+        // 読み込み完了まで編集できない
+        if (!selectAsset.As<MaterialAsset>()->Get())
+        {
+            ImGui::TextDisabled("読み込み中...");
+            return;
+        }
+
         const float windowWidth = ImGui::GetWindowWidth();
         const float offset      = ImGui::GetCurrentWindow()->WindowPadding.x;
         const float buttonWidth = 100;
@@ -381,7 +388,7 @@ namespace Silex
                             current  = id;
                             modified = true;
 
-                            material->Get()->albedoMap = asset.As<Texture2DAsset>();
+                            material->Get()->albedoMap = AssetManager::Get()->GetAssetAs<Texture2DAsset>(id);
                         }
 
                         if (selected)
@@ -8,7 +8,10 @@
 #include "Core/Timer.h"
 #include "Core/Random.h"
 #include "Core/Engine.h"
+#include "Core/ThreadPool.h"
+#include "Asset/Asset.h"
 #include "Rendering/Renderer.h"
+#include "Rendering/PipelineCompiler.h"
 #include "Serialize/SceneSerializer.h"
 
 #include <imgui/imgui_internal.h>
@@ -171,6 +174,17 @@ namespace Silex
 
                 // シーン描画
                 GUI::Image(sceneRenderer->GetSceneFinalOutput(), content.x, content.y);
+
+                // 矩形選択範囲
+                if (selectingMarquee)
+                {
+                    ImVec2 rectStart = ImVec2(relativeViewportRect[0].x + marqueeStart.x, relativeViewportRect[0].y + marqueeStart.y);
+                    ImVec2 rectEnd   = ImGui::GetMousePos();
+
+                    ImDrawList* drawList = ImGui::GetWindowDrawList();
+                    drawList->AddRectFilled(rectStart, rectEnd, IM_COL32(80, 140, 255, 40));
+                    drawList->AddRect(rectStart, rectEnd, IM_COL32(80, 140, 255, 200));
+                }
             }
 
             // ギズモ
@@ -259,19 +273,63 @@ namespace Silex
         if (showStats)
         {
             ImGui::Begin("統計", &showStats, usingCameraFlag);
-            ImGui::Text("FPS: %d (%.2f)ms", Engine::Get()->GetFrameRate(), Engine::Get()->GetDeltaTime() * 1000);
+            ImGui::Text("FPS: %u (%.2f)ms", Engine::Get()->GetFrameRate(), Engine::Get()->GetDeltaTime() * 1000);
             ImGui::Text("Resolution: %d, %d", sceneViewportFramebufferSize.x, sceneViewportFramebufferSize.y);
 
             ImGui::Text("Camera: %.0f, %.0f, %.0f", editorCamera.GetPosition().x, editorCamera.GetPosition().y, editorCamera.GetPosition().z);
 
             ImGui::RadioButton("hoveredViewport", hoveredViewport);
 
-            //ImGui::SeparatorText("");
+            ImGui::SeparatorText("");
+
+            SceneRenderStats stats = sceneRenderer->GetRenderStats();
+            ImGui::Text("GeometryDrawCall: %llu", stats.numGeometryDrawCall);
+            ImGui::Text("ShadowDrawCall:   %llu", stats.numShadowDrawCall);
+            ImGui::Text("NumMesh:          %u", stats.numRenderMesh);
+            ImGui::Text("Geometry Visible: %u (culled %u)", stats.numVisibleGeometry, stats.numCulledGeometry);
+            ImGui::Text("Shadow Visible:   %u (culled %u)", stats.numVisibleShadow, stats.numCulledShadow);
+            ImGui::Text("Occlusion Draw:   %u + %u (culled %u)", stats.numOcclusionEarly, stats.numOcclusionLate, stats.numOcclusionCulled);
+            ImGui::Text("RenderGraph Pass: %u (culled %u)", stats.numGraphPass, stats.numGraphCulledPass);
+            ImGui::Text("RenderGraph RT:   %.1f MB (no alias %.1f MB)", stats.graphTargetMemory / (1024.0f * 1024.0f), stats.graphTargetMemoryNoAlias / (1024.0f * 1024.0f));
+            ImGui::Text("Record:           %.3f ms / %u draws (%.2f us/draw)", stats.cpuRecordTime, stats.numRecordDraw, stats.numRecordDraw? stats.cpuRecordTime * 1000.0f / stats.numRecordDraw : 0.0f);
+            ImGui::Text("Record Secondary: %u (%u threads)", stats.numSecondaryBuffer, stats.numRecordThread);
+
+            // 間接描画 / メッシュソース毎の描画 を切り替えて記録時間を比較する
+            bool indirectDraw = sceneRenderer->IsIndirectDrawEnabled();
+            if (ImGui::Checkbox("間接描画", &indirectDraw))
+            {
+                sceneRenderer->SetIndirectDrawEnabled(indirectDraw);
+            }
 
-            //SceneRenderStats stats = sceneRenderer.GetRenderStats();
-            //ImGui::Text("GeometryDrawCall: %d", stats.numGeometryDrawCall);
-            //ImGui::Text("ShadowDrawCall:   %d", stats.numShadowDrawCall);
-            //ImGui::Text("NumMesh:          %d", stats.numRenderMesh);
+            const DrawModeStats& perSource = sceneRenderer->GetDrawModeStats(false);
+            const DrawModeStats& indirect  = sceneRenderer->GetDrawModeStats(true);
+            ImGui::Text("  PerSource: %.1f draws / %.3f ms (%llu frames)", perSource.GetAverageDrawCall(), perSource.GetAverageRecordTime(), perSource.numFrame);
+            ImGui::Text("  Indirect:  %.1f draws / %.3f ms (%llu frames)", indirect.GetAverageDrawCall(),  indirect.GetAverageRecordTime(),  indirect.numFrame);
+
+            bool culling = sceneRenderer->IsCullingEnabled();
+            if (ImGui::Checkbox("視錐台カリング", &culling))
+            {
+                sceneRenderer->SetCullingEnabled(culling);
+            }
+
+            bool occlusionCulling = sceneRenderer->IsOcclusionCullingEnabled();
+            if (ImGui::Checkbox("オクルージョンカリング", &occlusionCulling))
+            {
+                sceneRenderer->SetOcclusionCullingEnabled(occlusionCulling);
+            }
+
+            // 並列記録の有無・スレッド数を切り替えて、描画数に対する記録時間のスケーリングを比較する
+            bool parallelRecording = sceneRenderer->IsParallelRecordingEnabled();
+            if (ImGui::Checkbox("並列コマンド記録", &parallelRecording))
+            {
+                sceneRenderer->SetParallelRecordingEnabled(parallelRecording);
+            }
+
+            int recordThreadLimit = sceneRenderer->GetRecordThreadLimit();
+            if (ImGui::SliderInt("記録スレッド数 (0: 制限なし)", &recordThreadLimit, 0, ThreadPool::GetThreadCount() + 1))
+            {
+                sceneRenderer->SetRecordThreadLimit(recordThreadLimit);
+            }
 
             ImGui::SeparatorText("");
 
@@ -280,6 +338,40 @@ namespace Silex
                 ImGui::Text("%-*s %.2f ms", 24, profile, time);
             }
 
+            // GPU 区間計測 (数フレーム前の計測値)
+            for (const GPUTimestampResult& zone : Renderer::Get()->GetGPUTimestampResults())
+            {
+                ImGui::Text("GPU %-*s %.2f ms", 20, zone.name, zone.milliseconds);
+            }
+
+            ImGui::Text("PendingPipeline: %u", PipelineCompiler::GetPendingCount());
+
+            if (ImGui::Button("トレース出力"))
+            {
+                std::string filePath = OS::Get()->SaveFile("Chrome Trace (*.json)\0*.json\0", "json");
+                if (!filePath.empty())
+                {
+                    PerformanceProfiler::ExportChromeTrace(filePath);
+                }
+            }
+
+            // フレームアロケータ使用量
+            ImGui::SeparatorText("");
+            const LinearAllocator* frameAllocator = Renderer::Get()->GetFrameAllocator();
+            ImGui::Text("FrameAllocator: %.1f / %.1f KB (peak %.1f KB)", frameAllocator->GetUsedSize() / 1024.0f, frameAllocator->GetCapacity() / 1024.0f, frameAllocator->GetHighWaterMark() / 1024.0f);
+
+            // アセットのストリーミング (予算を下げると、シーンから参照されていないアセットが古い順に解放される)
+            ImGui::SeparatorText("");
+            AssetStreamingStats assetStats = AssetManager::Get()->GetStreamingStats();
+            ImGui::Text("Asset Resident:   %.1f / %.1f MB (%u assets, loading %u)", assetStats.residentBytes / (1024.0f * 1024.0f), assetStats.budgetBytes / (1024.0f * 1024.0f), assetStats.numResident, assetStats.numLoading);
+            ImGui::Text("Asset Load:       %llu (evicted %llu, %.1f MB)", assetStats.numLoad, assetStats.numEviction, assetStats.evictedBytes / (1024.0f * 1024.0f));
+
+            int assetBudget = (int)(assetStats.budgetBytes / (1024 * 1024));
+            if (ImGui::SliderInt("アセット予算 (MB)", &assetBudget, 64, 8192))
+            {
+                AssetManager::Get()->SetMemoryBudget((uint64)assetBudget * 1024 * 1024);
+            }
+
             // メモリー使用量
             //ImGui::SeparatorText("");
             //auto status = PoolAllocator::GetStatus();
@@ -324,10 +416,16 @@ namespace Silex
                 if (Input::IsKeyDown(Keys::Q)) editorCamera.Move(CameraMovementDir::Down,     deltaTime);
             }
 
-            // オブジェクト選択
-            if (Input::IsMouseButtonReleased(Mouse::Left) && !usingManipulater && hoveredViewport)
+            // オブジェクト選択 (クリック: 1ピクセル / ドラッグ: 矩形選択)
+            if (Input::IsMouseButtonPressed(Mouse::Left) && !usingManipulater && hoveredViewport)
             {
-                // SelectViewportEntity();
+                selectingMarquee = true;
+                marqueeStart     = GetViewportCursorPosition();
+            }
+            else if (Input::IsMouseButtonReleased(Mouse::Left) && selectingMarquee)
+            {
+                selectingMarquee = false;
+                SelectViewportEntity(marqueeStart, GetViewportCursorPosition());
             }
 
             if (Input::IsKeyDown(Keys::LeftControl))
@@ -383,26 +481,46 @@ namespace Silex
         return usingEditorCamera;
     }
 
-    void Editor::SelectViewportEntity()
+    glm::ivec2 Editor::GetViewportCursorPosition() const
     {
-        if (!hoveredViewport)
-            return;
-
         // ビューポートの相対座標を取得
         glm::ivec2 mouse       = Input::GetCursorPosition();
         glm::ivec2 viewportPos = { relativeViewportRect[0].x, relativeViewportRect[0].y };
         glm::ivec2 windowPos   = Window::Get()->GetWindowPos();
         glm::ivec2 diff        = viewportPos - windowPos;
-        glm::ivec2 mousediff   = mouse - diff;
 
-        // ピクセルID 読み取り
-        if (mousediff.x >= 0 && mousediff.y >= 0)
+        return mouse - diff;
+    }
+
+    void Editor::SelectViewportEntity(const glm::ivec2& start, const glm::ivec2& end)
+    {
+        // 矩形がビューポート外で完結する場合は選択しない (はみ出した部分はビューポート内に制限する)
+        glm::ivec2 rectMin = glm::max(glm::min(start, end), glm::ivec2(0));
+        glm::ivec2 rectMax = glm::min(glm::max(start, end), sceneViewportFramebufferSize - 1);
+
+        if (rectMin.x > rectMax.x || rectMin.y > rectMax.y)
+            return;
+
+        // ピクセルID 読み取り (結果はフレームインフライト数だけ後に返るので、その間にシーンが切り替わった場合は破棄する)
+        Scene* requestScene = scene.Get();
+        sceneRenderer->RequestEntityPickRect(rectMin.x, rectMin.y, rectMax.x, rectMax.y, [this, requestScene](const std::vector<int32>& entityIDs)
         {
-            selectionID = sceneRenderer->ReadEntityIDFromPixel(mousediff.x, mousediff.y);
-            SL_LOG_DEBUG("Clicked: EntityID({}) : (x, y) = {}, {}", selectionID, mousediff.x, mousediff.y);
-        }
+            if (scene.Get() == requestScene)
+            {
+                OnPickViewportEntity(entityIDs);
+            }
+        });
+    }
+
+    void Editor::OnPickViewportEntity(const std::vector<int32>& entityIDs)
+    {
+        selectionIDs = entityIDs;
+        selectionID  = entityIDs.empty()? -1 : entityIDs.front();
+
+        SL_LOG_DEBUG("Picked: EntityID({}) : {} entities", selectionID, entityIDs.size());
 
         // 選択したエンティティをシーンヒエラルキーのアクティブエンティティに設定し、ギズモを表示
+        // (プロパティパネルは単一選択なので、矩形選択では ID の最も小さいエンティティをアクティブにする)
         if (selectionID >= 0)
         {
             activeGizmoForcus = true;
@@ -54,7 +54,9 @@ namespace Silex
         void OpenScene(const std::string& filePath);
         void SaveSceneAs();
 
-        void SelectViewportEntity();
+        void SelectViewportEntity(const glm::ivec2& start, const glm::ivec2& end);
+        void OnPickViewportEntity(const std::vector<int32>& entityIDs);
+        glm::ivec2 GetViewportCursorPosition() const;
         void HandleInput(float deltaTime);
 
     private:
@@ -88,6 +90,9 @@ namespace Silex
         bool                hoveredViewport      = false;
         bool                activeGizmoForcus    = true;
         int32               selectionID          = -1;
+        std::vector<int32>  selectionIDs         = {};    // 矩形選択で選ばれた全エンティティ
+        bool                selectingMarquee     = false;
+        glm::ivec2          marqueeStart         = {};
         ImGuizmo::OPERATION manipulateType       = ImGuizmo::TRANSLATE;
         ImGuizmo::MODE      manipulateMode       = ImGuizmo::LOCAL;
         glm::vec3           selectEntityPosition = {};
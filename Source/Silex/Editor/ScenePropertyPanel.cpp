@@ -292,11 +292,8 @@ namespace Silex
                                     modified = true;
                                     meshName = asset->GetName().c_str();
 
-                                    Ref<MeshAsset> m = asset.As<MeshAsset>();
-                                    component.mesh = m;
-
-                                    uint32 numSlots = m->Get()->GetMaterialSlotCount();
-                                    component.materials.resize(numSlots);
+                                    // 未読み込みであれば読み込みを要求する (スロット数は常駐後に合わせる)
+                                    component.mesh = AssetManager::Get()->GetAssetAs<MeshAsset>(id);
                                 }
 
                                 if (selected)
@@ -320,6 +317,16 @@ namespace Silex
                     ImGui::PopID();
                 }
 
+                // メッシュは非同期に読み込まれるので、常駐した時点でマテリアルスロット数を合わせる
+                if (component.mesh && component.mesh->Get())
+                {
+                    uint32 numSlots = component.mesh->Get()->GetMaterialSlotCount();
+                    if (component.materials.size() != numSlots)
+                    {
+                        component.materials.resize(numSlots);
+                    }
+                }
+
                 {
                     ImGui::PushID("Cast Shadow");
                     ImGui::Checkbox("", &component.castShadow);
@@ -366,7 +373,7 @@ namespace Silex
                                     current = id;
                                     modified = true;
                                     materialName = asset->GetName().c_str();
-                                    material     = asset.As<MaterialAsset>();
+                                    material     = AssetManager::Get()->GetAssetAs<MaterialAsset>(id);
                                 }
 
                                 if (selected)
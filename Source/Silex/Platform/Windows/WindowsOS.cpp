@@ -193,6 +193,20 @@ namespace Silex
         return seconds + decimal;
     }
 
+    uint64 WindowsOS::GetTickCount()
+    {
+        // OS::Initialize からの経過クロック数 (変換を行わないので、高頻度の計測向け)
+        uint64 tick;
+        ::QueryPerformanceCounter((LARGE_INTEGER*)&tick);
+
+        return tick - startTickCount;
+    }
+
+    uint64 WindowsOS::GetTickFrequency()
+    {
+        return tickPerSecond;
+    }
+
     void WindowsOS::Sleep(uint32 millisec)
     {
         ::Sleep(millisec);
@@ -243,6 +257,54 @@ namespace Silex
         return {};
     }
 
+    bool WindowsOS::MapFile(const std::string& filePath, MappedFile& out_mappedFile)
+    {
+        out_mappedFile = {};
+
+        // 先読みのヒントとして、シーケンシャルアクセスを指定する
+        HANDLE file = ::CreateFileW(ToUTF16(filePath).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+
+        LARGE_INTEGER fileSize = {};
+        if (!::GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+        {
+            ::CloseHandle(file);
+            return false;
+        }
+
+        HANDLE mapping = ::CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping)
+        {
+            ::CloseHandle(file);
+            return false;
+        }
+
+        void* view = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!view)
+        {
+            ::CloseHandle(mapping);
+            ::CloseHandle(file);
+            return false;
+        }
+
+        out_mappedFile.data          = (const byte*)view;
+        out_mappedFile.size          = fileSize.QuadPart;
+        out_mappedFile.fileHandle    = file;
+        out_mappedFile.mappingHandle = mapping;
+
+        return true;
+    }
+
+    void WindowsOS::UnmapFile(MappedFile& mappedFile)
+    {
+        if (mappedFile.data)          ::UnmapViewOfFile(mappedFile.data);
+        if (mappedFile.mappingHandle) ::CloseHandle(mappedFile.mappingHandle);
+        if (mappedFile.fileHandle)    ::CloseHandle(mappedFile.fileHandle);
+
+        mappedFile = {};
+    }
+
     void WindowsOS::SetConsoleAttribute(uint16 color)
     {
 #if SL_DEBUG
@@ -21,12 +21,18 @@ namespace Silex
 
         // 時間
         uint64 GetTickSeconds()       override;
+        uint64 GetTickCount()         override;
+        uint64 GetTickFrequency()     override;
         void   Sleep(uint32 millisec) override;
 
         // ファイル
         std::string OpenFile(const char* filter = "All\0*.*\0")                                  override;
         std::string SaveFile(const char* filter = "All\0*.*\0", const char* extention = nullptr) override;
 
+        // ファイルマッピング
+        bool MapFile(const std::string& filePath, MappedFile& out_mappedFile) override;
+        void UnmapFile(MappedFile& mappedFile)                                override;
+
         // コンソール
         void SetConsoleAttribute(uint16 color)                      override;
         void OutputConsole(uint8 color, const std::string& message) override;
@@ -0,0 +1,92 @@
+
+#pragma once
+
+#include "Core/CoreType.h"
+
+
+namespace Silex
+{
+    //=========================================
+    // 軸並行境界ボックス
+    //=========================================
+    struct AABB
+    {
+        glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+        glm::vec3 max = glm::vec3(std::numeric_limits<float>::lowest());
+
+        bool IsValid() const { return min.x <= max.x && min.y <= max.y && min.z <= max.z; }
+
+        glm::vec3 GetCenter() const { return (min + max) * 0.5f; }
+        glm::vec3 GetExtent() const { return (max - min) * 0.5f; }
+
+        void Expand(const glm::vec3& point)
+        {
+            min = glm::min(min, point);
+            max = glm::max(max, point);
+        }
+
+        void Merge(const AABB& other)
+        {
+            min = glm::min(min, other.min);
+            max = glm::max(max, other.max);
+        }
+
+        // 変換後の点を包含する AABB (中心を変換し、半径は行列の絶対値で射影する)
+        AABB Transform(const glm::mat4& matrix) const
+        {
+            const glm::vec3 center = glm::vec3(matrix * glm::vec4(GetCenter(), 1.0f));
+            const glm::vec3 extent = GetExtent();
+
+            glm::vec3 worldExtent;
+            worldExtent.x = glm::abs(matrix[0][0]) * extent.x + glm::abs(matrix[1][0]) * extent.y + glm::abs(matrix[2][0]) * extent.z;
+            worldExtent.y = glm::abs(matrix[0][1]) * extent.x + glm::abs(matrix[1][1]) * extent.y + glm::abs(matrix[2][1]) * extent.z;
+            worldExtent.z = glm::abs(matrix[0][2]) * extent.x + glm::abs(matrix[1][2]) * extent.y + glm::abs(matrix[2][2]) * extent.z;
+
+            AABB result;
+            result.min = center - worldExtent;
+            result.max = center + worldExtent;
+            return result;
+        }
+    };
+
+    //=========================================
+    // 境界球
+    //=========================================
+    struct BoundingSphere
+    {
+        glm::vec3 center = glm::vec3(0.0f);
+        float     radius = 0.0f;
+    };
+
+    //=========================================
+    // 視錐台
+    //-----------------------------------------
+    // 各平面は (法線, 距離) で、内側が正 (dot(n, p) + d >= 0)
+    //=========================================
+    struct Frustum
+    {
+        glm::vec4 planes[6];
+
+        // ビュープロジェクション行列から平面を抽出 (Gribb/Hartmann)
+        // 深度範囲は [-1, 1] として抽出するので、[0, 1] の行列に対しても保守的 (カリングしすぎない) な結果になる
+        static Frustum FromMatrix(const glm::mat4& viewProjection)
+        {
+            const glm::mat4 m = glm::transpose(viewProjection);
+
+            Frustum frustum;
+            frustum.planes[0] = m[3] + m[0]; // 左
+            frustum.planes[1] = m[3] - m[0]; // 右
+            frustum.planes[2] = m[3] + m[1]; // 下
+            frustum.planes[3] = m[3] - m[1]; // 上
+            frustum.planes[4] = m[3] + m[2]; // 近
+            frustum.planes[5] = m[3] - m[2]; // 遠
+
+            for (glm::vec4& plane : frustum.planes)
+            {
+                plane /= glm::length(glm::vec3(plane));
+            }
+
+            return frustum;
+        }
+    };
+}
@@ -0,0 +1,55 @@
+#include "PCH.h"
+#include "Rendering/CookedFile.h"
+
+
+namespace Silex
+{
+    bool CookedFile::Write(const std::string& cookedPath, const std::vector<byte>& data)
+    {
+        std::error_code ec;
+        std::filesystem::create_directories(std::filesystem::path(cookedPath).parent_path(), ec);
+
+        std::string tempPath = cookedPath + ".tmp";
+
+        FILE* f = std::fopen(tempPath.c_str(), "wb");
+        if (!f)
+        {
+            SL_LOG_ERROR("ファイルの書き込みに失敗しました: {}", tempPath);
+            return false;
+        }
+
+        bool written = std::fwrite(data.data(), 1, data.size(), f) == data.size();
+        std::fclose(f);
+
+        if (written)
+        {
+            std::filesystem::rename(tempPath, cookedPath, ec);
+        }
+
+        if (!written || ec)
+        {
+            SL_LOG_ERROR("クック済みファイルの保存に失敗しました: {}", cookedPath);
+            std::filesystem::remove(tempPath, ec);
+            return false;
+        }
+
+        return true;
+    }
+
+    void CookedFile::Prefetch(const MappedFile& mapped)
+    {
+        if (!mapped.data)
+            return;
+
+        // 1ページにつき 1バイト読み込む
+        constexpr uint64 pageSize = 4096;
+
+        uint32 sum = 0;
+        for (uint64 offset = 0; offset < mapped.size; offset += pageSize)
+        {
+            sum += reinterpret_cast<const volatile byte*>(mapped.data)[offset];
+        }
+
+        (void)sum;
+    }
+}
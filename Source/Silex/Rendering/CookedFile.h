@@ -0,0 +1,23 @@
+
+#pragma once
+
+#include "Core/CoreType.h"
+#include "Core/OS.h"
+
+
+namespace Silex
+{
+    //======================================================================================
+    // クック済みファイルの共通処理 (MeshCooker / TextureCooker)
+    //======================================================================================
+    class CookedFile
+    {
+    public:
+
+        // 一時ファイルに書き込んでから置き換える (書き込み途中で終了しても、壊れたファイルが残らないように)
+        static bool Write(const std::string& cookedPath, const std::vector<byte>& data);
+
+        // マップしたページを事前に読み込む (アップロード時のページフォールトを読み込みスレッドで済ませる)
+        static void Prefetch(const MappedFile& mapped);
+    };
+}
@@ -0,0 +1,222 @@
+
+#include "PCH.h"
+#include "Rendering/FrustumCulling.h"
+
+#include <immintrin.h>
+#include <bit>
+
+
+namespace Silex
+{
+    //=========================================
+    // 判定式
+    //-----------------------------------------
+    // 中心 c / 半径 e の AABB は、平面 (n, d) に対して
+    //   dot(n, c) + d + dot(|n|, e) < 0
+    // のとき完全に外側にある。6平面のいずれかで外側なら、その視錐台からは不可視
+    //=========================================
+
+    void CullingBounds::Reserve(uint32 reserveCount)
+    {
+        centerX.reserve(reserveCount);
+        centerY.reserve(reserveCount);
+        centerZ.reserve(reserveCount);
+        extentX.reserve(reserveCount);
+        extentY.reserve(reserveCount);
+        extentZ.reserve(reserveCount);
+    }
+
+    void CullingBounds::Clear()
+    {
+        centerX.clear();
+        centerY.clear();
+        centerZ.clear();
+        extentX.clear();
+        extentY.clear();
+        extentZ.clear();
+        count = 0;
+    }
+
+    uint32 CullingBounds::Add(const AABB& worldBounds)
+    {
+        const glm::vec3 center = worldBounds.GetCenter();
+        const glm::vec3 extent = worldBounds.GetExtent();
+
+        centerX.push_back(center.x);
+        centerY.push_back(center.y);
+        centerZ.push_back(center.z);
+        extentX.push_back(extent.x);
+        extentY.push_back(extent.y);
+        extentZ.push_back(extent.z);
+
+        return count++;
+    }
+
+
+    // 1つの境界に対するスカラー判定 (SIMD 幅に満たない末尾用)
+    static bool IsVisible(uint32 index, const Frustum* frustums, uint32 numFrustum, const float* cx, const float* cy, const float* cz, const float* ex, const float* ey, const float* ez)
+    {
+        for (uint32 f = 0; f < numFrustum; f++)
+        {
+            bool inside = true;
+            for (const glm::vec4& plane : frustums[f].planes)
+            {
+                const float distance = plane.x * cx[index] + plane.y * cy[index] + plane.z * cz[index] + plane.w;
+                const float radius   = glm::abs(plane.x) * ex[index] + glm::abs(plane.y) * ey[index] + glm::abs(plane.z) * ez[index];
+
+                if (distance + radius < 0.0f)
+                {
+                    inside = false;
+                    break;
+                }
+            }
+
+            if (inside)
+                return true;
+        }
+
+        return false;
+    }
+
+    uint32 FrustumCulling::Cull(const CullingBounds& bounds, const Frustum* frustums, uint32 numFrustum, uint8* out_visible)
+    {
+        SL_CHECK(numFrustum == 0 || numFrustum > MaxFrustum, 0);
+
+        const uint32 count = bounds.count;
+        const float* cx = bounds.centerX.data();
+        const float* cy = bounds.centerY.data();
+        const float* cz = bounds.centerZ.data();
+        const float* ex = bounds.extentX.data();
+        const float* ey = bounds.extentY.data();
+        const float* ez = bounds.extentZ.data();
+
+        uint32 numVisible = 0;
+        uint32 i          = 0;
+
+#if defined(__AVX__)
+
+        // 平面の各成分をレジスタ幅にブロードキャストしておく (n.x, n.y, n.z, d, |n.x|, |n.y|, |n.z|)
+        __m256 planes[MaxFrustum][6][7];
+        for (uint32 f = 0; f < numFrustum; f++)
+        {
+            for (uint32 p = 0; p < 6; p++)
+            {
+                const glm::vec4& plane = frustums[f].planes[p];
+                planes[f][p][0] = _mm256_set1_ps(plane.x);
+                planes[f][p][1] = _mm256_set1_ps(plane.y);
+                planes[f][p][2] = _mm256_set1_ps(plane.z);
+                planes[f][p][3] = _mm256_set1_ps(plane.w);
+                planes[f][p][4] = _mm256_set1_ps(glm::abs(plane.x));
+                planes[f][p][5] = _mm256_set1_ps(glm::abs(plane.y));
+                planes[f][p][6] = _mm256_set1_ps(glm::abs(plane.z));
+            }
+        }
+
+        const __m256 zero = _mm256_setzero_ps();
+
+        // 8個同時に判定
+        for (; i + 8 <= count; i += 8)
+        {
+            const __m256 x  = _mm256_loadu_ps(cx + i);
+            const __m256 y  = _mm256_loadu_ps(cy + i);
+            const __m256 z  = _mm256_loadu_ps(cz + i);
+            const __m256 rx = _mm256_loadu_ps(ex + i);
+            const __m256 ry = _mm256_loadu_ps(ey + i);
+            const __m256 rz = _mm256_loadu_ps(ez + i);
+
+            __m256 visible = zero;
+            for (uint32 f = 0; f < numFrustum; f++)
+            {
+                __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+                for (uint32 p = 0; p < 6; p++)
+                {
+                    const __m256* plane = planes[f][p];
+
+                    __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(plane[0], x), _mm256_mul_ps(plane[1], y)), _mm256_add_ps(_mm256_mul_ps(plane[2], z), plane[3]));
+                    __m256 radius   = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(plane[4], rx), _mm256_mul_ps(plane[5], ry)), _mm256_mul_ps(plane[6], rz));
+
+                    inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(distance, radius), zero, _CMP_GE_OQ));
+                }
+
+                visible = _mm256_or_ps(visible, inside);
+            }
+
+            const uint32 mask = _mm256_movemask_ps(visible);
+            for (uint32 k = 0; k < 8; k++)
+            {
+                out_visible[i + k] = (mask >> k) & 1;
+            }
+
+            numVisible += std::popcount(mask);
+        }
+
+#else
+
+        // x64 では SSE2 は常に使用できる
+        __m128 planes[MaxFrustum][6][7];
+        for (uint32 f = 0; f < numFrustum; f++)
+        {
+            for (uint32 p = 0; p < 6; p++)
+            {
+                const glm::vec4& plane = frustums[f].planes[p];
+                planes[f][p][0] = _mm_set1_ps(plane.x);
+                planes[f][p][1] = _mm_set1_ps(plane.y);
+                planes[f][p][2] = _mm_set1_ps(plane.z);
+                planes[f][p][3] = _mm_set1_ps(plane.w);
+                planes[f][p][4] = _mm_set1_ps(glm::abs(plane.x));
+                planes[f][p][5] = _mm_set1_ps(glm::abs(plane.y));
+                planes[f][p][6] = _mm_set1_ps(glm::abs(plane.z));
+            }
+        }
+
+        const __m128 zero = _mm_setzero_ps();
+
+        // 4個同時に判定
+        for (; i + 4 <= count; i += 4)
+        {
+            const __m128 x  = _mm_loadu_ps(cx + i);
+            const __m128 y  = _mm_loadu_ps(cy + i);
+            const __m128 z  = _mm_loadu_ps(cz + i);
+            const __m128 rx = _mm_loadu_ps(ex + i);
+            const __m128 ry = _mm_loadu_ps(ey + i);
+            const __m128 rz = _mm_loadu_ps(ez + i);
+
+            __m128 visible = zero;
+            for (uint32 f = 0; f < numFrustum; f++)
+            {
+                __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+                for (uint32 p = 0; p < 6; p++)
+                {
+                    const __m128* plane = planes[f][p];
+
+                    __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(plane[0], x), _mm_mul_ps(plane[1], y)), _mm_add_ps(_mm_mul_ps(plane[2], z), plane[3]));
+                    __m128 radius   = _mm_add_ps(_mm_add_ps(_mm_mul_ps(plane[4], rx), _mm_mul_ps(plane[5], ry)), _mm_mul_ps(plane[6], rz));
+
+                    inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, radius), zero));
+                }
+
+                visible = _mm_or_ps(visible, inside);
+            }
+
+            const uint32 mask = _mm_movemask_ps(visible);
+            for (uint32 k = 0; k < 4; k++)
+            {
+                out_visible[i + k] = (mask >> k) & 1;
+            }
+
+            numVisible += std::popcount(mask);
+        }
+
+#endif
+
+        // 末尾
+        for (; i < count; i++)
+        {
+            const bool visible = IsVisible(i, frustums, numFrustum, cx, cy, cz, ex, ey, ez);
+            out_visible[i] = visible;
+            numVisible += visible;
+        }
+
+        return numVisible;
+    }
+}
@@ -0,0 +1,55 @@
+
+#pragma once
+
+#include "Rendering/Bounds.h"
+
+
+namespace Silex
+{
+    //=========================================
+    // カリング用 境界ボックス配列 (SoA)
+    //-----------------------------------------
+    // ワールド空間の 中心 / 半径 を成分毎の配列に格納し、SIMD で複数個を同時に判定する
+    // Clear しても容量は保持されるので、毎フレーム再構築しても再確保は発生しない
+    //=========================================
+    class CullingBounds
+    {
+        friend class FrustumCulling;
+
+    public:
+
+        void Reserve(uint32 count);
+        void Clear();
+
+        // 追加したインデックスを返す (Cull の out_visible と同じ並び)
+        uint32 Add(const AABB& worldBounds);
+
+        uint32 GetCount() const { return count; }
+
+    private:
+
+        std::vector<float> centerX;
+        std::vector<float> centerY;
+        std::vector<float> centerZ;
+        std::vector<float> extentX;
+        std::vector<float> extentY;
+        std::vector<float> extentZ;
+        uint32             count = 0;
+    };
+
+
+    //=========================================
+    // 視錐台カリング
+    //=========================================
+    class FrustumCulling
+    {
+    public:
+
+        // 一度に判定できる視錐台の最大数 (カメラ + シャドウカスケード)
+        static constexpr uint32 MaxFrustum = 8;
+
+        // いずれかの視錐台と交差する境界を可視とし、out_visible[i] に 1 (不可視は 0) を書き込む
+        // out_visible は bounds.GetCount() 個以上の領域が必要 / 戻り値は可視数
+        static uint32 Cull(const CullingBounds& bounds, const Frustum* frustums, uint32 numFrustum, uint8* out_visible);
+    };
+}
@@ -0,0 +1,88 @@
+
+#include "PCH.h"
+#include "Rendering/GeometryBuffer.h"
+#include "Rendering/Renderer.h"
+#include "Rendering/RenderingAPI.h"
+#include "Rendering/Mesh.h"
+
+
+namespace Silex
+{
+    GeometryBuffer::~GeometryBuffer()
+    {
+        Release();
+    }
+
+    bool GeometryBuffer::Build(const std::vector<MeshSource*>& sources)
+    {
+        Release();
+
+        RenderingAPI* api = Renderer::Get()->GetAPI();
+
+        // 各ソースの配置を決定
+        ranges.reserve(sources.size());
+        for (MeshSource* source : sources)
+        {
+            GeometryRange& range = ranges.emplace_back();
+            range.firstIndex   = indexCount;
+            range.indexCount   = source->GetIndexCount();
+            range.vertexOffset = vertexCount;
+            range.vertexCount  = source->GetVertexCount();
+
+            vertexCount += source->GetVertexCount();
+            indexCount  += source->GetIndexCount();
+        }
+
+        SL_CHECK(vertexCount == 0 || indexCount == 0, false);
+
+        const uint64 positionByteSize  = vertexCount * VertexPositionStride;
+        const uint64 attributeByteSize = vertexCount * VertexAttributeStride;
+        const uint64 indexByteSize     = indexCount  * sizeof(uint32);
+
+        positionBuffer  = api->CreateBuffer(positionByteSize,  BUFFER_USAGE_VERTEX_BIT | BUFFER_USAGE_TRANSFER_DST_BIT, MEMORY_ALLOCATION_TYPE_GPU);
+        attributeBuffer = api->CreateBuffer(attributeByteSize, BUFFER_USAGE_VERTEX_BIT | BUFFER_USAGE_TRANSFER_DST_BIT, MEMORY_ALLOCATION_TYPE_GPU);
+        indexBuffer     = api->CreateBuffer(indexByteSize,     BUFFER_USAGE_INDEX_BIT  | BUFFER_USAGE_TRANSFER_DST_BIT, MEMORY_ALLOCATION_TYPE_GPU);
+
+        // ソースのバッファは既に GPU 上にあるので、ステージングを経由せずにバッファ間でコピーする
+        Renderer::Get()->ImmidiateExcute([&](CommandBufferHandle* cmd)
+        {
+            for (uint32 i = 0; i < sources.size(); i++)
+            {
+                const GeometryRange& range = ranges[i];
+
+                BufferCopyRegion positionRegion = {};
+                positionRegion.dstOffset = (uint64)range.vertexOffset * VertexPositionStride;
+                positionRegion.size      = (uint64)range.vertexCount  * VertexPositionStride;
+
+                BufferCopyRegion attributeRegion = {};
+                attributeRegion.dstOffset = (uint64)range.vertexOffset * VertexAttributeStride;
+                attributeRegion.size      = (uint64)range.vertexCount  * VertexAttributeStride;
+
+                BufferCopyRegion indexRegion = {};
+                indexRegion.dstOffset = (uint64)range.firstIndex * sizeof(uint32);
+                indexRegion.size      = (uint64)range.indexCount * sizeof(uint32);
+
+                if (positionRegion.size)  api->Cmd_CopyBuffer(cmd, sources[i]->GetPositionBuffer()->GetHandle(),  positionBuffer,  1, &positionRegion);
+                if (attributeRegion.size) api->Cmd_CopyBuffer(cmd, sources[i]->GetAttributeBuffer()->GetHandle(), attributeBuffer, 1, &attributeRegion);
+                if (indexRegion.size)     api->Cmd_CopyBuffer(cmd, sources[i]->GetIndexBuffer()->GetHandle(),     indexBuffer,     1, &indexRegion);
+            }
+        });
+
+        return true;
+    }
+
+    void GeometryBuffer::Release()
+    {
+        if (positionBuffer)  Renderer::Get()->DestroyNativeHandle(positionBuffer);
+        if (attributeBuffer) Renderer::Get()->DestroyNativeHandle(attributeBuffer);
+        if (indexBuffer)     Renderer::Get()->DestroyNativeHandle(indexBuffer);
+
+        positionBuffer  = nullptr;
+        attributeBuffer = nullptr;
+        indexBuffer     = nullptr;
+        vertexCount     = 0;
+        indexCount      = 0;
+
+        ranges.clear();
+    }
+}
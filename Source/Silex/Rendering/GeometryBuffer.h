@@ -0,0 +1,58 @@
+
+#pragma once
+
+#include "Rendering/RenderingCore.h"
+
+
+namespace Silex
+{
+    class MeshSource;
+
+    // 統合バッファ内でのメッシュソースの範囲
+    struct GeometryRange
+    {
+        uint32 firstIndex   = 0;
+        uint32 indexCount   = 0;
+        int32  vertexOffset = 0;
+        uint32 vertexCount  = 0;
+    };
+
+
+    //=========================================
+    // 統合ジオメトリバッファ
+    //-----------------------------------------
+    // 複数のメッシュソースの頂点・インデックスを 1つの頂点バッファ (座標・属性ストリーム毎) / インデックスバッファに統合する
+    // バインドは 1回で済み、各ソースは GeometryRange (firstIndex / vertexOffset) で描画できるので
+    // 間接描画 (Cmd_DrawIndexedIndirect) の引数としてそのまま使用できる
+    //=========================================
+    class GeometryBuffer
+    {
+    public:
+
+        GeometryBuffer() = default;
+        ~GeometryBuffer();
+
+        // ソースのバッファから GPU 上でコピーして統合する (追加順に GeometryRange が並ぶ)
+        bool Build(const std::vector<MeshSource*>& sources);
+        void Release();
+
+        BufferHandle* GetPositionBuffer()  const { return positionBuffer;  }
+        BufferHandle* GetAttributeBuffer() const { return attributeBuffer; }
+        BufferHandle* GetIndexBuffer()     const { return indexBuffer;     }
+
+        const std::vector<GeometryRange>& GetRanges() const { return ranges;                }
+        uint32                            GetCount()  const { return (uint32)ranges.size(); }
+
+        uint64 GetVertexCount() const { return vertexCount; }
+        uint64 GetIndexCount()  const { return indexCount;  }
+
+    private:
+
+        BufferHandle*              positionBuffer  = nullptr;
+        BufferHandle*              attributeBuffer = nullptr;
+        BufferHandle*              indexBuffer     = nullptr;
+        std::vector<GeometryRange> ranges          = {};
+        uint64                     vertexCount     = 0;
+        uint64                     indexCount      = 0;
+    };
+}
@@ -26,9 +26,5 @@ namespace Silex
         float               metallic      = 1.0f;
         glm::vec2           textureTiling = glm::vec2(1.0f, 1.0f);
         ShadingModelType    shadingModel  = Lit;
-
-    public:
-
-        DescriptorSet* descriptorset = nullptr;
     };
 }
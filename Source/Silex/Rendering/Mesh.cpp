@@ -2,56 +2,68 @@
 #include "PCH.h"
 
 #include "Rendering/Mesh.h"
+#include "Rendering/MeshCooker.h"
 #include "Rendering/Renderer.h"
 #include "Asset/TextureReader.h"
 
 
 namespace Silex
 {
-    namespace Internal
-    {
-        // a,b,c,d 行(Row) 1,2,3,4 列(Column)
-        static inline glm::mat4 aiMatrixToGLMMatrix(const aiMatrix4x4& from)
-        {
-            glm::mat4 m;
-
-            m[0][0] = from.a1; m[1][0] = from.a2; m[2][0] = from.a3; m[3][0] = from.a4;
-            m[0][1] = from.b1; m[1][1] = from.b2; m[2][1] = from.b3; m[3][1] = from.b4;
-            m[0][2] = from.c1; m[1][2] = from.c2; m[2][2] = from.c3; m[3][2] = from.c4;
-            m[0][3] = from.d1; m[1][3] = from.d2; m[2][3] = from.d3; m[3][3] = from.d4;
-
-            return m;
-        }
-    }
-
-
     //===========================================
-    // 頂点データから生成
+    // クック済みデータから生成
     //===========================================
-    MeshSource::MeshSource(std::vector<Vertex>& vertices, std::vector<uint32>& indices, uint32 materialIndex)
-        : vertexCount(vertices.size())
-        , indexCount(indices.size())
-        , hasIndex(!indices.empty())
-        , materialIndex(materialIndex)
-    {
-        vertexBuffer = Renderer::Get()->CreateVertexBuffer(vertices.data(), sizeof(Vertex) * vertexCount);
-        indexBuffer  = Renderer::Get()->CreateIndexBuffer(indices.data(), sizeof(uint32) * indexCount);
-    }
-
-    MeshSource::MeshSource(uint64 numVertex, Vertex* vertices, uint64 numIndex, uint32* indices, uint32 materialIndex)
+    MeshSource::MeshSource(uint64 numVertex, const byte* positions, const VertexAttribute* attributes, uint64 numIndex, const uint32* indices, uint32 materialIndex, const AABB& bounds, const BoundingSphere& sphere)
         : vertexCount(numVertex)
         , indexCount(numIndex)
-        , hasIndex(indices != nullptr || numIndex == 0)
+        , hasIndex(numIndex != 0)
         , materialIndex(materialIndex)
+        , bounds(bounds)
+        , sphere(sphere)
     {
-        vertexBuffer = Renderer::Get()->CreateVertexBuffer(vertices, sizeof(Vertex) * vertexCount);
-        indexBuffer  = Renderer::Get()->CreateIndexBuffer(indices, sizeof(uint32) * indexCount);
+        // ステージングへのコピーは生成時に完了するので、呼び出し後にマップを解除してよい
+        positionBuffer  = Renderer::Get()->CreateVertexBuffer(const_cast<byte*>(positions), (uint64)VertexPositionStride * vertexCount);
+        attributeBuffer = Renderer::Get()->CreateVertexBuffer(const_cast<VertexAttribute*>(attributes), (uint64)VertexAttributeStride * vertexCount);
+        indexBuffer     = Renderer::Get()->CreateIndexBuffer(const_cast<uint32*>(indices), sizeof(uint32) * indexCount);
     }
 
     MeshSource::~MeshSource()
     {
-        if (vertexBuffer) Renderer::Get()->DestroyBuffer(vertexBuffer);
-        if (indexBuffer) Renderer::Get()->DestroyBuffer(indexBuffer);
+        if (positionBuffer)  Renderer::Get()->DestroyBuffer(positionBuffer);
+        if (attributeBuffer) Renderer::Get()->DestroyBuffer(attributeBuffer);
+        if (indexBuffer)     Renderer::Get()->DestroyBuffer(indexBuffer);
+    }
+
+    void MeshSource::CalculateBounds(const Vertex* vertices, uint64 numVertex, AABB& out_bounds, BoundingSphere& out_sphere)
+    {
+        out_bounds = {};
+        for (uint64 i = 0; i < numVertex; i++)
+        {
+            out_bounds.Expand(vertices[i].Position);
+        }
+
+        if (!out_bounds.IsValid())
+        {
+            out_bounds.min = out_bounds.max = glm::vec3(0.0f);
+        }
+
+        // 中心は AABB の中心とし、半径は最遠の頂点までの距離 (AABB の角までの距離よりも小さくなる)
+        float radiusSq    = 0.0f;
+        out_sphere.center = out_bounds.GetCenter();
+        for (uint64 i = 0; i < numVertex; i++)
+        {
+            glm::vec3 d = vertices[i].Position - out_sphere.center;
+            radiusSq = std::max(radiusSq, glm::dot(d, d));
+        }
+
+        out_sphere.radius = std::sqrt(radiusSq);
+    }
+
+    bool MeshSource::IsReady() const
+    {
+        Renderer* renderer = Renderer::Get();
+        return renderer->IsUploadComplete(positionBuffer->GetUploadToken())
+            && renderer->IsUploadComplete(attributeBuffer->GetUploadToken())
+            && renderer->IsUploadComplete(indexBuffer->GetUploadToken());
     }
 
     void MeshSource::Bind() const
@@ -76,29 +88,14 @@ namespace Silex
 
     void Mesh::Load(const std::filesystem::path& filePath)
     {
-        std::string assetPath = filePath.string();
-
-        uint32 flags = 0;
-        flags |= aiProcess_OptimizeMeshes;
-        flags |= aiProcess_Triangulate;
-        flags |= aiProcess_GenSmoothNormals; // NOTE: すでに法線情報が存在する場合は無視される
-        flags |= aiProcess_FlipUVs;
-        flags |= aiProcess_GenUVCoords;
-        flags |= aiProcess_CalcTangentSpace;
-
-        // メッシュファイルを読み込み
-        Assimp::Importer importer;
-        const aiScene* scene = importer.ReadFile(assetPath, flags);
-        if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
+        // クック済みファイルをマップして、そのままアップロード (無い・古い場合は Assimp で読み込み、次回以降のために保存)
+        CookedMeshFile file;
+        if (MeshCooker::Map(filePath.string(), file) || MeshCooker::CookToMemory(filePath.string(), file))
         {
-            SL_LOG_ERROR("Assimp Error: {}", importer.GetErrorString());
+            Load(file.view);
         }
 
-        // 各メッシュ情報を読み込み
-        ProcessNode(scene->mRootNode, scene, assetPath);
-
-        // マテリアル数
-        numMaterialSlot = scene->mNumMaterials;
+        MeshCooker::Close(file);
     }
 
     // 明示的に呼び出したい場合に（デストラクタで呼び出されるため、不要）
@@ -113,139 +110,81 @@ namespace Silex
     void Mesh::AddSource(MeshSource* source)
     {
         subMeshes.push_back(source);
+        _CalculateBounds();
     }
 
-    void Mesh::ProcessNode(aiNode* node, const aiScene* scene, const std::string& path)
+    bool Mesh::IsReady() const
     {
-        for (uint32 i = 0; i < node->mNumMeshes; i++)
+        for (const MeshSource* source : subMeshes)
         {
-            uint32 subMeshIndex = node->mMeshes[i];
-            aiMesh* mesh = scene->mMeshes[subMeshIndex];
+            if (!source->IsReady())
+                return false;
+        }
 
-            MeshSource* ms = ProcessMesh(mesh, scene, path);
-            ms->relativeTransform = Internal::aiMatrixToGLMMatrix(node->mTransformation);
+        return true;
+    }
 
-            subMeshes.emplace_back(ms);
+    void Mesh::_CalculateBounds()
+    {
+        bounds = {};
+        for (MeshSource* source : subMeshes)
+        {
+            bounds.Merge(source->GetBounds());
         }
 
-        for (uint32 i = 0; i < node->mNumChildren; i++)
+        if (!bounds.IsValid())
         {
-            ProcessNode(node->mChildren[i], scene, path);
+            bounds.min = bounds.max = glm::vec3(0.0f);
+        }
+
+        // 各ソースの境界球を包含する球
+        sphere.center = bounds.GetCenter();
+        sphere.radius = 0.0f;
+        for (MeshSource* source : subMeshes)
+        {
+            const BoundingSphere& s = source->GetBoundingSphere();
+            sphere.radius = std::max(sphere.radius, glm::distance(sphere.center, s.center) + s.radius);
         }
     }
-    
-    MeshSource* Mesh::ProcessMesh(aiMesh* mesh, const aiScene* scene, const std::string& path)
+
+    void Mesh::Load(const CookedMeshView& view)
     {
-        std::vector<Vertex> vertices;
-        std::vector<uint32> indices;
+        const CookedMeshHeader* header = view.header;
 
-        //==============================================
-        // 頂点
-        //==============================================
-        for (uint32 i = 0; i < mesh->mNumVertices; i++)
+        subMeshes.reserve(subMeshes.size() + header->numSubMesh);
+        for (uint32 i = 0; i < header->numSubMesh; i++)
         {
-            Vertex vertex;
-            glm::vec3 vector;
-
-            // 座標
-            if (mesh->HasPositions())
-            {
-                vector.x = mesh->mVertices[i].x;
-                vector.y = mesh->mVertices[i].y;
-                vector.z = mesh->mVertices[i].z;
-                vertex.Position = vector;
-            }
-
-            // ノーマル
-            if (mesh->HasNormals())
-            {
-                vector.x = mesh->mNormals[i].x;
-                vector.y = mesh->mNormals[i].y;
-                vector.z = mesh->mNormals[i].z;
-                vertex.Normal = vector;
-            }
-
-            // 接線
-            if (mesh->HasTangentsAndBitangents())
-            {
-                vector.x = mesh->mTangents[i].x;
-                vector.y = mesh->mTangents[i].y;
-                vector.z = mesh->mTangents[i].z;
-                vertex.Tangent = vector;
-
-                vector.x = mesh->mBitangents[i].x;
-                vector.y = mesh->mBitangents[i].y;
-                vector.z = mesh->mBitangents[i].z;
-                vertex.Bitangent = vector;
-            }
-
-            // テクスチャ座標
-            if (mesh->mTextureCoords[0])
-            {
-                glm::vec2 vec;
-
-                vec.x = mesh->mTextureCoords[0][i].x;
-                vec.y = mesh->mTextureCoords[0][i].y;
-                vertex.TexCoords = vec;
-            }
-            else
-            {
-                vertex.TexCoords = glm::vec2(0.0f, 0.0f);
-            }
-
-            vertices.push_back(vertex);
+            const CookedSubMesh&   cooked     = view.subMeshes[i];
+            const byte*            positions  = view.positions  + cooked.firstVertex * VertexPositionStride;
+            const VertexAttribute* attributes = view.attributes + cooked.firstVertex;
+            const uint32*          indices    = view.indices    + cooked.firstIndex;
+
+            MeshSource* source = slnew(MeshSource, cooked.numVertex, positions, attributes, cooked.numIndex, indices, cooked.materialIndex, cooked.bounds, cooked.sphere);
+            source->relativeTransform = cooked.transform;
+
+            subMeshes.emplace_back(source);
         }
 
-        //==============================================
-        // インデックス
-        //==============================================
-        for (uint32 i = 0; i < mesh->mNumFaces; i++)
+        for (uint32 i = 0; i < header->numTexture; i++)
         {
-            aiFace face = mesh->mFaces[i];
-            for (uint32 j = 0; j < face.mNumIndices; j++)
-            {
-                indices.push_back(face.mIndices[j]);
-            }
-        }
+            const CookedTexture& cooked = view.textures[i];
 
-        //==============================================
-        // テクスチャ
-        //==============================================
-        aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
+            MeshTexture& tex = textures[cooked.materialIndex];
+            tex.Path   = std::string(view.strings + cooked.pathOffset, cooked.pathLength);
+            tex.Albedo = cooked.albedo;
+        }
 
-        LoadMaterialTextures(mesh->mMaterialIndex, material, aiTextureType_DIFFUSE, path);           // ディフューズ
-      //LoadMaterialTextures(mesh->mMaterialIndex, material, aiTextureType_NORMALS, path);           // ノーマル
+        // マテリアル数
+        numMaterialSlot = header->numMaterialSlot;
 
-      //LoadMaterialTextures(mesh->mMaterialIndex, material, aiTextureType_DIFFUSE_ROUGHNESS, path); // 
-      //LoadMaterialTextures(mesh->mMaterialIndex, material, aiTextureType_AMBIENT_OCCLUSION, path); // AO
-      //LoadMaterialTextures(mesh->mMaterialIndex, material, aiTextureType_SPECULAR, path);          // スペキュラ
-      //LoadMaterialTextures(mesh->mMaterialIndex, material, aiTextureType_EMISSIVE, path);          // 
-      //LoadMaterialTextures(mesh->mMaterialIndex, material, aiTextureType_EMISSION_COLOR, path);    // 
+        // 座標の量子化範囲 (ファイル内の全サブメッシュで共通)
+        VertexQuantization quantization;
+        quantization.center = header->positionCenter;
+        quantization.extent = header->positionExtent;
+        dequantizeMatrix = VertexFormat::CalcDequantizeMatrix(quantization);
 
-        //==============================================
-        // メッシュソース生成
-        //==============================================
-        return slnew(MeshSource, vertices, indices, mesh->mMaterialIndex);
-    }
-    
-    void Mesh::LoadMaterialTextures(uint32 materialInddex, aiMaterial* material, aiTextureType type, const std::string& path)
-    {
-        for (uint32 i = 0; i < material->GetTextureCount(type); i++)
-        {
-            aiString str;
-            material->GetTexture(type, i, &str);
-            std::string aspath = str.C_Str();
-            std::replace(aspath.begin(), aspath.end(), '\\', '/');
-
-            // テクスチャファイルのディレクトリに変換
-            std::filesystem::path modelFilePath = path;
-            std::string parentPath = modelFilePath.parent_path().string();
-            std::string path       = parentPath + '/' + aspath;
-
-            MeshTexture& tex = textures[materialInddex];
-            tex.Path   = path;
-            tex.Albedo = 0;
-        }
+        // 境界
+        _CalculateBounds();
     }
 
 
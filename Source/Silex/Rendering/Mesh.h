@@ -3,22 +3,13 @@
 #include "Asset/Asset.h"
 #include "Rendering/RenderingCore.h"
 #include "Rendering/Material.h"
-
-#include <assimp/Importer.hpp>
-#include <assimp/postprocess.h>
-#include <assimp/scene.h>
+#include "Rendering/Bounds.h"
+#include "Rendering/VertexFormat.h"
 
 
 namespace Silex
 {
-    struct Vertex
-    {
-        glm::vec3 Position;
-        glm::vec3 Normal;
-        glm::vec2 TexCoords;
-        glm::vec3 Tangent;
-        glm::vec3 Bitangent;
-    };
+    struct CookedMeshView;
 
     struct MeshTexture
     {
@@ -30,6 +21,7 @@ namespace Silex
     // メッシュの頂点情報クラス
     //--------------------------------------------
     // 頂点データ・インデックスデータの管理
+    // 頂点は 座標ストリームと属性ストリームの 2つのバッファに分けて保持する (VertexFormat.h)
     //============================================
     class MeshSource : public Class
     {
@@ -37,8 +29,8 @@ namespace Silex
 
     public:
 
-        MeshSource(uint64 numVertex, Vertex* vertices, uint64 numIndex, uint32* indices, uint32 materialIndex = 0);
-        MeshSource(std::vector<Vertex>& vertices, std::vector<uint32>& indices, uint32 materialIndex = 0);
+        // エンコード済み・境界計算済みのデータから生成 (クック済みメッシュ用: 頂点を走査しない)
+        MeshSource(uint64 numVertex, const byte* positions, const VertexAttribute* attributes, uint64 numIndex, const uint32* indices, uint32 materialIndex, const AABB& bounds, const BoundingSphere& sphere);
         ~MeshSource();
 
         void Bind()   const;
@@ -48,24 +40,37 @@ namespace Silex
         uint32    GetMaterialIndex() const { return materialIndex;     }
         glm::mat4 GetTransform()     const { return relativeTransform; }
 
-        uint64        GetVertexCount()   const { return vertexCount;       }
-        uint64        GetIndexCount()    const { return indexCount;        }
-        VertexBuffer* GetVertexBuffer()  const { return vertexBuffer;      }
-        IndexBuffer*  GetIndexBuffer()   const { return indexBuffer;       }
+        uint64        GetVertexCount()     const { return vertexCount;     }
+        uint64        GetIndexCount()      const { return indexCount;      }
+        VertexBuffer* GetPositionBuffer()  const { return positionBuffer;  }
+        VertexBuffer* GetAttributeBuffer() const { return attributeBuffer; }
+        IndexBuffer*  GetIndexBuffer()     const { return indexBuffer;     }
+
+        // 頂点・インデックスバッファの非同期アップロードが完了しているか
+        bool IsReady() const;
+
+        // ローカル空間の境界 (頂点座標から生成時に計算)
+        const AABB&           GetBounds()         const { return bounds; }
+        const BoundingSphere& GetBoundingSphere() const { return sphere; }
 
         void SetTransform(const glm::mat4& matrix) { relativeTransform = matrix; }
 
+        // 頂点座標から境界を計算する
+        static void CalculateBounds(const Vertex* vertices, uint64 numVertex, AABB& out_bounds, BoundingSphere& out_sphere);
+
     private:
 
         bool          hasIndex          = false;
         uint32        materialIndex     = 0;
         uint32        vertexCount       = 0;
         uint32        indexCount        = 0;
-        VertexBuffer* vertexBuffer      = nullptr;
+        VertexBuffer* positionBuffer    = nullptr;
+        VertexBuffer* attributeBuffer   = nullptr;
         IndexBuffer*  indexBuffer       = nullptr;
         glm::mat4     relativeTransform = {};
 
-    private:
+        AABB           bounds = {};
+        BoundingSphere sphere = {};
 
         friend class Mesh;
     };
@@ -91,6 +96,9 @@ namespace Silex
         ~Mesh();
 
         void Load(const std::filesystem::path& filePath);
+
+        // クック済みデータからメッシュソースを生成 (段階的な読み込み用: ファイルの読み込みは MeshCooker で行う)
+        void Load(const CookedMeshView& view);
         void Unload();
         void AddSource(MeshSource* source);
 
@@ -108,17 +116,28 @@ namespace Silex
 
         uint32 GetMaterialSlotCount() const { return numMaterialSlot; };
 
+        // 全メッシュソースのアップロードが完了しているか
+        bool IsReady() const;
+
+        // 全メッシュソースを包含する境界
+        const AABB&           GetBounds()         const { return bounds; }
+        const BoundingSphere& GetBoundingSphere() const { return sphere; }
+
+        // 量子化した頂点座標をメッシュ空間に戻す行列 (量子化しない場合は単位行列)
+        const glm::mat4& GetDequantizeMatrix() const { return dequantizeMatrix; }
+
     private:
 
-        void        ProcessNode(aiNode* node, const aiScene* scene, const std::string& path);
-        MeshSource* ProcessMesh(aiMesh* mesh, const aiScene* scene, const std::string& path);
-        void        LoadMaterialTextures(uint32 materialInddex, aiMaterial* mat, aiTextureType type, const std::string& path);
+        void _CalculateBounds();
 
     private:
 
         std::unordered_map<uint32, MeshTexture> textures;
         std::vector<MeshSource*>                subMeshes;
         uint32                                  numMaterialSlot;
+        AABB                                    bounds;
+        BoundingSphere                          sphere;
+        glm::mat4                               dequantizeMatrix = glm::mat4(1.0f);
 
         //rhi::PrimitiveType primitiveType = rhi::PrimitiveType::Triangle;
 
@@ -0,0 +1,382 @@
+
+#include "PCH.h"
+#include "Rendering/MeshCooker.h"
+#include "Rendering/CookedFile.h"
+#include "Rendering/Mesh.h"
+#include "Core/Hash.h"
+
+#include <assimp/Importer.hpp>
+#include <assimp/postprocess.h>
+#include <assimp/scene.h>
+
+
+namespace Silex
+{
+    static const char* CookedMeshDirectory = "Assets/Models/Cache/";
+
+    // インポート設定 (キーに含めるので、変更すると次回の読み込みで再クックされる)
+    static constexpr uint32 MeshImportFlags =
+        aiProcess_OptimizeMeshes     |
+        aiProcess_Triangulate        |
+        aiProcess_GenSmoothNormals   | // NOTE: すでに法線情報が存在する場合は無視される
+        aiProcess_FlipUVs            |
+        aiProcess_GenUVCoords        |
+        aiProcess_CalcTangentSpace;
+
+    static uint64 AlignCookedOffset(uint64 offset)
+    {
+        return (offset + CookedMeshAlignment - 1) & ~(CookedMeshAlignment - 1);
+    }
+
+    // a,b,c,d 行(Row) 1,2,3,4 列(Column)
+    static glm::mat4 aiMatrixToGLMMatrix(const aiMatrix4x4& from)
+    {
+        glm::mat4 m;
+
+        m[0][0] = from.a1; m[1][0] = from.a2; m[2][0] = from.a3; m[3][0] = from.a4;
+        m[0][1] = from.b1; m[1][1] = from.b2; m[2][1] = from.b3; m[3][1] = from.b4;
+        m[0][2] = from.c1; m[1][2] = from.c2; m[2][2] = from.c3; m[3][2] = from.c4;
+        m[0][3] = from.d1; m[1][3] = from.d2; m[2][3] = from.d3; m[3][3] = from.d4;
+
+        return m;
+    }
+
+
+    //======================================================================================
+    // Assimp シーンからの収集
+    //======================================================================================
+    struct MeshCookContext
+    {
+        const aiScene*                          scene      = nullptr;
+        std::filesystem::path                   sourcePath = {};
+        std::vector<CookedSubMesh>              subMeshes  = {};
+        std::vector<Vertex>                     vertices   = {};
+        std::vector<uint32>                     indices    = {};
+        std::map<uint32, std::string>           textures   = {}; // マテリアルインデックス順に出力する
+    };
+
+    static void CookMaterialTextures(MeshCookContext& context, uint32 materialIndex, aiTextureType type)
+    {
+        aiMaterial* material = context.scene->mMaterials[materialIndex];
+
+        for (uint32 i = 0; i < material->GetTextureCount(type); i++)
+        {
+            aiString str;
+            material->GetTexture(type, i, &str);
+            std::string aspath = str.C_Str();
+            std::replace(aspath.begin(), aspath.end(), '\\', '/');
+
+            // テクスチャファイルのディレクトリに変換
+            context.textures[materialIndex] = context.sourcePath.parent_path().string() + '/' + aspath;
+        }
+    }
+
+    static void CookMesh(MeshCookContext& context, const aiMesh* mesh, const glm::mat4& transform)
+    {
+        const uint64 firstVertex = context.vertices.size();
+        const uint64 firstIndex  = context.indices.size();
+
+        //==============================================
+        // 頂点 (インポート形式で収集し、セクション配置の決定後に GPU 頂点フォーマットへエンコードする)
+        //==============================================
+        context.vertices.resize(firstVertex + mesh->mNumVertices);
+        Vertex* vertices = context.vertices.data() + firstVertex;
+
+        for (uint32 i = 0; i < mesh->mNumVertices; i++)
+        {
+            Vertex& vertex = vertices[i];
+
+            // 座標
+            if (mesh->HasPositions())
+            {
+                vertex.Position = { mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z };
+            }
+
+            // ノーマル
+            if (mesh->HasNormals())
+            {
+                vertex.Normal = { mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z };
+            }
+
+            // 接線
+            if (mesh->HasTangentsAndBitangents())
+            {
+                vertex.Tangent   = { mesh->mTangents[i].x,   mesh->mTangents[i].y,   mesh->mTangents[i].z   };
+                vertex.Bitangent = { mesh->mBitangents[i].x, mesh->mBitangents[i].y, mesh->mBitangents[i].z };
+            }
+
+            // テクスチャ座標
+            if (mesh->mTextureCoords[0])
+            {
+                vertex.TexCoords = { mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y };
+            }
+        }
+
+        //==============================================
+        // インデックス
+        //==============================================
+        uint64 numIndex = 0;
+        for (uint32 i = 0; i < mesh->mNumFaces; i++)
+        {
+            numIndex += mesh->mFaces[i].mNumIndices;
+        }
+
+        context.indices.resize(firstIndex + numIndex);
+        uint32* indices = context.indices.data() + firstIndex;
+
+        for (uint32 i = 0; i < mesh->mNumFaces; i++)
+        {
+            const aiFace& face = mesh->mFaces[i];
+            for (uint32 j = 0; j < face.mNumIndices; j++)
+            {
+                *indices++ = face.mIndices[j];
+            }
+        }
+
+        //==============================================
+        // サブメッシュ
+        //==============================================
+        CookedSubMesh& subMesh = context.subMeshes.emplace_back();
+        subMesh               = {};
+        subMesh.transform     = transform;
+        subMesh.firstVertex   = firstVertex;
+        subMesh.firstIndex    = firstIndex;
+        subMesh.numVertex     = mesh->mNumVertices;
+        subMesh.numIndex      = (uint32)numIndex;
+        subMesh.materialIndex = mesh->mMaterialIndex;
+
+        MeshSource::CalculateBounds(vertices, mesh->mNumVertices, subMesh.bounds, subMesh.sphere);
+
+        //==============================================
+        // テクスチャ
+        //==============================================
+        CookMaterialTextures(context, mesh->mMaterialIndex, aiTextureType_DIFFUSE); // ディフューズ
+    }
+
+    static void CookNode(MeshCookContext& context, const aiNode* node)
+    {
+        for (uint32 i = 0; i < node->mNumMeshes; i++)
+        {
+            const aiMesh* mesh = context.scene->mMeshes[node->mMeshes[i]];
+            CookMesh(context, mesh, aiMatrixToGLMMatrix(node->mTransformation));
+        }
+
+        for (uint32 i = 0; i < node->mNumChildren; i++)
+        {
+            CookNode(context, node->mChildren[i]);
+        }
+    }
+
+
+    //======================================================================================
+    // MeshCooker
+    //======================================================================================
+    bool MeshCooker::Cook(const std::string& sourcePath, uint64 sourceKey, std::vector<byte>& out_data)
+    {
+        // メッシュファイルを読み込み
+        Assimp::Importer importer;
+        const aiScene* scene = importer.ReadFile(sourcePath, MeshImportFlags);
+        if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
+        {
+            SL_LOG_ERROR("Assimp Error: {}", importer.GetErrorString());
+            return false;
+        }
+
+        MeshCookContext context;
+        context.scene      = scene;
+        context.sourcePath = sourcePath;
+
+        // ブロブの伸長による再確保を避ける (ノードから複数回参照されるメッシュがあれば、その分は伸長する)
+        uint64 numVertex = 0;
+        uint64 numIndex  = 0;
+        for (uint32 i = 0; i < scene->mNumMeshes; i++)
+        {
+            numVertex += scene->mMeshes[i]->mNumVertices;
+            numIndex  += scene->mMeshes[i]->mNumFaces * 3;
+        }
+
+        context.vertices.reserve(numVertex);
+        context.indices.reserve(numIndex);
+
+        CookNode(context, scene->mRootNode);
+
+        // テクスチャテーブルと文字列
+        std::vector<CookedTexture> textures;
+        std::string                strings;
+        for (const auto& [materialIndex, path] : context.textures)
+        {
+            CookedTexture& texture = textures.emplace_back();
+            texture.materialIndex = materialIndex;
+            texture.albedo        = 0;
+            texture.pathOffset    = (uint32)strings.size();
+            texture.pathLength    = (uint32)path.size();
+
+            strings += path;
+        }
+
+        // 座標の量子化範囲はファイル全体で共通 (サブメッシュは 1つの変換行列で逆量子化できる)
+        const VertexQuantization quantization = VertexFormat::CalcQuantization(context.vertices.data(), context.vertices.size());
+
+        // セクション配置
+        CookedMeshHeader header = {};
+        header.magic           = CookedMeshMagic;
+        header.version         = CookedMeshVersion;
+        header.sourceKey       = sourceKey;
+        header.numSubMesh      = (uint32)context.subMeshes.size();
+        header.numTexture      = (uint32)textures.size();
+        header.numMaterialSlot = scene->mNumMaterials;
+        header.positionStride  = VertexPositionStride;
+        header.numVertex       = context.vertices.size();
+        header.numIndex        = context.indices.size();
+        header.positionCenter  = quantization.center;
+        header.positionExtent  = quantization.extent;
+        header.stringSize      = strings.size();
+
+        uint64 offset = AlignCookedOffset(sizeof(CookedMeshHeader));
+        header.subMeshOffset = offset; offset = AlignCookedOffset(offset + sizeof(CookedSubMesh) * header.numSubMesh);
+        header.textureOffset = offset; offset = AlignCookedOffset(offset + sizeof(CookedTexture) * header.numTexture);
+        header.stringOffset  = offset; offset = AlignCookedOffset(offset + header.stringSize);
+        header.positionOffset  = offset; offset = AlignCookedOffset(offset + VertexPositionStride  * header.numVertex);
+        header.attributeOffset = offset; offset = AlignCookedOffset(offset + VertexAttributeStride * header.numVertex);
+        header.indexOffset     = offset; offset = AlignCookedOffset(offset + sizeof(uint32) * header.numIndex);
+        header.fileSize        = offset;
+
+        // パディングは 0 で埋める (同じ入力から同じファイルを生成する)
+        out_data.assign(header.fileSize, 0);
+
+        byte* data = out_data.data();
+        std::memcpy(data,                        &header,                   sizeof(CookedMeshHeader));
+        std::memcpy(data + header.subMeshOffset, context.subMeshes.data(),  sizeof(CookedSubMesh) * header.numSubMesh);
+        std::memcpy(data + header.textureOffset, textures.data(),           sizeof(CookedTexture) * header.numTexture);
+        std::memcpy(data + header.stringOffset,  strings.data(),            header.stringSize);
+        std::memcpy(data + header.indexOffset,   context.indices.data(),    sizeof(uint32) * header.numIndex);
+
+        // 頂点は GPU 頂点フォーマットに変換して ブロブ上に直接書き込む
+        VertexFormat::EncodePositions(context.vertices.data(), header.numVertex, quantization, data + header.positionOffset);
+        VertexFormat::EncodeAttributes(context.vertices.data(), header.numVertex, reinterpret_cast<VertexAttribute*>(data + header.attributeOffset));
+
+        return true;
+    }
+
+    bool MeshCooker::Parse(const byte* data, uint64 dataSize, uint64 sourceKey, CookedMeshView& out_view)
+    {
+        if (dataSize < sizeof(CookedMeshHeader))
+            return false;
+
+        const CookedMeshHeader* header = reinterpret_cast<const CookedMeshHeader*>(data);
+
+        bool valid = header->magic == CookedMeshMagic;
+        valid = valid && header->version   == CookedMeshVersion;
+        valid = valid && header->sourceKey == sourceKey;
+        valid = valid && header->fileSize  == dataSize;
+        valid = valid && header->positionStride == VertexPositionStride;
+
+        if (!valid)
+            return false;
+
+        // 各セクションがファイル内に収まっているか (ブロブの内容はハッシュで検証しない / 全ページの読み込みが発生するため)
+        auto InRange = [dataSize](uint64 offset, uint64 count, uint64 stride)
+        {
+            return offset % CookedMeshAlignment == 0 && offset <= dataSize && count <= (dataSize - offset) / stride;
+        };
+
+        valid = valid && InRange(header->subMeshOffset, header->numSubMesh, sizeof(CookedSubMesh));
+        valid = valid && InRange(header->textureOffset, header->numTexture, sizeof(CookedTexture));
+        valid = valid && InRange(header->stringOffset,  header->stringSize, 1);
+        valid = valid && InRange(header->positionOffset,  header->numVertex, VertexPositionStride);
+        valid = valid && InRange(header->attributeOffset, header->numVertex, VertexAttributeStride);
+        valid = valid && InRange(header->indexOffset,     header->numIndex,  sizeof(uint32));
+
+        if (!valid)
+            return false;
+
+        out_view.header    = header;
+        out_view.subMeshes = reinterpret_cast<const CookedSubMesh*>(data + header->subMeshOffset);
+        out_view.textures  = reinterpret_cast<const CookedTexture*>(data + header->textureOffset);
+        out_view.strings    = reinterpret_cast<const char*>(data + header->stringOffset);
+        out_view.positions  = data + header->positionOffset;
+        out_view.attributes = reinterpret_cast<const VertexAttribute*>(data + header->attributeOffset);
+        out_view.indices    = reinterpret_cast<const uint32*>(data + header->indexOffset);
+
+        // テーブルが参照する範囲 (テーブルは小さいので全て検証する)
+        for (uint32 i = 0; i < header->numSubMesh && valid; i++)
+        {
+            const CookedSubMesh& subMesh = out_view.subMeshes[i];
+            valid = valid && subMesh.firstVertex <= header->numVertex && subMesh.numVertex <= header->numVertex - subMesh.firstVertex;
+            valid = valid && subMesh.firstIndex  <= header->numIndex  && subMesh.numIndex  <= header->numIndex  - subMesh.firstIndex;
+        }
+
+        for (uint32 i = 0; i < header->numTexture && valid; i++)
+        {
+            const CookedTexture& texture = out_view.textures[i];
+            valid = valid && (uint64)texture.pathOffset + texture.pathLength <= header->stringSize;
+        }
+
+        return valid;
+    }
+
+    bool MeshCooker::Map(const std::string& sourcePath, CookedMeshFile& out_file)
+    {
+        out_file.sourcePath = sourcePath;
+        out_file.cookedPath = GetCookedPath(sourcePath);
+        out_file.sourceKey  = GetSourceKey(sourcePath);
+
+        if (!OS::Get()->MapFile(out_file.cookedPath, out_file.mapped))
+            return false;
+
+        if (!Parse(out_file.mapped.data, out_file.mapped.size, out_file.sourceKey, out_file.view))
+        {
+            SL_LOG_INFO("クック済みメッシュが古いため、再クックします: {}", out_file.cookedPath);
+            OS::Get()->UnmapFile(out_file.mapped);
+
+            return false;
+        }
+
+        return true;
+    }
+
+    bool MeshCooker::CookToMemory(const std::string& sourcePath, CookedMeshFile& out_file)
+    {
+        out_file.sourcePath = sourcePath;
+        out_file.cookedPath = GetCookedPath(sourcePath);
+        out_file.sourceKey  = GetSourceKey(sourcePath);
+
+        if (!Cook(sourcePath, out_file.sourceKey, out_file.memory))
+            return false;
+
+        // 保存に失敗しても、今回の読み込みはメモリ上のデータで続行する
+        CookedFile::Write(out_file.cookedPath, out_file.memory);
+
+        return Parse(out_file.memory.data(), out_file.memory.size(), out_file.sourceKey, out_file.view);
+    }
+
+    void MeshCooker::Close(CookedMeshFile& file)
+    {
+        OS::Get()->UnmapFile(file.mapped);
+
+        file.memory = {};
+        file.view   = {};
+    }
+
+    std::string MeshCooker::GetCookedPath(const std::string& sourcePath)
+    {
+        // 同名ファイルの衝突を避けるため、ソースのパスのハッシュを付ける
+        return std::format("{}{}.{:016x}.slmesh", CookedMeshDirectory, std::filesystem::path(sourcePath).stem().string(), Hash::FNV(sourcePath.c_str()));
+    }
+
+    uint64 MeshCooker::GetSourceKey(const std::string& sourcePath)
+    {
+        std::error_code ec;
+        const uint64 fileSize   = std::filesystem::file_size(sourcePath, ec);
+        const int64  writeTime  = std::filesystem::last_write_time(sourcePath, ec).time_since_epoch().count();
+        const uint32 vertexSize = VertexPositionStride + VertexAttributeStride;
+
+        uint64 key = Hash::FNV(&CookedMeshVersion, sizeof(CookedMeshVersion));
+        key = Hash::FNV(&MeshImportFlags, sizeof(MeshImportFlags), key);
+        key = Hash::FNV(&vertexSize,      sizeof(vertexSize),      key);
+        key = Hash::FNV(&fileSize,        sizeof(fileSize),        key);
+        key = Hash::FNV(&writeTime,       sizeof(writeTime),       key);
+
+        return key;
+    }
+}
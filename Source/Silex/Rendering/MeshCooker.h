@@ -0,0 +1,123 @@
+
+#pragma once
+
+#include "Core/CoreType.h"
+#include "Core/OS.h"
+#include "Rendering/Bounds.h"
+
+
+namespace Silex
+{
+    struct VertexAttribute;
+
+
+    //======================================================================================
+    // クック済みメッシュ
+    //--------------------------------------------------------------------------------------
+    // Assimp の読み込み・後処理 (接線計算・法線生成・メッシュ最適化) の結果を固定レイアウトのバイナリとして保存し、
+    // 次回以降はファイルをマップして 頂点・インデックスブロブをそのままアップロードする (頂点単位の処理は行わない)
+    // 頂点は GPU 頂点フォーマット (VertexFormat.h) にエンコード済みで、座標と属性を別のブロブに格納する
+    //
+    // [ヘッダー][サブメッシュテーブル][テクスチャテーブル][文字列][座標ブロブ][属性ブロブ][インデックスブロブ]
+    // 各セクションは CookedMeshAlignment 境界に配置し、マップしたポインタをそのまま参照する
+    //======================================================================================
+    static constexpr uint32 CookedMeshMagic     = 'S' | ('L' << 8) | ('M' << 16) | ('S' << 24);
+    static constexpr uint32 CookedMeshVersion   = 2;
+    static constexpr uint64 CookedMeshAlignment = 16;
+
+    struct CookedMeshHeader
+    {
+        uint32 magic;
+        uint32 version;
+        uint64 sourceKey;       // ソースファイル (サイズ・更新時刻) とインポート設定のハッシュ
+        uint64 fileSize;        // 書き込み途中のファイルの検出用
+
+        uint32 numSubMesh;
+        uint32 numTexture;
+        uint32 numMaterialSlot;
+        uint32 positionStride;  // VertexPositionStride (量子化の有無)
+        uint64 numVertex;
+        uint64 numIndex;
+
+        glm::vec3 positionCenter;  // 座標の量子化範囲 (量子化しない場合は 中心 0 / 半径 1)
+        glm::vec3 positionExtent;
+
+        uint64 subMeshOffset;
+        uint64 textureOffset;
+        uint64 stringOffset;
+        uint64 stringSize;
+        uint64 positionOffset;
+        uint64 attributeOffset;
+        uint64 indexOffset;
+    };
+
+    struct CookedSubMesh
+    {
+        glm::mat4      transform;
+        AABB           bounds;
+        BoundingSphere sphere;
+        uint64         firstVertex;   // 頂点ブロブ内の位置 (頂点単位)
+        uint64         firstIndex;    // インデックスブロブ内の位置 (インデックス単位)
+        uint32         numVertex;
+        uint32         numIndex;
+        uint32         materialIndex;
+        uint32         padding;
+    };
+
+    // マテリアルスロットのテクスチャ (パスは文字列セクション内の範囲)
+    struct CookedTexture
+    {
+        uint32 materialIndex;
+        uint32 albedo;
+        uint32 pathOffset;
+        uint32 pathLength;
+    };
+
+    // クック済みデータの参照 (マップしたファイル、またはクック直後のメモリを指し、所有権は持たない)
+    struct CookedMeshView
+    {
+        const CookedMeshHeader* header    = nullptr;
+        const CookedSubMesh*    subMeshes = nullptr;
+        const CookedTexture*    textures  = nullptr;
+        const char*             strings    = nullptr;
+        const byte*             positions  = nullptr; // VertexPositionStride 単位
+        const VertexAttribute*  attributes = nullptr;
+        const uint32*           indices    = nullptr;
+    };
+
+    // 読み込み中のクック済みメッシュ (マップしたファイル、またはクックしたメモリのどちらかを保持する)
+    struct CookedMeshFile
+    {
+        std::string       sourcePath = {};
+        std::string       cookedPath = {};
+        uint64            sourceKey  = 0;
+        MappedFile        mapped     = {};
+        std::vector<byte> memory     = {};
+        CookedMeshView    view       = {};
+    };
+
+
+    class MeshCooker
+    {
+    public:
+
+        // Assimp でソースファイルを読み込み、頂点をエンコードしてクック済みデータを生成する
+        static bool Cook(const std::string& sourcePath, uint64 sourceKey, std::vector<byte>& out_data);
+
+        // ヘッダーと各セクションの範囲を検証し、参照を構築する (sourceKey が一致しなければ失敗)
+        static bool Parse(const byte* data, uint64 dataSize, uint64 sourceKey, CookedMeshView& out_view);
+
+        // クック済みファイルをマップして検証する (存在しない・古い場合は false を返すので、CookToMemory で生成する)
+        static bool Map(const std::string& sourcePath, CookedMeshFile& out_file);
+
+        // Assimp でクックしてファイルに保存し、メモリ上のデータを参照する
+        static bool CookToMemory(const std::string& sourcePath, CookedMeshFile& out_file);
+
+        // マップ解除・メモリ解放 (ステージングへのコピー後に呼び出してよい)
+        static void Close(CookedMeshFile& file);
+
+        // ソースファイルに対応するクック済みファイルのパスとキー
+        static std::string GetCookedPath(const std::string& sourcePath);
+        static uint64      GetSourceKey(const std::string& sourcePath);
+    };
+}
@@ -0,0 +1,125 @@
+
+#include "PCH.h"
+#include "Rendering/PipelineCompiler.h"
+#include "Rendering/Renderer.h"
+#include "Rendering/RenderingAPI.h"
+
+
+namespace Silex
+{
+    // 生成要求中のパイプライン (WaitAll 用)
+    static std::mutex                         pipelineLock;
+    static std::unordered_set<AsyncPipeline*> pipelines;
+    static std::atomic<uint32>                pendingCount = 0;
+
+
+    AsyncPipeline* PipelineCompiler::CompileGraphics(ShaderHandle* shader, const PipelineStateInfo& info, RenderPassHandle* renderpass, uint32 renderSubpass, PipelineDynamicStateFlags dynamicState)
+    {
+        AsyncPipeline* pipeline = slnew(AsyncPipeline);
+        pipeline->isCompute    = false;
+        pipeline->shader       = shader;
+        pipeline->renderpass   = renderpass;
+        pipeline->subpass      = renderSubpass;
+        pipeline->dynamicState = dynamicState;
+        pipeline->info         = info;
+
+        // 入力レイアウトは呼び出し元のポインタを参照しているので、コピーして差し替える
+        if (info.inputLayout.layouts)
+        {
+            pipeline->inputLayouts.assign(info.inputLayout.layouts, info.inputLayout.layouts + info.inputLayout.numLayout);
+            pipeline->info.inputLayout.layouts = pipeline->inputLayouts.data();
+        }
+
+        return _Submit(pipeline);
+    }
+
+    AsyncPipeline* PipelineCompiler::CompileCompute(ShaderHandle* shader)
+    {
+        AsyncPipeline* pipeline = slnew(AsyncPipeline);
+        pipeline->isCompute = true;
+        pipeline->shader    = shader;
+
+        return _Submit(pipeline);
+    }
+
+    AsyncPipeline* PipelineCompiler::_Submit(AsyncPipeline* pipeline)
+    {
+        {
+            std::lock_guard lock(pipelineLock);
+            pipelines.insert(pipeline);
+        }
+
+        pendingCount.fetch_add(1, std::memory_order_relaxed);
+
+        pipeline->job = ThreadPool::Schedule([pipeline]()
+        {
+            SL_SCOPE_PROFILE("PipelineCompiler::Compile");
+
+            RenderingAPI* api = Renderer::Get()->GetAPI();
+
+            if (pipeline->isCompute)
+            {
+                pipeline->pipeline = api->CreateComputePipeline(pipeline->shader);
+            }
+            else
+            {
+                pipeline->pipeline = api->CreateGraphicsPipeline(pipeline->shader, &pipeline->info, pipeline->renderpass, pipeline->subpass, pipeline->dynamicState);
+            }
+
+            pendingCount.fetch_sub(1, std::memory_order_relaxed);
+            pipeline->state.store(pipeline->pipeline? PIPELINE_COMPILE_STATE_READY : PIPELINE_COMPILE_STATE_FAILED, std::memory_order_release);
+        });
+
+        return pipeline;
+    }
+
+    void PipelineCompiler::Wait(AsyncPipeline* pipeline)
+    {
+        if (pipeline)
+        {
+            ThreadPool::Wait(pipeline->job);
+        }
+    }
+
+    void PipelineCompiler::WaitAll()
+    {
+        std::vector<JobHandle> jobs;
+
+        {
+            std::lock_guard lock(pipelineLock);
+
+            jobs.reserve(pipelines.size());
+            for (AsyncPipeline* pipeline : pipelines)
+            {
+                jobs.push_back(pipeline->job);
+            }
+        }
+
+        ThreadPool::Wait(jobs.data(), jobs.size());
+    }
+
+    void PipelineCompiler::Destroy(AsyncPipeline* pipeline)
+    {
+        if (!pipeline)
+            return;
+
+        ThreadPool::Wait(pipeline->job);
+
+        {
+            std::lock_guard lock(pipelineLock);
+            pipelines.erase(pipeline);
+        }
+
+        if (pipeline->pipeline)
+        {
+            Renderer::Get()->GetAPI()->DestroyPipeline(pipeline->pipeline);
+        }
+
+        sldelete(pipeline);
+    }
+
+    uint32 PipelineCompiler::GetPendingCount()
+    {
+        return pendingCount.load(std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,81 @@
+
+#pragma once
+
+#include "Core/ThreadPool.h"
+#include "Rendering/RenderingCore.h"
+
+
+namespace Silex
+{
+    enum PipelineCompileState : uint32
+    {
+        PIPELINE_COMPILE_STATE_PENDING,
+        PIPELINE_COMPILE_STATE_READY,
+        PIPELINE_COMPILE_STATE_FAILED,
+    };
+
+
+    //=========================================
+    // 非同期生成パイプライン
+    //-----------------------------------------
+    // ワーカースレッドで生成され、完了するまで Get() は nullptr を返す
+    // 描画側は IsReady() で判定し、未完了の場合は描画をスキップ (または既存のパイプラインで代替) する
+    //=========================================
+    class AsyncPipeline
+    {
+        friend class PipelineCompiler;
+
+    public:
+
+        bool IsReady()   const { return state.load(std::memory_order_acquire) == PIPELINE_COMPILE_STATE_READY;   }
+        bool IsPending() const { return state.load(std::memory_order_acquire) == PIPELINE_COMPILE_STATE_PENDING; }
+        bool IsFailed()  const { return state.load(std::memory_order_acquire) == PIPELINE_COMPILE_STATE_FAILED;  }
+
+        PipelineHandle* Get() const { return IsReady()? pipeline : nullptr; }
+
+    private:
+
+        std::atomic<PipelineCompileState> state    = PIPELINE_COMPILE_STATE_PENDING;
+        PipelineHandle*                   pipeline = nullptr;
+        JobHandle                         job      = {};
+
+        // 生成情報 (ワーカースレッドから参照するので、呼び出し元のデータはコピーして保持する)
+        bool                      isCompute    = false;
+        ShaderHandle*             shader       = nullptr;
+        RenderPassHandle*         renderpass   = nullptr;
+        uint32                    subpass      = 0;
+        PipelineDynamicStateFlags dynamicState = DYNAMIC_STATE_NONE;
+        PipelineStateInfo         info         = {};
+        std::vector<InputLayout>  inputLayouts = {};
+    };
+
+
+    //=========================================
+    // パイプライン非同期コンパイル
+    //-----------------------------------------
+    // パイプライン生成 (ドライバー内のシェーダーコンパイル) をスレッドプールで並列に実行する
+    // シェーダー・レンダーパスは、生成が完了するまで破棄しないこと (WaitAll で完了を待機できる)
+    //=========================================
+    class PipelineCompiler
+    {
+    public:
+
+        // 生成要求 (即座に戻り、生成はワーカースレッドで行われる)
+        static AsyncPipeline* CompileGraphics(ShaderHandle* shader, const PipelineStateInfo& info, RenderPassHandle* renderpass, uint32 renderSubpass = 0, PipelineDynamicStateFlags dynamicState = DYNAMIC_STATE_NONE);
+        static AsyncPipeline* CompileCompute(ShaderHandle* shader);
+
+        // 生成完了まで待機 (待機中は呼び出しスレッドもジョブを実行する)
+        static void Wait(AsyncPipeline* pipeline);
+        static void WaitAll();
+
+        // 生成完了を待ってから破棄
+        static void Destroy(AsyncPipeline* pipeline);
+
+        // 生成中のパイプライン数
+        static uint32 GetPendingCount();
+
+    private:
+
+        static AsyncPipeline* _Submit(AsyncPipeline* pipeline);
+    };
+}
@@ -0,0 +1,609 @@
+#include "PCH.h"
+#include "Rendering/RenderGraph.h"
+#include "Rendering/RenderingAPI.h"
+#include "Rendering/Renderer.h"
+#include "Rendering/RenderingUtility.h"
+#include "Core/Profiler.h"
+
+
+namespace Silex
+{
+    // 書き込みを含むアクセス (これを含む使用の前後は メモリー依存が必要)
+    static constexpr BarrierAccessFlags WriteAccessMask = BARRIER_ACCESS_SHADER_WRITE_BIT
+                                                        | BARRIER_ACCESS_COLOR_ATTACHMENT_WRITE_BIT
+                                                        | BARRIER_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT
+                                                        | BARRIER_ACCESS_TRANSFER_WRITE_BIT
+                                                        | BARRIER_ACCESS_HOST_WRITE_BIT
+                                                        | BARRIER_ACCESS_MEMORY_WRITE_BIT;
+
+    // フラグメントシェーダーでのサンプリング
+    static const RenderGraphTextureState ShaderReadState =
+    {
+        TEXTURE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        BARRIER_ACCESS_SHADER_READ_BIT,
+    };
+
+    // アタッチメントへの書き込み (ブレンド・LOAD の読み取りを含む)
+    static RenderGraphTextureState GetAttachmentState(RenderingFormat format)
+    {
+        if (RenderingUtility::IsDepthFormat(format))
+        {
+            return
+            {
+                TEXTURE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                (PipelineStageBits)(PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT),
+                BARRIER_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | BARRIER_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+            };
+        }
+
+        return
+        {
+            TEXTURE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+            PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+            BARRIER_ACCESS_COLOR_ATTACHMENT_READ_BIT | BARRIER_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+        };
+    }
+
+    // 統計用のテクスチャサイズ (概算 / 未知のフォーマットは 4 バイトとして扱う)
+    static uint64 EstimateTextureSize(const RenderGraphTextureDesc& desc)
+    {
+        uint64 bytePerPixel = 4;
+        switch (desc.format)
+        {
+            case RENDERING_FORMAT_R16G16B16A16_SFLOAT: bytePerPixel = 8;  break;
+            case RENDERING_FORMAT_R32G32B32A32_SFLOAT: bytePerPixel = 16; break;
+            case RENDERING_FORMAT_D32_SFLOAT_S8_UINT:  bytePerPixel = 8;  break;
+            default: break;
+        }
+
+        return bytePerPixel * desc.width * desc.height;
+    }
+
+
+    //=========================================
+    // パスの入出力宣言
+    //=========================================
+    RenderGraphPassBuilder& RenderGraphPassBuilder::Read(RenderGraphTexture texture)
+    {
+        SL_ASSERT(texture.IsValid());
+
+        graph->passes[passIndex].reads.push_back(texture.index);
+        return *this;
+    }
+
+    RenderGraphPassBuilder& RenderGraphPassBuilder::Write(RenderGraphTexture texture, AttachmentLoadOp loadOp)
+    {
+        SL_ASSERT(texture.IsValid());
+
+        graph->passes[passIndex].writes.push_back({ texture.index, loadOp });
+        return *this;
+    }
+
+    RenderGraphPassBuilder& RenderGraphPassBuilder::GPUZone(const char* name)
+    {
+        graph->passes[passIndex].zone = name;
+        return *this;
+    }
+
+
+    //=========================================
+    // レンダーグラフ
+    //=========================================
+    void RenderGraph::Initialize(RenderingAPI* renderingAPI)
+    {
+        api     = renderingAPI;
+        invalid = true;
+    }
+
+    void RenderGraph::Finalize()
+    {
+        Reset();
+
+        for (PhysicalTexture& physical : retired)
+        {
+            _DestroyPhysicalTexture(physical);
+        }
+
+        for (auto& [key, renderPass] : renderPassCache)
+        {
+            api->DestroyRenderPass(renderPass);
+        }
+
+        retired.clear();
+        renderPassCache.clear();
+    }
+
+    void RenderGraph::Reset()
+    {
+        for (Pass& pass : passes)
+        {
+            if (pass.framebuffer)
+            {
+                Renderer::Get()->DestroyFramebuffer(pass.framebuffer);
+            }
+        }
+
+        // 確保済みの物理テクスチャは、次の Compile で同じ記述のテクスチャに再利用する
+        for (PhysicalTexture& physical : physicals)
+        {
+            if (physical.owned)
+            {
+                retired.push_back(physical);
+            }
+        }
+
+        passes.clear();
+        textures.clear();
+        physicals.clear();
+
+        stats   = {};
+        invalid = true;
+    }
+
+    RenderGraphTexture RenderGraph::ImportTexture(const char* name, Texture* texture, TextureView* view, RenderingFormat format, uint32 width, uint32 height, const RenderGraphTextureState& state)
+    {
+        TextureResource& resource = textures.emplace_back();
+        resource.name          = name;
+        resource.desc          = { format, width, height };
+        resource.importTexture = texture;
+        resource.importView    = view;
+        resource.importState   = state;
+
+        return { uint32(textures.size() - 1) };
+    }
+
+    RenderGraphTexture RenderGraph::CreateTexture(const char* name, const RenderGraphTextureDesc& desc)
+    {
+        TextureResource& resource = textures.emplace_back();
+        resource.name = name;
+        resource.desc = desc;
+
+        return { uint32(textures.size() - 1) };
+    }
+
+    RenderGraphPassBuilder RenderGraph::AddPass(const char* name, RenderGraphExecuteFunc&& execute)
+    {
+        Pass& pass = passes.emplace_back();
+        pass.name    = name;
+        pass.execute = std::move(execute);
+
+        return RenderGraphPassBuilder(this, uint32(passes.size() - 1));
+    }
+
+    void RenderGraph::Export(RenderGraphTexture texture, const RenderGraphTextureState& finalState)
+    {
+        SL_ASSERT(texture.IsValid());
+
+        textures[texture.index].exported   = true;
+        textures[texture.index].finalState = finalState;
+    }
+
+    bool RenderGraph::Compile()
+    {
+        SL_SCOPE_PROFILE("RenderGraph::Compile");
+
+        _CullPasses();
+        _AllocatePhysicalTextures();
+
+        if (!_CreatePassTargets())
+        {
+            return false;
+        }
+
+        invalid = false;
+        return true;
+    }
+
+    TextureView* RenderGraph::GetView(RenderGraphTexture texture) const
+    {
+        SL_ASSERT(texture.IsValid());
+
+        const uint32 physical = textures[texture.index].physical;
+        return physical != RENDER_INVALID_ID? physicals[physical].view : nullptr;
+    }
+
+    void RenderGraph::_CullPasses()
+    {
+        // エクスポートしたテクスチャを起点に 後ろのパスから辿り、読み取られる内容を書き込むパスのみを残す
+        std::vector<uint8> needed(textures.size(), 0);
+        for (uint32 i = 0; i < textures.size(); i++)
+        {
+            needed[i] = textures[i].exported;
+        }
+
+        for (int32 i = int32(passes.size()) - 1; i >= 0; i--)
+        {
+            Pass& pass = passes[i];
+
+            pass.culled = true;
+            for (const PassWrite& write : pass.writes)
+            {
+                if (needed[write.texture])
+                {
+                    pass.culled = false;
+                }
+            }
+
+            if (pass.culled)
+                continue;
+
+            // LOAD 以外の書き込みは以前の内容を破棄するので、それより前の書き込みは不要になる
+            for (const PassWrite& write : pass.writes)
+            {
+                needed[write.texture] = write.loadOp == ATTACHMENT_LOAD_OP_LOAD;
+            }
+
+            for (uint32 read : pass.reads)
+            {
+                needed[read] = true;
+            }
+        }
+
+        stats.numPass       = uint32(passes.size());
+        stats.numCulledPass = 0;
+        for (const Pass& pass : passes)
+        {
+            stats.numCulledPass += pass.culled;
+        }
+    }
+
+    void RenderGraph::_AllocatePhysicalTextures()
+    {
+        // 残ったパスでの使用範囲 (寿命)
+        for (uint32 passIndex = 0; passIndex < passes.size(); passIndex++)
+        {
+            const Pass& pass = passes[passIndex];
+            if (pass.culled)
+                continue;
+
+            auto Use = [&](uint32 index)
+            {
+                TextureResource& texture = textures[index];
+                texture.firstPass = std::min(texture.firstPass, passIndex);
+                texture.lastPass  = std::max(texture.lastPass,  passIndex);
+            };
+
+            for (uint32 read : pass.reads)              Use(read);
+            for (const PassWrite& write : pass.writes)  Use(write.texture);
+        }
+
+        // インポートしたテクスチャは所有しない物理テクスチャとして登録する
+        for (TextureResource& texture : textures)
+        {
+            if (!texture.importTexture)
+                continue;
+
+            PhysicalTexture& physical = physicals.emplace_back();
+            physical.desc    = texture.desc;
+            physical.texture = texture.importTexture;
+            physical.view    = texture.importView;
+            physical.owned   = false;
+            physical.state   = texture.importState;
+
+            texture.physical = uint32(physicals.size() - 1);
+        }
+
+        // パス順に 寿命の始まるテクスチャへ割り当て、寿命の終わったテクスチャを解放リストに戻す
+        // エクスポートしたテクスチャはグラフ外で参照されるので、解放せず他のテクスチャと共有しない
+        std::vector<uint32> freeList;
+        std::vector<uint32> exportList;
+
+        for (uint32 passIndex = 0; passIndex < passes.size(); passIndex++)
+        {
+            if (passes[passIndex].culled)
+                continue;
+
+            for (TextureResource& texture : textures)
+            {
+                if (!texture.importTexture && texture.firstPass == passIndex)
+                {
+                    texture.physical = _AcquirePhysicalTexture(texture.desc, texture.exported? exportList : freeList);
+                }
+            }
+
+            for (TextureResource& texture : textures)
+            {
+                if (!texture.importTexture && !texture.exported && texture.firstPass != RENDER_INVALID_ID && texture.lastPass == passIndex)
+                {
+                    freeList.push_back(texture.physical);
+                }
+            }
+        }
+
+        // 再利用されなかった 前回の物理テクスチャを破棄する
+        for (PhysicalTexture& physical : retired)
+        {
+            _DestroyPhysicalTexture(physical);
+        }
+
+        retired.clear();
+
+        // 統計
+        stats.numTexture          = 0;
+        stats.numPhysicalTexture  = 0;
+        stats.memorySize          = 0;
+        stats.unaliasedMemorySize = 0;
+
+        for (const TextureResource& texture : textures)
+        {
+            if (texture.importTexture)
+                continue;
+
+            stats.numTexture++;
+            if (texture.physical != RENDER_INVALID_ID)
+            {
+                stats.unaliasedMemorySize += EstimateTextureSize(texture.desc);
+            }
+        }
+
+        for (const PhysicalTexture& physical : physicals)
+        {
+            if (physical.owned)
+            {
+                stats.numPhysicalTexture++;
+                stats.memorySize += EstimateTextureSize(physical.desc);
+            }
+        }
+    }
+
+    uint32 RenderGraph::_AcquirePhysicalTexture(const RenderGraphTextureDesc& desc, std::vector<uint32>& freeList)
+    {
+        // 現在の構築内で寿命の終わった物理テクスチャ
+        for (uint32 i = 0; i < freeList.size(); i++)
+        {
+            const uint32 physical = freeList[i];
+            if (physicals[physical].desc == desc)
+            {
+                freeList.erase(freeList.begin() + i);
+                return physical;
+            }
+        }
+
+        // 前回の構築で確保した物理テクスチャ (リサイズしていなければ、パス構成の変更で再確保しない)
+        for (uint32 i = 0; i < retired.size(); i++)
+        {
+            if (retired[i].desc == desc)
+            {
+                physicals.push_back(retired[i]);
+                retired.erase(retired.begin() + i);
+                return uint32(physicals.size() - 1);
+            }
+        }
+
+        const TextureAspectFlags aspect = RenderingUtility::IsDepthFormat(desc.format)? TEXTURE_ASPECT_DEPTH_BIT : TEXTURE_ASPECT_COLOR_BIT;
+
+        PhysicalTexture& physical = physicals.emplace_back();
+        physical.desc    = desc;
+        physical.texture = Renderer::Get()->CreateTexture2D(desc.format, desc.width, desc.height);
+        physical.view    = Renderer::Get()->CreateTextureView(physical.texture, TEXTURE_TYPE_2D, aspect);
+        physical.owned   = true;
+        physical.state   = {};
+
+        return uint32(physicals.size() - 1);
+    }
+
+    bool RenderGraph::_CreatePassTargets()
+    {
+        for (Pass& pass : passes)
+        {
+            if (pass.culled || pass.writes.empty())
+                continue;
+
+            const uint32 numAttachment = uint32(pass.writes.size());
+            TextureHandle** attachments = SL_STACK(TextureHandle*, numAttachment);
+
+            RenderPassKey key = {};
+            pass.width  = textures[pass.writes[0].texture].desc.width;
+            pass.height = textures[pass.writes[0].texture].desc.height;
+
+            for (uint32 i = 0; i < numAttachment; i++)
+            {
+                const TextureResource& texture = textures[pass.writes[i].texture];
+                if (texture.desc.width != pass.width || texture.desc.height != pass.height)
+                {
+                    SL_LOG_LOCATION_ERROR("アタッチメントのサイズが一致しません");
+                    SL_LOG_ERROR("pass: {}, attachment: {}", pass.name, texture.name);
+                    return false;
+                }
+
+                key.formats.push_back(texture.desc.format);
+                key.loadOps.push_back(pass.writes[i].loadOp);
+                attachments[i] = physicals[texture.physical].texture->GetHandle();
+            }
+
+            pass.renderPass  = _FindOrCreateRenderPass(key);
+            pass.framebuffer = Renderer::Get()->CreateFramebuffer(pass.renderPass, numAttachment, attachments, pass.width, pass.height);
+        }
+
+        return true;
+    }
+
+    RenderPassHandle* RenderGraph::_FindOrCreateRenderPass(const RenderPassKey& key)
+    {
+        for (const auto& [cachedKey, renderPass] : renderPassCache)
+        {
+            if (cachedKey == key)
+            {
+                return renderPass;
+            }
+        }
+
+        // レイアウトの移行はグラフのバリアで行うので、レンダーパスの開始・終了時には移行しない
+        const uint32 numAttachment = uint32(key.formats.size());
+        std::vector<Attachment>           attachments(numAttachment);
+        std::vector<RenderPassClearValue> clearValues(numAttachment);
+
+        Subpass subpass = {};
+
+        for (uint32 i = 0; i < numAttachment; i++)
+        {
+            const bool          isDepth = RenderingUtility::IsDepthFormat(key.formats[i]);
+            const TextureLayout layout  = isDepth? TEXTURE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL : TEXTURE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+            attachments[i].format        = key.formats[i];
+            attachments[i].samples       = TEXTURE_SAMPLES_1;
+            attachments[i].loadOp        = key.loadOps[i];
+            attachments[i].storeOp       = ATTACHMENT_STORE_OP_STORE;
+            attachments[i].initialLayout = layout;
+            attachments[i].finalLayout   = layout;
+
+            AttachmentReference reference = {};
+            reference.attachment = i;
+            reference.layout     = layout;
+
+            if (isDepth)
+            {
+                subpass.depthstencilReference = reference;
+                clearValues[i].SetDepthStencil(1.0f, 0);
+            }
+            else
+            {
+                subpass.colorReferences.push_back(reference);
+                clearValues[i].SetFloat(0, 0, 0, 1);
+            }
+        }
+
+        RenderPassHandle* renderPass = api->CreateRenderPass(numAttachment, attachments.data(), 1, &subpass, 0, nullptr, numAttachment, clearValues.data());
+        renderPassCache.push_back({ key, renderPass });
+
+        return renderPass;
+    }
+
+    void RenderGraph::Execute(CommandBufferHandle* commandBuffer)
+    {
+        if (invalid)
+        {
+            SL_LOG_LOCATION_ERROR("コンパイルされていないレンダーグラフは実行できません");
+            return;
+        }
+
+        // インポートしたテクスチャは毎フレーム グラフ外で使用されるので、開始時点の状態に戻す
+        for (const TextureResource& texture : textures)
+        {
+            if (texture.importTexture)
+            {
+                physicals[texture.physical].state = texture.importState;
+            }
+        }
+
+        const char* currentZone = nullptr;
+        uint32      zoneIndex   = 0;
+
+        for (Pass& pass : passes)
+        {
+            if (pass.culled)
+                continue;
+
+            if (pass.zone != currentZone)
+            {
+                if (currentZone) Renderer::Get()->EndGPUTimestamp(zoneIndex);
+                if (pass.zone)   zoneIndex = Renderer::Get()->BeginGPUTimestamp(pass.zone);
+
+                currentZone = pass.zone;
+            }
+
+            // 読み取り・書き込み前のバリア
+            PipelineStageFlags srcStage = 0;
+            PipelineStageFlags dstStage = 0;
+
+            for (uint32 read : pass.reads)
+            {
+                _TransitionTexture(textures[read].physical, ShaderReadState, false, srcStage, dstStage);
+            }
+
+            for (const PassWrite& write : pass.writes)
+            {
+                const TextureResource& texture = textures[write.texture];
+                _TransitionTexture(texture.physical, GetAttachmentState(texture.desc.format), write.loadOp != ATTACHMENT_LOAD_OP_LOAD, srcStage, dstStage);
+            }
+
+            _FlushBarriers(commandBuffer, srcStage, dstStage);
+
+            // 記録
+            const uint32 numView = uint32(pass.writes.size());
+            TextureViewHandle** views = SL_STACK(TextureViewHandle*, numView);
+            for (uint32 i = 0; i < numView; i++)
+            {
+                views[i] = physicals[textures[pass.writes[i].texture].physical].view->GetHandle();
+            }
+
+            api->Cmd_BeginRenderPass(commandBuffer, pass.renderPass, pass.framebuffer, numView, views);
+            api->Cmd_SetViewport(commandBuffer, 0, 0, pass.width, pass.height);
+            api->Cmd_SetScissor(commandBuffer, 0, 0, pass.width, pass.height);
+
+            pass.execute(commandBuffer);
+
+            api->Cmd_EndRenderPass(commandBuffer);
+        }
+
+        if (currentZone)
+        {
+            Renderer::Get()->EndGPUTimestamp(zoneIndex);
+        }
+
+        // エクスポートしたテクスチャを グラフ外で使用する状態に移行する
+        PipelineStageFlags srcStage = 0;
+        PipelineStageFlags dstStage = 0;
+
+        for (const TextureResource& texture : textures)
+        {
+            if (texture.exported && texture.physical != RENDER_INVALID_ID)
+            {
+                _TransitionTexture(texture.physical, texture.finalState, false, srcStage, dstStage);
+            }
+        }
+
+        _FlushBarriers(commandBuffer, srcStage, dstStage);
+    }
+
+    void RenderGraph::_TransitionTexture(uint32 physical, const RenderGraphTextureState& next, bool discard, PipelineStageFlags& out_srcStage, PipelineStageFlags& out_dstStage)
+    {
+        PhysicalTexture&         texture = physicals[physical];
+        RenderGraphTextureState& current = texture.state;
+
+        const bool layoutChanged = current.layout != next.layout;
+        const bool hazard        = (current.access & WriteAccessMask) || (next.access & WriteAccessMask);
+
+        if (!layoutChanged && !hazard)
+        {
+            // 読み取り同士は同期不要 (後の書き込みが全ての読み取りを待機するように ステージを蓄積しておく)
+            current.stage   = (PipelineStageBits)(current.stage | next.stage);
+            current.access |= next.access;
+            return;
+        }
+
+        TextureBarrierInfo barrier = {};
+        barrier.texture             = texture.texture->GetHandle();
+        barrier.srcAccess           = current.access & WriteAccessMask;
+        barrier.dstAccess           = next.access;
+        barrier.oldLayout           = discard? TEXTURE_LAYOUT_UNDEFINED : current.layout;
+        barrier.newLayout           = next.layout;
+        barrier.subresources.aspect = RenderingUtility::IsDepthFormat(texture.desc.format)? TEXTURE_ASPECT_DEPTH_BIT : TEXTURE_ASPECT_COLOR_BIT;
+
+        pendingBarriers.push_back(barrier);
+
+        out_srcStage |= current.stage;
+        out_dstStage |= next.stage;
+
+        current = next;
+    }
+
+    void RenderGraph::_FlushBarriers(CommandBufferHandle* commandBuffer, PipelineStageFlags srcStage, PipelineStageFlags dstStage)
+    {
+        if (pendingBarriers.empty())
+            return;
+
+        api->Cmd_PipelineBarrier(commandBuffer, (PipelineStageBits)srcStage, (PipelineStageBits)dstStage, 0, nullptr, 0, nullptr, uint32(pendingBarriers.size()), pendingBarriers.data());
+        pendingBarriers.clear();
+    }
+
+    void RenderGraph::_DestroyPhysicalTexture(PhysicalTexture& physical)
+    {
+        Renderer::Get()->DestroyTextureView(physical.view);
+        Renderer::Get()->DestroyTexture(physical.texture);
+
+        physical.view    = nullptr;
+        physical.texture = nullptr;
+    }
+}
@@ -0,0 +1,224 @@
+
+#pragma once
+
+#include "Rendering/RenderingCore.h"
+
+
+namespace Silex
+{
+    class RenderingAPI;
+    class Texture;
+    class Texture2D;
+    class TextureView;
+    class RenderGraph;
+
+
+    // グラフ内のテクスチャ参照 (Compile で物理テクスチャに割り当てられる)
+    struct RenderGraphTexture
+    {
+        uint32 index = RENDER_INVALID_ID;
+
+        bool IsValid() const { return index != RENDER_INVALID_ID; }
+    };
+
+    // トランジェントテクスチャの記述 (記述が一致し、寿命が重ならないテクスチャは同じ物理テクスチャを共有する)
+    struct RenderGraphTextureDesc
+    {
+        RenderingFormat format = RENDERING_FORMAT_R8G8B8A8_UNORM;
+        uint32          width  = 0;
+        uint32          height = 0;
+
+        bool operator==(const RenderGraphTextureDesc& other) const
+        {
+            return format == other.format && width == other.width && height == other.height;
+        }
+    };
+
+    // グラフの外部でのテクスチャの状態 (インポート時は実行開始時点の状態、エクスポート時は実行後に移行する状態)
+    struct RenderGraphTextureState
+    {
+        TextureLayout      layout = TEXTURE_LAYOUT_UNDEFINED;
+        PipelineStageBits  stage  = PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+        BarrierAccessFlags access = 0;
+    };
+
+    // Compile 結果の統計 (メモリーサイズはフォーマットとサイズからの概算)
+    struct RenderGraphStats
+    {
+        uint32 numPass             = 0;
+        uint32 numCulledPass       = 0;
+        uint32 numTexture          = 0; // トランジェントテクスチャ数 (インポートを除く)
+        uint32 numPhysicalTexture  = 0; // 実際に確保した物理テクスチャ数
+        uint64 memorySize          = 0; // 物理テクスチャの合計
+        uint64 unaliasedMemorySize = 0; // 共有しなかった場合の合計
+    };
+
+    // パスの記録処理 (アタッチメントへ書き込むパスは、レンダーパス開始・ビューポート設定後に呼び出される)
+    using RenderGraphExecuteFunc = std::function<void(CommandBufferHandle* commandBuffer)>;
+
+
+    //=========================================
+    // パスの入出力宣言
+    //=========================================
+    class RenderGraphPassBuilder
+    {
+    public:
+
+        RenderGraphPassBuilder(RenderGraph* renderGraph, uint32 index)
+            : graph(renderGraph)
+            , passIndex(index)
+        {
+        }
+
+        // シェーダーリソースとしてサンプリングする
+        RenderGraphPassBuilder& Read(RenderGraphTexture texture);
+
+        // アタッチメントとして書き込む (LOAD 以外は以前の内容を破棄する)
+        RenderGraphPassBuilder& Write(RenderGraphTexture texture, AttachmentLoadOp loadOp = ATTACHMENT_LOAD_OP_CLEAR);
+
+        // GPU 区間計測 (連続するパスが同じ区間名を指定した場合は 1つの区間にまとめる / 名前はポインタで比較する)
+        RenderGraphPassBuilder& GPUZone(const char* name);
+
+    private:
+
+        RenderGraph* graph;
+        uint32       passIndex;
+    };
+
+
+    //=========================================
+    // フレームレンダーグラフ
+    //-----------------------------------------
+    // パスが宣言した読み書きから 以下を導出する
+    //  - 出力 (エクスポート) に寄与しないパスのカリング
+    //  - パス間のレイアウト移行とバリア (レンダーパス自体はレイアウトを移行しない)
+    //  - トランジェントテクスチャの寿命と、寿命が重ならないテクスチャ間での物理テクスチャの共有
+    //  - パス毎のレンダーパス (フォーマット・ロード操作でキャッシュ) とフレームバッファ
+    //
+    // 構築 (Reset → Import / Create / AddPass → Compile) は Invalidate されたときのみ行い、
+    // 以降のフレームは Execute でコンパイル結果を記録する
+    //=========================================
+    class RenderGraph
+    {
+        friend class RenderGraphPassBuilder;
+
+    public:
+
+        void Initialize(RenderingAPI* renderingAPI);
+        void Finalize();
+
+        // 構築
+        void                   Reset();
+        RenderGraphTexture     ImportTexture(const char* name, Texture* texture, TextureView* view, RenderingFormat format, uint32 width, uint32 height, const RenderGraphTextureState& state);
+        RenderGraphTexture     CreateTexture(const char* name, const RenderGraphTextureDesc& desc);
+        RenderGraphPassBuilder AddPass(const char* name, RenderGraphExecuteFunc&& execute);
+
+        // グラフ外で使用するテクスチャ (カリングの起点となり、他のテクスチャと共有されない)
+        void Export(RenderGraphTexture texture, const RenderGraphTextureState& finalState);
+
+        // カリング・物理テクスチャの割り当て・レンダーパス/フレームバッファの生成
+        bool Compile();
+
+        // コンパイル結果をコマンドバッファに記録する
+        void Execute(CommandBufferHandle* commandBuffer);
+
+        // 再構築が必要な状態にする (リサイズ・パス構成の変更時)
+        void Invalidate()       { invalid = true; }
+        bool IsInvalid() const  { return invalid; }
+
+        // Compile 後に有効 (カリングされたパスのみが使用するテクスチャは nullptr)
+        TextureView* GetView(RenderGraphTexture texture) const;
+
+        const RenderGraphStats& GetStats() const { return stats; }
+
+    private:
+
+        struct TextureResource
+        {
+            const char*             name       = nullptr;
+            RenderGraphTextureDesc  desc       = {};
+            uint32                  physical   = RENDER_INVALID_ID;
+            uint32                  firstPass  = RENDER_INVALID_ID;
+            uint32                  lastPass   = 0;
+            bool                    exported   = false;
+            RenderGraphTextureState finalState = {};
+
+            // インポート
+            Texture*                importTexture = nullptr;
+            TextureView*            importView    = nullptr;
+            RenderGraphTextureState importState   = {};
+        };
+
+        struct PassWrite
+        {
+            uint32           texture = RENDER_INVALID_ID;
+            AttachmentLoadOp loadOp  = ATTACHMENT_LOAD_OP_CLEAR;
+        };
+
+        struct Pass
+        {
+            const char*            name    = nullptr;
+            const char*            zone    = nullptr;
+            RenderGraphExecuteFunc execute = nullptr;
+            std::vector<uint32>    reads   = {};
+            std::vector<PassWrite> writes  = {};
+            bool                   culled  = false;
+
+            RenderPassHandle*  renderPass  = nullptr;
+            FramebufferHandle* framebuffer = nullptr;
+            uint32             width       = 0;
+            uint32             height      = 0;
+        };
+
+        struct PhysicalTexture
+        {
+            RenderGraphTextureDesc  desc    = {};
+            Texture*                texture = nullptr;
+            TextureView*            view    = nullptr;
+            bool                    owned   = false;
+            RenderGraphTextureState state   = {}; // 最後に記録した使用の状態 (フレームを跨いで保持する)
+        };
+
+        // レンダーパスのキャッシュキー (パイプラインの互換性はフォーマットのみで決まるので、ロード操作が異なるパスも同じパイプラインを使用できる)
+        struct RenderPassKey
+        {
+            std::vector<RenderingFormat>  formats = {};
+            std::vector<AttachmentLoadOp> loadOps = {};
+
+            bool operator==(const RenderPassKey& other) const
+            {
+                return formats == other.formats && loadOps == other.loadOps;
+            }
+        };
+
+        void              _CullPasses();
+        void              _AllocatePhysicalTextures();
+        uint32            _AcquirePhysicalTexture(const RenderGraphTextureDesc& desc, std::vector<uint32>& freeList);
+        bool              _CreatePassTargets();
+        RenderPassHandle* _FindOrCreateRenderPass(const RenderPassKey& key);
+
+        // 使用前の状態遷移をバリアとして追加する (読み取り同士など、不要な場合は追加しない)
+        void _TransitionTexture(uint32 physical, const RenderGraphTextureState& next, bool discard, PipelineStageFlags& out_srcStage, PipelineStageFlags& out_dstStage);
+        void _FlushBarriers(CommandBufferHandle* commandBuffer, PipelineStageFlags srcStage, PipelineStageFlags dstStage);
+        void _DestroyPhysicalTexture(PhysicalTexture& physical);
+
+    private:
+
+        RenderingAPI* api = nullptr;
+
+        std::vector<TextureResource> textures  = {};
+        std::vector<Pass>            passes    = {};
+        std::vector<PhysicalTexture> physicals = {};
+
+        // 前回の構築で確保し、まだ再利用されていない物理テクスチャ (次の Compile で再利用されなければ破棄する)
+        std::vector<PhysicalTexture> retired = {};
+
+        std::vector<std::pair<RenderPassKey, RenderPassHandle*>> renderPassCache = {};
+
+        // 記録中のバリア (Execute 内で使い回す)
+        std::vector<TextureBarrierInfo> pendingBarriers = {};
+
+        RenderGraphStats stats   = {};
+        bool             invalid = true;
+    };
+}
@@ -8,6 +8,7 @@
 #include "Rendering/RenderingContext.h"
 #include "Rendering/RenderingAPI.h"
 #include "Rendering/RenderingUtility.h"
+#include "Rendering/UploadManager.h"
 #include "Rendering/Mesh.h"
 
 #include <imgui/imgui_internal.h>
@@ -31,17 +32,26 @@ namespace Silex
     {
         api->WaitDevice();
 
+        uploader->Finalize();
+        sldelete(uploader);
+
+        DestroyBuffer(dynamicUniformBuffer);
+        DestroySampler(bindlessSampler);
+
         for (uint32 i = 0; i < frameData.size(); i++)
         {
             _DestroyPendingResources(i);
 
             api->DestroyCommandBuffer(frameData[i].commandBuffer);
+            api->DestroyCommandBuffer(frameData[i].uploadCommandBuffer);
             api->DestroyCommandPool(frameData[i].commandPool);
             api->DestroySemaphore(frameData[i].presentSemaphore);
             api->DestroySemaphore(frameData[i].renderSemaphore);
             api->DestroyFence(frameData[i].fence);
+            api->DestroyQueryPool(frameData[i].timestampPool);
 
             sldelete(frameData[i].pendingResources);
+            sldelete(frameData[i].frameAllocator);
         }
 
         api->DestroyCommandBuffer(immidiateContext.commandBuffer);
@@ -71,6 +81,10 @@ namespace Silex
         // コマンドキュー生成
         graphicsQueue = api->CreateCommandQueue(graphicsQueueID);
         SL_CHECK(!graphicsQueue, false);
+
+        // 非同期アップロード (転送専用のキューファミリがあれば、そちらに送信する)
+        uploader = slnew(UploadManager);
+        SL_CHECK(!uploader->Initialize(api, graphicsQueueID, uploadStagingSize), false);
       
         // フレームデータ生成
         frameData.resize(numFramesInFlight);
@@ -78,6 +92,10 @@ namespace Silex
         {
             frameData[i].pendingResources = slnew(PendingDestroyResourceQueue);
 
+            // フレームアロケータ生成
+            frameData[i].frameAllocator = slnew(LinearAllocator);
+            frameData[i].frameAllocator->Initialize(frameAllocatorSize);
+
             // コマンドプール生成
             frameData[i].commandPool = api->CreateCommandPool(graphicsQueueID);
             SL_CHECK(!frameData[i].commandPool, false);
@@ -86,6 +104,9 @@ namespace Silex
             frameData[i].commandBuffer = api->CreateCommandBuffer(frameData[i].commandPool);
             SL_CHECK(!frameData[i].commandBuffer, false);
 
+            frameData[i].uploadCommandBuffer = api->CreateCommandBuffer(frameData[i].commandPool);
+            SL_CHECK(!frameData[i].uploadCommandBuffer, false);
+
             // セマフォ生成
             frameData[i].presentSemaphore = api->CreateSemaphore();
             SL_CHECK(!frameData[i].presentSemaphore, false);
@@ -96,6 +117,13 @@ namespace Silex
             // フェンス生成
             frameData[i].fence = api->CreateFence();
             SL_CHECK(!frameData[i].fence, false);
+
+            // タイムスタンプクエリ生成 (非対応デバイスでは計測しない)
+            if (api->GetTimestampPeriod() > 0.0)
+            {
+                frameData[i].timestampPool = api->CreateQueryPool(QUERY_TYPE_TIMESTAMP, maxGPUTimestampZone * 2);
+                frameData[i].timestampNames.reserve(maxGPUTimestampZone);
+            }
         }
 
         // 即時コマンドデータ
@@ -108,6 +136,17 @@ namespace Silex
         immidiateContext.fence = api->CreateFence();
         SL_CHECK(!immidiateContext.fence, false);
 
+        // 動的ユニフォームバッファ生成
+        dynamicUniformBuffer = CreateDynamicUniformBuffer(dynamicUniformBufferSize);
+        SL_CHECK(!dynamicUniformBuffer, false);
+
+        // バインドレステーブル (マテリアルテクスチャは全て同一のサンプラーで参照する)
+        bindlessTextureSlots.Initialize(BINDLESS_TEXTURE_CAPACITY);
+        bindlessBufferSlots.Initialize(BINDLESS_BUFFER_CAPACITY);
+
+        bindlessSampler = CreateSampler(SAMPLER_FILTER_LINEAR, SAMPLER_REPEAT_MODE_REPEAT);
+        SL_CHECK(!bindlessSampler, false);
+
         return true;
     }
 
@@ -125,11 +164,33 @@ namespace Silex
             SL_CHECK(!result, false);
 
             frameData[frameIndex].waitingSignal = false;
+
+            // 待機済みなので、このフレームで前回記録したタイムスタンプは揃っている
+            _ResolveGPUTimestamps(frameIndex);
         }
 
         // 削除キュー実行
         _DestroyPendingResources(frameIndex);
 
+        // フレームアロケータ・動的ユニフォームバッファのリセット (GPU 待機後なので、このフレームで前回確保したメモリは参照されていない)
+        frame.frameAllocator->Reset();
+        dynamicUniformBuffer->Reset(frameIndex);
+
+        // 前フレーム以降のアップロードを送信し、転送が完了したものの所有権をグラフィックスキューで取得する
+        // (取得コマンドはフレームのコマンドバッファより先に送信されるので、このフレームから使用できる)
+        uploader->Flush();
+        uploader->Retire(false);
+
+        if (uploader->HasPendingAcquire())
+        {
+            api->BeginCommandBuffer(frame.uploadCommandBuffer);
+            uploader->RecordAcquire(frame.uploadCommandBuffer);
+            api->EndCommandBuffer(frame.uploadCommandBuffer);
+
+            result = api->SubmitQueueWithTimeline(graphicsQueue, frame.uploadCommandBuffer, nullptr, 0);
+            SL_CHECK(!result, false);
+        }
+
         // 描画先スワップチェインバッファを取得
         auto [fb, view] = api->GetCurrentBackBuffer(Window::Get()->GetSwapChain(), frame.presentSemaphore);
         currentSwapchainFramebuffer = fb;
@@ -155,10 +216,11 @@ namespace Silex
     {
         // RGBA8_UNORM フォーマットテクスチャ
         TextureHandle* gpuTexture = _CreateTexture(TEXTURE_DIMENSION_2D, TEXTURE_TYPE_2D, RENDERING_FORMAT_R8G8B8A8_UNORM, width, height, 1, 1, genMipmap, TEXTURE_USAGE_COPY_DST_BIT);
-        _SubmitTextureData(gpuTexture, width, height, genMipmap, pixelData, dataSize);
+        UploadToken    token      = _SubmitTextureData(gpuTexture, width, height, genMipmap, pixelData, dataSize);
 
         Texture2D* texture = slnew(Texture2D, numFramesInFlight);
         texture->SetHandle(gpuTexture, 0);
+        texture->uploadToken = token;
 
         return texture;
     }
@@ -167,10 +229,36 @@ namespace Silex
     {
         // RGBA16_SFLOAT フォーマットテクスチャ
         TextureHandle* gpuTexture = _CreateTexture(TEXTURE_DIMENSION_2D, TEXTURE_TYPE_2D, RENDERING_FORMAT_R16G16B16A16_SFLOAT, width, height, 1, 1, genMipmap, TEXTURE_USAGE_COPY_DST_BIT);
-        _SubmitTextureData(gpuTexture, width, height, genMipmap, pixelData, dataSize);
+        UploadToken    token      = _SubmitTextureData(gpuTexture, width, height, genMipmap, pixelData, dataSize);
 
         Texture2D* texture = slnew(Texture2D, numFramesInFlight);
         texture->SetHandle(gpuTexture, 0);
+        texture->uploadToken = token;
+
+        return texture;
+    }
+
+    Texture2D* Renderer::CreateTextureFromMemory(RenderingFormat format, const void* pixelData, uint64 dataSize, uint32 width, uint32 height, uint32 numMip, const uint64* mipOffsets)
+    {
+        // 圧縮フォーマットはカラーアタッチメント・ブリットに使用できないので、サンプリングとコピー先のみ
+        TextureInfo texformat = {};
+        texformat.format    = format;
+        texformat.width     = width;
+        texformat.height    = height;
+        texformat.dimension = TEXTURE_DIMENSION_2D;
+        texformat.type      = TEXTURE_TYPE_2D;
+        texformat.usageBits = TEXTURE_USAGE_SAMPLING_BIT | TEXTURE_USAGE_COPY_DST_BIT;
+        texformat.samples   = TEXTURE_SAMPLES_1;
+        texformat.array     = 1;
+        texformat.depth     = 1;
+        texformat.mipLevels = numMip;
+
+        TextureHandle* gpuTexture = api->CreateTexture(texformat);
+        UploadToken    token      = uploader->UploadTexture(gpuTexture, width, height, numMip, mipOffsets, pixelData, dataSize);
+
+        Texture2D* texture = slnew(Texture2D, numFramesInFlight);
+        texture->SetHandle(gpuTexture, 0);
+        texture->uploadToken = token;
 
         return texture;
     }
@@ -206,6 +294,12 @@ namespace Silex
     {
         FrameData& frame = frameData[frameIndex];
 
+        if (texture->bindlessView)
+        {
+            frame.pendingResources->bindlessTexture.push_back(texture->bindlessIndex);
+            DestroyTextureView(texture->bindlessView);
+        }
+
         TextureHandle* h = texture->GetHandle();
         frame.pendingResources->texture.push_back(h);
 
@@ -292,64 +386,11 @@ namespace Silex
         return api->CreateTexture(texformat);
     }
 
-    void Renderer::_SubmitTextureData(TextureHandle* texture, uint32 width, uint32 height, bool genMipmap, const void* pixelData, uint64 dataSize)
+    UploadToken Renderer::_SubmitTextureData(TextureHandle* texture, uint32 width, uint32 height, bool genMipmap, const void* pixelData, uint64 dataSize)
     {
-        // ステージングバッファ
-        BufferHandle* staging = api->CreateBuffer(dataSize, BUFFER_USAGE_TRANSFER_SRC_BIT, MEMORY_ALLOCATION_TYPE_CPU);
-
-        // ステージングにテクスチャデータをコピー
-        void* mappedPtr = api->MapBuffer(staging);
-        std::memcpy(mappedPtr, pixelData, dataSize);
-        api->UnmapBuffer(staging);
-
-        // コピーコマンド
-        ImmidiateExcute([&](CommandBufferHandle* cmd)
-        {
-            TextureSubresourceRange range = {};
-            range.aspect = TEXTURE_ASPECT_COLOR_BIT;
-
-            TextureBarrierInfo info = {};
-            info.texture      = texture;
-            info.subresources = range;
-            info.srcAccess    = BARRIER_ACCESS_MEMORY_WRITE_BIT;
-            info.dstAccess    = BARRIER_ACCESS_MEMORY_WRITE_BIT;
-            info.oldLayout    = TEXTURE_LAYOUT_UNDEFINED;
-            info.newLayout    = TEXTURE_LAYOUT_TRANSFER_DST_OPTIMAL;
-
-            api->Cmd_PipelineBarrier(cmd, PIPELINE_STAGE_ALL_COMMANDS_BIT, PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, nullptr, 0, nullptr, 1, &info);
-
-            TextureSubresource subresource = {};
-            subresource.aspect     = TEXTURE_ASPECT_COLOR_BIT;
-
-            BufferTextureCopyRegion region = {};
-            region.bufferOffset        = 0;
-            region.textureOffset       = { 0, 0, 0 };
-            region.textureRegionSize   = { width, height, 1 };
-            region.textureSubresources = subresource;
-
-            api->Cmd_CopyBufferToTexture(cmd, staging, texture, TEXTURE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
-
-            if (genMipmap)
-            {
-                // ミップマップ生成
-                _GenerateMipmaps(cmd, texture, width, height, 1, 1, TEXTURE_ASPECT_COLOR_BIT);
-
-                // シェーダーリードに移行 (ミップマップ生成時のコピーでコピーソースに移行するため、コピーソース -> シェーダーリード)
-                info.oldLayout = TEXTURE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-                info.newLayout = TEXTURE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-                api->Cmd_PipelineBarrier(cmd, PIPELINE_STAGE_ALL_COMMANDS_BIT, PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, nullptr, 0, nullptr, 1, &info);
-            }
-            else
-            {
-                // シェーダーリードに移行 (バッファからの転送でレイアウト変更がないため、コピー先 -> シェーダーリード)
-                info.oldLayout = TEXTURE_LAYOUT_TRANSFER_DST_OPTIMAL;
-                info.newLayout = TEXTURE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-                api->Cmd_PipelineBarrier(cmd, PIPELINE_STAGE_ALL_COMMANDS_BIT, PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, nullptr, 0, nullptr, 1, &info);
-            }
-        });
-
-        // ステージング破棄
-        api->DestroyBuffer(staging);
+        // ステージングリングへのコピーと転送コマンドの記録のみ行い、完了は待たない
+        // (ミップマップ生成とシェーダーリードへの移行は、転送完了後にグラフィックスキューで行われる)
+        return uploader->UploadTexture(texture, width, height, genMipmap, pixelData, dataSize);
     }
     
     void Renderer::_GenerateMipmaps(CommandBufferHandle* cmd, TextureHandle* texture, uint32 width, uint32 height, uint32 depth, uint32 array, TextureAspectFlags aspect)
@@ -451,24 +492,63 @@ namespace Silex
         return buffer;
     }
 
-    BufferHandle* Renderer::CreateStorageBuffer(void* data, uint64 size)
+    StorageBuffer* Renderer::CreateStorageBuffer(void* data, uint64 size)
     {
-        //StorageBuffer* buffer = slnew(StorageBuffer, numFramesInFlight);
-        //for (uint32 i = 0; i < numFramesInFlight; i++)
-        //{
-        //    void* mapped = nullptr;
-        //    BufferHandle* h = _CreateAndMapBuffer(BUFFER_USAGE_STORAGE_BIT, data, size, &mapped);
-        //    buffer->handle[i] = h;
-        //    buffer->mappedPtr = mapped;
-        //}
+        StorageBuffer* buffer = slnew(StorageBuffer, numFramesInFlight);
+        for (uint32 i = 0; i < numFramesInFlight; i++)
+        {
+            void* mapped = nullptr;
+            BufferHandle* h = _CreateAndMapBuffer(BUFFER_USAGE_STORAGE_BIT, data, size, &mapped);
+            buffer->SetHandle(h, i);
+        }
+
+        return buffer;
+    }
+
+    DynamicUniformBuffer* Renderer::CreateDynamicUniformBuffer(uint64 sizePerFrame)
+    {
+        DynamicUniformBuffer* buffer = slnew(DynamicUniformBuffer, numFramesInFlight);
+        buffer->capacity  = sizePerFrame;
+        buffer->alignment = api->GetMinUniformBufferOffsetAlignment();
+
+        // 全フレーム分を永続マップしておき、確保時はコピーのみ行う
+        for (uint32 i = 0; i < numFramesInFlight; i++)
+        {
+            void* mapped = nullptr;
+            BufferHandle* h = _CreateAndMapBuffer(BUFFER_USAGE_UNIFORM_BIT, nullptr, sizePerFrame, &mapped);
+            buffer->SetHandle(h, i);
+            buffer->mappedPointers[i] = (uint8*)mapped;
+        }
+
+        return buffer;
+    }
+
+    BufferHandle* Renderer::CreateIndirectBuffer(void* data, uint64 size)
+    {
+        // CPU から毎フレーム書き込むので、マップしたまま保持する
+        return _CreateAndMapBuffer(BUFFER_USAGE_INDIRECT_BIT, data, size, nullptr);
+    }
+
+    BufferHandle* Renderer::CreateDeviceBuffer(void* data, uint64 size, BufferUsageFlags usage)
+    {
+        // GPU からのみ読み書きするバッファ (コンピュートシェーダーの出力など) / 初期データがあれば転送する
+        // ハンドルのみを返すので、転送の完了まで待機する
+        if (data != nullptr)
+        {
+            UploadToken token;
+            BufferHandle* buffer = _CreateAndSubmitBufferData(usage, data, size, &token);
+            WaitUpload(token);
+
+            return buffer;
+        }
 
-        return _CreateAndMapBuffer(BUFFER_USAGE_STORAGE_BIT, data, size, nullptr);
+        return api->CreateBuffer(size, usage | BUFFER_USAGE_TRANSFER_DST_BIT, MEMORY_ALLOCATION_TYPE_GPU);
     }
 
     VertexBuffer* Renderer::CreateVertexBuffer(void* data, uint64 size)
     {
         VertexBuffer* buffer = slnew(VertexBuffer, numFramesInFlight);
-        BufferHandle* h = _CreateAndSubmitBufferData(BUFFER_USAGE_VERTEX_BIT, data, size);
+        BufferHandle* h = _CreateAndSubmitBufferData(BUFFER_USAGE_VERTEX_BIT, data, size, &buffer->uploadToken);
         buffer->SetHandle(h, 0);
 
         return buffer;
@@ -477,7 +557,7 @@ namespace Silex
     IndexBuffer* Renderer::CreateIndexBuffer(void* data, uint64 size)
     {
         IndexBuffer* buffer = slnew(IndexBuffer, numFramesInFlight);
-        BufferHandle* h = _CreateAndSubmitBufferData(BUFFER_USAGE_INDEX_BIT, data, size);
+        BufferHandle* h = _CreateAndSubmitBufferData(BUFFER_USAGE_INDEX_BIT, data, size, &buffer->uploadToken);
         buffer->SetHandle(h, 0);
 
         return buffer;
@@ -524,24 +604,14 @@ namespace Silex
         return buffer;
     }
 
-    BufferHandle* Renderer::_CreateAndSubmitBufferData(BufferUsageFlags type, const void* data, uint64 dataSize)
+    BufferHandle* Renderer::_CreateAndSubmitBufferData(BufferUsageFlags type, const void* data, uint64 dataSize, UploadToken* outToken)
     {
-        BufferHandle* buffer  = api->CreateBuffer(dataSize, type | BUFFER_USAGE_TRANSFER_DST_BIT, MEMORY_ALLOCATION_TYPE_GPU);
-        BufferHandle* staging = api->CreateBuffer(dataSize, type | BUFFER_USAGE_TRANSFER_SRC_BIT, MEMORY_ALLOCATION_TYPE_CPU);
-        
-        void* mapped = api->MapBuffer(staging);
-        std::memcpy(mapped, data, dataSize);
-        api->UnmapBuffer(staging);
-
-        ImmidiateExcute([&](CommandBufferHandle* cmd)
-        {
-            BufferCopyRegion region = {};
-            region.size = dataSize;
+        // 統合バッファ (GeometryBuffer) へのバッファ間コピー元にもなるので、転送元としても使用できるようにする
+        BufferHandle* buffer = api->CreateBuffer(dataSize, type | BUFFER_USAGE_TRANSFER_DST_BIT | BUFFER_USAGE_TRANSFER_SRC_BIT, MEMORY_ALLOCATION_TYPE_GPU);
+        UploadToken   token  = uploader->UploadBuffer(buffer, data, dataSize);
 
-            api->Cmd_CopyBuffer(cmd, staging, buffer, 1, &region);
-        });
-
-        api->DestroyBuffer(staging);
+        if (outToken != nullptr)
+            *outToken = token;
 
         return buffer;
     }
@@ -592,6 +662,51 @@ namespace Silex
 
 
 
+    uint32 Renderer::RegisterBindlessTexture(Texture2D* texture)
+    {
+        if (texture->bindlessView)
+            return texture->bindlessIndex;
+
+        // 転送中のテクスチャは登録しない (呼び出し側はデフォルトテクスチャで代替し、次フレーム以降に再登録する)
+        if (!uploader->IsComplete(texture->uploadToken))
+            return RENDER_INVALID_ID;
+
+        uint32 index = bindlessTextureSlots.Allocate();
+        if (index == IndexAllocator::InvalidIndex)
+        {
+            SL_LOG_LOCATION_ERROR("バインドレステクスチャのスロットが不足しています");
+            return RENDER_INVALID_ID;
+        }
+
+        texture->bindlessView  = CreateTextureView(texture, TEXTURE_TYPE_2D, TEXTURE_ASPECT_COLOR_BIT);
+        texture->bindlessIndex = index;
+
+        api->UpdateBindlessTexture(index, texture->bindlessView->GetHandle(), bindlessSampler->GetHandle());
+        return index;
+    }
+
+    uint32 Renderer::RegisterBindlessBuffer(BufferHandle* buffer)
+    {
+        uint32 index = bindlessBufferSlots.Allocate();
+        if (index == IndexAllocator::InvalidIndex)
+        {
+            SL_LOG_LOCATION_ERROR("バインドレスバッファのスロットが不足しています");
+            return RENDER_INVALID_ID;
+        }
+
+        api->UpdateBindlessBuffer(index, buffer);
+        return index;
+    }
+
+    void Renderer::UnregisterBindlessBuffer(uint32 index)
+    {
+        if (index == RENDER_INVALID_ID)
+            return;
+
+        FrameData& frame = frameData[frameIndex];
+        frame.pendingResources->bindlessBuffer.push_back(index);
+    }
+
     SwapChainHandle* Renderer::CreateSwapChain(SurfaceHandle* surface, uint32 width, uint32 height, VSyncMode mode)
     {
         return api->CreateSwapChain(surface, width, height, numSwapchainFrameBuffer, mode);
@@ -613,7 +728,7 @@ namespace Silex
         FrameData& frame = frameData[frameIndex];
 
         bool result = api->Present(graphicsQueue, swapchain, frame.renderSemaphore);
-        frameIndex = (frameIndex + 1) % 2;
+        frameIndex = (frameIndex + 1) % numFramesInFlight;
 
         return result;
     }
@@ -634,7 +749,94 @@ namespace Silex
 
     void Renderer::ImmidiateExcute(std::function<void(CommandBufferHandle*)>&& func)
     {
-        api->ImmidiateCommands(graphicsQueue, immidiateContext.commandBuffer, immidiateContext.fence, std::move(func));
+        // 即時コマンドはアップロード済みのリソースを参照することが多いので、記録済みの転送を全て完了させてから
+        // 所有権の取得を同じコマンドバッファの先頭に記録する
+        uploader->Flush();
+        uploader->Retire(true);
+
+        api->ImmidiateCommands(graphicsQueue, immidiateContext.commandBuffer, immidiateContext.fence, [&](CommandBufferHandle* cmd)
+        {
+            uploader->RecordAcquire(cmd);
+            func(cmd);
+        });
+    }
+
+    bool Renderer::IsUploadComplete(UploadToken token) const
+    {
+        return uploader->IsComplete(token);
+    }
+
+    void Renderer::WaitUpload(UploadToken token)
+    {
+        if (uploader->IsComplete(token))
+            return;
+
+        // 空の即時コマンドで 転送完了の待機と所有権の取得を行う
+        ImmidiateExcute([](CommandBufferHandle* cmd) {});
+    }
+
+    uint32 Renderer::BeginGPUTimestamp(const char* name)
+    {
+        FrameData& frame = frameData[frameIndex];
+
+        if (!frame.timestampPool || frame.timestampNames.size() >= maxGPUTimestampZone)
+            return RENDER_INVALID_ID;
+
+        // フレーム内の最初の区間でクエリをリセット
+        if (frame.timestampNames.empty())
+        {
+            api->Cmd_ResetQueryPool(frame.commandBuffer, frame.timestampPool, 0, maxGPUTimestampZone * 2);
+        }
+
+        uint32 zoneIndex = frame.timestampNames.size();
+        frame.timestampNames.push_back(name);
+
+        api->Cmd_WriteTimestamp(frame.commandBuffer, frame.timestampPool, PIPELINE_STAGE_TOP_OF_PIPE_BIT, zoneIndex * 2);
+        return zoneIndex;
+    }
+
+    void Renderer::EndGPUTimestamp(uint32 zoneIndex)
+    {
+        FrameData& frame = frameData[frameIndex];
+
+        if (zoneIndex == RENDER_INVALID_ID)
+            return;
+
+        api->Cmd_WriteTimestamp(frame.commandBuffer, frame.timestampPool, PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, zoneIndex * 2 + 1);
+    }
+
+    const std::vector<GPUTimestampResult>& Renderer::GetGPUTimestampResults() const
+    {
+        return gpuTimestampResults;
+    }
+
+    void Renderer::_ResolveGPUTimestamps(uint32 frame)
+    {
+        FrameData& f = frameData[frame];
+
+        if (!f.timestampPool || f.timestampNames.empty())
+            return;
+
+        const uint32 numQuery = f.timestampNames.size() * 2;
+        const double period   = api->GetTimestampPeriod();
+
+        uint64* ticks = SL_STACK(uint64, numQuery);
+        if (api->GetQueryResults(f.timestampPool, 0, numQuery, ticks))
+        {
+            gpuTimestampResults.clear();
+
+            for (uint32 i = 0; i < f.timestampNames.size(); i++)
+            {
+                uint64 begin = ticks[i * 2 + 0];
+                uint64 end   = ticks[i * 2 + 1];
+
+                // タイムスタンプ (ナノ秒 = カウント * period) をミリ秒に変換
+                float milliseconds = end > begin? (float)((double)(end - begin) * period / 1'000'000.0) : 0.0f;
+                gpuTimestampResults.push_back({ f.timestampNames[i], milliseconds });
+            }
+        }
+
+        f.timestampNames.clear();
     }
 
     void Renderer::_DestroyPendingResources(uint32 frame)
@@ -696,6 +898,20 @@ namespace Silex
         }
 
         f.pendingResources->pipeline.clear();
+
+        for (uint32 index : f.pendingResources->bindlessTexture)
+        {
+            bindlessTextureSlots.Free(index);
+        }
+
+        f.pendingResources->bindlessTexture.clear();
+
+        for (uint32 index : f.pendingResources->bindlessBuffer)
+        {
+            bindlessBufferSlots.Free(index);
+        }
+
+        f.pendingResources->bindlessBuffer.clear();
     }
 
     const DeviceInfo& Renderer::GetDeviceInfo() const
@@ -728,6 +944,16 @@ namespace Silex
         return numFramesInFlight;
     }
 
+    LinearAllocator* Renderer::GetFrameAllocator() const
+    {
+        return frameData[frameIndex].frameAllocator;
+    }
+
+    DynamicUniformBuffer* Renderer::GetDynamicUniformBuffer() const
+    {
+        return dynamicUniformBuffer;
+    }
+
     CommandQueueHandle* Renderer::GetGraphicsCommandQueue() const
     {
         return graphicsQueue;
@@ -1,6 +1,8 @@
 
 #pragma once
 
+#include "Core/LinearAllocator.h"
+#include "Core/IndexAllocator.h"
 #include "Scene/Camera.h"
 #include "Rendering/ShaderCompiler.h"
 #include "Rendering/RenderingStructures.h"
@@ -10,6 +12,7 @@ namespace Silex
 {
     class RenderingAPI;
     class RenderingContext;
+    class UploadManager;
 
 
     // 削除待機リソース
@@ -23,6 +26,10 @@ namespace Silex
         std::vector<FramebufferHandle*>   framebuffer;
         std::vector<ShaderHandle*>        shader;
         std::vector<PipelineHandle*>      pipeline;
+
+        // バインドレステーブルのスロット (GPU が参照しなくなってから再利用する)
+        std::vector<uint32>               bindlessTexture;
+        std::vector<uint32>               bindlessBuffer;
     };
 
     // フレームデータ
@@ -35,6 +42,21 @@ namespace Silex
         FenceHandle*                 fence            = nullptr;
         bool                         waitingSignal    = false;
         PendingDestroyResourceQueue* pendingResources = nullptr;
+        LinearAllocator*             frameAllocator   = nullptr;
+
+        // 非同期アップロードの所有権取得用 (フレームのコマンドバッファより先に送信する)
+        CommandBufferHandle*         uploadCommandBuffer = nullptr;
+
+        // GPU タイムスタンプ (区間 i の開始クエリは 2i, 終了クエリは 2i + 1)
+        QueryPoolHandle*             timestampPool    = nullptr;
+        std::vector<const char*>     timestampNames   = {};
+    };
+
+    // GPU 区間計測結果
+    struct GPUTimestampResult
+    {
+        const char* name         = nullptr;
+        float       milliseconds = 0.0f;
     };
 
     // 即時コマンドデータ
@@ -50,6 +72,7 @@ namespace Silex
     class Renderer : public Class
     {
         friend class SceneRenderer;
+        friend class UploadManager;
 
         SL_CLASS(Renderer, Class);
 
@@ -85,6 +108,12 @@ namespace Silex
         uint32           GetCurrentFrameIndex()  const;
         uint32           GetFrameCountInFlight() const;
 
+        // フレームアロケータ (BeginFrame でリセットされる、現在フレーム内でのみ有効な一時メモリ)
+        LinearAllocator* GetFrameAllocator() const;
+
+        // 動的ユニフォームバッファ (BeginFrame でリセットされる、フレーム毎の定数用リングバッファ)
+        DynamicUniformBuffer* GetDynamicUniformBuffer() const;
+
         // デバイス情報
         const DeviceInfo& GetDeviceInfo() const;
 
@@ -96,6 +125,9 @@ namespace Silex
         Texture2D* CreateTextureFromMemory(const uint8* pixelData, uint64 dataSize, uint32 width, uint32 height, bool genMipmap);
         Texture2D* CreateTextureFromMemory(const float* pixelData, uint64 dataSize, uint32 width, uint32 height, bool genMipmap);
 
+        // 生成済みのミップチェーン (BC 圧縮フォーマット等, mipOffsets: pixelData 内の各ミップの位置)
+        Texture2D* CreateTextureFromMemory(RenderingFormat format, const void* pixelData, uint64 dataSize, uint32 width, uint32 height, uint32 numMip, const uint64* mipOffsets);
+
         // レンダーテクスチャ
         Texture2D*      CreateTexture2D(RenderingFormat format, uint32 width, uint32 height, bool genMipmap = false, TextureUsageFlags additionalFlags = 0);
         Texture2DArray* CreateTexture2DArray(RenderingFormat format, uint32 width, uint32 height, uint32 array, bool genMipmap = false, TextureUsageFlags additionalFlags = 0);
@@ -111,14 +143,17 @@ namespace Silex
         void     DestroySampler(Sampler* sampler);
 
         // バッファ
-        Buffer*        CreateBuffer(void* data, uint64 size);
-        UniformBuffer* CreateUniformBuffer(void* data, uint64 size);
-        BufferHandle*  CreateStorageBuffer(void* data, uint64 size);
-        VertexBuffer*  CreateVertexBuffer(void* data, uint64 size);
-        IndexBuffer*   CreateIndexBuffer(void* data, uint64 size);
-        void*          GetMappedPointer(BufferHandle* buffer);
-        void           DestroyBuffer(Buffer* buffer);
-        bool           UpdateBufferData(BufferHandle* buffer, const void* data, uint32 dataByte);
+        Buffer*               CreateBuffer(void* data, uint64 size);
+        UniformBuffer*        CreateUniformBuffer(void* data, uint64 size);
+        StorageBuffer*        CreateStorageBuffer(void* data, uint64 size);
+        DynamicUniformBuffer* CreateDynamicUniformBuffer(uint64 sizePerFrame);
+        BufferHandle*         CreateIndirectBuffer(void* data, uint64 size);
+        BufferHandle*         CreateDeviceBuffer(void* data, uint64 size, BufferUsageFlags usage);
+        VertexBuffer*         CreateVertexBuffer(void* data, uint64 size);
+        IndexBuffer*          CreateIndexBuffer(void* data, uint64 size);
+        void*                 GetMappedPointer(BufferHandle* buffer);
+        void                  DestroyBuffer(Buffer* buffer);
+        bool                  UpdateBufferData(BufferHandle* buffer, const void* data, uint32 dataByte);
 
         // フレームバッファ
         FramebufferHandle* CreateFramebuffer(RenderPassHandle* renderpass, uint32 numTexture, TextureHandle** textures, uint32 width, uint32 height);
@@ -129,6 +164,12 @@ namespace Silex
         void           DestroyDescriptorSet(DescriptorSet* set);
         void           UpdateDescriptorSet(DescriptorSetHandle* set, DescriptorSetInfo& setInfo);
 
+        // バインドレス (戻り値はシェーダーから参照するテーブル内インデックス / 失敗時は RENDER_INVALID_ID)
+        // テクスチャは初回登録時にスロットを確保し、DestroyTexture で解放する (アップロード完了前は RENDER_INVALID_ID)
+        uint32 RegisterBindlessTexture(Texture2D* texture);
+        uint32 RegisterBindlessBuffer(BufferHandle* buffer);
+        void   UnregisterBindlessBuffer(uint32 index);
+
         // スワップチェイン
         SwapChainHandle* CreateSwapChain(SurfaceHandle* surface, uint32 width, uint32 height, VSyncMode mode);
         bool             ResizeSwapChain(SwapChainHandle* swapchain, uint32 width, uint32 height, VSyncMode mode);
@@ -137,8 +178,21 @@ namespace Silex
         void             BeginSwapChainPass();
         void             EndSwapChainPass();
 
-        // 即時コマンド
+        // 即時コマンド (送信前に 記録済みの非同期アップロードの完了を待機する)
         void ImmidiateExcute(std::function<void(CommandBufferHandle*)>&& func);
+
+        // 非同期アップロード (テクスチャ・頂点/インデックスバッファの生成時に発行されたトークンで完了を判定する)
+        // 完了していないリソースは、そのフレームでは使用しないこと
+        bool IsUploadComplete(UploadToken token) const;
+        void WaitUpload(UploadToken token);
+
+        // GPU 区間計測 (現在フレームのコマンドバッファに記録する)
+        // クエリのリセットを行うので、フレーム内の最初の区間はレンダーパス外で開始すること
+        uint32 BeginGPUTimestamp(const char* name);
+        void   EndGPUTimestamp(uint32 zoneIndex);
+
+        // 完了済みフレーム (フレームインフライト数だけ前のフレーム) の GPU 区間計測結果
+        const std::vector<GPUTimestampResult>& GetGPUTimestampResults() const;
     
     public:
 
@@ -160,26 +214,47 @@ namespace Silex
     private:
 
         BufferHandle* _CreateAndMapBuffer(BufferUsageFlags type, const void* data, uint64 dataSize, void** outMappedPtr);
-        BufferHandle* _CreateAndSubmitBufferData(BufferUsageFlags type, const void* data, uint64 dataSize);
+        BufferHandle* _CreateAndSubmitBufferData(BufferUsageFlags type, const void* data, uint64 dataSize, UploadToken* outToken = nullptr);
 
         TextureHandle* _CreateTexture(TextureDimension dimension, TextureType type, RenderingFormat format, uint32 width, uint32 height, uint32 depth, uint32 array, bool genMipmap, TextureUsageFlags additionalFlags);
-        void           _SubmitTextureData(TextureHandle* texture, uint32 width, uint32 height, bool genMipmap, const void* pixelData, uint64 dataSize);
+        UploadToken    _SubmitTextureData(TextureHandle* texture, uint32 width, uint32 height, bool genMipmap, const void* pixelData, uint64 dataSize);
         void           _GenerateMipmaps(CommandBufferHandle* cmd, TextureHandle* texture, uint32 width, uint32 height, uint32 depth, uint32 array, TextureAspectFlags aspect);
 
         // リソース解放処理
         void _DestroyPendingResources(uint32 frame);
 
+        // GPU タイムスタンプの読み取り (フェンス待機後に呼び出す)
+        void _ResolveGPUTimestamps(uint32 frame);
+
     private:
 
         // 定数
-        uint32 numSwapchainFrameBuffer = 3;
-        uint32 numFramesInFlight       = 2;
+        uint32 numSwapchainFrameBuffer  = 3;
+        uint32 numFramesInFlight        = 2;
+        uint64 frameAllocatorSize       = 4 * 1024 * 1024;
+        uint64 dynamicUniformBufferSize = 4 * 1024 * 1024;
+        uint64 uploadStagingSize        = 64 * 1024 * 1024;
+        uint32 maxGPUTimestampZone      = 32;
 
         // フレームデータ
         ImmidiateCommandData   immidiateContext = {};
         std::vector<FrameData> frameData        = {};
         uint64                 frameIndex       = 0;
 
+        // GPU 区間計測結果
+        std::vector<GPUTimestampResult> gpuTimestampResults = {};
+
+        // フレーム毎の定数用リングバッファ
+        DynamicUniformBuffer* dynamicUniformBuffer = nullptr;
+
+        // 転送キューへの非同期アップロード
+        UploadManager* uploader = nullptr;
+
+        // バインドレステーブルのスロット管理
+        IndexAllocator bindlessTextureSlots = {};
+        IndexAllocator bindlessBufferSlots  = {};
+        Sampler*       bindlessSampler      = nullptr;
+
         // スワップチェイン
         FramebufferHandle* currentSwapchainFramebuffer = nullptr;
         TextureViewHandle* currentSwapchainView        = nullptr;
@@ -198,5 +273,26 @@ namespace Silex
         // インスタンス
         static inline Renderer* instance = nullptr;
     };
+
+
+    // スコープ寿命の GPU 区間計測
+    class ScopedGPUTimestamp
+    {
+    public:
+
+        ScopedGPUTimestamp(const char* name)
+        {
+            zoneIndex = Renderer::Get()->BeginGPUTimestamp(name);
+        }
+
+        ~ScopedGPUTimestamp()
+        {
+            Renderer::Get()->EndGPUTimestamp(zoneIndex);
+        }
+
+    private:
+
+        uint32 zoneIndex;
+    };
 }
 
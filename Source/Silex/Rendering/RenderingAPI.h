@@ -32,6 +32,7 @@ namespace Silex
         virtual void DestroyCommandQueue(CommandQueueHandle* queue) = 0;
         virtual QueueID QueryQueueID(QueueFamilyFlags flag, SurfaceHandle* surface = nullptr) const = 0;
         virtual bool SubmitQueue(CommandQueueHandle* queue, CommandBufferHandle* commandbuffer, FenceHandle* fence, SemaphoreHandle* present, SemaphoreHandle* render) = 0;
+        virtual bool SubmitQueueWithTimeline(CommandQueueHandle* queue, CommandBufferHandle* commandbuffer, SemaphoreHandle* timeline, uint64 signalValue) = 0;
 
         //--------------------------------------------------
         // コマンドプール
@@ -39,6 +40,9 @@ namespace Silex
         virtual CommandPoolHandle* CreateCommandPool(QueueID id, CommandBufferType type = COMMAND_BUFFER_TYPE_PRIMARY) = 0;
         virtual void DestroyCommandPool(CommandPoolHandle* pool) = 0;
 
+        // プールから割り当てた全コマンドバッファをリセットする (GPU の使用完了後に呼び出す)
+        virtual bool ResetCommandPool(CommandPoolHandle* pool) = 0;
+
         //--------------------------------------------------
         // コマンドバッファ
         //--------------------------------------------------
@@ -47,6 +51,9 @@ namespace Silex
         virtual bool BeginCommandBuffer(CommandBufferHandle* commandBuffer) = 0;
         virtual bool EndCommandBuffer(CommandBufferHandle* commandBuffer) = 0;
 
+        // レンダーパス内で実行するセカンダリコマンドバッファの記録開始 (レンダーパス・サブパスを継承する)
+        virtual bool BeginSecondaryCommandBuffer(CommandBufferHandle* commandBuffer, RenderPassHandle* renderpass, uint32 subpass = 0) = 0;
+
         //--------------------------------------------------
         // セマフォ
         //--------------------------------------------------
@@ -56,6 +63,11 @@ namespace Silex
         virtual SemaphoreHandle* CreateSemaphore() = 0;
         virtual void DestroySemaphore(SemaphoreHandle* semaphore) = 0;
 
+        // タイムラインセマフォ (単調増加するカウンター値で完了を判定する)
+        virtual SemaphoreHandle* CreateTimelineSemaphore(uint64 initialValue = 0) = 0;
+        virtual uint64 GetTimelineSemaphoreValue(SemaphoreHandle* semaphore) = 0;
+        virtual bool WaitTimelineSemaphore(SemaphoreHandle* semaphore, uint64 value) = 0;
+
         //--------------------------------------------------
         // フェンス
         //--------------------------------------------------
@@ -128,12 +140,27 @@ namespace Silex
         virtual void UpdateDescriptorSet(DescriptorSetHandle* set, uint32 numdescriptors, DescriptorInfo* descriptors) = 0;
         virtual void DestroyDescriptorSet(DescriptorSetHandle* descriptorset) = 0;
 
+        //--------------------------------------------------
+        // バインドレス
+        //--------------------------------------------------
+        virtual void UpdateBindlessTexture(uint32 index, TextureViewHandle* view, SamplerHandle* sampler) = 0;
+        virtual void UpdateBindlessBuffer(uint32 index, BufferHandle* buffer) = 0;
+
         //--------------------------------------------------
         // パイプライン
         //--------------------------------------------------
         virtual PipelineHandle* CreateGraphicsPipeline(ShaderHandle* shader, PipelineStateInfo* info, RenderPassHandle* renderpass, uint32 renderSubpass = 0, PipelineDynamicStateFlags dynamicState = DYNAMIC_STATE_NONE) = 0;
         virtual PipelineHandle* CreateComputePipeline(ShaderHandle* shader) = 0;
         virtual void DestroyPipeline(PipelineHandle* pipeline) = 0;
+        virtual PipelineCacheStats GetPipelineCacheStats() const = 0;
+
+        //--------------------------------------------------
+        // クエリ
+        //--------------------------------------------------
+        virtual QueryPoolHandle* CreateQueryPool(QueryType type, uint32 numQuery) = 0;
+        virtual void DestroyQueryPool(QueryPoolHandle* pool) = 0;
+        virtual bool GetQueryResults(QueryPoolHandle* pool, uint32 firstQuery, uint32 numQuery, uint64* outResults) = 0;
+        virtual double GetTimestampPeriod() const = 0;
 
         //--------------------------------------------------
         // コマンド
@@ -152,21 +179,32 @@ namespace Silex
         virtual void Cmd_BeginRenderPass(CommandBufferHandle* commandbuffer, RenderPassHandle* renderpass, FramebufferHandle* framebuffer, uint32 numView, TextureViewHandle** views, CommandBufferType commandBufferType = COMMAND_BUFFER_TYPE_PRIMARY) = 0;
         virtual void Cmd_EndRenderPass(CommandBufferHandle* commandbuffer) = 0;
         virtual void Cmd_NextRenderSubpass(CommandBufferHandle* commandbuffer, CommandBufferType commandBufferType) = 0;
+        virtual void Cmd_ExecuteCommands(CommandBufferHandle* commandbuffer, uint32 numCommandBuffer, CommandBufferHandle** commandBuffers) = 0;
         virtual void Cmd_SetViewport(CommandBufferHandle* commandbuffer, uint32 x, uint32 y, uint32 width, uint32 height) = 0;
         virtual void Cmd_SetScissor(CommandBufferHandle* commandbuffer, uint32 x, uint32 y, uint32 width, uint32 height) = 0;
         virtual void Cmd_ClearAttachments(CommandBufferHandle* commandbuffer, uint32 numAttachmentClear, AttachmentClear** attachmentClears, uint32 x, uint32 y, uint32 width, uint32 height) = 0;
         virtual void Cmd_BindPipeline(CommandBufferHandle* commandbuffer, PipelineHandle* pipeline) = 0;
-        virtual void Cmd_BindDescriptorSet(CommandBufferHandle* commandbuffer, DescriptorSetHandle* descriptorset, uint32 setIndex) = 0;
+        virtual void Cmd_BindDescriptorSet(CommandBufferHandle* commandbuffer, DescriptorSetHandle* descriptorset, uint32 setIndex, uint32 numDynamicOffset = 0, const uint32* dynamicOffsets = nullptr) = 0;
+        virtual void Cmd_BindBindlessDescriptorSet(CommandBufferHandle* commandbuffer, ShaderHandle* shader, uint32 setIndex) = 0;
         virtual void Cmd_Draw(CommandBufferHandle* commandbuffer, uint32 vertexCount, uint32 instanceCount, uint32 baseVertex, uint32 firstInstance) = 0;
         virtual void Cmd_DrawIndexed(CommandBufferHandle* commandbuffer, uint32 indexCount, uint32 instanceCount, uint32 firstIndex, int32 vertexOffset, uint32 firstInstance) = 0;
+        virtual void Cmd_DrawIndexedIndirect(CommandBufferHandle* commandbuffer, BufferHandle* buffer, uint64 offset, uint32 drawCount, uint32 stride) = 0;
+        virtual void Cmd_DrawIndexedIndirectCount(CommandBufferHandle* commandbuffer, BufferHandle* buffer, uint64 offset, BufferHandle* countBuffer, uint64 countBufferOffset, uint32 maxDrawCount, uint32 stride) = 0;
+        virtual void Cmd_Dispatch(CommandBufferHandle* commandbuffer, uint32 groupCountX, uint32 groupCountY, uint32 groupCountZ) = 0;
+        virtual void Cmd_DispatchIndirect(CommandBufferHandle* commandbuffer, BufferHandle* buffer, uint64 offset) = 0;
         virtual void Cmd_BindVertexBuffers(CommandBufferHandle* commandbuffer, uint32 bindingCount, BufferHandle** buffers, uint64* offsets) = 0;
         virtual void Cmd_BindVertexBuffer(CommandBufferHandle* commandbuffer, BufferHandle* buffer, uint64 offset) = 0;
         virtual void Cmd_BindIndexBuffer(CommandBufferHandle* commandbuffer, BufferHandle* buffer, IndexBufferFormat format, uint64 offset) = 0;
+        virtual void Cmd_ResetQueryPool(CommandBufferHandle* commandbuffer, QueryPoolHandle* pool, uint32 firstQuery, uint32 numQuery) = 0;
+        virtual void Cmd_WriteTimestamp(CommandBufferHandle* commandbuffer, QueryPoolHandle* pool, PipelineStageBits stage, uint32 queryIndex) = 0;
 
         //--------------------------------------------------
         // MISC
         //--------------------------------------------------
         virtual bool ImmidiateCommands(CommandQueueHandle* queue, CommandBufferHandle* commandBuffer, FenceHandle* fence, std::function<void(CommandBufferHandle*)>&& func) = 0;
         virtual bool WaitDevice() = 0;
+        virtual bool IsDrawIndirectCountSupported() const = 0;
+        virtual bool IsTextureCompressionSupported() const = 0;
+        virtual uint64 GetMinUniformBufferOffsetAlignment() const = 0;
     };
 }
@@ -13,7 +13,8 @@ namespace Silex
     //================================================
     // ハンドル
     //================================================
-    using QueueID = uint32;
+    using QueueID     = uint32;
+    using UploadToken = uint64; // 非同期アップロードの完了判定値 (タイムラインセマフォの値)
 
     SL_DECLARE_HANDLE(SurfaceHandle);
     SL_DECLARE_HANDLE(CommandQueueHandle);
@@ -31,6 +32,7 @@ namespace Silex
     SL_DECLARE_HANDLE(TextureViewHandle);
     SL_DECLARE_HANDLE(TextureHandle);
     SL_DECLARE_HANDLE(ShaderHandle);
+    SL_DECLARE_HANDLE(QueryPoolHandle);
 
 
     //================================================
@@ -370,6 +372,28 @@ namespace Silex
         COMMAND_BUFFER_TYPE_MAX,
     };
 
+    //================================================
+    // パイプラインキャッシュ
+    //================================================
+    struct PipelineCacheStats
+    {
+        bool   loadedFromDisk  = false; // ディスクから有効なキャッシュを読み込めたか
+        uint64 loadedDataSize  = 0;     // 読み込んだキャッシュサイズ
+        uint32 numPipeline     = 0;     // 生成したパイプライン数
+        float  creationTimeMs  = 0.0f;  // パイプライン生成に掛かった合計時間
+    };
+
+    //================================================
+    // クエリ
+    //================================================
+    enum QueryType
+    {
+        QUERY_TYPE_TIMESTAMP,
+        QUERY_TYPE_OCCLUSION,
+
+        QUERY_TYPE_MAX,
+    };
+
     //=================================================
     // バッファ
     //=================================================
@@ -623,6 +647,7 @@ namespace Silex
         BarrierAccessFlags dstAccess;
     };
 
+    // キュー間で所有権を移す場合は srcQueue / dstQueue にキューファミリを指定する (解放側と取得側で同じ値のバリアを発行する)
     struct BufferBarrierInfo
     {
         BufferHandle*            buffer;
@@ -630,6 +655,8 @@ namespace Silex
         BarrierAccessFlags dstAccess;
         uint64             offset;
         uint64             size;
+        QueueID            srcQueue = RENDER_INVALID_ID;
+        QueueID            dstQueue = RENDER_INVALID_ID;
     };
 
     struct TextureBarrierInfo
@@ -640,6 +667,8 @@ namespace Silex
         TextureLayout           oldLayout = TEXTURE_LAYOUT_UNDEFINED;
         TextureLayout           newLayout = TEXTURE_LAYOUT_UNDEFINED;
         TextureSubresourceRange subresources;
+        QueueID                 srcQueue  = RENDER_INVALID_ID;
+        QueueID                 dstQueue  = RENDER_INVALID_ID;
     };
 
     //================================================
@@ -721,9 +750,10 @@ namespace Silex
 
     struct DescriptorHandle
     {
-        BufferHandle*      buffer    = nullptr;
-        TextureViewHandle* imageView = nullptr;
-        SamplerHandle*     sampler   = nullptr;
+        BufferHandle*      buffer      = nullptr;
+        TextureViewHandle* imageView   = nullptr;
+        SamplerHandle*     sampler     = nullptr;
+        uint64             bufferRange = 0; // 0 の場合はバッファ全体
     };
 
     //=========================================================
@@ -738,6 +768,20 @@ namespace Silex
         DescriptorHandle handles;
     };
 
+    //=========================================================
+    // バインドレス
+    //---------------------------------------------------------
+    // 全シェーダーで共有する 1つのデスクリプターセット (インデックスで参照する)
+    // シェーダーでサイズ未指定の sampler2D 配列を宣言したセットは、このセットのレイアウトに置き換えられる
+    //=========================================================
+    enum : uint32
+    {
+        BINDLESS_TEXTURE_BINDING  = 0,    // sampler2D textures[]
+        BINDLESS_BUFFER_BINDING   = 1,    // buffer { ... } buffers[]
+        BINDLESS_TEXTURE_CAPACITY = 4096,
+        BINDLESS_BUFFER_CAPACITY  = 256,
+    };
+
     struct DescriptorSetInfo
     {
         std::vector<DescriptorInfo> infos;
@@ -753,7 +797,7 @@ namespace Silex
             info.handles = DescriptorHandle{ nullptr, view, sampler };
         }
 
-        void BindBuffer(uint32 binding, DescriptorType type, BufferHandle* buffer)
+        void BindBuffer(uint32 binding, DescriptorType type, BufferHandle* buffer, uint64 range = 0)
         {
             if (infos.size() < binding + 1)
                 infos.resize(binding + 1);
@@ -761,7 +805,7 @@ namespace Silex
             DescriptorInfo& info = infos[binding];
             info.binding = binding;
             info.type    = type;
-            info.handles = DescriptorHandle{ buffer, nullptr, nullptr };
+            info.handles = DescriptorHandle{ buffer, nullptr, nullptr, range };
         }
     };
 
@@ -896,6 +940,11 @@ namespace Silex
         VERTEX_BUFFER_FORMAT_R32G32       = RENDERING_FORMAT_R32G32_SFLOAT,
         VERTEX_BUFFER_FORMAT_R32G32B32    = RENDERING_FORMAT_R32G32B32_SFLOAT,
         VERTEX_BUFFER_FORMAT_R32G32B32A32 = RENDERING_FORMAT_R32G32B32A32_SFLOAT,
+
+        // 圧縮頂点用
+        VERTEX_BUFFER_FORMAT_R16G16_SNORM       = RENDERING_FORMAT_R16G16_SNORM,
+        VERTEX_BUFFER_FORMAT_R16G16_SFLOAT      = RENDERING_FORMAT_R16G16_SFLOAT,
+        VERTEX_BUFFER_FORMAT_R16G16B16A16_SNORM = RENDERING_FORMAT_R16G16B16A16_SNORM,
     };
 
     enum IndexBufferFormat
@@ -940,6 +989,10 @@ namespace Silex
                 case VERTEX_BUFFER_FORMAT_R32G32:       stride += 8;  break;
                 case VERTEX_BUFFER_FORMAT_R32G32B32:    stride += 12; break;
                 case VERTEX_BUFFER_FORMAT_R32G32B32A32: stride += 16; break;
+
+                case VERTEX_BUFFER_FORMAT_R16G16_SNORM:       stride += 4; break;
+                case VERTEX_BUFFER_FORMAT_R16G16_SFLOAT:      stride += 4; break;
+                case VERTEX_BUFFER_FORMAT_R16G16B16A16_SNORM: stride += 8; break;
             }
         }
     };
@@ -1249,6 +1302,24 @@ namespace Silex
         uint64 size      = 0;
     };
 
+    // 間接描画引数 (VkDrawIndexedIndirectCommand と同じレイアウト)
+    struct DrawIndexedIndirectCommand
+    {
+        uint32 indexCount    = 0;
+        uint32 instanceCount = 0;
+        uint32 firstIndex    = 0;
+        int32  vertexOffset  = 0;
+        uint32 firstInstance = 0;
+    };
+
+    // 間接ディスパッチ引数 (VkDispatchIndirectCommand と同じレイアウト)
+    struct DispatchIndirectCommand
+    {
+        uint32 groupCountX = 0;
+        uint32 groupCountY = 0;
+        uint32 groupCountZ = 0;
+    };
+
     struct TextureCopyRegion
     {
         TextureSubresource srcSubresources;
@@ -87,6 +87,39 @@ namespace Silex
         Renderer::Get()->UpdateBufferData(handle[frameindex], data, writeByteSize);
     }
 
+    //==============================================================
+    // 動的ユニフォームバッファ
+    //==============================================================
+    DynamicUniformBuffer::DynamicUniformBuffer(uint32 frames)
+    {
+        handle.resize(frames);
+        mappedPointers.resize(frames, nullptr);
+        offsets.resize(frames, 0);
+    }
+
+    uint32 DynamicUniformBuffer::Allocate(const void* data, uint64 writeByteSize)
+    {
+        uint32 frameindex = Renderer::Get()->GetCurrentFrameIndex();
+
+        // 動的オフセットは minUniformBufferOffsetAlignment の倍数である必要がある
+        uint64 offset = (offsets[frameindex] + alignment - 1) & ~(alignment - 1);
+        if (offset + writeByteSize > capacity)
+        {
+            SL_LOG_LOCATION_ERROR("動的ユニフォームバッファの容量が不足しています");
+            return RENDER_INVALID_ID;
+        }
+
+        std::memcpy(mappedPointers[frameindex] + offset, data, writeByteSize);
+        offsets[frameindex] = offset + writeByteSize;
+
+        return (uint32)offset;
+    }
+
+    void DynamicUniformBuffer::Reset(uint32 frameIndex)
+    {
+        offsets[frameIndex] = 0;
+    }
+
     //==============================================================
     // 頂点バッファ
     //==============================================================
@@ -140,6 +173,15 @@ namespace Silex
         }
     }
 
+    void DescriptorSet::SetResource(uint32 binding, DynamicUniformBuffer* uniformBuffer, uint64 range)
+    {
+        // リングバッファ自体は変わらないので、フレーム毎に1度だけ登録すれば以降の更新は不要
+        for (uint32 i = 0; i < descriptorSetInfo.size(); i++)
+        {
+            descriptorSetInfo[i].BindBuffer(binding, DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, uniformBuffer->GetHandle(i), range);
+        }
+    }
+
     void DescriptorSet::SetResource(uint32 binding, StorageBuffer* storageBuffer)
     {
         for (uint32 i = 0; i < descriptorSetInfo.size(); i++)
@@ -147,4 +189,21 @@ namespace Silex
             descriptorSetInfo[i].BindBuffer(binding, DESCRIPTOR_TYPE_STORAGE_BUFFER, storageBuffer->GetHandle(i));
         }
     }
+
+    void DescriptorSet::SetStorageImage(uint32 binding, TextureView* view)
+    {
+        for (uint32 i = 0; i < descriptorSetInfo.size(); i++)
+        {
+            descriptorSetInfo[i].BindTexture(binding, DESCRIPTOR_TYPE_STORAGE_IMAGE, view->GetHandle(0), nullptr);
+        }
+    }
+
+    void DescriptorSet::SetStorageBuffer(uint32 binding, BufferHandle* buffer)
+    {
+        // GPU 上でのみ書き換えるバッファはマルチバッファリングせず、フレーム間の同期はバリアで取る
+        for (uint32 i = 0; i < descriptorSetInfo.size(); i++)
+        {
+            descriptorSetInfo[i].BindBuffer(binding, DESCRIPTOR_TYPE_STORAGE_BUFFER, buffer);
+        }
+    }
 }
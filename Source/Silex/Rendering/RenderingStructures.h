@@ -10,6 +10,7 @@ namespace Silex
     class VertexBuffer;
     class UniformBuffer;
     class StorageBuffer;
+    class DynamicUniformBuffer;
     class Sampler;
     class Texture;
     class Texture2D;
@@ -93,6 +94,8 @@ namespace Silex
     {
         SL_CLASS(Texture, RenderingStructure<Texture>)
 
+        friend class Renderer;
+
     public:
 
         Texture() = default;
@@ -106,10 +109,22 @@ namespace Silex
 
         DescriptorSetHandle* GetDescriptorSet() { return descriptorset; }
 
+        // バインドレステーブル内のインデックス (Renderer::RegisterBindlessTexture で登録されるまでは無効値)
+        uint32 GetBindlessIndex() const { return bindlessIndex; }
+
+        // 非同期アップロードのトークン (Renderer::IsUploadComplete で完了を判定する / 転送しないテクスチャは 0)
+        UploadToken GetUploadToken() const { return uploadToken; }
+
     protected:
 
         TextureInfo          textureInfo;
         DescriptorSetHandle* descriptorset;
+
+        // バインドレス登録用のビュー
+        TextureView* bindlessView  = nullptr;
+        uint32       bindlessIndex = RENDER_INVALID_ID;
+
+        UploadToken uploadToken = 0;
     };
 
     //==============================================================
@@ -158,6 +173,8 @@ namespace Silex
     {
         SL_CLASS(Buffer, RenderingStructure<Buffer>)
 
+        friend class Renderer;
+
     public:
 
         Buffer() = default;
@@ -169,8 +186,13 @@ namespace Silex
 
         void* GetMappedPointer(uint32 frameIndex = 0);
 
+        // 非同期アップロードのトークン (Renderer::IsUploadComplete で完了を判定する / 転送しないバッファは 0)
+        UploadToken GetUploadToken() const { return uploadToken; }
+
     protected:
 
+        UploadToken uploadToken = 0;
+
         //uint64 byteSize  = 0;
         //bool   isMapped  = false;
         //bool   isInCPU   = false;
@@ -243,6 +265,41 @@ namespace Silex
         void SetData(const void* data, uint64 writeByteSize);
     };
 
+    //==============================================================
+    // 動的ユニフォームバッファ (フレーム毎のリングバッファ)
+    //--------------------------------------------------------------
+    // フレーム毎に永続マップしたバッファを1つ持ち、確保はポインタを進めてコピーするだけで完了する
+    // デスクリプターにはバッファを1度だけ登録し、描画時に 確保で得たオフセットを動的オフセットとして渡す
+    // 確保した領域は、同じフレームインデックスで次に Reset されるまで (GPU 処理完了まで) 有効
+    //==============================================================
+    class DynamicUniformBuffer : public Buffer
+    {
+        SL_CLASS(DynamicUniformBuffer, Buffer)
+
+        friend class Renderer;
+
+    public:
+
+        DynamicUniformBuffer(uint32 frames);
+
+        // 現在フレームの領域に data をコピーし、その動的オフセットを返す (容量不足の場合は RENDER_INVALID_ID)
+        uint32 Allocate(const void* data, uint64 writeByteSize);
+
+        // 指定フレームの確保位置を先頭に戻す
+        void Reset(uint32 frameIndex);
+
+        uint64 GetCapacity()                  const { return capacity;            }
+        uint64 GetAlignment()                 const { return alignment;           }
+        uint64 GetUsedSize(uint32 frameIndex) const { return offsets[frameIndex]; }
+
+    private:
+
+        std::vector<uint8*> mappedPointers;
+        std::vector<uint64> offsets;
+        uint64              capacity  = 0;
+        uint64              alignment = 0;
+    };
+
 
 
     class TextureView : public RenderingStructure<TextureView>
@@ -280,6 +337,13 @@ namespace Silex
         void SetResource(uint32 binding, UniformBuffer* uniformBuffer);
         void SetResource(uint32 binding, StorageBuffer* storageBuffer);
 
+        // 動的ユニフォームバッファ (range はシェーダーから参照する 1 回分の確保サイズ)
+        void SetResource(uint32 binding, DynamicUniformBuffer* uniformBuffer, uint64 range);
+
+        // ストレージイメージ / 全フレームで共有する GPU 専用ストレージバッファ
+        void SetStorageImage(uint32 binding, TextureView* view);
+        void SetStorageBuffer(uint32 binding, BufferHandle* buffer);
+
     private:
 
         //=====================================================================================
@@ -16,6 +16,13 @@ namespace Silex
                 or (format == RENDERING_FORMAT_D16_UNORM);
         }
 
+        // ブロック圧縮フォーマットチェック (レンダーターゲット・ブリットには使用できない)
+        inline bool IsCompressedFormat(RenderingFormat format)
+        {
+            return (format >= RENDERING_FORMAT_BC1_RGB_UNORM_BLOCK)
+               and (format <= RENDERING_FORMAT_BC7_SRGB_BLOCK);
+        }
+
         // ミップマップレベル取得
         inline std::vector<Extent> CalculateMipmap(uint32 width, uint32 height)
         {
@@ -1,6 +1,8 @@
 
 #include "PCH.h"
 #include "Rendering/ShaderCompiler.h"
+#include "Core/ParallelFor.h"
+#include "Core/Profiler.h"
 
 //==========================================================================
 // NOTE:
@@ -50,59 +52,6 @@ namespace Silex
         return true;
     }
 
-    static bool ReadSpvBinary(std::vector<uint32>& output, const std::string& filepath)
-    {
-        FILE* f = std::fopen(filepath.c_str(), "rb");
-        if (f)
-        {
-            std::fseek(f, 0, SEEK_END);
-            uint64 size = std::ftell(f);
-            std::fseek(f, 0, SEEK_SET);
-
-            output = std::vector<uint32>(size / sizeof(uint32));
-            std::fread(output.data(), sizeof(uint32), output.size(), f);
-        }
-        else
-        {
-            SL_LOG_ERROR("ファイルの読み込みに失敗しました: {}", filepath.c_str());
-            return false;
-        }
-
-        std::fclose(f);
-        return true;
-    }
-
-    static bool WriteSpvBinary(const std::vector<uint32>& writeData, const std::string& filepath)
-    {
-        FILE* f = std::fopen(filepath.c_str(), "wb");
-        if (f)
-        {
-            std::fwrite(writeData.data(), sizeof(uint32), writeData.size(), f);
-        }
-        else
-        {
-            SL_LOG_ERROR("ファイルの読み込みに失敗しました: {}", filepath.c_str());
-            return false;
-        }
-
-        std::fclose(f);
-        return true;
-    }
-
-    static bool IsFileCachedRecently(const std::filesystem::path& file, const std::filesystem::path& cacheFile)
-    {
-        auto fts = std::filesystem::last_write_time(file);
-        auto cts = std::filesystem::last_write_time(cacheFile);
-
-        auto fsec = std::chrono::duration_cast<std::chrono::seconds>(fts.time_since_epoch());
-        auto csec = std::chrono::duration_cast<std::chrono::seconds>(cts.time_since_epoch());
-
-        // コンパイルに成功した場合にキャッシュが更新されるので、キャッシュのタイムスタンプが最近であれば
-        // 最新のコンパイル済みキャッシュと判断できる
-        return csec > fsec;
-    }
-
-
     class ShaderIncluder : public shaderc::CompileOptions::IncluderInterface
     {
     public:
@@ -248,16 +197,525 @@ namespace Silex
     }
 #endif
 
+    //======================================================================================
+    // シェーダーキャッシュ
+    //--------------------------------------------------------------------------------------
+    // キーは「プリプロセス済みソース (インクルード展開後)・コンパイルオプション・コンパイラバージョン」の
+    // ハッシュなので、インクルードファイルの編集や同名ファイルの衝突でも誤ったキャッシュを使用しない
+    // エントリーには SPIR-V とリフレクションデータを格納し、ヒット時は SPIRV-Cross の解析も省略する
+    //======================================================================================
+    static const char*     ShaderCacheDirectory = "Assets/Shaders/Cache/";
+    static constexpr uint32 ShaderCacheMagic     = 'S' | ('L' << 8) | ('S' << 16) | ('C' << 24);
+    static constexpr uint32 ShaderCacheVersion   = 1;
+
+    static std::atomic<uint32> cacheHitCount  = 0;
+    static std::atomic<uint32> cacheMissCount = 0;
+    static std::atomic<bool>   cacheEnabled   = true;
+
+    // キャッシュキーに含めるコンパイルオプション (_CompileStage / _PreprocessStage と同じ値を使用すること)
+    struct ShaderCompileOptionDesc
+    {
+#if SHADERC
+        shaderc_target_env  targetEnvironment = shaderc_target_env_vulkan;
+        shaderc_env_version targetVersion     = shaderc_env_version_vulkan_1_2;
+#endif
+        bool warningsAsErrors = true;
+    };
+
+    static const ShaderCompileOptionDesc CompileOptionDesc = {};
+
+    struct ShaderCacheFileHeader
+    {
+        uint32 magic;
+        uint32 version;
+        uint64 key;
+        uint64 dataSize;
+        uint64 dataHash;
+    };
+
+    static uint64 MakeShaderCacheKey(const std::vector<std::pair<ShaderStage, std::string>>& preprocessedSources)
+    {
+        uint32 spvVersion  = 0;
+        uint32 spvRevision = 0;
+#if SHADERC
+        shaderc_get_spv_version(&spvVersion, &spvRevision);
+#endif
+
+        uint32 warningsAsErrors = CompileOptionDesc.warningsAsErrors;
+
+        uint64 key = Hash::FNV(&ShaderCacheVersion, sizeof(ShaderCacheVersion));
+        key = Hash::FNV(&spvVersion,       sizeof(spvVersion),       key);
+        key = Hash::FNV(&spvRevision,      sizeof(spvRevision),      key);
+        key = Hash::FNV(&warningsAsErrors, sizeof(warningsAsErrors), key);
+#if SHADERC
+        uint32 targetEnvironment = CompileOptionDesc.targetEnvironment;
+        uint32 targetVersion     = CompileOptionDesc.targetVersion;
+        key = Hash::FNV(&targetEnvironment, sizeof(targetEnvironment), key);
+        key = Hash::FNV(&targetVersion,     sizeof(targetVersion),     key);
+#endif
+
+        for (const auto& [stage, source] : preprocessedSources)
+        {
+            uint32 stageBit = stage;
+            key = Hash::FNV(&stageBit, sizeof(stageBit), key);
+            key = Hash::FNV(source.data(), source.size(), key);
+        }
+
+        return key;
+    }
+
+    // 同名の別ディレクトリのシェーダーと衝突しないように、パスのハッシュを含める ("<stem>.<pathHash>.")
+    static std::string MakeShaderCachePrefix(const std::string& filePath)
+    {
+        return std::format("{}.{:016x}.", std::filesystem::path(filePath).stem().string(), Hash::FNV(filePath.c_str()));
+    }
+
+    static std::string MakeShaderCachePath(const std::string& filePath, uint64 key)
+    {
+        return std::format("{}{}{:016x}.bin", ShaderCacheDirectory, MakeShaderCachePrefix(filePath), key);
+    }
+
+
+    //--------------------------------------
+    // キャッシュエントリー 書き込み
+    //--------------------------------------
+    class ShaderCacheWriter
+    {
+    public:
+
+        template<typename T>
+        void Write(const T& value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            const byte* p = reinterpret_cast<const byte*>(&value);
+            data.insert(data.end(), p, p + sizeof(T));
+        }
+
+        void Write(const std::string& str)
+        {
+            Write<uint32>(str.size());
+            data.insert(data.end(), str.begin(), str.end());
+        }
+
+        void Write(const std::vector<uint32>& words)
+        {
+            Write<uint32>(words.size());
+            const byte* p = reinterpret_cast<const byte*>(words.data());
+            data.insert(data.end(), p, p + words.size() * sizeof(uint32));
+        }
+
+        void Write(const ShaderBuffer& buffer)
+        {
+            Write<uint32>(buffer.stage);
+            Write(buffer.name);
+            Write(buffer.size);
+            Write(buffer.setIndex);
+            Write(buffer.bindingPoint);
+        }
+
+        void Write(const ShaderImage& image)
+        {
+            Write<uint32>(image.stage);
+            Write(image.name);
+            Write(image.arraySize);
+            Write(image.dimension);
+            Write(image.setIndex);
+            Write(image.bindingPoint);
+        }
+
+        template<typename K, typename V>
+        void Write(const std::unordered_map<K, V>& map)
+        {
+            Write<uint32>(map.size());
+            for (const auto& [key, value] : map)
+            {
+                Write(key);
+                Write(value);
+            }
+        }
+
+        void Write(const ShaderReflectionData& reflection)
+        {
+            Write<uint32>(reflection.descriptorSets.size());
+            for (const ShaderDescriptorSet& set : reflection.descriptorSets)
+            {
+                Write(set.uniformBuffers);
+                Write(set.storageBuffers);
+                Write(set.imageSamplers);
+                Write(set.storageImages);
+                Write(set.separateTextures);
+                Write(set.separateSamplers);
+            }
+
+            Write<uint32>(reflection.pushConstantRanges.size());
+            for (const PushConstantRange& range : reflection.pushConstantRanges)
+            {
+                Write<uint32>(range.stage);
+                Write(range.offset);
+                Write(range.size);
+            }
+
+            Write<uint32>(reflection.pushConstants.size());
+            for (const auto& [name, pushConstant] : reflection.pushConstants)
+            {
+                Write(name);
+                Write(pushConstant.name);
+                Write(pushConstant.size);
+
+                Write<uint32>(pushConstant.members.size());
+                for (const auto& [memberName, member] : pushConstant.members)
+                {
+                    Write(memberName);
+                    Write<uint32>(member.type);
+                    Write(member.name);
+                    Write(member.size);
+                    Write(member.offset);
+                }
+            }
+
+            Write<uint32>(reflection.resources.size());
+            for (const auto& [name, resource] : reflection.resources)
+            {
+                Write(name);
+                Write(resource.name);
+                Write(resource.setIndex);
+                Write(resource.registerIndex);
+                Write(resource.count);
+            }
+        }
+
+        std::vector<byte> data;
+    };
+
+
+    //--------------------------------------
+    // キャッシュエントリー 読み込み
+    //--------------------------------------
+    class ShaderCacheReader
+    {
+    public:
+
+        ShaderCacheReader(const std::vector<byte>& data)
+            : data(data)
+        {
+        }
+
+        template<typename T>
+        void Read(T& out)
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            if (!_Consume(sizeof(T)))
+                return;
+
+            std::memcpy(&out, data.data() + offset - sizeof(T), sizeof(T));
+        }
+
+        template<typename E>
+        void ReadEnum(E& out)
+        {
+            uint32 value = 0;
+            Read(value);
+            out = (E)value;
+        }
+
+        void Read(std::string& out)
+        {
+            uint32 length = 0;
+            Read(length);
+
+            if (!_Consume(length))
+                return;
+
+            out.assign(reinterpret_cast<const char*>(data.data() + offset - length), length);
+        }
+
+        void Read(std::vector<uint32>& out)
+        {
+            uint32 count = 0;
+            Read(count);
+
+            if (!_Consume((uint64)count * sizeof(uint32)))
+                return;
+
+            out.resize(count);
+            std::memcpy(out.data(), data.data() + offset - count * sizeof(uint32), count * sizeof(uint32));
+        }
+
+        void Read(ShaderBuffer& out)
+        {
+            ReadEnum(out.stage);
+            Read(out.name);
+            Read(out.size);
+            Read(out.setIndex);
+            Read(out.bindingPoint);
+        }
+
+        void Read(ShaderImage& out)
+        {
+            ReadEnum(out.stage);
+            Read(out.name);
+            Read(out.arraySize);
+            Read(out.dimension);
+            Read(out.setIndex);
+            Read(out.bindingPoint);
+        }
+
+        template<typename K, typename V>
+        void Read(std::unordered_map<K, V>& out)
+        {
+            uint32 count = 0;
+            Read(count);
+
+            for (uint32 i = 0; i < count && valid; i++)
+            {
+                K key = {};
+                Read(key);
+                Read(out[key]);
+            }
+        }
+
+        void Read(ShaderReflectionData& out)
+        {
+            uint32 numSet = 0;
+            Read(numSet);
+            if (!_Check(numSet))
+                return;
+
+            out.descriptorSets.resize(numSet);
+            for (ShaderDescriptorSet& set : out.descriptorSets)
+            {
+                Read(set.uniformBuffers);
+                Read(set.storageBuffers);
+                Read(set.imageSamplers);
+                Read(set.storageImages);
+                Read(set.separateTextures);
+                Read(set.separateSamplers);
+            }
+
+            uint32 numRange = 0;
+            Read(numRange);
+            if (!_Check(numRange))
+                return;
+
+            out.pushConstantRanges.resize(numRange);
+            for (PushConstantRange& range : out.pushConstantRanges)
+            {
+                ReadEnum(range.stage);
+                Read(range.offset);
+                Read(range.size);
+            }
+
+            uint32 numPushConstant = 0;
+            Read(numPushConstant);
+            for (uint32 i = 0; i < numPushConstant && valid; i++)
+            {
+                std::string name;
+                Read(name);
+
+                ShaderPushConstant& pushConstant = out.pushConstants[name];
+                Read(pushConstant.name);
+                Read(pushConstant.size);
+
+                uint32 numMember = 0;
+                Read(numMember);
+                for (uint32 m = 0; m < numMember && valid; m++)
+                {
+                    std::string memberName;
+                    Read(memberName);
+
+                    PushConstantMember& member = pushConstant.members[memberName];
+                    ReadEnum(member.type);
+                    Read(member.name);
+                    Read(member.size);
+                    Read(member.offset);
+                }
+            }
+
+            uint32 numResource = 0;
+            Read(numResource);
+            for (uint32 i = 0; i < numResource && valid; i++)
+            {
+                std::string name;
+                Read(name);
+
+                ShaderResourceDeclaration& resource = out.resources[name];
+                Read(resource.name);
+                Read(resource.setIndex);
+                Read(resource.registerIndex);
+                Read(resource.count);
+            }
+        }
+
+        bool IsValid() const { return valid;                  }
+        bool IsEnd()   const { return offset == data.size(); }
+
+    private:
+
+        bool _Consume(uint64 size)
+        {
+            if (!valid || offset + size > data.size())
+            {
+                valid = false;
+                return false;
+            }
+
+            offset += size;
+            return true;
+        }
+
+        // 要素数が残りのデータ量を超える (破損している) 場合は無効
+        bool _Check(uint32 count)
+        {
+            valid = valid && count <= data.size() - offset;
+            return valid;
+        }
+
+        const std::vector<byte>& data;
+        uint64                   offset = 0;
+        bool                     valid  = true;
+    };
+
+
+    static bool ReadShaderCache(const std::string& cachePath, uint64 key, ShaderCompiledData& out_compiledData)
+    {
+        FILE* f = std::fopen(cachePath.c_str(), "rb");
+        if (!f)
+            return false;
+
+        ShaderCacheFileHeader header = {};
+        std::vector<byte>     data;
+
+        bool valid = std::fread(&header, sizeof(header), 1, f) == 1;
+        valid = valid && header.magic   == ShaderCacheMagic;
+        valid = valid && header.version == ShaderCacheVersion;
+        valid = valid && header.key     == key;
+
+        if (valid)
+        {
+            data.resize(header.dataSize);
+            valid = std::fread(data.data(), 1, header.dataSize, f) == header.dataSize;
+            valid = valid && Hash::FNV(data.data(), data.size()) == header.dataHash;
+        }
+
+        std::fclose(f);
+
+        if (!valid)
+        {
+            SL_LOG_WARN("シェーダーキャッシュが破損しているため、再コンパイルします: {}", cachePath);
+            return false;
+        }
+
+        ShaderCacheReader reader(data);
+
+        uint32 numStage = 0;
+        reader.Read(numStage);
+
+        for (uint32 i = 0; i < numStage && reader.IsValid(); i++)
+        {
+            ShaderStage stage = {};
+            reader.ReadEnum(stage);
+            reader.Read(out_compiledData.shaderBinaries[stage]);
+        }
+
+        reader.Read(out_compiledData.reflection);
+        return reader.IsValid() && reader.IsEnd();
+    }
+
+    static bool WriteShaderCache(const std::string& cachePath, uint64 key, const ShaderCompiledData& compiledData)
+    {
+        ShaderCacheWriter writer;
+
+        writer.Write<uint32>(compiledData.shaderBinaries.size());
+        for (const auto& [stage, binary] : compiledData.shaderBinaries)
+        {
+            writer.Write<uint32>(stage);
+            writer.Write(binary);
+        }
+
+        writer.Write(compiledData.reflection);
+
+        ShaderCacheFileHeader header = {};
+        header.magic    = ShaderCacheMagic;
+        header.version  = ShaderCacheVersion;
+        header.key      = key;
+        header.dataSize = writer.data.size();
+        header.dataHash = Hash::FNV(writer.data.data(), writer.data.size());
+
+        // 一時ファイルに書き込んでから置き換える (書き込み途中で終了しても、壊れたキャッシュが残らないように)
+        std::string tempPath = cachePath + ".tmp";
+
+        FILE* f = std::fopen(tempPath.c_str(), "wb");
+        if (!f)
+        {
+            SL_LOG_ERROR("ファイルの書き込みに失敗しました: {}", tempPath);
+            return false;
+        }
+
+        bool written = std::fwrite(&header, sizeof(header), 1, f) == 1;
+        written = written && std::fwrite(writer.data.data(), 1, writer.data.size(), f) == writer.data.size();
+        std::fclose(f);
+
+        std::error_code ec;
+        if (written)
+        {
+            std::filesystem::rename(tempPath, cachePath, ec);
+        }
+
+        if (!written || ec)
+        {
+            SL_LOG_ERROR("シェーダーキャッシュの保存に失敗しました: {}", cachePath);
+            std::filesystem::remove(tempPath, ec);
+            return false;
+        }
+
+        return true;
+    }
+
+    // 同じシェーダーの古いキー ("<stem>.<pathHash>.<key>.bin") のキャッシュを削除する
+    // (ソースやインクルードを編集する度に、使われなくなったキャッシュが溜まり続けないように)
+    static void PruneShaderCache(const std::string& filePath, uint64 key)
+    {
+        const std::string prefix  = MakeShaderCachePrefix(filePath);
+        const std::string current = std::filesystem::path(MakeShaderCachePath(filePath, key)).filename().string();
+
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::directory_iterator(ShaderCacheDirectory, ec))
+        {
+            const std::string name = entry.path().filename().string();
+
+            // パスのハッシュまで一致するものだけが同じシェーダー (同名の別ディレクトリのシェーダーは対象にしない)
+            bool isSameShader = name.starts_with(prefix);
+            isSameShader = isSameShader && name.ends_with(".bin");
+
+            if (isSameShader && name != current)
+            {
+                std::error_code removeError;
+                std::filesystem::remove(entry.path(), removeError);
+            }
+        }
+    }
+
+
     using _SetIndex = uint32;
     using _Binding  = uint32;
 
-    // ステージ間共有バッファ保存用変数
-    static std::unordered_map<_SetIndex, std::unordered_map<_Binding, ShaderBuffer>> ExistUniformBuffers;
-    static std::unordered_map<_SetIndex, std::unordered_map<_Binding, ShaderBuffer>> ExistStorageBuffers;
-    static bool                                                                      IsExistPushConstant;
-    static ShaderReflectionData                                                      ReflectionData;
+    // ステージ間共有バッファ保存用変数 (Compile 呼び出し毎)
+    struct ShaderReflectionContext
+    {
+        std::unordered_map<_SetIndex, std::unordered_map<_Binding, ShaderBuffer>> existUniformBuffers;
+        std::unordered_map<_SetIndex, std::unordered_map<_Binding, ShaderBuffer>> existStorageBuffers;
+        bool                                                                      isExistPushConstant = false;
+        ShaderReflectionData                                                      reflectionData;
+    };
 
-    static const char* ShaderCacheDirectory = "Assets/Shaders/Cache/";
+#if SHADERC
+    // shaderc::Compiler の生成コストを避けるため、スレッド毎に使い回す
+    static shaderc::Compiler& GetThreadCompiler()
+    {
+        static thread_local shaderc::Compiler compiler;
+        return compiler;
+    }
+#endif
 
 
     ShaderCompiler* ShaderCompiler::Get()
@@ -269,11 +727,9 @@ namespace Silex
     {
         bool result = false;
 
-        // キャッシュファイルが無ければ生成
-        if (!std::filesystem::exists(ShaderCacheDirectory))
-        {
-            std::filesystem::create_directory(ShaderCacheDirectory);
-        }
+        // キャッシュファイルが無ければ生成 (複数スレッドから同時に呼ばれても失敗しないように)
+        std::error_code ec;
+        std::filesystem::create_directories(ShaderCacheDirectory, ec);
 
         // ファイル読み込み
         std::string rawSource;
@@ -284,71 +740,134 @@ namespace Silex
         std::unordered_map<ShaderStage, std::string> parsedRawSources;
         parsedRawSources = _SplitStages(rawSource);
 
-        SL_LOG_TRACE("**************************************************");
         SL_LOG_TRACE("Compile: {}", filePath.c_str());
-        SL_LOG_TRACE("**************************************************");
 
-        // ステージごとにコンパイル
-        std::unordered_map<ShaderStage, std::vector<uint32>> spirvBinaries;
-        for (const auto& [stage, source] : parsedRawSources)
+        // ステージ順に並べる (キャッシュキーとリフレクションの統合順序を、列挙順に依存させない)
+        std::vector<std::pair<ShaderStage, std::string>> stageSources(parsedRawSources.begin(), parsedRawSources.end());
+        std::sort(stageSources.begin(), stageSources.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+        const uint32 numStage = stageSources.size();
+        std::vector<std::string> errors(numStage);
+
+        // ステージごとにプリプロセス (キャッシュキーはインクルード・マクロ展開後のソースから求める)
+        std::vector<std::pair<ShaderStage, std::string>> preprocessedSources(numStage);
+        ParallelFor(numStage, 1, [&](uint32 index)
         {
-            std::filesystem::path file = filePath;
-            std::string cachepath = ShaderCacheDirectory + file.stem().string() + ToExtention(stage) + ".bin";
+            preprocessedSources[index].first = stageSources[index].first;
+            errors[index] = _PreprocessStage(stageSources[index].first, stageSources[index].second, preprocessedSources[index].second, filePath);
+        });
 
-            // キャッシュファイルが存在し、タイムスタンプが最新であれば使用する
-            if (std::filesystem::exists(cachepath) && IsFileCachedRecently(file, cachepath))
+        for (const std::string& error : errors)
+        {
+            if (!error.empty())
             {
-                ReadSpvBinary(spirvBinaries[stage], cachepath);
+                SL_LOG_ERROR("ShaderCompile: {}", error.c_str());
+                return false;
             }
-            else
+        }
+
+        const bool        useCache  = cacheEnabled.load(std::memory_order_relaxed);
+        const uint64      cacheKey  = MakeShaderCacheKey(preprocessedSources);
+        const std::string cachePath = MakeShaderCachePath(filePath, cacheKey);
+
+        // キャッシュヒット: コンパイル・リフレクションともに省略し、キャッシュファイルも書き換えない
+        if (useCache)
+        {
+            ShaderCompiledData cached;
+            if (ReadShaderCache(cachePath, cacheKey, cached))
             {
-                std::string error = _CompileStage(stage, source, spirvBinaries[stage], filePath);
-                if (!error.empty())
-                {
-                    SL_LOG_ERROR("ShaderCompile: {}", error.c_str());
-                    return false;
-                }
-            }
+                cacheHitCount.fetch_add(1, std::memory_order_relaxed);
+                SL_LOG_TRACE("Cache: {}", cachePath.c_str());
 
-            // バイナリファイル書き込み（キャッシュ）
-            WriteSpvBinary(spirvBinaries[stage], cachepath);
+                out_compiledData = std::move(cached);
+                return true;
+            }
         }
 
-        out_compiledData.reflection.descriptorSets.clear();
-        out_compiledData.reflection.pushConstantRanges.clear();
-        out_compiledData.reflection.pushConstants.clear();
-        out_compiledData.reflection.resources.clear();
-        out_compiledData.shaderBinaries.clear();
+        cacheMissCount.fetch_add(1, std::memory_order_relaxed);
 
-        ExistUniformBuffers.clear();
-        ExistStorageBuffers.clear();
-        IsExistPushConstant = false;
+        // ステージごとにコンパイル
+        std::vector<std::vector<uint32>> spirvBinaries(numStage);
+        ParallelFor(numStage, 1, [&](uint32 index)
+        {
+            errors[index] = _CompileStage(preprocessedSources[index].first, preprocessedSources[index].second, spirvBinaries[index], filePath);
+        });
 
-        // ステージごとにリフレクション
-        for (const auto& [stage, binary] : spirvBinaries)
+        for (const std::string& error : errors)
         {
-            _ReflectStage(stage, binary);
+            if (!error.empty())
+            {
+                SL_LOG_ERROR("ShaderCompile: {}", error.c_str());
+                return false;
+            }
         }
 
-        SL_LOG_TRACE("**************************************************");
+        // ステージごとにリフレクション (ステージ間で共有するバッファを統合するので、ステージ順に逐次実行)
+        ShaderReflectionContext context;
+        for (uint32 i = 0; i < numStage; i++)
+        {
+            _ReflectStage(context, preprocessedSources[i].first, spirvBinaries[i]);
+        }
 
         // コンパイル結果
-        out_compiledData.reflection     = ReflectionData;
-        out_compiledData.shaderBinaries = spirvBinaries;
+        out_compiledData.reflection = std::move(context.reflectionData);
+        out_compiledData.shaderBinaries.clear();
 
-        // リフレクションデータリセット
-        ReflectionData.descriptorSets.clear();
-        ReflectionData.pushConstantRanges.clear();
-        ReflectionData.pushConstants.clear();
-        ReflectionData.resources.clear();
+        for (uint32 i = 0; i < numStage; i++)
+        {
+            out_compiledData.shaderBinaries[preprocessedSources[i].first] = std::move(spirvBinaries[i]);
+        }
 
-        ExistUniformBuffers.clear();
-        ExistStorageBuffers.clear();
-        IsExistPushConstant = false;
+        // バイナリファイル書き込み（キャッシュ）
+        if (useCache)
+        {
+            if (WriteShaderCache(cachePath, cacheKey, out_compiledData))
+            {
+                PruneShaderCache(filePath, cacheKey);
+            }
+        }
 
         return true;
     }
 
+    bool ShaderCompiler::CompileAll(const std::vector<std::string>& filePaths, std::vector<ShaderCompiledData>& out_compiledData)
+    {
+        SL_SCOPE_PROFILE("ShaderCompiler::CompileAll");
+
+        const uint32 numFile = filePaths.size();
+
+        out_compiledData.clear();
+        out_compiledData.resize(numFile);
+
+        // 要素毎に書き込み先が独立しているので、結果は実行順序に依存しない
+        std::vector<uint8> succeeded(numFile, 0);
+        ParallelFor(numFile, 1, [&](uint32 index)
+        {
+            succeeded[index] = Compile(filePaths[index], out_compiledData[index]);
+
+            if (!succeeded[index])
+            {
+                out_compiledData[index] = {};
+            }
+        });
+
+        return std::all_of(succeeded.begin(), succeeded.end(), [](uint8 v) { return v != 0; });
+    }
+
+    void ShaderCompiler::SetCacheEnabled(bool enable)
+    {
+        cacheEnabled.store(enable, std::memory_order_relaxed);
+    }
+
+    ShaderCacheStats ShaderCompiler::GetCacheStats() const
+    {
+        ShaderCacheStats stats;
+        stats.numHit  = cacheHitCount.load(std::memory_order_relaxed);
+        stats.numMiss = cacheMissCount.load(std::memory_order_relaxed);
+
+        return stats;
+    }
+
     std::unordered_map<ShaderStage, std::string> ShaderCompiler::_SplitStages(const std::string& source)
     {
         std::unordered_map<ShaderStage, std::string> shaderSources;
@@ -397,17 +916,50 @@ namespace Silex
         return shaderSources;
     }
 
+#if SHADERC
+    static void SetupCompileOptions(shaderc::CompileOptions& options)
+    {
+        options.SetTargetEnvironment(CompileOptionDesc.targetEnvironment, CompileOptionDesc.targetVersion);
+        options.SetIncluder(std::make_unique<ShaderIncluder>());
+
+        if (CompileOptionDesc.warningsAsErrors)
+            options.SetWarningsAsErrors();
+    }
+#endif
+
+    std::string ShaderCompiler::_PreprocessStage(ShaderStage stage, const std::string& source, std::string& out_preprocessed, const std::string& filepath)
+    {
+#if SHADERC
+        shaderc::Compiler& compiler = GetThreadCompiler();
+
+        shaderc::CompileOptions options;
+        SetupCompileOptions(options);
+
+        const shaderc::PreprocessedSourceCompilationResult preprocessResult = compiler.PreprocessGlsl(source, ToShaderC(stage), filepath.c_str(), options);
+        if (preprocessResult.GetCompilationStatus() != shaderc_compilation_status_success)
+        {
+            // エラーあり
+            return preprocessResult.GetErrorMessage();
+        }
+
+        out_preprocessed.assign(preprocessResult.cbegin(), preprocessResult.cend());
+        return {};
+#else
+        // glslang 経路ではプリプロセスを分離していないので、ソースをそのままキーにする (インクルードの変更は検出できない)
+        out_preprocessed = source;
+        return {};
+#endif
+    }
+
     std::string ShaderCompiler::_CompileStage(ShaderStage stage, const std::string& source, std::vector<uint32>& out_putSpirv, const std::string& filepath)
     {
 #if SHADERC
 
-        shaderc::Compiler compiler;
+        shaderc::Compiler& compiler = GetThreadCompiler();
 
-        // コンパイル: SPIR-V バイナリ形式へコンパイル
+        // コンパイル: SPIR-V バイナリ形式へコンパイル (プリプロセス済みのソースを受け取る)
         shaderc::CompileOptions options;
-        options.SetTargetEnvironment(shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_2);
-        options.SetWarningsAsErrors();
-        options.SetIncluder(std::make_unique<ShaderIncluder>());
+        SetupCompileOptions(options);
 
         
         const shaderc::SpvCompilationResult compileResult = compiler.CompileGlslToSpv(source, ToShaderC(stage), filepath.c_str(), options);
@@ -455,7 +1007,7 @@ namespace Silex
 #endif
     }
 
-    void ShaderCompiler::_ReflectStage(ShaderStage stage, const std::vector<uint32>& spirv)
+    void ShaderCompiler::_ReflectStage(ShaderReflectionContext& context, ShaderStage stage, const std::vector<uint32>& spirv)
     {
         SL_LOG_TRACE("・{}", ToStageString(stage));
 
@@ -477,11 +1029,11 @@ namespace Silex
                 const uint32 descriptorSet = compiler.get_decoration(resource.id, spv::DecorationDescriptorSet);
                 const uint32 size          = compiler.get_declared_struct_size(bufferType);
 
-                if (descriptorSet >= ReflectionData.descriptorSets.size())
-                    ReflectionData.descriptorSets.resize(descriptorSet + 1);
+                if (descriptorSet >= context.reflectionData.descriptorSets.size())
+                    context.reflectionData.descriptorSets.resize(descriptorSet + 1);
 
-                ShaderDescriptorSet& shaderDescriptorSet = ReflectionData.descriptorSets[descriptorSet];
-                if (ExistUniformBuffers[descriptorSet].find(binding) == ExistUniformBuffers[descriptorSet].end())
+                ShaderDescriptorSet& shaderDescriptorSet = context.reflectionData.descriptorSets[descriptorSet];
+                if (context.existUniformBuffers[descriptorSet].find(binding) == context.existUniformBuffers[descriptorSet].end())
                 {
                     ShaderBuffer uniformBuffer;
                     uniformBuffer.setIndex     = descriptorSet;
@@ -490,18 +1042,18 @@ namespace Silex
                     uniformBuffer.name         = name;
                     uniformBuffer.stage        = SHADER_STAGE_ALL;
 
-                    ExistUniformBuffers.at(descriptorSet)[binding] = uniformBuffer;
+                    context.existUniformBuffers.at(descriptorSet)[binding] = uniformBuffer;
                 }
                 else
                 {
-                    ShaderBuffer& uniformBuffer = ExistUniformBuffers.at(descriptorSet).at(binding);
+                    ShaderBuffer& uniformBuffer = context.existUniformBuffers.at(descriptorSet).at(binding);
                     if (size > uniformBuffer.size)
                     {
                         uniformBuffer.size = size;
                     }
                 }
 
-                shaderDescriptorSet.uniformBuffers[binding] = ExistUniformBuffers.at(descriptorSet).at(binding);
+                shaderDescriptorSet.uniformBuffers[binding] = context.existUniformBuffers.at(descriptorSet).at(binding);
 
                 SL_LOG_TRACE("  (set: {}, bind: {}) uniform {}", descriptorSet, binding, name);
             }
@@ -521,11 +1073,11 @@ namespace Silex
                 const uint32 descriptorSet = compiler.get_decoration(resource.id, spv::DecorationDescriptorSet);
                 const uint32 size          = compiler.get_declared_struct_size(bufferType);
 
-                if (descriptorSet >= ReflectionData.descriptorSets.size())
-                    ReflectionData.descriptorSets.resize(descriptorSet + 1);
+                if (descriptorSet >= context.reflectionData.descriptorSets.size())
+                    context.reflectionData.descriptorSets.resize(descriptorSet + 1);
 
-                ShaderDescriptorSet& shaderDescriptorSet = ReflectionData.descriptorSets[descriptorSet];
-                if (ExistStorageBuffers[descriptorSet].find(binding) == ExistStorageBuffers[descriptorSet].end())
+                ShaderDescriptorSet& shaderDescriptorSet = context.reflectionData.descriptorSets[descriptorSet];
+                if (context.existStorageBuffers[descriptorSet].find(binding) == context.existStorageBuffers[descriptorSet].end())
                 {
                     ShaderBuffer storageBuffer;
                     storageBuffer.setIndex     = descriptorSet;
@@ -534,18 +1086,18 @@ namespace Silex
                     storageBuffer.name         = name;
                     storageBuffer.stage        = SHADER_STAGE_ALL;
 
-                    ExistStorageBuffers.at(descriptorSet)[binding] = storageBuffer;
+                    context.existStorageBuffers.at(descriptorSet)[binding] = storageBuffer;
                 }
                 else
                 {
-                    ShaderBuffer& storageBuffer = ExistStorageBuffers.at(descriptorSet).at(binding);
+                    ShaderBuffer& storageBuffer = context.existStorageBuffers.at(descriptorSet).at(binding);
                     if (size > storageBuffer.size)
                     {
                         storageBuffer.size = size;
                     }
                 }
 
-                shaderDescriptorSet.storageBuffers[binding] = ExistStorageBuffers.at(descriptorSet).at(binding);
+                shaderDescriptorSet.storageBuffers[binding] = context.existStorageBuffers.at(descriptorSet).at(binding);
 
                 SL_LOG_TRACE("  (set: {}, bind: {}) buffer {}", descriptorSet, binding, name);
             }
@@ -565,10 +1117,10 @@ namespace Silex
             if (!type.array.empty())
                 arraySize = type.array[0];
 
-            if (descriptorSet >= ReflectionData.descriptorSets.size())
-                ReflectionData.descriptorSets.resize(descriptorSet + 1);
+            if (descriptorSet >= context.reflectionData.descriptorSets.size())
+                context.reflectionData.descriptorSets.resize(descriptorSet + 1);
 
-            ShaderImage& imageSampler = ReflectionData.descriptorSets[descriptorSet].imageSamplers[binding];
+            ShaderImage& imageSampler = context.reflectionData.descriptorSets[descriptorSet].imageSamplers[binding];
             imageSampler.bindingPoint = binding;
             imageSampler.setIndex     = descriptorSet;
             imageSampler.name         = name;
@@ -576,7 +1128,7 @@ namespace Silex
             imageSampler.dimension    = dimension;
             imageSampler.arraySize    = arraySize;
 
-            ShaderResourceDeclaration& resource = ReflectionData.resources[name]; 
+            ShaderResourceDeclaration& resource = context.reflectionData.resources[name]; 
             resource.name          = name;
             resource.setIndex      = descriptorSet;
             resource.registerIndex = binding;
@@ -599,10 +1151,10 @@ namespace Silex
             if (arraySize == 0)
                 arraySize = 1;
 
-            if (descriptorSet >= ReflectionData.descriptorSets.size())
-                ReflectionData.descriptorSets.resize(descriptorSet + 1);
+            if (descriptorSet >= context.reflectionData.descriptorSets.size())
+                context.reflectionData.descriptorSets.resize(descriptorSet + 1);
 
-            ShaderDescriptorSet& shaderDescriptorSet = ReflectionData.descriptorSets[descriptorSet];
+            ShaderDescriptorSet& shaderDescriptorSet = context.reflectionData.descriptorSets[descriptorSet];
             auto& imageSampler        = shaderDescriptorSet.separateTextures[binding];
             imageSampler.bindingPoint = binding;
             imageSampler.setIndex     = descriptorSet;
@@ -611,7 +1163,7 @@ namespace Silex
             imageSampler.dimension    = dimension;
             imageSampler.arraySize    = arraySize;
 
-            ShaderResourceDeclaration& resource = ReflectionData.resources[name];
+            ShaderResourceDeclaration& resource = context.reflectionData.resources[name];
             resource.name          = name;
             resource.setIndex      = descriptorSet;
             resource.registerIndex = binding;
@@ -634,10 +1186,10 @@ namespace Silex
             if (arraySize == 0)
                 arraySize = 1;
 
-            if (descriptorSet >= ReflectionData.descriptorSets.size())
-                ReflectionData.descriptorSets.resize(descriptorSet + 1);
+            if (descriptorSet >= context.reflectionData.descriptorSets.size())
+                context.reflectionData.descriptorSets.resize(descriptorSet + 1);
 
-            ShaderDescriptorSet& shaderDescriptorSet = ReflectionData.descriptorSets[descriptorSet];
+            ShaderDescriptorSet& shaderDescriptorSet = context.reflectionData.descriptorSets[descriptorSet];
             auto& imageSampler = shaderDescriptorSet.separateSamplers[binding];
             imageSampler.bindingPoint = binding;
             imageSampler.setIndex     = descriptorSet;
@@ -646,7 +1198,7 @@ namespace Silex
             imageSampler.dimension    = dimension;
             imageSampler.arraySize    = arraySize;
 
-            ShaderResourceDeclaration& resource = ReflectionData.resources[name];
+            ShaderResourceDeclaration& resource = context.reflectionData.resources[name];
             resource.name          = name;
             resource.setIndex      = descriptorSet;
             resource.registerIndex = binding;
@@ -668,10 +1220,10 @@ namespace Silex
             if (arraySize == 0)
                 arraySize = 1;
 
-            if (descriptorSet >= ReflectionData.descriptorSets.size())
-                ReflectionData.descriptorSets.resize(descriptorSet + 1);
+            if (descriptorSet >= context.reflectionData.descriptorSets.size())
+                context.reflectionData.descriptorSets.resize(descriptorSet + 1);
 
-            ShaderDescriptorSet& shaderDescriptorSet = ReflectionData.descriptorSets[descriptorSet];
+            ShaderDescriptorSet& shaderDescriptorSet = context.reflectionData.descriptorSets[descriptorSet];
             auto& imageSampler = shaderDescriptorSet.storageImages[binding];
             imageSampler.bindingPoint = binding;
             imageSampler.setIndex     = descriptorSet;
@@ -680,7 +1232,7 @@ namespace Silex
             imageSampler.arraySize    = arraySize;
             imageSampler.stage        = stage;
 
-            ShaderResourceDeclaration& resource = ReflectionData.resources[name];
+            ShaderResourceDeclaration& resource = context.reflectionData.resources[name];
             resource.name          = name;
             resource.setIndex      = descriptorSet;
             resource.registerIndex = binding;
@@ -698,30 +1250,30 @@ namespace Silex
             uint32 memberCount     = bufferType.member_types.size();
             uint32 bufferOffset    = 0;
 
-            //if (ReflectionData.pushConstantRanges.size())
-            //     bufferOffset = ReflectionData.pushConstantRanges.back().offset + ReflectionData.pushConstantRanges.back().size;
+            //if (context.reflectionData.pushConstantRanges.size())
+            //     bufferOffset = context.reflectionData.pushConstantRanges.back().offset + context.reflectionData.pushConstantRanges.back().size;
 
-            // auto& pushConstantRange  = ReflectionData.pushConstantRanges.emplace_back();
+            // auto& pushConstantRange  = context.reflectionData.pushConstantRanges.emplace_back();
 
             //================================================================================================================
             // 全シェーダーステージ間で同じレイアウトのプッシュ定数が定義されていることを前提とし、1つの定数レンジで SHADER_STAGE_ALL とする
             // つまり、（ループで1つのデータを更新するので）一番最後にプッシュ定数宣言したステージのデータが全ステージで共有される
             //================================================================================================================
-            if (!IsExistPushConstant)
+            if (!context.isExistPushConstant)
             {
-                PushConstantRange& range = ReflectionData.pushConstantRanges.emplace_back();
+                PushConstantRange& range = context.reflectionData.pushConstantRanges.emplace_back();
                 range.stage  = SHADER_STAGE_ALL;
                 range.size   = bufferSize;
                 range.offset = bufferOffset;
 
-                IsExistPushConstant = true;
+                context.isExistPushConstant = true;
             }
 
             //================================================================================================================
             // 以下、メンバー情報のデバッグ情報のため、実際には使用しない（※ステージ間で異なるレイアウトのリフレクションの取得を試みたが、出来なかった）
             //================================================================================================================
             {
-                ShaderPushConstant& buffer = ReflectionData.pushConstants[name];
+                ShaderPushConstant& buffer = context.reflectionData.pushConstants[name];
                 buffer.name = name;
                 buffer.size = bufferSize - bufferOffset;
 
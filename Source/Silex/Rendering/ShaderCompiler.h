@@ -126,9 +126,25 @@ namespace Silex
     };
 
 
+    //------------------------------------
+    // キャッシュ統計
+    //------------------------------------
+    struct ShaderCacheStats
+    {
+        uint32 numHit  = 0;
+        uint32 numMiss = 0;
+    };
+
+
+    // リフレクション作業データ (Compile 呼び出し毎に生成し、スレッド間で共有しない)
+    struct ShaderReflectionContext;
+
+
     //------------------------------------
     // シェーダーコンパイラ
     //------------------------------------
+    // Compile / CompileAll は複数スレッドから同時に呼び出せる
+    //------------------------------------
     class ShaderCompiler : public Object
     {
         SL_CLASS(ShaderCompiler, Object)
@@ -145,16 +161,29 @@ namespace Silex
         // コンパイル
         bool Compile(const std::string& filePath, ShaderCompiledData& out_compiledData);
 
+        // 一括コンパイル (ファイル・ステージ単位でスレッドプールで並列に実行)
+        // 結果は入力と同じ順序で格納され、失敗したファイルの要素は空になる
+        bool CompileAll(const std::vector<std::string>& filePaths, std::vector<ShaderCompiledData>& out_compiledData);
+
+        // キャッシュのヒット・ミス回数
+        ShaderCacheStats GetCacheStats() const;
+
+        // キャッシュの使用 (無効時は読み書きともに行わない / ベンチマーク用)
+        void SetCacheEnabled(bool enable);
+
     private:
 
         // コンパイル前処理
         std::unordered_map<ShaderStage, std::string> _SplitStages(const std::string& source);
 
+        // プリプロセス (インクルード・マクロを展開したソースを生成)
+        std::string _PreprocessStage(ShaderStage stage, const std::string& source, std::string& out_preprocessed, const std::string& filepath);
+
         // コンパイル(spirvバイナリ)を生成
         std::string _CompileStage(ShaderStage stage, const std::string& source, std::vector<uint32>& out_putSpirv, const std::string& filepath);
 
-        // コンパイル(spirvバイナリ)を生成
-        void _ReflectStage(ShaderStage stage, const std::vector<uint32>& spirv);
+        // リフレクション
+        void _ReflectStage(ShaderReflectionContext& context, ShaderStage stage, const std::vector<uint32>& spirv);
 
     private:
 
@@ -0,0 +1,366 @@
+#include "PCH.h"
+#include "Rendering/TextureCooker.h"
+#include "Rendering/CookedFile.h"
+#include "Rendering/TextureEncoder.h"
+#include "Rendering/RenderingUtility.h"
+#include "Rendering/Renderer.h"
+#include "Rendering/RenderingAPI.h"
+#include "Asset/TextureReader.h"
+#include "Core/Profiler.h"
+#include "Core/Hash.h"
+
+
+namespace Silex
+{
+    static const char* CookedTextureDirectory = "Assets/Textures/Cache/";
+
+    // 不透明テクスチャを BC1 で保存する品質の下限 (下回る場合は BC7 を使用する)
+    static const double MinBC1PSNR = 36.0;
+
+    static uint64 AlignCookedOffset(uint64 offset)
+    {
+        return (offset + CookedTextureAlignment - 1) & ~(CookedTextureAlignment - 1);
+    }
+
+    // 法線マップは命名規則で判定する (Sponza: *_normal / *_Normal)
+    static bool IsNormalMap(const std::string& sourcePath)
+    {
+        std::string stem = std::filesystem::path(sourcePath).stem().string();
+        std::transform(stem.begin(), stem.end(), stem.begin(), [](char c) { return (char)std::tolower((unsigned char)c); });
+
+        return stem.ends_with("_normal") || stem.ends_with("_nrm");
+    }
+
+    static bool HasAlpha(const uint8* pixels, uint64 numPixels)
+    {
+        for (uint64 i = 0; i < numPixels; i++)
+        {
+            if (pixels[i * 4 + 3] != 255)
+                return true;
+        }
+
+        return false;
+    }
+
+    static double CalcPSNR(double meanSquaredError)
+    {
+        return meanSquaredError > 0.0? 10.0 * std::log10(255.0 * 255.0 / meanSquaredError) : std::numeric_limits<double>::infinity();
+    }
+
+    static const char* GetFormatName(RenderingFormat format)
+    {
+        switch (format)
+        {
+            case RENDERING_FORMAT_BC1_RGB_UNORM_BLOCK: return "BC1";
+            case RENDERING_FORMAT_BC3_UNORM_BLOCK:     return "BC3";
+            case RENDERING_FORMAT_BC5_UNORM_BLOCK:     return "BC5";
+            case RENDERING_FORMAT_BC6H_UFLOAT_BLOCK:   return "BC6H";
+            case RENDERING_FORMAT_BC7_UNORM_BLOCK:     return "BC7";
+            case RENDERING_FORMAT_R8G8B8A8_UNORM:      return "RGBA8";
+            case RENDERING_FORMAT_R16G16B16A16_SFLOAT: return "RGBA16F";
+            default:                                   return "Unknown";
+        }
+    }
+
+    static RenderingFormat SelectFormat(const std::string& sourcePath, bool compress, bool isHDR, const void* pixels, uint32 width, uint32 height)
+    {
+        if (!compress)
+            return isHDR? RENDERING_FORMAT_R16G16B16A16_SFLOAT : RENDERING_FORMAT_R8G8B8A8_UNORM;
+
+        if (isHDR)
+            return RENDERING_FORMAT_BC6H_UFLOAT_BLOCK;
+
+        if (IsNormalMap(sourcePath))
+            return RENDERING_FORMAT_BC5_UNORM_BLOCK;
+
+        if (HasAlpha((const uint8*)pixels, (uint64)width * height))
+            return RENDERING_FORMAT_BC3_UNORM_BLOCK;
+
+        return RENDERING_FORMAT_BC1_RGB_UNORM_BLOCK;
+    }
+
+    // 2x2 ボックスフィルタで縮小する (奇数サイズの端は、範囲外を端のピクセルで代用する)
+    template<typename T>
+    static void Downsample(const T* src, uint32 srcWidth, uint32 srcHeight, T* dst, uint32 dstWidth, uint32 dstHeight)
+    {
+        for (uint32 y = 0; y < dstHeight; y++)
+        {
+            const uint64 y0 = std::min(y * 2 + 0, srcHeight - 1);
+            const uint64 y1 = std::min(y * 2 + 1, srcHeight - 1);
+
+            for (uint32 x = 0; x < dstWidth; x++)
+            {
+                const uint64 x0 = std::min(x * 2 + 0, srcWidth - 1);
+                const uint64 x1 = std::min(x * 2 + 1, srcWidth - 1);
+
+                for (uint32 c = 0; c < 4; c++)
+                {
+                    const float sum = (float)src[(y0 * srcWidth + x0) * 4 + c] + (float)src[(y0 * srcWidth + x1) * 4 + c]
+                                    + (float)src[(y1 * srcWidth + x0) * 4 + c] + (float)src[(y1 * srcWidth + x1) * 4 + c];
+
+                    dst[((uint64)y * dstWidth + x) * 4 + c] = std::is_integral_v<T>? T(sum * 0.25f + 0.5f) : T(sum * 0.25f);
+                }
+            }
+        }
+    }
+
+    // ミップ 1 以降を生成する (ミップ 0 はデコード結果をそのまま使用する)
+    template<typename T>
+    static void GenerateMipmaps(const T* pixels, const std::vector<Extent>& mipmaps, std::vector<std::vector<T>>& out_levels, std::vector<const void*>& out_pixels)
+    {
+        out_levels.resize(mipmaps.size());
+        out_pixels.resize(mipmaps.size());
+        out_pixels[0] = pixels;
+
+        for (uint32 mip = 1; mip < mipmaps.size(); mip++)
+        {
+            const Extent& src = mipmaps[mip - 1];
+            const Extent& dst = mipmaps[mip];
+
+            out_levels[mip].resize((uint64)dst.width * dst.height * 4);
+            Downsample((const T*)out_pixels[mip - 1], src.width, src.height, out_levels[mip].data(), dst.width, dst.height);
+
+            out_pixels[mip] = out_levels[mip].data();
+        }
+    }
+
+
+    bool TextureCooker::Cook(const std::string& sourcePath, uint64 sourceKey, bool compress, std::vector<byte>& out_data)
+    {
+        SL_SCOPE_PROFILE("TextureCooker::Cook");
+
+        TextureReader reader;
+        const bool  isHDR  = reader.IsHDR(sourcePath.c_str());
+        const void* pixels = isHDR? (const void*)reader.ReadHDR(sourcePath.c_str()) : (const void*)reader.Read(sourcePath.c_str());
+
+        if (!pixels)
+            return false;
+
+        const uint32 width  = reader.data.width;
+        const uint32 height = reader.data.height;
+
+        // ミップチェーン
+        const std::vector<Extent> mipmaps = RenderingUtility::CalculateMipmap(width, height);
+
+        std::vector<std::vector<uint8>> ldrLevels;
+        std::vector<std::vector<float>> hdrLevels;
+        std::vector<const void*>        mipPixels;
+
+        if (isHDR) GenerateMipmaps((const float*)pixels, mipmaps, hdrLevels, mipPixels);
+        else       GenerateMipmaps((const uint8*)pixels, mipmaps, ldrLevels, mipPixels);
+
+        // 不透明テクスチャは、BC1 の誤差が大きい (グラデーション等でバンディングが目立つ) 場合に BC7 を使用する
+        RenderingFormat   format = SelectFormat(sourcePath, compress, isHDR, pixels, width, height);
+        std::vector<byte> bc1Level;
+
+        if (format == RENDERING_FORMAT_BC1_RGB_UNORM_BLOCK)
+        {
+            bc1Level.resize(TextureEncoder::CalcLevelSize(format, width, height));
+            double error = TextureEncoder::Encode(format, pixels, width, height, bc1Level.data());
+
+            if (CalcPSNR(error) < MinBC1PSNR)
+            {
+                format   = RENDERING_FORMAT_BC7_UNORM_BLOCK;
+                bc1Level = {};
+            }
+        }
+
+        //==============================================
+        // レイアウト
+        //==============================================
+        CookedTextureHeader header = {};
+        header.magic     = CookedTextureMagic;
+        header.version   = CookedTextureVersion;
+        header.sourceKey = sourceKey;
+        header.format    = (uint32)format;
+        header.width     = width;
+        header.height    = height;
+        header.numMip    = (uint32)mipmaps.size();
+
+        std::vector<uint64> mipOffsets(header.numMip);
+        uint64 dataSize = 0;
+
+        for (uint32 mip = 0; mip < header.numMip; mip++)
+        {
+            mipOffsets[mip] = dataSize;
+            dataSize = AlignCookedOffset(dataSize + TextureEncoder::CalcLevelSize(format, mipmaps[mip].width, mipmaps[mip].height));
+        }
+
+        uint64 offset = AlignCookedOffset(sizeof(CookedTextureHeader));
+        header.mipOffset  = offset; offset = AlignCookedOffset(offset + sizeof(uint64) * header.numMip);
+        header.dataOffset = offset; offset = AlignCookedOffset(offset + dataSize);
+        header.dataSize   = dataSize;
+        header.fileSize   = offset;
+
+        // パディングは 0 で埋める (同じ入力から同じファイルを生成する)
+        out_data.assign(header.fileSize, 0);
+
+        byte* data = out_data.data();
+        std::memcpy(data,                    &header,           sizeof(CookedTextureHeader));
+        std::memcpy(data + header.mipOffset, mipOffsets.data(), sizeof(uint64) * header.numMip);
+
+        //==============================================
+        // エンコード (ブロック行単位で並列に処理される)
+        //==============================================
+        for (uint32 mip = 0; mip < header.numMip; mip++)
+        {
+            byte* dst = data + header.dataOffset + mipOffsets[mip];
+
+            if (mip == 0 && !bc1Level.empty())
+            {
+                std::memcpy(dst, bc1Level.data(), bc1Level.size());
+            }
+            else
+            {
+                TextureEncoder::Encode(format, mipPixels[mip], mipmaps[mip].width, mipmaps[mip].height, dst);
+            }
+        }
+
+        SL_LOG_INFO("テクスチャをクックしました: {} ({}, {}x{}, {} mips, {:.2f} MB / 非圧縮 {:.2f} MB)", sourcePath, GetFormatName(format), width, height,
+            header.numMip, dataSize / (1024.0 * 1024.0), reader.data.byteSize * 4.0 / 3.0 / (1024.0 * 1024.0));
+
+        return true;
+    }
+
+    bool TextureCooker::Parse(const byte* data, uint64 dataSize, uint64 sourceKey, CookedTextureView& out_view)
+    {
+        if (dataSize < sizeof(CookedTextureHeader))
+            return false;
+
+        const CookedTextureHeader* header = reinterpret_cast<const CookedTextureHeader*>(data);
+        const RenderingFormat      format = (RenderingFormat)header->format;
+
+        bool valid = header->magic == CookedTextureMagic;
+        valid = valid && header->version   == CookedTextureVersion;
+        valid = valid && header->sourceKey == sourceKey;
+        valid = valid && header->fileSize  == dataSize;
+        valid = valid && TextureEncoder::IsSupported(format);
+        valid = valid && header->width > 0 && header->height > 0;
+        valid = valid && header->numMip == RenderingUtility::CalculateMipmap(header->width, header->height).size();
+
+        if (!valid)
+            return false;
+
+        auto InRange = [dataSize](uint64 offset, uint64 count, uint64 stride)
+        {
+            return offset % CookedTextureAlignment == 0 && offset <= dataSize && count <= (dataSize - offset) / stride;
+        };
+
+        valid = valid && InRange(header->mipOffset,  header->numMip,   sizeof(uint64));
+        valid = valid && InRange(header->dataOffset, header->dataSize, 1);
+
+        if (!valid)
+            return false;
+
+        out_view.header     = header;
+        out_view.mipOffsets = reinterpret_cast<const uint64*>(data + header->mipOffset);
+        out_view.data       = data + header->dataOffset;
+
+        // 各ミップがデータ内に収まっているか (コピー元オフセットはブロックサイズの倍数であること)
+        for (uint32 mip = 0; mip < header->numMip && valid; mip++)
+        {
+            const uint64 offset = out_view.mipOffsets[mip];
+            const uint64 size   = TextureEncoder::CalcLevelSize(format, std::max(header->width >> mip, 1u), std::max(header->height >> mip, 1u));
+
+            valid = valid && offset % CookedTextureAlignment == 0 && offset <= header->dataSize && size <= header->dataSize - offset;
+        }
+
+        return valid;
+    }
+
+    bool TextureCooker::Map(const std::string& sourcePath, CookedTextureFile& out_file)
+    {
+        out_file.sourcePath = sourcePath;
+        out_file.cookedPath = GetCookedPath(sourcePath);
+        out_file.sourceKey  = GetSourceKey(sourcePath, IsCompressionSupported());
+
+        if (!OS::Get()->MapFile(out_file.cookedPath, out_file.mapped))
+            return false;
+
+        if (!Parse(out_file.mapped.data, out_file.mapped.size, out_file.sourceKey, out_file.view))
+        {
+            SL_LOG_INFO("クック済みテクスチャが古いため、再クックします: {}", out_file.cookedPath);
+            OS::Get()->UnmapFile(out_file.mapped);
+
+            return false;
+        }
+
+        return true;
+    }
+
+    bool TextureCooker::CookToMemory(const std::string& sourcePath, CookedTextureFile& out_file)
+    {
+        const bool compress = IsCompressionSupported();
+
+        out_file.sourcePath = sourcePath;
+        out_file.cookedPath = GetCookedPath(sourcePath);
+        out_file.sourceKey  = GetSourceKey(sourcePath, compress);
+
+        if (!Cook(sourcePath, out_file.sourceKey, compress, out_file.memory))
+            return false;
+
+        // 保存に失敗しても、今回の読み込みはメモリ上のデータで続行する
+        CookedFile::Write(out_file.cookedPath, out_file.memory);
+
+        return Parse(out_file.memory.data(), out_file.memory.size(), out_file.sourceKey, out_file.view);
+    }
+
+    void TextureCooker::Close(CookedTextureFile& file)
+    {
+        OS::Get()->UnmapFile(file.mapped);
+
+        file.memory = {};
+        file.view   = {};
+    }
+
+    Texture2D* TextureCooker::CreateTexture(const CookedTextureView& view)
+    {
+        const CookedTextureHeader* header = view.header;
+        return Renderer::Get()->CreateTextureFromMemory((RenderingFormat)header->format, view.data, header->dataSize, header->width, header->height, header->numMip, view.mipOffsets);
+    }
+
+    Texture2D* TextureCooker::Load(const std::string& sourcePath)
+    {
+        // クック済みファイルをマップして、そのままアップロード (無い・古い場合はクックし、次回以降のために保存)
+        Texture2D* texture = nullptr;
+
+        CookedTextureFile file;
+        if (Map(sourcePath, file) || CookToMemory(sourcePath, file))
+        {
+            texture = CreateTexture(file.view);
+        }
+
+        Close(file);
+        return texture;
+    }
+
+    std::string TextureCooker::GetCookedPath(const std::string& sourcePath)
+    {
+        // 同名ファイルの衝突を避けるため、ソースのパスのハッシュを付ける
+        return std::format("{}{}.{:016x}.sltex", CookedTextureDirectory, std::filesystem::path(sourcePath).stem().string(), Hash::FNV(sourcePath.c_str()));
+    }
+
+    bool TextureCooker::IsCompressionSupported()
+    {
+        // クック結果はデバイスの対応状況で変わるので、レンダラーの初期化前には判定できない (Cook に明示的に指定する)
+        Renderer* renderer = Renderer::Get();
+        SL_ASSERT(renderer && renderer->GetAPI());
+
+        return renderer && renderer->GetAPI() && renderer->GetAPI()->IsTextureCompressionSupported();
+    }
+
+    uint64 TextureCooker::GetSourceKey(const std::string& sourcePath, bool compress)
+    {
+        std::error_code ec;
+        const uint64 fileSize  = std::filesystem::file_size(sourcePath, ec);
+        const int64  writeTime = std::filesystem::last_write_time(sourcePath, ec).time_since_epoch().count();
+
+        uint64 key = Hash::FNV(&CookedTextureVersion, sizeof(CookedTextureVersion));
+        key = Hash::FNV(&compress,   sizeof(compress),   key);
+        key = Hash::FNV(&MinBC1PSNR, sizeof(MinBC1PSNR), key);
+        key = Hash::FNV(&fileSize,   sizeof(fileSize),   key);
+        key = Hash::FNV(&writeTime,  sizeof(writeTime),  key);
+
+        return key;
+    }
+}
@@ -0,0 +1,103 @@
+
+#pragma once
+
+#include "Core/CoreType.h"
+#include "Core/OS.h"
+#include "Rendering/RenderingCore.h"
+
+
+namespace Silex
+{
+    class Texture2D;
+
+
+    //======================================================================================
+    // クック済みテクスチャ
+    //--------------------------------------------------------------------------------------
+    // ソース画像 (PNG / JPG / HDR) のデコード・ミップチェーン生成・ブロック圧縮の結果を保存し、
+    // 次回以降はファイルをマップして 全ミップをそのままアップロードする (デコードと GPU でのミップ生成は行わない)
+    //
+    // [ヘッダー][ミップオフセットテーブル][ミップ 0][ミップ 1] ...
+    // 各セクションは CookedTextureAlignment 境界に配置し、マップしたポインタをそのまま参照する
+    //
+    // フォーマットは内容から選択する
+    //  HDR        : BC6H
+    //  法線マップ : BC5 (ファイル名が *_normal)
+    //  アルファ有 : BC3
+    //  不透明     : BC1 (誤差が大きい場合は BC7)
+    // BC 圧縮に対応していないデバイスでは、非圧縮 (RGBA8 / RGBA16F) で保存する
+    //======================================================================================
+    static constexpr uint32 CookedTextureMagic     = 'S' | ('L' << 8) | ('T' << 16) | ('X' << 24);
+    static constexpr uint32 CookedTextureVersion   = 1;
+    static constexpr uint64 CookedTextureAlignment = 16;
+
+    struct CookedTextureHeader
+    {
+        uint32 magic;
+        uint32 version;
+        uint64 sourceKey;       // ソースファイル (サイズ・更新時刻) と圧縮設定のハッシュ
+        uint64 fileSize;        // 書き込み途中のファイルの検出用
+
+        uint32 format;          // RenderingFormat
+        uint32 width;
+        uint32 height;
+        uint32 numMip;
+
+        uint64 mipOffset;       // ミップオフセットテーブルの位置
+        uint64 dataOffset;      // ミップデータの位置 (テーブルの値は ここからの相対位置)
+        uint64 dataSize;
+    };
+
+    // クック済みデータの参照 (マップしたファイル、またはクック直後のメモリを指し、所有権は持たない)
+    struct CookedTextureView
+    {
+        const CookedTextureHeader* header     = nullptr;
+        const uint64*              mipOffsets = nullptr;
+        const byte*                data       = nullptr;
+    };
+
+    // 読み込み中のクック済みテクスチャ (マップしたファイル、またはクックしたメモリのどちらかを保持する)
+    struct CookedTextureFile
+    {
+        std::string       sourcePath = {};
+        std::string       cookedPath = {};
+        uint64            sourceKey  = 0;
+        MappedFile        mapped     = {};
+        std::vector<byte> memory     = {};
+        CookedTextureView view       = {};
+    };
+
+
+    class TextureCooker
+    {
+    public:
+
+        // ソース画像をデコードし、ミップチェーンを生成して圧縮する (compress: BC 圧縮するか, 無効時は非圧縮で保存する)
+        static bool Cook(const std::string& sourcePath, uint64 sourceKey, bool compress, std::vector<byte>& out_data);
+
+        // ヘッダーとミップの範囲を検証し、参照を構築する (sourceKey が一致しなければ失敗)
+        static bool Parse(const byte* data, uint64 dataSize, uint64 sourceKey, CookedTextureView& out_view);
+
+        // クック済みファイルをマップして検証する (存在しない・古い場合は false を返すので、CookToMemory で生成する)
+        static bool Map(const std::string& sourcePath, CookedTextureFile& out_file);
+
+        // クックしてファイルに保存し、メモリ上のデータを参照する
+        static bool CookToMemory(const std::string& sourcePath, CookedTextureFile& out_file);
+
+        // マップ解除・メモリ解放 (ステージングへのコピー後に呼び出してよい)
+        static void Close(CookedTextureFile& file);
+
+        // クック済みデータからテクスチャを生成する (メインスレッドのみ)
+        static Texture2D* CreateTexture(const CookedTextureView& view);
+
+        // クック済みファイル (無い・古い場合はクックする) からテクスチャを生成する (メインスレッドのみ)
+        static Texture2D* Load(const std::string& sourcePath);
+
+        // デバイスが BC 圧縮に対応しているか (Map / CookToMemory / Load はこの結果でクックするので、レンダラーの初期化後に呼び出す)
+        static bool IsCompressionSupported();
+
+        // ソースファイルに対応するクック済みファイルのパスとキー (キーは圧縮の有無を含む)
+        static std::string GetCookedPath(const std::string& sourcePath);
+        static uint64      GetSourceKey(const std::string& sourcePath, bool compress);
+    };
+}
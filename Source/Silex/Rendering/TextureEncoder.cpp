@@ -0,0 +1,605 @@
+#include "PCH.h"
+#include "Rendering/TextureEncoder.h"
+#include "Core/ParallelFor.h"
+
+#include <glm/gtc/packing.hpp>
+#include <emmintrin.h>
+
+
+namespace Silex
+{
+    // 並列処理の単位 (ブロック行数)
+    static const uint32 EncodeRowGrain = 4;
+
+    // UF16 (BC6H) で表現できる最大値
+    static const float MaxHalfValue = 65504.0f;
+
+
+    //======================================================================================
+    // 4x4 ブロック
+    //======================================================================================
+    // チャンネルごとに 16ピクセルを並べ、4ピクセルずつ SSE で処理する
+    struct alignas(16) BlockPixels
+    {
+        float channel[4][16];
+    };
+
+    // ブロック内へ下位ビットから順に書き込む (BC6H / BC7)
+    struct BlockBitWriter
+    {
+        byte*  data = nullptr;
+        uint32 bit  = 0;
+
+        void Write(uint32 value, uint32 numBits)
+        {
+            for (uint32 i = 0; i < numBits; i++, bit++)
+            {
+                data[bit >> 3] |= ((value >> i) & 1) << (bit & 7);
+            }
+        }
+    };
+
+    // 画像端のブロックは、端のピクセルを繰り返して埋める
+    static void LoadBlock(const uint8* pixels, uint32 width, uint32 height, uint32 blockX, uint32 blockY, BlockPixels& out_block)
+    {
+        for (uint32 y = 0; y < 4; y++)
+        {
+            const uint32 py = std::min(blockY * 4 + y, height - 1);
+
+            for (uint32 x = 0; x < 4; x++)
+            {
+                const uint32 px    = std::min(blockX * 4 + x, width - 1);
+                const uint8* pixel = pixels + ((uint64)py * width + px) * 4;
+
+                for (uint32 c = 0; c < 4; c++)
+                {
+                    out_block.channel[c][y * 4 + x] = pixel[c];
+                }
+            }
+        }
+    }
+
+    // HDR は 半精度浮動小数のビット列 (BC6H が補間する空間) に変換して読み込む
+    static void LoadBlockHDR(const float* pixels, uint32 width, uint32 height, uint32 blockX, uint32 blockY, BlockPixels& out_block)
+    {
+        for (uint32 y = 0; y < 4; y++)
+        {
+            const uint32 py = std::min(blockY * 4 + y, height - 1);
+
+            for (uint32 x = 0; x < 4; x++)
+            {
+                const uint32 px    = std::min(blockX * 4 + x, width - 1);
+                const float* pixel = pixels + ((uint64)py * width + px) * 4;
+
+                for (uint32 c = 0; c < 3; c++)
+                {
+                    out_block.channel[c][y * 4 + x] = (float)glm::packHalf1x16(std::clamp(pixel[c], 0.0f, MaxHalfValue));
+                }
+
+                out_block.channel[3][y * 4 + x] = 0.0f;
+            }
+        }
+    }
+
+
+    //======================================================================================
+    // 端点・インデックスの計算 (SSE)
+    //======================================================================================
+    static float HorizontalSum(__m128 v)
+    {
+        v = _mm_add_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+        v = _mm_add_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+        return _mm_cvtss_f32(v);
+    }
+
+    static void CalcChannelBounds(const BlockPixels& block, uint32 channel, float& out_min, float& out_max)
+    {
+        const float* values = block.channel[channel];
+
+        __m128 v0 = _mm_load_ps(values + 0);
+        __m128 v1 = _mm_load_ps(values + 4);
+        __m128 v2 = _mm_load_ps(values + 8);
+        __m128 v3 = _mm_load_ps(values + 12);
+
+        __m128 minValue = _mm_min_ps(_mm_min_ps(v0, v1), _mm_min_ps(v2, v3));
+        __m128 maxValue = _mm_max_ps(_mm_max_ps(v0, v1), _mm_max_ps(v2, v3));
+
+        // 4 レーンを集約
+        minValue = _mm_min_ps(minValue, _mm_shuffle_ps(minValue, minValue, _MM_SHUFFLE(2, 3, 0, 1)));
+        minValue = _mm_min_ps(minValue, _mm_shuffle_ps(minValue, minValue, _MM_SHUFFLE(1, 0, 3, 2)));
+        maxValue = _mm_max_ps(maxValue, _mm_shuffle_ps(maxValue, maxValue, _MM_SHUFFLE(2, 3, 0, 1)));
+        maxValue = _mm_max_ps(maxValue, _mm_shuffle_ps(maxValue, maxValue, _MM_SHUFFLE(1, 0, 3, 2)));
+
+        out_min = _mm_cvtss_f32(minValue);
+        out_max = _mm_cvtss_f32(maxValue);
+    }
+
+    static float CalcChannelMean(const BlockPixels& block, uint32 channel)
+    {
+        const float* values = block.channel[channel];
+
+        __m128 sum = _mm_add_ps(_mm_add_ps(_mm_load_ps(values + 0), _mm_load_ps(values + 4)), _mm_add_ps(_mm_load_ps(values + 8), _mm_load_ps(values + 12)));
+        return HorizontalSum(sum) / 16.0f;
+    }
+
+    // バウンディングボックスの対角線のうち、ピクセルの分布に沿う向きを端点とする (主軸の近似)
+    // 端点は 補間値が外側の色に偏らないよう、範囲の insetRatio だけ内側に寄せる
+    static void SelectEndpoints(const BlockPixels& block, uint32 numChannels, float insetRatio, float* out_e0, float* out_e1)
+    {
+        float  minValue[4] = {};
+        float  maxValue[4] = {};
+        uint32 major       = 0;
+
+        for (uint32 c = 0; c < numChannels; c++)
+        {
+            CalcChannelBounds(block, c, minValue[c], maxValue[c]);
+
+            if (maxValue[c] - minValue[c] > maxValue[major] - minValue[major])
+                major = c;
+        }
+
+        // 範囲が最も広いチャンネルとの共分散が負のチャンネルは、対角線の向きを反転する
+        const __m128 majorMean = _mm_set1_ps(CalcChannelMean(block, major));
+
+        for (uint32 c = 0; c < numChannels; c++)
+        {
+            bool flip = false;
+            if (c != major)
+            {
+                const __m128 mean       = _mm_set1_ps(CalcChannelMean(block, c));
+                __m128       covariance = _mm_setzero_ps();
+
+                for (uint32 i = 0; i < 16; i += 4)
+                {
+                    __m128 dMajor = _mm_sub_ps(_mm_load_ps(&block.channel[major][i]), majorMean);
+                    __m128 d      = _mm_sub_ps(_mm_load_ps(&block.channel[c][i]),     mean);
+                    covariance    = _mm_add_ps(covariance, _mm_mul_ps(dMajor, d));
+                }
+
+                flip = HorizontalSum(covariance) < 0.0f;
+            }
+
+            const float inset = (maxValue[c] - minValue[c]) * insetRatio;
+            const float low   = minValue[c] + inset;
+            const float high  = maxValue[c] - inset;
+
+            out_e0[c] = flip? high : low;
+            out_e1[c] = flip? low  : high;
+        }
+    }
+
+    // 端点 e0 → e1 の軸に各ピクセルを射影し、[0, numSteps] の段階に丸める (e0, e1 は firstChannel からの相対インデックス)
+    static void QuantizeToAxis(const BlockPixels& block, uint32 firstChannel, uint32 numChannels, const float* e0, const float* e1, uint32 numSteps, uint8* out_steps)
+    {
+        float axis[4] = {};
+        float lengthSq = 0.0f;
+
+        for (uint32 c = 0; c < numChannels; c++)
+        {
+            axis[c]   = e1[c] - e0[c];
+            lengthSq += axis[c] * axis[c];
+        }
+
+        if (lengthSq < 1e-6f)
+        {
+            std::memset(out_steps, 0, 16);
+            return;
+        }
+
+        const __m128 scale    = _mm_set1_ps((float)numSteps / lengthSq);
+        const __m128 maxSteps = _mm_set1_ps((float)numSteps);
+
+        for (uint32 i = 0; i < 16; i += 4)
+        {
+            __m128 dot = _mm_setzero_ps();
+            for (uint32 c = 0; c < numChannels; c++)
+            {
+                __m128 d = _mm_sub_ps(_mm_load_ps(&block.channel[firstChannel + c][i]), _mm_set1_ps(e0[c]));
+                dot = _mm_add_ps(dot, _mm_mul_ps(d, _mm_set1_ps(axis[c])));
+            }
+
+            // 最近接の段階に丸める (MXCSR の既定の丸めモード)
+            __m128  t     = _mm_min_ps(_mm_max_ps(_mm_mul_ps(dot, scale), _mm_setzero_ps()), maxSteps);
+            __m128i steps = _mm_cvtps_epi32(t);
+
+            alignas(16) int32 values[4];
+            _mm_store_si128((__m128i*)values, steps);
+
+            for (uint32 j = 0; j < 4; j++)
+            {
+                out_steps[i + j] = (uint8)values[j];
+            }
+        }
+    }
+
+    // 選択した段階で復元した値との二乗誤差の合計
+    static float CalcBlockError(const BlockPixels& block, uint32 numChannels, const float* e0, const float* e1, const uint8* steps, uint32 numSteps)
+    {
+        float error = 0.0f;
+        for (uint32 i = 0; i < 16; i++)
+        {
+            const float t = (float)steps[i] / numSteps;
+            for (uint32 c = 0; c < numChannels; c++)
+            {
+                const float d = block.channel[c][i] - (e0[c] + (e1[c] - e0[c]) * t);
+                error += d * d;
+            }
+        }
+
+        return error;
+    }
+
+
+    //======================================================================================
+    // BC1 / BC4
+    //======================================================================================
+    static uint16 PackRGB565(const float* color)
+    {
+        const uint32 r = (uint32)std::clamp(color[0] * 31.0f / 255.0f + 0.5f, 0.0f, 31.0f);
+        const uint32 g = (uint32)std::clamp(color[1] * 63.0f / 255.0f + 0.5f, 0.0f, 63.0f);
+        const uint32 b = (uint32)std::clamp(color[2] * 31.0f / 255.0f + 0.5f, 0.0f, 31.0f);
+
+        return (uint16)((r << 11) | (g << 5) | b);
+    }
+
+    static void UnpackRGB565(uint16 color, float* out_color)
+    {
+        const uint32 r = (color >> 11) & 31;
+        const uint32 g = (color >> 5)  & 63;
+        const uint32 b = (color >> 0)  & 31;
+
+        out_color[0] = (float)((r << 3) | (r >> 2));
+        out_color[1] = (float)((g << 2) | (g >> 4));
+        out_color[2] = (float)((b << 3) | (b >> 2));
+    }
+
+    // BC1 (8 バイト): 565 端点 x2 + 2bit インデックス x16
+    static float EncodeBC1Block(const BlockPixels& block, byte* out_block)
+    {
+        float e0[3], e1[3];
+        SelectEndpoints(block, 3, 1.0f / 16.0f, e0, e1);
+
+        uint16 color0 = PackRGB565(e0);
+        uint16 color1 = PackRGB565(e1);
+
+        // 4色モードは color0 > color1 (同値の場合は全ピクセルが color0 を参照する)
+        if (color0 < color1)
+            std::swap(color0, color1);
+
+        float q0[3], q1[3];
+        UnpackRGB565(color0, q0);
+        UnpackRGB565(color1, q1);
+
+        uint8 steps[16] = {};
+        if (color0 != color1)
+        {
+            QuantizeToAxis(block, 0, 3, q0, q1, 3, steps);
+        }
+
+        // 段階 (color0 → color1) からインデックスへ: 0 = color0, 1 = color1, 2 = 2/3 color0 + 1/3 color1, 3 = 1/3 color0 + 2/3 color1
+        static const uint8 StepToIndex[4] = { 0, 2, 3, 1 };
+
+        uint32 indices = 0;
+        for (uint32 i = 0; i < 16; i++)
+        {
+            indices |= (uint32)StepToIndex[steps[i]] << (i * 2);
+        }
+
+        std::memcpy(out_block + 0, &color0,  sizeof(uint16));
+        std::memcpy(out_block + 2, &color1,  sizeof(uint16));
+        std::memcpy(out_block + 4, &indices, sizeof(uint32));
+
+        return CalcBlockError(block, 3, q0, q1, steps, 3);
+    }
+
+    // BC4 (8 バイト): 8bit 端点 x2 + 3bit インデックス x16 (BC3 のアルファ, BC5 の各チャンネル)
+    static void EncodeBC4Block(const BlockPixels& block, uint32 channel, byte* out_block)
+    {
+        float minValue, maxValue;
+        CalcChannelBounds(block, channel, minValue, maxValue);
+
+        // 8段階モードは value0 > value1
+        const uint8 value0 = (uint8)std::clamp(maxValue + 0.5f, 0.0f, 255.0f);
+        const uint8 value1 = (uint8)std::clamp(minValue + 0.5f, 0.0f, 255.0f);
+
+        uint8 steps[16] = {};
+        if (value0 != value1)
+        {
+            const float e0 = value0;
+            const float e1 = value1;
+            QuantizeToAxis(block, channel, 1, &e0, &e1, 7, steps);
+        }
+
+        // 段階 (value0 → value1) からインデックスへ: 0 = value0, 1 = value1, 2 ~ 7 = value0 側からの補間値
+        static const uint8 StepToIndex[8] = { 0, 2, 3, 4, 5, 6, 7, 1 };
+
+        uint64 indices = 0;
+        for (uint32 i = 0; i < 16; i++)
+        {
+            indices |= (uint64)StepToIndex[steps[i]] << (i * 3);
+        }
+
+        out_block[0] = value0;
+        out_block[1] = value1;
+        std::memcpy(out_block + 2, &indices, 6);
+    }
+
+
+    //======================================================================================
+    // BC7 (モード 6) / BC6H (モード 11)
+    //======================================================================================
+    // 7bit + 端点ごとの pビット に量子化し、復元値を返す
+    static void QuantizeBC7Endpoint(const float* endpoint, uint32* out_quantized, uint32& out_pbit, float* out_restored)
+    {
+        float bestError = std::numeric_limits<float>::max();
+
+        for (uint32 pbit = 0; pbit < 2; pbit++)
+        {
+            uint32 quantized[4];
+            float  restored[4];
+            float  error = 0.0f;
+
+            for (uint32 c = 0; c < 4; c++)
+            {
+                quantized[c] = (uint32)std::clamp((endpoint[c] - pbit) * 0.5f + 0.5f, 0.0f, 127.0f);
+                restored[c]  = (float)((quantized[c] << 1) | pbit);
+                error       += (restored[c] - endpoint[c]) * (restored[c] - endpoint[c]);
+            }
+
+            if (error < bestError)
+            {
+                bestError = error;
+                out_pbit  = pbit;
+                std::memcpy(out_quantized, quantized, sizeof(quantized));
+                std::memcpy(out_restored,  restored,  sizeof(restored));
+            }
+        }
+    }
+
+    // BC7 モード 6 (16 バイト): 7bit RGBA 端点 x2 + pビット x2 + 4bit インデックス x16
+    static float EncodeBC7Block(const BlockPixels& block, byte* out_block)
+    {
+        float e0[4], e1[4];
+        SelectEndpoints(block, 4, 1.0f / 32.0f, e0, e1);
+
+        uint32 quantized[2][4];
+        uint32 pbit[2];
+        float  restored[2][4];
+        QuantizeBC7Endpoint(e0, quantized[0], pbit[0], restored[0]);
+        QuantizeBC7Endpoint(e1, quantized[1], pbit[1], restored[1]);
+
+        // 4bit の補間ウェイトはほぼ等間隔なので、段階をそのままインデックスとする
+        uint8 steps[16];
+        QuantizeToAxis(block, 0, 4, restored[0], restored[1], 15, steps);
+
+        const float error = CalcBlockError(block, 3, restored[0], restored[1], steps, 15);
+
+        // アンカー (ピクセル 0) のインデックスは最上位ビットを省略して格納するので、0 になるよう端点を入れ替える
+        if (steps[0] & 8)
+        {
+            std::swap(quantized[0], quantized[1]);
+            std::swap(pbit[0], pbit[1]);
+
+            for (uint32 i = 0; i < 16; i++)
+            {
+                steps[i] = 15 - steps[i];
+            }
+        }
+
+        std::memset(out_block, 0, 16);
+        BlockBitWriter writer = { out_block };
+
+        writer.Write(1 << 6, 7);
+
+        for (uint32 c = 0; c < 4; c++)
+        {
+            writer.Write(quantized[0][c], 7);
+            writer.Write(quantized[1][c], 7);
+        }
+
+        writer.Write(pbit[0], 1);
+        writer.Write(pbit[1], 1);
+
+        writer.Write(steps[0], 3);
+        for (uint32 i = 1; i < 16; i++)
+        {
+            writer.Write(steps[i], 4);
+        }
+
+        return error;
+    }
+
+    // 半精度のビット列 → 10bit 端点
+    // (復号時は 端点を 16bit に展開 (q * 64 + 32) して補間し、31/64 倍して半精度のビット列とする)
+    static uint32 QuantizeBC6HEndpoint(float halfBits)
+    {
+        return (uint32)std::clamp((halfBits - 15.5f) / 31.0f + 0.5f, 0.0f, 1023.0f);
+    }
+
+    static float RestoreBC6HEndpoint(uint32 quantized)
+    {
+        const uint32 unquantized = quantized == 0? 0 : quantized == 1023? 0xFFFF : (quantized << 6) + 32;
+        return (float)((unquantized * 31) >> 6);
+    }
+
+    // BC6H モード 11 (16 バイト): 10bit RGB 端点 x2 + 4bit インデックス x16 (符号なし)
+    static void EncodeBC6HBlock(const BlockPixels& block, byte* out_block)
+    {
+        float e0[3], e1[3];
+        SelectEndpoints(block, 3, 1.0f / 32.0f, e0, e1);
+
+        uint32 quantized[2][3];
+        float  restored[2][3];
+        for (uint32 c = 0; c < 3; c++)
+        {
+            quantized[0][c] = QuantizeBC6HEndpoint(e0[c]);
+            quantized[1][c] = QuantizeBC6HEndpoint(e1[c]);
+            restored[0][c]  = RestoreBC6HEndpoint(quantized[0][c]);
+            restored[1][c]  = RestoreBC6HEndpoint(quantized[1][c]);
+        }
+
+        uint8 steps[16];
+        QuantizeToAxis(block, 0, 3, restored[0], restored[1], 15, steps);
+
+        // アンカー (ピクセル 0) のインデックスは最上位ビットを省略して格納する
+        if (steps[0] & 8)
+        {
+            std::swap(quantized[0], quantized[1]);
+
+            for (uint32 i = 0; i < 16; i++)
+            {
+                steps[i] = 15 - steps[i];
+            }
+        }
+
+        std::memset(out_block, 0, 16);
+        BlockBitWriter writer = { out_block };
+
+        writer.Write(0x03, 5);
+
+        for (uint32 c = 0; c < 3; c++) writer.Write(quantized[0][c], 10);
+        for (uint32 c = 0; c < 3; c++) writer.Write(quantized[1][c], 10);
+
+        writer.Write(steps[0], 3);
+        for (uint32 i = 1; i < 16; i++)
+        {
+            writer.Write(steps[i], 4);
+        }
+    }
+
+
+    //======================================================================================
+    // TextureEncoder
+    //======================================================================================
+    static uint32 GetBlockBytes(RenderingFormat format)
+    {
+        return format == RENDERING_FORMAT_BC1_RGB_UNORM_BLOCK? 8 : 16;
+    }
+
+    bool TextureEncoder::IsSupported(RenderingFormat format)
+    {
+        switch (format)
+        {
+            case RENDERING_FORMAT_BC1_RGB_UNORM_BLOCK:
+            case RENDERING_FORMAT_BC3_UNORM_BLOCK:
+            case RENDERING_FORMAT_BC5_UNORM_BLOCK:
+            case RENDERING_FORMAT_BC6H_UFLOAT_BLOCK:
+            case RENDERING_FORMAT_BC7_UNORM_BLOCK:
+            case RENDERING_FORMAT_R8G8B8A8_UNORM:
+            case RENDERING_FORMAT_R16G16B16A16_SFLOAT:
+                return true;
+
+            default: return false;
+        }
+    }
+
+    bool TextureEncoder::IsHDRFormat(RenderingFormat format)
+    {
+        return format == RENDERING_FORMAT_BC6H_UFLOAT_BLOCK || format == RENDERING_FORMAT_R16G16B16A16_SFLOAT;
+    }
+
+    uint64 TextureEncoder::CalcLevelSize(RenderingFormat format, uint32 width, uint32 height)
+    {
+        if (format == RENDERING_FORMAT_R8G8B8A8_UNORM)      return (uint64)width * height * 4;
+        if (format == RENDERING_FORMAT_R16G16B16A16_SFLOAT) return (uint64)width * height * 8;
+
+        const uint64 numBlockX = (width  + 3) / 4;
+        const uint64 numBlockY = (height + 3) / 4;
+        return numBlockX * numBlockY * GetBlockBytes(format);
+    }
+
+    double TextureEncoder::Encode(RenderingFormat format, const void* pixels, uint32 width, uint32 height, byte* out_data)
+    {
+        SL_CHECK(!IsSupported(format), 0.0);
+
+        // 非圧縮
+        if (format == RENDERING_FORMAT_R8G8B8A8_UNORM)
+        {
+            std::memcpy(out_data, pixels, CalcLevelSize(format, width, height));
+            return 0.0;
+        }
+
+        if (format == RENDERING_FORMAT_R16G16B16A16_SFLOAT)
+        {
+            const float* src = (const float*)pixels;
+            uint16*      dst = (uint16*)out_data;
+
+            for (uint64 i = 0; i < (uint64)width * height * 4; i++)
+            {
+                dst[i] = glm::packHalf1x16(src[i]);
+            }
+
+            return 0.0;
+        }
+
+        const uint32 numBlockX  = (width  + 3) / 4;
+        const uint32 numBlockY  = (height + 3) / 4;
+        const uint32 blockBytes = GetBlockBytes(format);
+
+        // 誤差はブロック行ごとに集計する (行単位で並列に処理するため)
+        std::vector<double> rowErrors(numBlockY, 0.0);
+
+        ParallelFor(numBlockY, EncodeRowGrain, [&](uint32 blockY)
+        {
+            BlockPixels block;
+            byte* row = out_data + (uint64)blockY * numBlockX * blockBytes;
+
+            for (uint32 blockX = 0; blockX < numBlockX; blockX++)
+            {
+                byte* dst = row + (uint64)blockX * blockBytes;
+
+                switch (format)
+                {
+                    case RENDERING_FORMAT_BC1_RGB_UNORM_BLOCK:
+                    {
+                        LoadBlock((const uint8*)pixels, width, height, blockX, blockY, block);
+                        rowErrors[blockY] += EncodeBC1Block(block, dst);
+                        break;
+                    }
+
+                    case RENDERING_FORMAT_BC3_UNORM_BLOCK:
+                    {
+                        // アルファを独立して圧縮する (カラーブロックは BC1 と同じ 4色モード)
+                        LoadBlock((const uint8*)pixels, width, height, blockX, blockY, block);
+                        EncodeBC4Block(block, 3, dst);
+                        EncodeBC1Block(block, dst + 8);
+                        break;
+                    }
+
+                    case RENDERING_FORMAT_BC5_UNORM_BLOCK:
+                    {
+                        // 法線マップの XY (Z はシェーダーで復元する)
+                        LoadBlock((const uint8*)pixels, width, height, blockX, blockY, block);
+                        EncodeBC4Block(block, 0, dst);
+                        EncodeBC4Block(block, 1, dst + 8);
+                        break;
+                    }
+
+                    case RENDERING_FORMAT_BC6H_UFLOAT_BLOCK:
+                    {
+                        LoadBlockHDR((const float*)pixels, width, height, blockX, blockY, block);
+                        EncodeBC6HBlock(block, dst);
+                        break;
+                    }
+
+                    case RENDERING_FORMAT_BC7_UNORM_BLOCK:
+                    {
+                        LoadBlock((const uint8*)pixels, width, height, blockX, blockY, block);
+                        rowErrors[blockY] += EncodeBC7Block(block, dst);
+                        break;
+                    }
+
+                    default: break;
+                }
+            }
+        });
+
+        double error = 0.0;
+        for (double rowError : rowErrors)
+        {
+            error += rowError;
+        }
+
+        return error / ((double)numBlockX * numBlockY * 16 * 3);
+    }
+}
@@ -0,0 +1,36 @@
+
+#pragma once
+
+#include "Core/CoreType.h"
+#include "Rendering/RenderingCore.h"
+
+
+namespace Silex
+{
+    //======================================================================================
+    // テクスチャのブロック圧縮 (BC1 / BC3 / BC5 / BC6H / BC7)
+    //--------------------------------------------------------------------------------------
+    // 4x4 ブロックごとに、バウンディングボックスの対角線から端点を選び、各ピクセルを端点間の軸に射影してインデックスを決める
+    // 境界・射影の計算は 4 ピクセルずつ SSE で処理し、ブロック行をスレッドプールで並列に処理する
+    //
+    // BC7 はモード 6 (1 サブセット RGBA)、BC6H はモード 11 (1 リージョン, 10bit 端点) のみを使用する
+    // BC 非対応デバイス向けに、非圧縮フォーマット (RGBA8 / RGBA16F) への変換にも対応する
+    //======================================================================================
+    class TextureEncoder
+    {
+    public:
+
+        // エンコードに対応しているフォーマットか
+        static bool IsSupported(RenderingFormat format);
+
+        // 入力に float RGBA (HDR) を使用するフォーマットか (それ以外は uint8 RGBA)
+        static bool IsHDRFormat(RenderingFormat format);
+
+        // 1ミップ分のデータサイズ
+        static uint64 CalcLevelSize(RenderingFormat format, uint32 width, uint32 height);
+
+        // 1ミップ分をエンコードし、RGB の 1チャンネルあたりの平均二乗誤差 (0 ~ 255 スケール) を返す
+        // (誤差は フォーマット選択用に BC1 / BC7 のみ計測し、それ以外は 0 を返す)
+        static double Encode(RenderingFormat format, const void* pixels, uint32 width, uint32 height, byte* out_data);
+    };
+}
@@ -0,0 +1,479 @@
+
+#include "PCH.h"
+#include "Rendering/UploadManager.h"
+#include "Rendering/RenderingAPI.h"
+#include "Rendering/Renderer.h"
+
+
+namespace Silex
+{
+    static uint64 AlignUp(uint64 value, uint64 alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+
+    bool UploadManager::Initialize(RenderingAPI* renderingAPI, QueueID graphicsQueue, uint64 stagingSize)
+    {
+        api             = renderingAPI;
+        graphicsQueueID = graphicsQueue;
+
+        // 転送をサポートするキューのうち、最も機能の少ない (専用に近い) ファミリを選択
+        transferQueueID = api->QueryQueueID(QUEUE_FAMILY_TRANSFER_BIT);
+        if (transferQueueID == RENDER_INVALID_ID)
+        {
+            // グラフィックスキューは転送ビットを公開していなくても転送できる
+            // (同じ VkQueue をレンダラーと共有するが、送信は RenderingAPI 側で排他される)
+            transferQueueID = graphicsQueueID;
+        }
+
+        transferQueue = api->CreateCommandQueue(transferQueueID);
+        SL_CHECK(!transferQueue, false);
+
+        for (UploadBatch& batch : batches)
+        {
+            batch.commandPool = api->CreateCommandPool(transferQueueID);
+            SL_CHECK(!batch.commandPool, false);
+
+            batch.commandBuffer = api->CreateCommandBuffer(batch.commandPool);
+            SL_CHECK(!batch.commandBuffer, false);
+        }
+
+        timeline = api->CreateTimelineSemaphore(0);
+        SL_CHECK(!timeline, false);
+
+        // ステージングリング (永続マップ)
+        stagingCapacity = AlignUp(stagingSize, StagingAlignment);
+        staging         = api->CreateBuffer(stagingCapacity, BUFFER_USAGE_TRANSFER_SRC_BIT, MEMORY_ALLOCATION_TYPE_CPU);
+        SL_CHECK(!staging, false);
+
+        stagingMapped = (uint8*)api->MapBuffer(staging);
+        SL_CHECK(!stagingMapped, false);
+
+        SL_LOG_INFO("UploadManager: transfer queue family {} ({})", transferQueueID, IsDedicatedQueue()? "dedicated" : "shared with graphics");
+
+        return true;
+    }
+
+    void UploadManager::Finalize()
+    {
+        std::lock_guard lock(mutex);
+
+        _Flush();
+        _Retire(true);
+
+        // 取得が記録されないまま終了する場合は、リソース側も同時に破棄されるので何もしない
+        readyAcquires.clear();
+
+        for (UploadBatch& batch : batches)
+        {
+            api->DestroyCommandBuffer(batch.commandBuffer);
+            api->DestroyCommandPool(batch.commandPool);
+        }
+
+        if (staging)
+        {
+            api->UnmapBuffer(staging);
+            api->DestroyBuffer(staging);
+        }
+
+        api->DestroySemaphore(timeline);
+        api->DestroyCommandQueue(transferQueue);
+
+        staging       = nullptr;
+        stagingMapped = nullptr;
+        timeline      = nullptr;
+        transferQueue = nullptr;
+    }
+
+    UploadToken UploadManager::UploadBuffer(BufferHandle* dst, const void* data, uint64 dataSize)
+    {
+        std::lock_guard lock(mutex);
+
+        // ステージングにコピー (リングに収まらないサイズは一時バッファを使用する)
+        BufferHandle* src    = staging;
+        uint64        offset = _AllocateStaging(dataSize);
+
+        if (offset == InvalidOffset)
+        {
+            src    = api->CreateBuffer(dataSize, BUFFER_USAGE_TRANSFER_SRC_BIT, MEMORY_ALLOCATION_TYPE_CPU);
+            offset = 0;
+
+            void* mapped = api->MapBuffer(src);
+            std::memcpy(mapped, data, dataSize);
+            api->UnmapBuffer(src);
+        }
+        else
+        {
+            std::memcpy(stagingMapped + offset, data, dataSize);
+        }
+
+        UploadBatch* batch = _BeginRecord();
+        if (src != staging)
+            batch->oversized.push_back(src);
+
+        BufferCopyRegion region = {};
+        region.srcOffset = offset;
+        region.size      = dataSize;
+
+        api->Cmd_CopyBuffer(batch->commandBuffer, src, dst, 1, &region);
+
+        PendingAcquire acquire = {};
+        acquire.buffer = dst;
+        acquire.size   = dataSize;
+
+        if (IsDedicatedQueue())
+        {
+            _RecordOwnershipTransfer(batch->commandBuffer, acquire, false);
+            batch->acquires.push_back(acquire);
+        }
+        else
+        {
+            // 同一ファミリなので、後続のグラフィックスコマンドとはキューの送信順とメモリバリアで同期する
+            BufferBarrierInfo barrier = {};
+            barrier.buffer    = dst;
+            barrier.srcAccess = BARRIER_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccess = BARRIER_ACCESS_MEMORY_READ_BIT;
+            barrier.offset    = 0;
+            barrier.size      = dataSize;
+
+            api->Cmd_PipelineBarrier(batch->commandBuffer, PIPELINE_STAGE_TRANSFER_BIT, PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, nullptr, 1, &barrier, 0, nullptr);
+        }
+
+        return batch->token;
+    }
+
+    UploadToken UploadManager::UploadTexture(TextureHandle* dst, uint32 width, uint32 height, bool genMipmap, const void* pixelData, uint64 dataSize)
+    {
+        // ミップ 0 のみコピーし、ミップマップ生成時は 1 以降を取得側でブリットする
+        const uint64 mipOffset = 0;
+        return _UploadTexture(dst, width, height, 1, &mipOffset, genMipmap, pixelData, dataSize);
+    }
+
+    UploadToken UploadManager::UploadTexture(TextureHandle* dst, uint32 width, uint32 height, uint32 numMip, const uint64* mipOffsets, const void* pixelData, uint64 dataSize)
+    {
+        return _UploadTexture(dst, width, height, numMip, mipOffsets, false, pixelData, dataSize);
+    }
+
+    UploadToken UploadManager::_UploadTexture(TextureHandle* dst, uint32 width, uint32 height, uint32 numMip, const uint64* mipOffsets, bool genMipmap, const void* pixelData, uint64 dataSize)
+    {
+        std::lock_guard lock(mutex);
+
+        BufferHandle* src    = staging;
+        uint64        offset = _AllocateStaging(dataSize);
+
+        if (offset == InvalidOffset)
+        {
+            src    = api->CreateBuffer(dataSize, BUFFER_USAGE_TRANSFER_SRC_BIT, MEMORY_ALLOCATION_TYPE_CPU);
+            offset = 0;
+
+            void* mapped = api->MapBuffer(src);
+            std::memcpy(mapped, pixelData, dataSize);
+            api->UnmapBuffer(src);
+        }
+        else
+        {
+            std::memcpy(stagingMapped + offset, pixelData, dataSize);
+        }
+
+        UploadBatch* batch = _BeginRecord();
+        if (src != staging)
+            batch->oversized.push_back(src);
+
+        CommandBufferHandle* cmd = batch->commandBuffer;
+
+        // 全ミップをコピー先に移行 (ミップマップ生成時は ミップ1 以降もブリット先になる)
+        TextureBarrierInfo info = {};
+        info.texture      = dst;
+        info.srcAccess    = 0;
+        info.dstAccess    = BARRIER_ACCESS_TRANSFER_WRITE_BIT;
+        info.oldLayout    = TEXTURE_LAYOUT_UNDEFINED;
+        info.newLayout    = TEXTURE_LAYOUT_TRANSFER_DST_OPTIMAL;
+
+        api->Cmd_PipelineBarrier(cmd, PIPELINE_STAGE_TOP_OF_PIPE_BIT, PIPELINE_STAGE_TRANSFER_BIT, 0, nullptr, 0, nullptr, 1, &info);
+
+        // 各ミップの範囲は ステージング上でもデータ内と同じ相対位置に並ぶ
+        BufferTextureCopyRegion* regions = SL_STACK(BufferTextureCopyRegion, numMip);
+        for (uint32 mip = 0; mip < numMip; mip++)
+        {
+            TextureSubresource subresource = {};
+            subresource.aspect   = TEXTURE_ASPECT_COLOR_BIT;
+            subresource.mipLevel = mip;
+
+            BufferTextureCopyRegion& region = regions[mip];
+            region.bufferOffset        = offset + mipOffsets[mip];
+            region.textureOffset       = { 0, 0, 0 };
+            region.textureRegionSize   = { std::max(width >> mip, 1u), std::max(height >> mip, 1u), 1 };
+            region.textureSubresources = subresource;
+        }
+
+        api->Cmd_CopyBufferToTexture(cmd, src, dst, TEXTURE_LAYOUT_TRANSFER_DST_OPTIMAL, numMip, regions);
+
+        PendingAcquire acquire = {};
+        acquire.texture   = dst;
+        acquire.width     = width;
+        acquire.height    = height;
+        acquire.genMipmap = genMipmap;
+
+        if (IsDedicatedQueue())
+        {
+            // 転送キューではブリットできないので、ミップマップ生成は取得側で行う
+            _RecordOwnershipTransfer(cmd, acquire, false);
+            batch->acquires.push_back(acquire);
+        }
+        else
+        {
+            _RecordShaderReadLayout(cmd, acquire);
+        }
+
+        return batch->token;
+    }
+
+    void UploadManager::Flush()
+    {
+        std::lock_guard lock(mutex);
+        _Flush();
+    }
+
+    void UploadManager::Retire(bool wait)
+    {
+        std::lock_guard lock(mutex);
+        _Retire(wait);
+    }
+
+    bool UploadManager::HasPendingAcquire() const
+    {
+        std::lock_guard lock(mutex);
+        return !readyAcquires.empty();
+    }
+
+    void UploadManager::RecordAcquire(CommandBufferHandle* commandBuffer)
+    {
+        std::lock_guard lock(mutex);
+
+        for (const PendingAcquire& acquire : readyAcquires)
+        {
+            _RecordOwnershipTransfer(commandBuffer, acquire, true);
+
+            if (acquire.texture)
+            {
+                _RecordShaderReadLayout(commandBuffer, acquire);
+            }
+        }
+
+        readyAcquires.clear();
+
+        // 以降にこのコマンドバッファより後で送信されるグラフィックスコマンドから使用できる
+        acquiredToken = retiredToken;
+    }
+
+    bool UploadManager::IsComplete(UploadToken token) const
+    {
+        std::lock_guard lock(mutex);
+        return token <= acquiredToken;
+    }
+
+    UploadManager::UploadBatch* UploadManager::_BeginRecord()
+    {
+        UploadBatch& batch = batches[currentBatch];
+        if (batch.recording)
+            return &batch;
+
+        // 前回の使用で送信したコマンドの完了を待ってから再利用する (リング順に送信するので、このバッチが最も古い)
+        if (batch.submitted)
+        {
+            api->WaitTimelineSemaphore(timeline, batch.token);
+            _Retire(false);
+        }
+
+        api->BeginCommandBuffer(batch.commandBuffer);
+
+        batch.token     = nextToken;
+        batch.recording = true;
+
+        return &batch;
+    }
+
+    UploadManager::UploadBatch* UploadManager::_FindOldestSubmitted()
+    {
+        UploadBatch* oldest = nullptr;
+        for (UploadBatch& batch : batches)
+        {
+            if (batch.submitted && (!oldest || batch.token < oldest->token))
+                oldest = &batch;
+        }
+
+        return oldest;
+    }
+
+    uint64 UploadManager::_AllocateStaging(uint64 size)
+    {
+        const uint64 alignedSize = AlignUp(size, StagingAlignment);
+        if (alignedSize > stagingCapacity)
+            return InvalidOffset;
+
+        while (true)
+        {
+            // 末尾に収まらない場合は先頭に折り返す (残りは埋め草として、このバッチの使用分に含める)
+            const uint64 offset  = ringHead % stagingCapacity;
+            const uint64 padding = (offset + alignedSize > stagingCapacity)? stagingCapacity - offset : 0;
+
+            if (ringHead + padding + alignedSize - ringTail <= stagingCapacity)
+            {
+                ringHead += padding;
+                const uint64 result = ringHead % stagingCapacity;
+                ringHead += alignedSize;
+
+                return result;
+            }
+
+            // リングが空の場合は待機できるバッチが無いので、先頭に折り返した位置から確保し直す
+            // (書き込み位置が途中にあると、空でも 書き込み位置より大きい確保は折り返しを含めて収まらない)
+            if (ringHead == ringTail)
+            {
+                ringHead += stagingCapacity - offset;
+                ringTail  = ringHead;
+                continue;
+            }
+
+            // 空きがないので、記録中のバッチを送信して最も古いバッチの完了を待つ
+            if (batches[currentBatch].recording)
+            {
+                _Flush();
+            }
+
+            UploadBatch* oldest = _FindOldestSubmitted();
+            SL_ASSERT(oldest != nullptr);
+
+            api->WaitTimelineSemaphore(timeline, oldest->token);
+            _Retire(false);
+        }
+    }
+
+    void UploadManager::_Flush()
+    {
+        UploadBatch& batch = batches[currentBatch];
+        if (!batch.recording)
+            return;
+
+        api->EndCommandBuffer(batch.commandBuffer);
+
+        bool result = api->SubmitQueueWithTimeline(transferQueue, batch.commandBuffer, timeline, batch.token);
+        if (!result)
+        {
+            SL_LOG_LOCATION_ERROR("転送キューへの送信に失敗しました");
+        }
+
+        batch.ringEnd   = ringHead;
+        batch.recording = false;
+        batch.submitted = true;
+
+        nextToken++;
+        currentBatch = (currentBatch + 1) % MaxBatch;
+    }
+
+    void UploadManager::_Retire(bool wait)
+    {
+        // 送信順 (トークン順) に回収する
+        while (UploadBatch* oldest = _FindOldestSubmitted())
+        {
+            if (wait)
+            {
+                api->WaitTimelineSemaphore(timeline, oldest->token);
+            }
+            else if (api->GetTimelineSemaphoreValue(timeline) < oldest->token)
+            {
+                break;
+            }
+
+            _RetireBatch(*oldest);
+        }
+    }
+
+    void UploadManager::_RetireBatch(UploadBatch& batch)
+    {
+        // リングが空の時に書き込み位置を進めている場合があるので、解放位置は戻さない
+        ringTail = std::max(ringTail, batch.ringEnd);
+
+        for (BufferHandle* buffer : batch.oversized)
+        {
+            api->DestroyBuffer(buffer);
+        }
+
+        readyAcquires.insert(readyAcquires.end(), batch.acquires.begin(), batch.acquires.end());
+
+        batch.oversized.clear();
+        batch.acquires.clear();
+        batch.submitted = false;
+
+        retiredToken = batch.token;
+
+        // 取得が不要な場合 (同一ファミリ) は、転送完了の時点で使用できる
+        if (readyAcquires.empty())
+        {
+            acquiredToken = retiredToken;
+        }
+    }
+
+    void UploadManager::_RecordOwnershipTransfer(CommandBufferHandle* commandBuffer, const PendingAcquire& acquire, bool acquireSide)
+    {
+        // 解放側の dstAccess と 取得側の srcAccess は無視されるので 0 とする
+        const PipelineStageBits srcStage = acquireSide? PIPELINE_STAGE_TOP_OF_PIPE_BIT : PIPELINE_STAGE_TRANSFER_BIT;
+        const PipelineStageBits dstStage = acquireSide? PIPELINE_STAGE_ALL_COMMANDS_BIT : PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+
+        if (acquire.buffer)
+        {
+            BufferBarrierInfo barrier = {};
+            barrier.buffer    = acquire.buffer;
+            barrier.srcAccess = acquireSide? 0 : BARRIER_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccess = acquireSide? BARRIER_ACCESS_MEMORY_READ_BIT : 0;
+            barrier.offset    = 0;
+            barrier.size      = acquire.size;
+            barrier.srcQueue  = transferQueueID;
+            barrier.dstQueue  = graphicsQueueID;
+
+            api->Cmd_PipelineBarrier(commandBuffer, srcStage, dstStage, 0, nullptr, 1, &barrier, 0, nullptr);
+        }
+        else
+        {
+            // ミップマップ生成を行う場合は コピー先のまま移し、生成後にシェーダーリードに移行する
+            TextureBarrierInfo info = {};
+            info.texture   = acquire.texture;
+            info.srcAccess = acquireSide? 0 : BARRIER_ACCESS_TRANSFER_WRITE_BIT;
+            info.dstAccess = acquireSide? BARRIER_ACCESS_MEMORY_READ_BIT | BARRIER_ACCESS_MEMORY_WRITE_BIT : 0;
+            info.oldLayout = TEXTURE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            info.newLayout = acquire.genMipmap? TEXTURE_LAYOUT_TRANSFER_DST_OPTIMAL : TEXTURE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            info.srcQueue  = transferQueueID;
+            info.dstQueue  = graphicsQueueID;
+
+            api->Cmd_PipelineBarrier(commandBuffer, srcStage, dstStage, 0, nullptr, 0, nullptr, 1, &info);
+        }
+    }
+
+    void UploadManager::_RecordShaderReadLayout(CommandBufferHandle* commandBuffer, const PendingAcquire& acquire)
+    {
+        // 専用キューで所有権を移した場合、ミップマップなしのテクスチャは移行済み
+        const bool transferred = IsDedicatedQueue();
+        if (transferred && !acquire.genMipmap)
+            return;
+
+        TextureBarrierInfo info = {};
+        info.texture   = acquire.texture;
+        info.srcAccess = BARRIER_ACCESS_MEMORY_WRITE_BIT;
+        info.dstAccess = BARRIER_ACCESS_MEMORY_READ_BIT;
+        info.newLayout = TEXTURE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+        if (acquire.genMipmap)
+        {
+            // ミップマップ生成 (生成後は全ミップがコピーソース)
+            Renderer::Get()->_GenerateMipmaps(commandBuffer, acquire.texture, acquire.width, acquire.height, 1, 1, TEXTURE_ASPECT_COLOR_BIT);
+            info.oldLayout = TEXTURE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        }
+        else
+        {
+            info.oldLayout = TEXTURE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        }
+
+        api->Cmd_PipelineBarrier(commandBuffer, PIPELINE_STAGE_ALL_COMMANDS_BIT, PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, nullptr, 0, nullptr, 1, &info);
+    }
+}
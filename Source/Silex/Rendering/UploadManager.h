@@ -0,0 +1,139 @@
+
+#pragma once
+
+#include "Rendering/RenderingCore.h"
+
+#include <mutex>
+
+
+namespace Silex
+{
+    class RenderingAPI;
+
+
+    //=========================================
+    // 非同期アップロード
+    //-----------------------------------------
+    // 永続マップしたステージングリングにデータをコピーし、複数のコピーを 1つのコマンドバッファにまとめて
+    // 転送キューに送信する。各バッチはタイムラインセマフォの値をシグナルし、その値をトークンとして返す
+    //
+    // 転送キューがグラフィックスと別のファミリの場合は、転送側で所有権を解放し、
+    // 転送完了後にグラフィックスキューのコマンドで取得する (ミップマップ生成も取得側で行う)
+    // トークンは 取得が記録された時点で完了 (IsComplete) となり、以降のグラフィックスコマンドから使用できる
+    //=========================================
+    class UploadManager
+    {
+    public:
+
+        // 同時に転送中にできるバッチ数
+        static constexpr uint32 MaxBatch = 4;
+
+        // ステージングリング内の確保単位 (コピー元オフセットの境界)
+        static constexpr uint64 StagingAlignment = 16;
+
+        // リングに収まらないサイズの確保結果
+        static constexpr uint64 InvalidOffset = UINT64_MAX;
+
+    public:
+
+        bool Initialize(RenderingAPI* renderingAPI, QueueID graphicsQueue, uint64 stagingSize);
+        void Finalize();
+
+        // アップロード要求 (データはステージングにコピーされるので、呼び出し後に破棄してよい)
+        UploadToken UploadBuffer(BufferHandle* dst, const void* data, uint64 dataSize);
+        UploadToken UploadTexture(TextureHandle* dst, uint32 width, uint32 height, bool genMipmap, const void* pixelData, uint64 dataSize);
+
+        // 生成済みのミップチェーンのアップロード (mipOffsets: pixelData 内の各ミップの位置, ブロックサイズの倍数であること)
+        UploadToken UploadTexture(TextureHandle* dst, uint32 width, uint32 height, uint32 numMip, const uint64* mipOffsets, const void* pixelData, uint64 dataSize);
+
+        // 記録中のバッチを転送キューに送信する
+        void Flush();
+
+        // 転送が完了したバッチを回収する (wait: 送信済みの全バッチの完了を待機する)
+        void Retire(bool wait);
+
+        // 回収済みバッチの所有権取得を グラフィックスキューのコマンドに記録する
+        bool HasPendingAcquire() const;
+        void RecordAcquire(CommandBufferHandle* commandBuffer);
+
+        // 取得まで完了しているか
+        bool IsComplete(UploadToken token) const;
+
+        // 転送キューがグラフィックスと別のファミリか
+        bool IsDedicatedQueue() const { return transferQueueID != graphicsQueueID; }
+
+        uint64 GetStagingCapacity() const { return stagingCapacity; }
+
+    private:
+
+        // グラフィックスキューで取得するリソース
+        struct PendingAcquire
+        {
+            BufferHandle*  buffer    = nullptr;
+            uint64         size      = 0;
+            TextureHandle* texture   = nullptr;
+            uint32         width     = 0;
+            uint32         height    = 0;
+            bool           genMipmap = false;
+        };
+
+        struct UploadBatch
+        {
+            CommandPoolHandle*          commandPool   = nullptr;
+            CommandBufferHandle*        commandBuffer = nullptr;
+            UploadToken                 token         = 0;
+            uint64                      ringEnd       = 0;     // 送信時点のリング書き込み位置 (回収時に解放位置とする)
+            bool                        recording     = false;
+            bool                        submitted     = false;
+            std::vector<PendingAcquire> acquires      = {};
+            std::vector<BufferHandle*>  oversized     = {};    // リングに収まらないデータ用の一時ステージング
+        };
+
+        UploadToken _UploadTexture(TextureHandle* dst, uint32 width, uint32 height, uint32 numMip, const uint64* mipOffsets, bool genMipmap, const void* pixelData, uint64 dataSize);
+
+        // 以下はロック取得済みの状態で呼び出す
+        UploadBatch* _BeginRecord();
+        UploadBatch* _FindOldestSubmitted();
+        uint64       _AllocateStaging(uint64 size);
+        void         _Flush();
+        void         _Retire(bool wait);
+        void         _RetireBatch(UploadBatch& batch);
+
+        // 所有権の解放 / 取得バリア (両側で同じ内容を発行する)
+        void _RecordOwnershipTransfer(CommandBufferHandle* commandBuffer, const PendingAcquire& acquire, bool acquireSide);
+
+        // ミップマップ生成とシェーダーリードへの移行 (グラフィックスをサポートするキューで記録する)
+        void _RecordShaderReadLayout(CommandBufferHandle* commandBuffer, const PendingAcquire& acquire);
+
+    private:
+
+        RenderingAPI* api = nullptr;
+
+        // キュー
+        QueueID             graphicsQueueID = RENDER_INVALID_ID;
+        QueueID             transferQueueID = RENDER_INVALID_ID;
+        CommandQueueHandle* transferQueue   = nullptr;
+
+        // バッチ (リング状に使用する)
+        std::array<UploadBatch, MaxBatch> batches      = {};
+        uint32                            currentBatch = 0;
+
+        // タイムライン
+        SemaphoreHandle* timeline      = nullptr;
+        UploadToken      nextToken     = 1;
+        UploadToken      retiredToken  = 0;
+        UploadToken      acquiredToken = 0;
+
+        // 回収済みで取得待ちのリソース
+        std::vector<PendingAcquire> readyAcquires = {};
+
+        // ステージングリング (書き込み位置・解放位置は折り返さない累積値で管理する)
+        BufferHandle* staging         = nullptr;
+        uint8*        stagingMapped   = nullptr;
+        uint64        stagingCapacity = 0;
+        uint64        ringHead        = 0;
+        uint64        ringTail        = 0;
+
+        mutable std::mutex mutex;
+    };
+}
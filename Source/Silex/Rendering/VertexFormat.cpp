@@ -0,0 +1,154 @@
+#include "PCH.h"
+#include "Rendering/VertexFormat.h"
+
+#include <glm/gtc/packing.hpp>
+
+
+namespace Silex
+{
+    static constexpr float SNorm16Max = 32767.0f;
+
+    static int16 PackSNorm16(float v)
+    {
+        return (int16)std::round(std::clamp(v, -1.0f, 1.0f) * SNorm16Max);
+    }
+
+    static float UnpackSNorm16(int16 v)
+    {
+        // GPU の snorm 展開と同じく -32768 は -1.0 として扱う
+        return std::max(v / SNorm16Max, -1.0f);
+    }
+
+
+    VertexQuantization VertexFormat::CalcQuantization(const Vertex* vertices, uint64 numVertex)
+    {
+        VertexQuantization quantization = {};
+        if (!QuantizeVertexPosition || numVertex == 0)
+            return quantization;
+
+        glm::vec3 min = vertices[0].Position;
+        glm::vec3 max = vertices[0].Position;
+        for (uint64 i = 1; i < numVertex; i++)
+        {
+            min = glm::min(min, vertices[i].Position);
+            max = glm::max(max, vertices[i].Position);
+        }
+
+        // 平面のメッシュでも 0 除算にならないように
+        quantization.center = (min + max) * 0.5f;
+        quantization.extent = glm::max((max - min) * 0.5f, glm::vec3(1e-6f));
+
+        return quantization;
+    }
+
+    glm::mat4 VertexFormat::CalcDequantizeMatrix(const VertexQuantization& quantization)
+    {
+        return glm::scale(glm::translate(glm::mat4(1.0f), quantization.center), quantization.extent);
+    }
+
+    void VertexFormat::EncodePositions(const Vertex* vertices, uint64 numVertex, const VertexQuantization& quantization, byte* out_positions)
+    {
+        if constexpr (QuantizeVertexPosition)
+        {
+            VertexPositionQuantized* positions = reinterpret_cast<VertexPositionQuantized*>(out_positions);
+            for (uint64 i = 0; i < numVertex; i++)
+            {
+                glm::vec3 p = (vertices[i].Position - quantization.center) / quantization.extent;
+
+                positions[i].Position[0] = PackSNorm16(p.x);
+                positions[i].Position[1] = PackSNorm16(p.y);
+                positions[i].Position[2] = PackSNorm16(p.z);
+                positions[i].Position[3] = 0;
+            }
+        }
+        else
+        {
+            VertexPosition* positions = reinterpret_cast<VertexPosition*>(out_positions);
+            for (uint64 i = 0; i < numVertex; i++)
+            {
+                positions[i].Position = vertices[i].Position;
+            }
+        }
+    }
+
+    void VertexFormat::EncodeAttributes(const Vertex* vertices, uint64 numVertex, VertexAttribute* out_attributes)
+    {
+        for (uint64 i = 0; i < numVertex; i++)
+        {
+            const Vertex&    vertex    = vertices[i];
+            VertexAttribute& attribute = out_attributes[i];
+
+            glm::vec2 normal  = EncodeOctahedron(vertex.Normal);
+            glm::vec2 tangent = EncodeOctahedron(vertex.Tangent);
+
+            attribute.Normal[0] = PackSNorm16(normal.x);
+            attribute.Normal[1] = PackSNorm16(normal.y);
+
+            // |uv| < 2 の範囲なら誤差は 1/2048 以下 (タイリングの大きい UV ほど精度が落ちる)
+            attribute.TexCoords[0] = glm::packHalf1x16(vertex.TexCoords.x);
+            attribute.TexCoords[1] = glm::packHalf1x16(vertex.TexCoords.y);
+
+            // 従法線は cross(N, T) * 符号 で復元するので、符号のみ接線 x の符号として格納する
+            // (x を [0, 1] に写してから符号を掛け、0 にならないように下限を 1 とする)
+            const float sign = glm::dot(glm::cross(vertex.Normal, vertex.Tangent), vertex.Bitangent) < 0.0f? -1.0f : 1.0f;
+            const int16 x    = (int16)std::max(std::round((tangent.x * 0.5f + 0.5f) * SNorm16Max), 1.0f);
+
+            attribute.Tangent[0] = (int16)(x * sign);
+            attribute.Tangent[1] = PackSNorm16(tangent.y);
+        }
+    }
+
+    glm::vec2 VertexFormat::EncodeOctahedron(const glm::vec3& n)
+    {
+        const float sum = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+        if (sum == 0.0f)
+            return glm::vec2(0.0f);
+
+        glm::vec2 e = glm::vec2(n.x, n.y) / sum;
+
+        // 下半球は対角線で折り返す
+        if (n.z < 0.0f)
+        {
+            glm::vec2 s = glm::vec2(e.x >= 0.0f? 1.0f : -1.0f, e.y >= 0.0f? 1.0f : -1.0f);
+            e = (1.0f - glm::abs(glm::vec2(e.y, e.x))) * s;
+        }
+
+        return e;
+    }
+
+    glm::vec3 VertexFormat::DecodeOctahedron(const glm::vec2& e)
+    {
+        glm::vec3 n = glm::vec3(e.x, e.y, 1.0f - std::abs(e.x) - std::abs(e.y));
+
+        const float t = std::max(-n.z, 0.0f);
+        n.x += n.x >= 0.0f? -t : t;
+        n.y += n.y >= 0.0f? -t : t;
+
+        return glm::normalize(n);
+    }
+
+    glm::vec3 VertexFormat::DecodePosition(const byte* positions, uint64 index, const VertexQuantization& quantization)
+    {
+        if constexpr (QuantizeVertexPosition)
+        {
+            const VertexPositionQuantized& p = reinterpret_cast<const VertexPositionQuantized*>(positions)[index];
+            glm::vec3 q = glm::vec3(UnpackSNorm16(p.Position[0]), UnpackSNorm16(p.Position[1]), UnpackSNorm16(p.Position[2]));
+
+            return quantization.center + q * quantization.extent;
+        }
+        else
+        {
+            return reinterpret_cast<const VertexPosition*>(positions)[index].Position;
+        }
+    }
+
+    void VertexFormat::DecodeAttribute(const VertexAttribute& attribute, glm::vec3& out_normal, glm::vec2& out_texcoord, glm::vec3& out_tangent, float& out_bitangentSign)
+    {
+        out_normal   = DecodeOctahedron(glm::vec2(UnpackSNorm16(attribute.Normal[0]), UnpackSNorm16(attribute.Normal[1])));
+        out_texcoord = glm::vec2(glm::unpackHalf1x16(attribute.TexCoords[0]), glm::unpackHalf1x16(attribute.TexCoords[1]));
+
+        const float x = UnpackSNorm16(attribute.Tangent[0]);
+        out_bitangentSign = x < 0.0f? -1.0f : 1.0f;
+        out_tangent       = DecodeOctahedron(glm::vec2(std::abs(x) * 2.0f - 1.0f, UnpackSNorm16(attribute.Tangent[1])));
+    }
+}
@@ -0,0 +1,85 @@
+
+#pragma once
+
+#include "Core/CoreType.h"
+
+
+namespace Silex
+{
+    // インポート時の頂点 (クックの入力 / GPU には VertexPosition + VertexAttribute に変換してアップロードする)
+    struct Vertex
+    {
+        glm::vec3 Position;
+        glm::vec3 Normal;
+        glm::vec2 TexCoords;
+        glm::vec3 Tangent;
+        glm::vec3 Bitangent;
+    };
+
+
+    //======================================================================================
+    // GPU 頂点フォーマット
+    //--------------------------------------------------------------------------------------
+    // 座標とその他の属性を別ストリームに分け、深度のみのパス (シャドウ・キューブマップ) は座標ストリームだけを読み込む
+    //
+    //  ストリーム 0 (座標) : float3 (12 バイト) / 量子化時は snorm16x4 (8 バイト)
+    //  ストリーム 1 (属性) : 法線 snorm16x2 (八面体) + UV half2 + 接線 snorm16x2 (八面体 + 従法線の符号) = 12 バイト
+    //
+    // 量子化した座標はメッシュ全体の境界 (中心・半径) で正規化し、逆量子化はインスタンスの変換行列に含める
+    // (境界の中心が原点で 各軸の半径が等しいキューブは、逆量子化しなくても方向が変わらない)
+    //======================================================================================
+
+    // 頂点座標を量子化するか (変更すると、次回の読み込みで全メッシュが再クックされる)
+    static constexpr bool QuantizeVertexPosition = false;
+
+    struct VertexPosition
+    {
+        glm::vec3 Position;
+    };
+
+    struct VertexPositionQuantized
+    {
+        int16 Position[4]; // w は未使用 (頂点属性のフォーマットに 3要素の 16bit 形式が無いため)
+    };
+
+    struct VertexAttribute
+    {
+        int16  Normal[2];
+        uint16 TexCoords[2];
+        int16  Tangent[2];   // x の符号に従法線の向きを格納する
+    };
+
+    static constexpr uint32 VertexPositionStride  = QuantizeVertexPosition? sizeof(VertexPositionQuantized) : sizeof(VertexPosition);
+    static constexpr uint32 VertexAttributeStride = sizeof(VertexAttribute);
+
+    // 座標の量子化範囲 (メッシュ全体の境界)
+    struct VertexQuantization
+    {
+        glm::vec3 center = glm::vec3(0.0f);
+        glm::vec3 extent = glm::vec3(1.0f);
+    };
+
+
+    class VertexFormat
+    {
+    public:
+
+        // 全頂点を包含する量子化範囲 (量子化しない場合は単位範囲)
+        static VertexQuantization CalcQuantization(const Vertex* vertices, uint64 numVertex);
+
+        // 量子化した座標 [-1, 1] をメッシュ空間に戻す行列 (インスタンスの変換行列に右から掛ける)
+        static glm::mat4 CalcDequantizeMatrix(const VertexQuantization& quantization);
+
+        // 座標ストリーム (VertexPositionStride 単位) と属性ストリームに変換する
+        static void EncodePositions(const Vertex* vertices, uint64 numVertex, const VertexQuantization& quantization, byte* out_positions);
+        static void EncodeAttributes(const Vertex* vertices, uint64 numVertex, VertexAttribute* out_attributes);
+
+        // 八面体エンコード (シェーダーと同じ展開で 検証・誤差計測に使用する)
+        static glm::vec2 EncodeOctahedron(const glm::vec3& n);
+        static glm::vec3 DecodeOctahedron(const glm::vec2& e);
+
+        // 座標・属性ストリームから復元する (誤差計測用)
+        static glm::vec3 DecodePosition(const byte* positions, uint64 index, const VertexQuantization& quantization);
+        static void      DecodeAttribute(const VertexAttribute& attribute, glm::vec3& out_normal, glm::vec2& out_texcoord, glm::vec3& out_tangent, float& out_bitangentSign);
+    };
+}
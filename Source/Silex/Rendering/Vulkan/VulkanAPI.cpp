@@ -1,12 +1,15 @@
 
 #include "PCH.h"
 
+#include "Core/OS.h"
 #include "Rendering/ShaderCompiler.h"
 #include "Rendering/Vulkan/VulkanAPI.h"
 #include "Rendering/Vulkan/VulkanContext.h"
 #include "Rendering/RenderingUtility.h"
 #include "ImGui/Vulkan/VulkanGUI.h"
 
+#include <bit>
+
 
 namespace Silex
 {
@@ -94,6 +97,14 @@ namespace Silex
                 sizes++;
                 sizeCount++;
             }
+            if (key.descriptorTypeCounts[DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC])
+            {
+                *sizes = {};
+                sizes->type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+                sizes->descriptorCount = key.descriptorTypeCounts[DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC] * MaxDescriptorsetPerPool;
+                sizes++;
+                sizeCount++;
+            }
             if (key.descriptorTypeCounts[DESCRIPTOR_TYPE_STORAGE_BUFFER]) {
                 *sizes = {};
                 sizes->type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
@@ -147,6 +158,74 @@ namespace Silex
         }
     }
 
+    bool VulkanAPI::_CreateBindlessDescriptorSet()
+    {
+        // 未登録のスロットを含んだままバインドでき (PARTIALLY_BOUND)、
+        // バインド後も GPU が参照していないスロットは更新できる (UPDATE_AFTER_BIND)
+        const VkDescriptorBindingFlags bindingFlags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+        VkDescriptorBindingFlags flags[2] = { bindingFlags, bindingFlags };
+
+        VkDescriptorSetLayoutBinding bindings[2] = {};
+        bindings[0].binding         = BINDLESS_TEXTURE_BINDING;
+        bindings[0].descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        bindings[0].descriptorCount = BINDLESS_TEXTURE_CAPACITY;
+        bindings[0].stageFlags      = VK_SHADER_STAGE_ALL;
+        bindings[1].binding         = BINDLESS_BUFFER_BINDING;
+        bindings[1].descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[1].descriptorCount = BINDLESS_BUFFER_CAPACITY;
+        bindings[1].stageFlags      = VK_SHADER_STAGE_ALL;
+
+        VkDescriptorSetLayoutBindingFlagsCreateInfo flagsInfo = {};
+        flagsInfo.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+        flagsInfo.bindingCount  = std::size(flags);
+        flagsInfo.pBindingFlags = flags;
+
+        VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+        layoutInfo.sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        layoutInfo.pNext        = &flagsInfo;
+        layoutInfo.flags        = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+        layoutInfo.bindingCount = std::size(bindings);
+        layoutInfo.pBindings    = bindings;
+
+        VkResult result = vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &bindlessLayout);
+        SL_CHECK_VKRESULT(result, false);
+
+        // 専用プール (通常のプールとは生成フラグが異なるので、キーによるプール共有の対象外)
+        VkDescriptorPoolSize sizes[2] = {};
+        sizes[0].type            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        sizes[0].descriptorCount = BINDLESS_TEXTURE_CAPACITY;
+        sizes[1].type            = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        sizes[1].descriptorCount = BINDLESS_BUFFER_CAPACITY;
+
+        VkDescriptorPoolCreateInfo poolInfo = {};
+        poolInfo.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.flags         = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+        poolInfo.maxSets       = 1;
+        poolInfo.poolSizeCount = std::size(sizes);
+        poolInfo.pPoolSizes    = sizes;
+
+        result = vkCreateDescriptorPool(device, &poolInfo, nullptr, &bindlessPool);
+        SL_CHECK_VKRESULT(result, false);
+
+        VkDescriptorSetAllocateInfo allocateInfo = {};
+        allocateInfo.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocateInfo.descriptorPool     = bindlessPool;
+        allocateInfo.descriptorSetCount = 1;
+        allocateInfo.pSetLayouts        = &bindlessLayout;
+
+        result = vkAllocateDescriptorSets(device, &allocateInfo, &bindlessSet);
+        SL_CHECK_VKRESULT(result, false);
+
+        return true;
+    }
+
+    void VulkanAPI::_DestroyBindlessDescriptorSet()
+    {
+        // セットはプールと共に解放される
+        if (bindlessPool)   vkDestroyDescriptorPool(device, bindlessPool, nullptr);
+        if (bindlessLayout) vkDestroyDescriptorSetLayout(device, bindlessLayout, nullptr);
+    }
+
     // 指定されたサンプル数が、利用可能なサンプル数かどうかチェックする
     VkSampleCountFlagBits VulkanAPI::_CheckSupportedSampleCounts(TextureSamples samples)
     {
@@ -485,6 +564,182 @@ namespace Silex
 
 
 
+    //==================================================================================
+    // パイプラインキャッシュ
+    //==================================================================================
+    static const char* PipelineCacheFilePath = "Assets/Shaders/Cache/PipelineCache.bin";
+
+    static constexpr uint32 PipelineCacheMagic   = 'S' | ('L' << 8) | ('P' << 16) | ('C' << 24);
+    static constexpr uint32 PipelineCacheVersion = 1;
+
+    // キャッシュファイルヘッダー
+    // デバイス・ドライバーが変わるとキャッシュは使用できないので、一致しない場合は破棄する
+    // (ドライバー側でも検証されるが、不正なデータでクラッシュする実装もあるため事前に検証する)
+    struct PipelineCacheFileHeader
+    {
+        uint32 magic;
+        uint32 version;
+        uint32 vendorID;
+        uint32 deviceID;
+        uint32 driverVersion;
+        uint8  deviceUUID[VK_UUID_SIZE];
+        uint8  pipelineCacheUUID[VK_UUID_SIZE];
+        uint64 dataSize;
+        uint64 dataHash;
+    };
+
+    static PipelineCacheFileHeader MakePipelineCacheHeader(VkPhysicalDevice physicalDevice)
+    {
+        VkPhysicalDeviceIDProperties idProperties = {};
+        idProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES;
+
+        VkPhysicalDeviceProperties2 properties = {};
+        properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+        properties.pNext = &idProperties;
+        vkGetPhysicalDeviceProperties(physicalDevice, &properties.properties);
+
+        // デバイス UUID は 1.1 以降でのみ取得できる (1.0 のデバイスではゼロのまま、他の項目で検証する)
+        if (properties.properties.apiVersion >= VK_API_VERSION_1_1)
+        {
+            vkGetPhysicalDeviceProperties2(physicalDevice, &properties);
+        }
+
+        PipelineCacheFileHeader header = {};
+        header.magic         = PipelineCacheMagic;
+        header.version       = PipelineCacheVersion;
+        header.vendorID      = properties.properties.vendorID;
+        header.deviceID      = properties.properties.deviceID;
+        header.driverVersion = properties.properties.driverVersion;
+        std::memcpy(header.deviceUUID,        idProperties.deviceUUID,                  VK_UUID_SIZE);
+        std::memcpy(header.pipelineCacheUUID, properties.properties.pipelineCacheUUID, VK_UUID_SIZE);
+
+        return header;
+    }
+
+    static bool IsCompatiblePipelineCache(const PipelineCacheFileHeader& a, const PipelineCacheFileHeader& b)
+    {
+        return a.magic         == b.magic
+            && a.version       == b.version
+            && a.vendorID      == b.vendorID
+            && a.deviceID      == b.deviceID
+            && a.driverVersion == b.driverVersion
+            && std::memcmp(a.deviceUUID,        b.deviceUUID,        VK_UUID_SIZE) == 0
+            && std::memcmp(a.pipelineCacheUUID, b.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+    }
+
+    bool VulkanAPI::_CreatePipelineCache()
+    {
+        const PipelineCacheFileHeader expected = MakePipelineCacheHeader(context->GetPhysicalDevice());
+        std::vector<byte> initialData;
+
+        FILE* f = std::fopen(PipelineCacheFilePath, "rb");
+        if (f)
+        {
+            std::error_code ec;
+            uint64 fileSize = std::filesystem::file_size(PipelineCacheFilePath, ec);
+
+            PipelineCacheFileHeader header = {};
+            bool valid = !ec && std::fread(&header, sizeof(header), 1, f) == 1;
+            valid = valid && IsCompatiblePipelineCache(header, expected);
+            valid = valid && header.dataSize == fileSize - sizeof(header);
+
+            if (valid)
+            {
+                initialData.resize(header.dataSize);
+                valid = std::fread(initialData.data(), 1, header.dataSize, f) == header.dataSize;
+                valid = valid && Hash::FNV(initialData.data(), initialData.size()) == header.dataHash;
+            }
+
+            std::fclose(f);
+
+            if (!valid)
+            {
+                SL_LOG_WARN("パイプラインキャッシュが現在のデバイスと一致しないため、破棄します: {}", PipelineCacheFilePath);
+                initialData.clear();
+            }
+        }
+
+        VkPipelineCacheCreateInfo createInfo = {};
+        createInfo.sType           = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+        createInfo.initialDataSize = initialData.size();
+        createInfo.pInitialData    = initialData.empty()? nullptr : initialData.data();
+
+        VkResult result = vkCreatePipelineCache(device, &createInfo, nullptr, &pipelineCache);
+
+        // ドライバーに拒否された場合は、空のキャッシュで生成し直す
+        if (result != VK_SUCCESS && !initialData.empty())
+        {
+            initialData.clear();
+            createInfo.initialDataSize = 0;
+            createInfo.pInitialData    = nullptr;
+
+            result = vkCreatePipelineCache(device, &createInfo, nullptr, &pipelineCache);
+        }
+
+        SL_CHECK_VKRESULT(result, false);
+
+        pipelineCacheLoaded   = !initialData.empty();
+        pipelineCacheLoadSize = initialData.size();
+
+        return true;
+    }
+
+    bool VulkanAPI::_SavePipelineCache()
+    {
+        size_t dataSize = 0;
+        VkResult result = vkGetPipelineCacheData(device, pipelineCache, &dataSize, nullptr);
+        SL_CHECK_VKRESULT(result, false);
+
+        std::vector<byte> data(dataSize);
+        result = vkGetPipelineCacheData(device, pipelineCache, &dataSize, data.data());
+        SL_CHECK_VKRESULT(result, false);
+
+        PipelineCacheFileHeader header = MakePipelineCacheHeader(context->GetPhysicalDevice());
+        header.dataSize = dataSize;
+        header.dataHash = Hash::FNV(data.data(), dataSize);
+
+        std::filesystem::path filePath = PipelineCacheFilePath;
+        if (!std::filesystem::exists(filePath.parent_path()))
+        {
+            std::filesystem::create_directories(filePath.parent_path());
+        }
+
+        // 一時ファイルに書き込んでから置き換える (書き込み途中で終了しても、壊れたキャッシュが残らないように)
+        std::string tempPath = filePath.string() + ".tmp";
+
+        FILE* f = std::fopen(tempPath.c_str(), "wb");
+        if (!f)
+        {
+            SL_LOG_ERROR("ファイルの書き込みに失敗しました: {}", tempPath);
+            return false;
+        }
+
+        bool written = std::fwrite(&header, sizeof(header), 1, f) == 1;
+        written = written && std::fwrite(data.data(), 1, dataSize, f) == dataSize;
+        std::fclose(f);
+
+        std::error_code ec;
+        if (written)
+        {
+            std::filesystem::rename(tempPath, filePath, ec);
+        }
+
+        if (!written || ec)
+        {
+            SL_LOG_ERROR("パイプラインキャッシュの保存に失敗しました: {}", PipelineCacheFilePath);
+            std::filesystem::remove(tempPath, ec);
+            return false;
+        }
+
+        return true;
+    }
+
+    void VulkanAPI::_RecordPipelineCreation(uint64 beginTick)
+    {
+        numPipelineCreated.fetch_add(1, std::memory_order_relaxed);
+        pipelineCreationTicks.fetch_add(OS::Get()->GetTickCount() - beginTick, std::memory_order_relaxed);
+    }
+
     //==================================================================================
     // Vulkan API
     //==================================================================================
@@ -497,6 +752,14 @@ namespace Silex
     {
         vkDeviceWaitIdle(device);
 
+        if (pipelineCache)
+        {
+            _SavePipelineCache();
+            vkDestroyPipelineCache(device, pipelineCache, nullptr);
+        }
+
+        _DestroyBindlessDescriptorSet();
+
         if (allocator) vmaDestroyAllocator(allocator);
         if (device)    vkDestroyDevice(device, nullptr);
     }
@@ -598,6 +861,54 @@ namespace Silex
         result = vmaCreateAllocator(&allocatorInfo, &allocator);
         SL_CHECK_VKRESULT(result, false);
 
+        // パイプラインキャッシュ
+        SL_CHECK(!_CreatePipelineCache(), false);
+
+        // タイムスタンプ対応確認 (全グラフィックス・コンピュートキューで書き込めること)
+        VkPhysicalDeviceProperties properties = {};
+        vkGetPhysicalDeviceProperties(context->GetPhysicalDevice(), &properties);
+
+        minUniformBufferOffsetAlignment = properties.limits.minUniformBufferOffsetAlignment;
+        maxUniformBuffersDynamic        = properties.limits.maxDescriptorSetUniformBuffersDynamic;
+
+        if (properties.limits.timestampComputeAndGraphics)
+        {
+            timestampPeriod = properties.limits.timestampPeriod;
+        }
+        else
+        {
+            SL_LOG_WARN("このデバイスはタイムスタンプクエリに対応していません");
+        }
+
+        // 間接描画 (対応していれば、上記でデバイス生成時に有効化されている)
+        multiDrawIndirect = features2.features.multiDrawIndirect;
+        drawIndirectCount = features_12.drawIndirectCount;
+
+        // BC 圧縮テクスチャ (対応していれば、上記でデバイス生成時に有効化されている)
+        textureCompressionBC = features2.features.textureCompressionBC;
+
+        // バインドレス (マテリアルテクスチャの参照に必須)
+        // マテリアルテーブル (materialTables[]) はプッシュ定数のインデックスで参照するので、ストレージバッファ配列の動的インデックスも必要
+        const bool bindlessSupported = features_12.descriptorIndexing && features_12.runtimeDescriptorArray && features_12.descriptorBindingPartiallyBound
+            && features_12.descriptorBindingSampledImageUpdateAfterBind && features_12.descriptorBindingStorageBufferUpdateAfterBind
+            && features_12.descriptorBindingUpdateUnusedWhilePending && features_12.shaderSampledImageArrayNonUniformIndexing
+            && features2.features.shaderSampledImageArrayDynamicIndexing && features2.features.shaderStorageBufferArrayDynamicIndexing;
+
+        if (!bindlessSupported)
+        {
+            SL_LOG_ERROR("このデバイスはバインドレス (descriptor indexing) に対応していません");
+            return false;
+        }
+
+        // タイムラインセマフォ (非同期アップロードの完了判定に必須)
+        if (!features_12.timelineSemaphore)
+        {
+            SL_LOG_ERROR("このデバイスはタイムラインセマフォに対応していません");
+            return false;
+        }
+
+        SL_CHECK(!_CreateBindlessDescriptorSet(), false);
+
         return true;
     }
 
@@ -633,6 +944,7 @@ namespace Silex
     QueueID VulkanAPI::QueryQueueID(QueueFamilyFlags queueFlag, SurfaceHandle* surface) const
     {
         QueueID familyIndex = RENDER_INVALID_ID;
+        uint32  minFlags    = UINT32_MAX;
 
         const auto& queueFamilyProperties = context->GetQueueFamilyProperties();
         for (uint32 i = 0; i < queueFamilyProperties.size(); i++)
@@ -643,15 +955,19 @@ namespace Silex
                 continue;
             }
 
-            // TODO: 専用キューを選択
-            // 独立したキューがあればそのキューの方が性能が良いとされるので、flag値が低いものが専用キューになる。
-
-            // 全フラグが立っていたら（全てのキューをサポートしている場合）
+            // 要求フラグを全て含むキューのうち、他の機能が最も少ないもの (専用キュー) を選択する
+            // 独立したキューがあればそのキューの方が性能が良いとされる (転送専用キューは DMA エンジンに対応する)
             const bool includeAll = (queueFamilyProperties[i].queueFlags & queueFlag) == queueFlag;
             if (includeAll)
             {
-                familyIndex = i;
-                break;
+                const uint32 flags    = queueFamilyProperties[i].queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT);
+                const uint32 numFlags = std::popcount(flags);
+
+                if (numFlags < minFlags)
+                {
+                    familyIndex = i;
+                    minFlags    = numFlags;
+                }
             }
         }
 
@@ -677,12 +993,45 @@ namespace Silex
         submitInfo.signalSemaphoreCount = 1;
         submitInfo.pSignalSemaphores    = &(VulkanCast(render))->semaphore;
 
+        std::lock_guard lock(queueMutex);
+
         VkResult result = vkQueueSubmit(vkqueue->queue, 1, &submitInfo, vkfence->fence);
         SL_CHECK_VKRESULT(result, false);
 
         return false;
     }
 
+    bool VulkanAPI::SubmitQueueWithTimeline(CommandQueueHandle* queue, CommandBufferHandle* commandbuffer, SemaphoreHandle* timeline, uint64 signalValue)
+    {
+        VulkanCommandQueue*  vkqueue         = VulkanCast(queue);
+        VulkanCommandBuffer* vkcommandBuffer = VulkanCast(commandbuffer);
+
+        VkTimelineSemaphoreSubmitInfo timelineInfo = {};
+        timelineInfo.sType                     = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+        timelineInfo.signalSemaphoreValueCount = 1;
+        timelineInfo.pSignalSemaphoreValues    = &signalValue;
+
+        VkSubmitInfo submitInfo = {};
+        submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers    = &vkcommandBuffer->commandBuffer;
+
+        // セマフォが指定されていなければ、シグナルせずに送信のみ行う
+        if (timeline)
+        {
+            submitInfo.pNext                = &timelineInfo;
+            submitInfo.signalSemaphoreCount = 1;
+            submitInfo.pSignalSemaphores    = &(VulkanCast(timeline))->semaphore;
+        }
+
+        std::lock_guard lock(queueMutex);
+
+        VkResult result = vkQueueSubmit(vkqueue->queue, 1, &submitInfo, nullptr);
+        SL_CHECK_VKRESULT(result, false);
+
+        return true;
+    }
+
 
 
     //==================================================================================
@@ -719,6 +1068,17 @@ namespace Silex
         }
     }
 
+    bool VulkanAPI::ResetCommandPool(CommandPoolHandle* pool)
+    {
+        // 割り当て済みのバッファは解放されず、初期状態に戻るだけなので 次のフレームでも再利用できる
+        VulkanCommandPool* vkpool = VulkanCast(pool);
+
+        VkResult result = vkResetCommandPool(device, vkpool->commandPool, 0);
+        SL_CHECK_VKRESULT(result, false);
+
+        return true;
+    }
+
     //==================================================================================
     // コマンドバッファ
     //==================================================================================
@@ -786,6 +1146,29 @@ namespace Silex
         return true;
     }
 
+    bool VulkanAPI::BeginSecondaryCommandBuffer(CommandBufferHandle* commandBuffer, RenderPassHandle* renderpass, uint32 subpass)
+    {
+        // プールのリセット (ResetCommandPool) でリセット済みの前提なので、個別のリセットは行わない
+        VulkanCommandBuffer* vkcmdBuffer = VulkanCast(commandBuffer);
+
+        // フレームバッファはイメージレスで描画時に確定するので、継承情報には指定しない (VK_NULL_HANDLE は許可されている)
+        VkCommandBufferInheritanceInfo inheritanceInfo = {};
+        inheritanceInfo.sType       = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+        inheritanceInfo.renderPass  = VulkanCast(renderpass)->renderpass;
+        inheritanceInfo.subpass     = subpass;
+        inheritanceInfo.framebuffer = VK_NULL_HANDLE;
+
+        VkCommandBufferBeginInfo beginInfo = {};
+        beginInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags            = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+        beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+        VkResult result = vkBeginCommandBuffer(vkcmdBuffer->commandBuffer, &beginInfo);
+        SL_CHECK_VKRESULT(result, false);
+
+        return true;
+    }
+
     //==================================================================================
     // セマフォ
     //==================================================================================
@@ -816,6 +1199,50 @@ namespace Silex
         }
     }
 
+    SemaphoreHandle* VulkanAPI::CreateTimelineSemaphore(uint64 initialValue)
+    {
+        VkSemaphoreTypeCreateInfo typeInfo = {};
+        typeInfo.sType         = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+        typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+        typeInfo.initialValue  = initialValue;
+
+        VkSemaphoreCreateInfo createInfo = {};
+        createInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        createInfo.pNext = &typeInfo;
+
+        VkSemaphore vkSemaphore = nullptr;
+        VkResult result = vkCreateSemaphore(device, &createInfo, nullptr, &vkSemaphore);
+        SL_CHECK_VKRESULT(result, nullptr);
+
+        VulkanSemaphore* semaphore = slnew(VulkanSemaphore);
+        semaphore->semaphore = vkSemaphore;
+
+        return semaphore;
+    }
+
+    uint64 VulkanAPI::GetTimelineSemaphoreValue(SemaphoreHandle* semaphore)
+    {
+        uint64 value = 0;
+        VkResult result = vkGetSemaphoreCounterValue(device, VulkanCast(semaphore)->semaphore, &value);
+        SL_CHECK_VKRESULT(result, 0);
+
+        return value;
+    }
+
+    bool VulkanAPI::WaitTimelineSemaphore(SemaphoreHandle* semaphore, uint64 value)
+    {
+        VkSemaphoreWaitInfo waitInfo = {};
+        waitInfo.sType          = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+        waitInfo.semaphoreCount = 1;
+        waitInfo.pSemaphores    = &(VulkanCast(semaphore))->semaphore;
+        waitInfo.pValues        = &value;
+
+        VkResult result = vkWaitSemaphores(device, &waitInfo, UINT64_MAX);
+        SL_CHECK_VKRESULT(result, false);
+
+        return true;
+    }
+
     //==================================================================================
     // フェンス
     //==================================================================================
@@ -896,7 +1323,9 @@ namespace Silex
         VulkanSurface*   vkSurface   = vkSwapchain->surface;
 
         // GPU待機
+        std::unique_lock lock(queueMutex);
         VkResult result = vkDeviceWaitIdle(device);
+        lock.unlock();
         SL_CHECK_VKRESULT(result, false);
 
         // スワップチェイン仕様クエリ
@@ -938,6 +1367,8 @@ namespace Silex
         presentInfo.pSwapchains         = &vkswapchain->swapchain;
         presentInfo.pImageIndices       = &vkswapchain->imageIndex;
 
+        std::lock_guard lock(queueMutex);
+
         VkResult result = vkQueuePresentKHR(vkqueue->queue, &presentInfo);
         SL_CHECK_VKRESULT(result, false);
 
@@ -963,7 +1394,9 @@ namespace Silex
             VulkanSwapChain* vkSwapchain = VulkanCast(swapchain);
 
             // GPU待機
+            std::unique_lock lock(queueMutex);
             VkResult result = vkDeviceWaitIdle(device);
+            lock.unlock();
             SL_CHECK_VKRESULT(result, SL_DONT_USE);
 
             // レンダーパス破棄
@@ -1487,8 +1920,8 @@ namespace Silex
         {
             bufferBarriers[i] = {};
             bufferBarriers[i].sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
-            bufferBarriers[i].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-            bufferBarriers[i].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            bufferBarriers[i].srcQueueFamilyIndex = bufferBarrier[i].srcQueue != RENDER_INVALID_ID? bufferBarrier[i].srcQueue : VK_QUEUE_FAMILY_IGNORED;
+            bufferBarriers[i].dstQueueFamilyIndex = bufferBarrier[i].dstQueue != RENDER_INVALID_ID? bufferBarrier[i].dstQueue : VK_QUEUE_FAMILY_IGNORED;
             bufferBarriers[i].srcAccessMask       = (VkAccessFlags)bufferBarrier[i].srcAccess;
             bufferBarriers[i].dstAccessMask       = (VkAccessFlags)bufferBarrier[i].dstAccess;
             bufferBarriers[i].buffer              = VulkanCast(bufferBarrier[i].buffer)->buffer;
@@ -1506,8 +1939,8 @@ namespace Silex
             imageBarriers[i].dstAccessMask                   = (VkAccessFlags)textureBarrier[i].dstAccess;
             imageBarriers[i].oldLayout                       = (VkImageLayout)textureBarrier[i].oldLayout;
             imageBarriers[i].newLayout                       = (VkImageLayout)textureBarrier[i].newLayout;
-            imageBarriers[i].srcQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
-            imageBarriers[i].dstQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+            imageBarriers[i].srcQueueFamilyIndex             = textureBarrier[i].srcQueue != RENDER_INVALID_ID? textureBarrier[i].srcQueue : VK_QUEUE_FAMILY_IGNORED;
+            imageBarriers[i].dstQueueFamilyIndex             = textureBarrier[i].dstQueue != RENDER_INVALID_ID? textureBarrier[i].dstQueue : VK_QUEUE_FAMILY_IGNORED;
             imageBarriers[i].image                           = vktexture->image;
             imageBarriers[i].subresourceRange.aspectMask     = (VkImageAspectFlags)textureBarrier[i].subresources.aspect;
             imageBarriers[i].subresourceRange.baseMipLevel   = textureBarrier[i].subresources.baseMipLevel;
@@ -1774,6 +2207,21 @@ namespace Silex
         vkCmdNextSubpass(cmd->commandBuffer, vksubpassContents);
     }
 
+    void VulkanAPI::Cmd_ExecuteCommands(CommandBufferHandle* commandbuffer, uint32 numCommandBuffer, CommandBufferHandle** commandBuffers)
+    {
+        if (numCommandBuffer == 0)
+            return;
+
+        VkCommandBuffer* vkcommandBuffers = SL_STACK(VkCommandBuffer, numCommandBuffer);
+        for (uint32 i = 0; i < numCommandBuffer; i++)
+        {
+            vkcommandBuffers[i] = VulkanCast(commandBuffers[i])->commandBuffer;
+        }
+
+        VulkanCommandBuffer* cmd = VulkanCast(commandbuffer);
+        vkCmdExecuteCommands(cmd->commandBuffer, numCommandBuffer, vkcommandBuffers);
+    }
+
     void VulkanAPI::Cmd_SetViewport(CommandBufferHandle* commandbuffer, uint32 x, uint32 y, uint32 width, uint32 height)
     {
         // ビューポート Y座標 反転
@@ -1838,15 +2286,37 @@ namespace Silex
         VulkanPipeline* vkpipeline = VulkanCast(pipeline);
         VulkanCommandBuffer* cmd   = VulkanCast(commandbuffer);
 
-        vkCmdBindPipeline(cmd->commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vkpipeline->pipeline);
+        vkCmdBindPipeline(cmd->commandBuffer, vkpipeline->bindPoint, vkpipeline->pipeline);
     }
 
-    void VulkanAPI::Cmd_BindDescriptorSet(CommandBufferHandle* commandbuffer, DescriptorSetHandle* descriptorset, uint32 setIndex)
+    void VulkanAPI::Cmd_BindDescriptorSet(CommandBufferHandle* commandbuffer, DescriptorSetHandle* descriptorset, uint32 setIndex, uint32 numDynamicOffset, const uint32* dynamicOffsets)
     {
         VulkanDescriptorSet* vkdescriptorset = VulkanCast(descriptorset);
         VulkanCommandBuffer* cmd             = VulkanCast(commandbuffer);
 
-        vkCmdBindDescriptorSets(cmd->commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vkdescriptorset->pipelineLayout, setIndex, 1, &vkdescriptorset->descriptorSet, 0, nullptr);
+        // ユニフォームバッファは全て動的オフセットを持つので、指定がなければ 0 で埋める
+        if (numDynamicOffset < vkdescriptorset->numDynamicOffset)
+        {
+            uint32* offsets = SL_STACK(uint32, vkdescriptorset->numDynamicOffset);
+            for (uint32 i = 0; i < vkdescriptorset->numDynamicOffset; i++)
+            {
+                offsets[i] = i < numDynamicOffset? dynamicOffsets[i] : 0;
+            }
+
+            numDynamicOffset = vkdescriptorset->numDynamicOffset;
+            dynamicOffsets   = offsets;
+        }
+
+        vkCmdBindDescriptorSets(cmd->commandBuffer, vkdescriptorset->bindPoint, vkdescriptorset->pipelineLayout, setIndex, 1, &vkdescriptorset->descriptorSet, numDynamicOffset, dynamicOffsets);
+    }
+
+    void VulkanAPI::Cmd_BindBindlessDescriptorSet(CommandBufferHandle* commandbuffer, ShaderHandle* shader, uint32 setIndex)
+    {
+        VulkanShader*        vkshader = VulkanCast(shader);
+        VulkanCommandBuffer* cmd      = VulkanCast(commandbuffer);
+
+        // セットは全シェーダーで共通なので、バインドするシェーダーのパイプラインレイアウトを使用する
+        vkCmdBindDescriptorSets(cmd->commandBuffer, vkshader->bindPoint, vkshader->pipelineLayout, setIndex, 1, &bindlessSet, 0, nullptr);
     }
 
     void VulkanAPI::Cmd_Draw(CommandBufferHandle* commandbuffer, uint32 vertexCount, uint32 instanceCount, uint32 baseVertex, uint32 firstInstance)
@@ -1861,6 +2331,49 @@ namespace Silex
         vkCmdDrawIndexed(cmd->commandBuffer, indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
     }
 
+    void VulkanAPI::Cmd_DrawIndexedIndirect(CommandBufferHandle* commandbuffer, BufferHandle* buffer, uint64 offset, uint32 drawCount, uint32 stride)
+    {
+        VulkanCommandBuffer* cmd = VulkanCast(commandbuffer);
+        VulkanBuffer* vkbuffer   = VulkanCast(buffer);
+
+        if (multiDrawIndirect)
+        {
+            vkCmdDrawIndexedIndirect(cmd->commandBuffer, vkbuffer->buffer, offset, drawCount, stride);
+        }
+        else
+        {
+            for (uint32 i = 0; i < drawCount; i++)
+            {
+                vkCmdDrawIndexedIndirect(cmd->commandBuffer, vkbuffer->buffer, offset + (uint64)i * stride, 1, stride);
+            }
+        }
+    }
+
+    void VulkanAPI::Cmd_DrawIndexedIndirectCount(CommandBufferHandle* commandbuffer, BufferHandle* buffer, uint64 offset, BufferHandle* countBuffer, uint64 countBufferOffset, uint32 maxDrawCount, uint32 stride)
+    {
+        SL_CHECK(!drawIndirectCount, );
+
+        VulkanCommandBuffer* cmd    = VulkanCast(commandbuffer);
+        VulkanBuffer* vkbuffer      = VulkanCast(buffer);
+        VulkanBuffer* vkcountBuffer = VulkanCast(countBuffer);
+
+        vkCmdDrawIndexedIndirectCount(cmd->commandBuffer, vkbuffer->buffer, offset, vkcountBuffer->buffer, countBufferOffset, maxDrawCount, stride);
+    }
+
+    void VulkanAPI::Cmd_Dispatch(CommandBufferHandle* commandbuffer, uint32 groupCountX, uint32 groupCountY, uint32 groupCountZ)
+    {
+        VulkanCommandBuffer* cmd = VulkanCast(commandbuffer);
+        vkCmdDispatch(cmd->commandBuffer, groupCountX, groupCountY, groupCountZ);
+    }
+
+    void VulkanAPI::Cmd_DispatchIndirect(CommandBufferHandle* commandbuffer, BufferHandle* buffer, uint64 offset)
+    {
+        VulkanCommandBuffer* cmd = VulkanCast(commandbuffer);
+        VulkanBuffer* vkbuffer   = VulkanCast(buffer);
+
+        vkCmdDispatchIndirect(cmd->commandBuffer, vkbuffer->buffer, offset);
+    }
+
     void VulkanAPI::Cmd_BindVertexBuffers(CommandBufferHandle* commandbuffer, uint32 bindingCount, BufferHandle** buffers, uint64* offsets)
     {
         VkBuffer* vkbuffers = SL_STACK(VkBuffer, bindingCount);
@@ -1891,6 +2404,92 @@ namespace Silex
         vkCmdBindIndexBuffer(cmd->commandBuffer, buf->buffer, offset, format == INDEX_BUFFER_FORMAT_UINT16? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32);
     }
 
+    void VulkanAPI::Cmd_ResetQueryPool(CommandBufferHandle* commandbuffer, QueryPoolHandle* pool, uint32 firstQuery, uint32 numQuery)
+    {
+        VulkanQueryPool* vkpool = VulkanCast(pool);
+
+        VulkanCommandBuffer* cmd = VulkanCast(commandbuffer);
+        vkCmdResetQueryPool(cmd->commandBuffer, vkpool->pool, firstQuery, numQuery);
+    }
+
+    void VulkanAPI::Cmd_WriteTimestamp(CommandBufferHandle* commandbuffer, QueryPoolHandle* pool, PipelineStageBits stage, uint32 queryIndex)
+    {
+        VulkanQueryPool* vkpool = VulkanCast(pool);
+
+        VulkanCommandBuffer* cmd = VulkanCast(commandbuffer);
+        vkCmdWriteTimestamp(cmd->commandBuffer, (VkPipelineStageFlagBits)stage, vkpool->pool, queryIndex);
+    }
+
+    //==================================================================================
+    // クエリ
+    //==================================================================================
+    QueryPoolHandle* VulkanAPI::CreateQueryPool(QueryType type, uint32 numQuery)
+    {
+        SL_CHECK(type == QUERY_TYPE_TIMESTAMP && timestampPeriod == 0.0, nullptr);
+
+        VkQueryPoolCreateInfo createInfo = {};
+        createInfo.sType      = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        createInfo.queryType  = type == QUERY_TYPE_TIMESTAMP? VK_QUERY_TYPE_TIMESTAMP : VK_QUERY_TYPE_OCCLUSION;
+        createInfo.queryCount = numQuery;
+
+        VkQueryPool vkpool = nullptr;
+        VkResult result = vkCreateQueryPool(device, &createInfo, nullptr, &vkpool);
+        SL_CHECK_VKRESULT(result, nullptr);
+
+        VulkanQueryPool* pool = slnew(VulkanQueryPool);
+        pool->pool     = vkpool;
+        pool->type     = createInfo.queryType;
+        pool->numQuery = numQuery;
+
+        // タイムスタンプの有効ビット数 (上位ビットは不定なのでマスクする)
+        if (type == QUERY_TYPE_TIMESTAMP)
+        {
+            QueueID graphicsQueue = QueryQueueID(QUEUE_FAMILY_GRAPHICS_BIT);
+            if (graphicsQueue != RENDER_INVALID_ID)
+            {
+                uint32 validBits = context->GetQueueFamilyProperties()[graphicsQueue].timestampValidBits;
+                pool->validMask  = validBits >= 64? UINT64_MAX : (1ull << validBits) - 1;
+            }
+        }
+
+        return pool;
+    }
+
+    void VulkanAPI::DestroyQueryPool(QueryPoolHandle* pool)
+    {
+        if (pool)
+        {
+            VulkanQueryPool* vkpool = VulkanCast(pool);
+            vkDestroyQueryPool(device, vkpool->pool, nullptr);
+
+            sldelete(vkpool);
+        }
+    }
+
+    bool VulkanAPI::GetQueryResults(QueryPoolHandle* pool, uint32 firstQuery, uint32 numQuery, uint64* outResults)
+    {
+        VulkanQueryPool* vkpool = VulkanCast(pool);
+
+        // WAIT_BIT は指定しない (結果が揃っていなければ VK_NOT_READY が返り、CPU は待機しない)
+        VkResult result = vkGetQueryPoolResults(device, vkpool->pool, firstQuery, numQuery, sizeof(uint64) * numQuery, outResults, sizeof(uint64), VK_QUERY_RESULT_64_BIT);
+        if (result == VK_NOT_READY)
+            return false;
+
+        SL_CHECK_VKRESULT(result, false);
+
+        for (uint32 i = 0; i < numQuery; i++)
+        {
+            outResults[i] &= vkpool->validMask;
+        }
+
+        return true;
+    }
+
+    double VulkanAPI::GetTimestampPeriod() const
+    {
+        return timestampPeriod;
+    }
+
     //==================================================================================
     // 即時コマンド
     //==================================================================================
@@ -1921,8 +2520,12 @@ namespace Silex
         submitInfo.commandBufferCount = 1;
         submitInfo.pCommandBuffers    = &vkcmd;
 
-        vkresult = vkQueueSubmit(vkqueue, 1, &submitInfo, vkfence);
-        SL_CHECK_VKRESULT(vkresult, false);
+        {
+            std::lock_guard lock(queueMutex);
+
+            vkresult = vkQueueSubmit(vkqueue, 1, &submitInfo, vkfence);
+            SL_CHECK_VKRESULT(vkresult, false);
+        }
 
         vkresult = vkWaitForFences(device, 1, &vkfence, true, UINT64_MAX);
         SL_CHECK_VKRESULT(vkresult, false);
@@ -1932,12 +2535,29 @@ namespace Silex
 
     bool VulkanAPI::WaitDevice()
     {
+        std::lock_guard lock(queueMutex);
+
         VkResult vkresult = vkDeviceWaitIdle(device);
         SL_CHECK_VKRESULT(vkresult, false);
 
         return true;
     }
 
+    bool VulkanAPI::IsDrawIndirectCountSupported() const
+    {
+        return drawIndirectCount;
+    }
+
+    bool VulkanAPI::IsTextureCompressionSupported() const
+    {
+        return textureCompressionBC;
+    }
+
+    uint64 VulkanAPI::GetMinUniformBufferOffsetAlignment() const
+    {
+        return minUniformBufferOffsetAlignment;
+    }
+
     //==================================================================================
     // シェーダー
     //==================================================================================
@@ -1955,16 +2575,45 @@ namespace Silex
         std::vector<VkPushConstantRange>             pushConstantRanges(numPushConstants);
         std::vector<VkPipelineShaderStageCreateInfo> shaderStages;
 
+        // 共有レイアウトを参照するセット (シェーダー破棄時に破棄しない)
+        std::vector<bool> bindlessSets(numDescriptorsets, false);
+
+        // ユニフォームは全て動的オフセットにするので、パイプラインレイアウト全体で動的ユニフォームの上限を超えないこと
+        uint32 numUniformBuffers = 0;
+        for (const ShaderDescriptorSet& descriptorsets : reflectData.descriptorSets)
+        {
+            numUniformBuffers += descriptorsets.uniformBuffers.size();
+        }
+
+        if (numUniformBuffers > maxUniformBuffersDynamic)
+        {
+            SL_LOG_ERROR("シェーダーのユニフォームバッファ数 ({}) が 動的ユニフォームバッファの上限 ({}) を超えています", numUniformBuffers, maxUniformBuffersDynamic);
+            return nullptr;
+        }
+
         // デスクリプターセットレイアウト
         for (uint32 setIndex = 0; setIndex < numDescriptorsets; setIndex++)
         {
             const ShaderDescriptorSet& descriptorsets = reflectData.descriptorSets[setIndex];
 
-            // ユニフォーム
+            // サイズ未指定のテクスチャ配列を含むセットは、バインドレスセットのレイアウトを使用する
+            const bool isBindless = std::any_of(descriptorsets.imageSamplers.begin(), descriptorsets.imageSamplers.end(), [](const auto& pair)
+            {
+                return pair.second.arraySize == 0;
+            });
+
+            if (isBindless)
+            {
+                layouts[setIndex]      = bindlessLayout;
+                bindlessSets[setIndex] = true;
+                continue;
+            }
+
+            // ユニフォーム (リングバッファからのサブアロケーションを参照できるように、全て動的オフセットとする)
             for (const auto& [index, uniform] : descriptorsets.uniformBuffers)
             {
                 VkDescriptorSetLayoutBinding& binding = layoutBindings.emplace_back();
-                binding.descriptorType     = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+                binding.descriptorType     = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
                 binding.binding            = index;
                 binding.descriptorCount    = 1;
                 binding.stageFlags         = uniform.stage;
@@ -2121,8 +2770,10 @@ namespace Silex
         // Vulkanデータ生成
         VulkanShader* vkshader = slnew(VulkanShader);
         vkshader->descriptorsetLayouts = layouts;
+        vkshader->bindlessSets         = bindlessSets;
         vkshader->pipelineLayout       = vkpipelineLayout;
         vkshader->stageInfos           = shaderStages;
+        vkshader->bindPoint            = (stageFlags == VK_SHADER_STAGE_COMPUTE_BIT)? VK_PIPELINE_BIND_POINT_COMPUTE : VK_PIPELINE_BIND_POINT_GRAPHICS;
         vkshader->reflection           = reflectionData;
 
         return vkshader;
@@ -2137,7 +2788,10 @@ namespace Silex
 
             for (uint32 i = 0; i < vkshader->descriptorsetLayouts.size(); i++)
             {
-                vkDestroyDescriptorSetLayout(device, vkshader->descriptorsetLayouts[i], nullptr);
+                if (!vkshader->bindlessSets[i])
+                {
+                    vkDestroyDescriptorSetLayout(device, vkshader->descriptorsetLayouts[i], nullptr);
+                }
             }
 
             vkDestroyPipelineLayout(device, vkshader->pipelineLayout, nullptr);
@@ -2168,7 +2822,7 @@ namespace Silex
         numDescriptor += key.descriptorTypeCounts[DESCRIPTOR_TYPE_IMAGE]          = shaderset.separateTextures.size();
         numDescriptor += key.descriptorTypeCounts[DESCRIPTOR_TYPE_SAMPLER]        = shaderset.separateSamplers.size();
         numDescriptor += key.descriptorTypeCounts[DESCRIPTOR_TYPE_IMAGE_SAMPLER]  = shaderset.imageSamplers.size();
-        numDescriptor += key.descriptorTypeCounts[DESCRIPTOR_TYPE_UNIFORM_BUFFER] = shaderset.uniformBuffers.size();
+        numDescriptor += key.descriptorTypeCounts[DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC] = shaderset.uniformBuffers.size();
         numDescriptor += key.descriptorTypeCounts[DESCRIPTOR_TYPE_STORAGE_IMAGE]  = shaderset.storageImages.size();
         numDescriptor += key.descriptorTypeCounts[DESCRIPTOR_TYPE_STORAGE_BUFFER] = shaderset.storageBuffers.size();
 
@@ -2198,9 +2852,12 @@ namespace Silex
         descriptorset->descriptorPool = vkPool;
         descriptorset->descriptorSet  = vkdescriptorset;
         descriptorset->pipelineLayout = vkShader->pipelineLayout;
+        descriptorset->bindPoint      = vkShader->bindPoint;
         descriptorset->poolKey        = key;
         descriptorset->writes.resize(numDescriptor);
 
+        descriptorset->numDynamicOffset = shaderset.uniformBuffers.size();
+
         return descriptorset;
     }
 
@@ -2221,17 +2878,19 @@ namespace Silex
 
             switch (descriptor.type)
             {
-                // ユニフォームバッファ
+                // ユニフォームバッファ (レイアウトは全て動的オフセット)
+                // 範囲指定があれば、バインド時の動的オフセットからその範囲のみを参照する
                 case DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+                case DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
                 {
                     VkDescriptorBufferInfo* bufferInfo = SL_STACK(VkDescriptorBufferInfo, 1);
 
                     VulkanBuffer* buffer = VulkanCast(descriptor.handles.buffer);
                     *bufferInfo = {};
                     bufferInfo->buffer = buffer->buffer;
-                    bufferInfo->range  = buffer->size;
+                    bufferInfo->range  = descriptor.handles.bufferRange? descriptor.handles.bufferRange : buffer->size;
 
-                    writes[i].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+                    writes[i].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
                     writes[i].pBufferInfo    = bufferInfo;
 
                     break;
@@ -2417,6 +3076,52 @@ namespace Silex
         }
     }
 
+    //==================================================================================
+    // バインドレス
+    //==================================================================================
+    void VulkanAPI::UpdateBindlessTexture(uint32 index, TextureViewHandle* view, SamplerHandle* sampler)
+    {
+        SL_CHECK(index >= BINDLESS_TEXTURE_CAPACITY, );
+
+        VkDescriptorImageInfo imageInfo = {};
+        imageInfo.imageView   = VulkanCast(view)->view;
+        imageInfo.sampler     = VulkanCast(sampler)->sampler;
+        imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+        VkWriteDescriptorSet write = {};
+        write.sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet          = bindlessSet;
+        write.dstBinding      = BINDLESS_TEXTURE_BINDING;
+        write.dstArrayElement = index;
+        write.descriptorCount = 1;
+        write.descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        write.pImageInfo      = &imageInfo;
+
+        vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+    }
+
+    void VulkanAPI::UpdateBindlessBuffer(uint32 index, BufferHandle* buffer)
+    {
+        SL_CHECK(index >= BINDLESS_BUFFER_CAPACITY, );
+
+        VulkanBuffer* vkbuffer = VulkanCast(buffer);
+
+        VkDescriptorBufferInfo bufferInfo = {};
+        bufferInfo.buffer = vkbuffer->buffer;
+        bufferInfo.range  = vkbuffer->size;
+
+        VkWriteDescriptorSet write = {};
+        write.sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet          = bindlessSet;
+        write.dstBinding      = BINDLESS_BUFFER_BINDING;
+        write.dstArrayElement = index;
+        write.descriptorCount = 1;
+        write.descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        write.pBufferInfo     = &bufferInfo;
+
+        vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+    }
+
 
     //==================================================================================
     // パイプライン
@@ -2645,10 +3350,14 @@ namespace Silex
         pipelineCreateInfo.renderPass          = VulkanCast(renderpass)->renderpass;
         pipelineCreateInfo.subpass             = renderSubpass;
 
+        uint64 beginTick = OS::Get()->GetTickCount();
+
         VkPipeline vkpipeline = nullptr;
-        VkResult result = vkCreateGraphicsPipelines(device, nullptr, 1, &pipelineCreateInfo, nullptr, &vkpipeline);
+        VkResult result = vkCreateGraphicsPipelines(device, pipelineCache, 1, &pipelineCreateInfo, nullptr, &vkpipeline);
         SL_CHECK_VKRESULT(result, nullptr);
 
+        _RecordPipelineCreation(beginTick);
+
         VulkanPipeline* pipeline = slnew(VulkanPipeline);
         pipeline->pipeline = vkpipeline;
 
@@ -2665,12 +3374,17 @@ namespace Silex
         pipelineCreateInfo.stage  = vkshader->stageInfos[0];
         pipelineCreateInfo.layout = vkshader->pipelineLayout;
 
+        uint64 beginTick = OS::Get()->GetTickCount();
+
         VkPipeline vkpipeline = nullptr;
-        VkResult result = vkCreateComputePipelines(device, nullptr, 1, &pipelineCreateInfo, nullptr, &vkpipeline);
+        VkResult result = vkCreateComputePipelines(device, pipelineCache, 1, &pipelineCreateInfo, nullptr, &vkpipeline);
         SL_CHECK_VKRESULT(result, nullptr);
 
+        _RecordPipelineCreation(beginTick);
+
         VulkanPipeline* pipeline = slnew(VulkanPipeline);
-        pipeline->pipeline = vkpipeline;
+        pipeline->pipeline  = vkpipeline;
+        pipeline->bindPoint = VK_PIPELINE_BIND_POINT_COMPUTE;
 
         return pipeline;
     }
@@ -2685,4 +3399,17 @@ namespace Silex
             sldelete(vkpipeline);
         }
     }
+
+    PipelineCacheStats VulkanAPI::GetPipelineCacheStats() const
+    {
+        uint64 ticks = pipelineCreationTicks.load(std::memory_order_relaxed);
+
+        PipelineCacheStats stats = {};
+        stats.loadedFromDisk = pipelineCacheLoaded;
+        stats.loadedDataSize = pipelineCacheLoadSize;
+        stats.numPipeline    = numPipelineCreated.load(std::memory_order_relaxed);
+        stats.creationTimeMs = (float)((double)ticks * 1'000.0 / (double)OS::Get()->GetTickFrequency());
+
+        return stats;
+    }
 }
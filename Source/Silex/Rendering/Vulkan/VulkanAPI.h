@@ -31,12 +31,14 @@ namespace Silex
         void DestroyCommandQueue(CommandQueueHandle* queue) override;
         QueueID QueryQueueID(QueueFamilyFlags queueFlag, SurfaceHandle* surface = nullptr) const override;
         bool SubmitQueue(CommandQueueHandle* queue, CommandBufferHandle* commandbuffer, FenceHandle* fence, SemaphoreHandle* present, SemaphoreHandle* render) override;
+        bool SubmitQueueWithTimeline(CommandQueueHandle* queue, CommandBufferHandle* commandbuffer, SemaphoreHandle* timeline, uint64 signalValue) override;
 
         //--------------------------------------------------
         // コマンドプール
         //--------------------------------------------------
         CommandPoolHandle* CreateCommandPool(QueueID id, CommandBufferType type = COMMAND_BUFFER_TYPE_PRIMARY) override;
         void DestroyCommandPool(CommandPoolHandle* pool) override;
+        bool ResetCommandPool(CommandPoolHandle* pool) override;
 
         //--------------------------------------------------
         // コマンドバッファ
@@ -45,12 +47,16 @@ namespace Silex
         void DestroyCommandBuffer(CommandBufferHandle* commandBuffer) override;
         bool BeginCommandBuffer(CommandBufferHandle* commandBuffer) override;
         bool EndCommandBuffer(CommandBufferHandle* commandBuffer) override;
+        bool BeginSecondaryCommandBuffer(CommandBufferHandle* commandBuffer, RenderPassHandle* renderpass, uint32 subpass = 0) override;
 
         //--------------------------------------------------
         // セマフォ
         //--------------------------------------------------
         SemaphoreHandle* CreateSemaphore() override;
         void DestroySemaphore(SemaphoreHandle* semaphore) override;
+        SemaphoreHandle* CreateTimelineSemaphore(uint64 initialValue = 0) override;
+        uint64 GetTimelineSemaphoreValue(SemaphoreHandle* semaphore) override;
+        bool WaitTimelineSemaphore(SemaphoreHandle* semaphore, uint64 value) override;
 
         //--------------------------------------------------
         // フェンス
@@ -124,12 +130,27 @@ namespace Silex
         void UpdateDescriptorSet(DescriptorSetHandle* set, uint32 numdescriptors, DescriptorInfo* descriptors) override;
         void DestroyDescriptorSet(DescriptorSetHandle* descriptorset) override;
 
+        //--------------------------------------------------
+        // バインドレス
+        //--------------------------------------------------
+        void UpdateBindlessTexture(uint32 index, TextureViewHandle* view, SamplerHandle* sampler) override;
+        void UpdateBindlessBuffer(uint32 index, BufferHandle* buffer) override;
+
         //--------------------------------------------------
         // パイプライン
         //--------------------------------------------------
         PipelineHandle* CreateGraphicsPipeline(ShaderHandle* shader, PipelineStateInfo* info, RenderPassHandle* renderpass, uint32 renderSubpass = 0, PipelineDynamicStateFlags dynamicState = DYNAMIC_STATE_NONE) override;
         PipelineHandle* CreateComputePipeline(ShaderHandle* shader) override;
         void DestroyPipeline(PipelineHandle* pipeline) override;
+        PipelineCacheStats GetPipelineCacheStats() const override;
+
+        //--------------------------------------------------
+        // クエリ
+        //--------------------------------------------------
+        QueryPoolHandle* CreateQueryPool(QueryType type, uint32 numQuery) override;
+        void DestroyQueryPool(QueryPoolHandle* pool) override;
+        bool GetQueryResults(QueryPoolHandle* pool, uint32 firstQuery, uint32 numQuery, uint64* outResults) override;
+        double GetTimestampPeriod() const override;
 
         //--------------------------------------------------
         // コマンド
@@ -148,22 +169,33 @@ namespace Silex
         void Cmd_BeginRenderPass(CommandBufferHandle* commandbuffer, RenderPassHandle* renderpass, FramebufferHandle* framebuffer, uint32 numView, TextureViewHandle** views, CommandBufferType commandBufferType = COMMAND_BUFFER_TYPE_PRIMARY) override;
         void Cmd_EndRenderPass(CommandBufferHandle* commandbuffer) override;
         void Cmd_NextRenderSubpass(CommandBufferHandle* commandbuffer, CommandBufferType commandBufferType) override;
+        void Cmd_ExecuteCommands(CommandBufferHandle* commandbuffer, uint32 numCommandBuffer, CommandBufferHandle** commandBuffers) override;
         void Cmd_SetViewport(CommandBufferHandle* commandbuffer, uint32 x, uint32 y, uint32 width, uint32 height) override;
         void Cmd_SetScissor(CommandBufferHandle* commandbuffer, uint32 x, uint32 y, uint32 width, uint32 height) override;
         void Cmd_ClearAttachments(CommandBufferHandle* commandbuffer, uint32 numAttachmentClear, AttachmentClear** attachmentClears, uint32 x, uint32 y, uint32 width, uint32 height) override;
         void Cmd_BindPipeline(CommandBufferHandle* commandbuffer, PipelineHandle* pipeline) override;
-        void Cmd_BindDescriptorSet(CommandBufferHandle* commandbuffer, DescriptorSetHandle* descriptorset, uint32 setIndex) override;
+        void Cmd_BindDescriptorSet(CommandBufferHandle* commandbuffer, DescriptorSetHandle* descriptorset, uint32 setIndex, uint32 numDynamicOffset = 0, const uint32* dynamicOffsets = nullptr) override;
+        void Cmd_BindBindlessDescriptorSet(CommandBufferHandle* commandbuffer, ShaderHandle* shader, uint32 setIndex) override;
         void Cmd_Draw(CommandBufferHandle* commandbuffer, uint32 vertexCount, uint32 instanceCount, uint32 baseVertex, uint32 firstInstance) override;
         void Cmd_DrawIndexed(CommandBufferHandle* commandbuffer, uint32 indexCount, uint32 instanceCount, uint32 firstIndex, int32 vertexOffset, uint32 firstInstance) override;
+        void Cmd_DrawIndexedIndirect(CommandBufferHandle* commandbuffer, BufferHandle* buffer, uint64 offset, uint32 drawCount, uint32 stride) override;
+        void Cmd_DrawIndexedIndirectCount(CommandBufferHandle* commandbuffer, BufferHandle* buffer, uint64 offset, BufferHandle* countBuffer, uint64 countBufferOffset, uint32 maxDrawCount, uint32 stride) override;
+        void Cmd_Dispatch(CommandBufferHandle* commandbuffer, uint32 groupCountX, uint32 groupCountY, uint32 groupCountZ) override;
+        void Cmd_DispatchIndirect(CommandBufferHandle* commandbuffer, BufferHandle* buffer, uint64 offset) override;
         void Cmd_BindVertexBuffers(CommandBufferHandle* commandbuffer, uint32 bindingCount, BufferHandle** buffers, uint64* offsets) override;
         void Cmd_BindVertexBuffer(CommandBufferHandle* commandbuffer, BufferHandle* buffer, uint64 offset) override;
         void Cmd_BindIndexBuffer(CommandBufferHandle* commandbuffer, BufferHandle* buffer, IndexBufferFormat format, uint64 offset) override;
+        void Cmd_ResetQueryPool(CommandBufferHandle* commandbuffer, QueryPoolHandle* pool, uint32 firstQuery, uint32 numQuery) override;
+        void Cmd_WriteTimestamp(CommandBufferHandle* commandbuffer, QueryPoolHandle* pool, PipelineStageBits stage, uint32 queryIndex) override;
 
         //--------------------------------------------------
         // MISC
         //--------------------------------------------------
         bool ImmidiateCommands(CommandQueueHandle* queue, CommandBufferHandle* commandBuffer, FenceHandle* fence, std::function<void(CommandBufferHandle*)>&& func) override;
         bool WaitDevice() override;
+        bool IsDrawIndirectCountSupported() const override;
+        bool IsTextureCompressionSupported() const override;
+        uint64 GetMinUniformBufferOffsetAlignment() const override;
 
 
     private:
@@ -172,6 +204,10 @@ namespace Silex
         VkDescriptorPool _FindOrCreateDescriptorPool(const VulkanDescriptorSet::PoolKey& key);
         void             _DecrementPoolRefCount(VkDescriptorPool pool, VulkanDescriptorSet::PoolKey& poolKey);
 
+        // バインドレス デスクリプターセットの生成・破棄
+        bool _CreateBindlessDescriptorSet();
+        void _DestroyBindlessDescriptorSet();
+
         // 利用可能サンプル数のチェック
         VkSampleCountFlagBits _CheckSupportedSampleCounts(TextureSamples samples);
 
@@ -181,6 +217,11 @@ namespace Silex
         VulkanRenderPass* _CreateSwapChainRenderPass(VkFormat format);
         bool              _QuerySwapChainCapability(VkSurfaceKHR surface, uint32 width, uint32 height, uint32 requestFramebufferCount, VkPresentModeKHR mode, VulkanSwapChain::Capability& out_cap);
 
+        // パイプラインキャッシュの読み込み・保存
+        bool _CreatePipelineCache();
+        bool _SavePipelineCache();
+        void _RecordPipelineCreation(uint64 beginTick);
+
     private:
 
         // デスクリプター型と個数では一意のハッシュ値を生成できないので、unordered_mapではなく、mapを採用
@@ -199,7 +240,36 @@ namespace Silex
         // 論理デバイス
         VkDevice device = nullptr;
 
+        // キューへの送信・プレゼント・デバイス待機の排他 (VkQueue は外部同期が必要で、転送キューがグラフィックスと同じキューになる場合がある)
+        std::mutex queueMutex;
+
         // VMAアロケータ (VulkanMemoryAllocator: VkImage/VkBuffer に関るメモリ管理を代行)
         VmaAllocator allocator = nullptr;
+
+        // タイムスタンプ 1 カウントあたりのナノ秒 (0 の場合はタイムスタンプ非対応)
+        double timestampPeriod = 0.0;
+
+        // 間接描画 (multiDrawIndirect 非対応の場合は、1描画ずつ発行する)
+        bool multiDrawIndirect = false;
+        bool drawIndirectCount = false;
+
+        // BC 圧縮テクスチャ (非対応の場合、テクスチャは非圧縮でクックされる)
+        bool textureCompressionBC = false;
+
+        // 動的ユニフォームバッファのオフセットアライメント / パイプラインレイアウト当たりの上限数
+        uint64 minUniformBufferOffsetAlignment = 256;
+        uint32 maxUniformBuffersDynamic        = 8;
+
+        // バインドレス (全シェーダーで共有する、更新後バインド可能な 1つのデスクリプターセット)
+        VkDescriptorSetLayout bindlessLayout = nullptr;
+        VkDescriptorPool      bindlessPool   = nullptr;
+        VkDescriptorSet       bindlessSet    = nullptr;
+
+        // パイプラインキャッシュ (起動時にディスクから読み込み、終了時に保存する)
+        VkPipelineCache     pipelineCache          = nullptr;
+        bool                pipelineCacheLoaded    = false;
+        uint64              pipelineCacheLoadSize  = 0;
+        std::atomic<uint32> numPipelineCreated     = 0;
+        std::atomic<uint64> pipelineCreationTicks  = 0;
     };
 }
@@ -26,6 +26,7 @@ namespace Silex
     struct VulkanRenderPass;
     struct VulkanSurface;
     struct VulkanSwapChain;
+    struct VulkanQueryPool;
 
     template<class T> struct VulkanTypeTraits {};
     template<> struct VulkanTypeTraits<BufferHandle>        { using Internal = VulkanBuffer;        };
@@ -44,6 +45,7 @@ namespace Silex
     template<> struct VulkanTypeTraits<RenderPassHandle>    { using Internal = VulkanRenderPass;    };
     template<> struct VulkanTypeTraits<SurfaceHandle>       { using Internal = VulkanSurface;       };
     template<> struct VulkanTypeTraits<SwapChainHandle>     { using Internal = VulkanSwapChain;     };
+    template<> struct VulkanTypeTraits<QueryPoolHandle>     { using Internal = VulkanQueryPool;     };
 
     //=============================================
     // Vulkan 型キャスト
@@ -194,19 +196,25 @@ namespace Silex
     {
         std::vector<VkPipelineShaderStageCreateInfo> stageInfos           = {};
         std::vector<VkDescriptorSetLayout>           descriptorsetLayouts = {};
+        std::vector<bool>                            bindlessSets         = {};
         VkPipelineLayout                             pipelineLayout       = nullptr;
+        VkPipelineBindPoint                          bindPoint            = VK_PIPELINE_BIND_POINT_GRAPHICS;
         ShaderReflectionData*                        reflection           = nullptr;
     };
 
     // デスクリプターセット
     struct VulkanDescriptorSet : public DescriptorSetHandle
     {
-        VkDescriptorSet  descriptorSet  = nullptr;
-        VkDescriptorPool descriptorPool = nullptr;
-        VkPipelineLayout pipelineLayout = nullptr;
+        VkDescriptorSet     descriptorSet  = nullptr;
+        VkDescriptorPool    descriptorPool = nullptr;
+        VkPipelineLayout    pipelineLayout = nullptr;
+        VkPipelineBindPoint bindPoint      = VK_PIPELINE_BIND_POINT_GRAPHICS;
 
         std::vector<VkWriteDescriptorSet> writes;
 
+        // バインド時に必要な動的オフセット数 (ユニフォームバッファ数)
+        uint32 numDynamicOffset = 0;
+
         // プール検索キー
         struct PoolKey
         {
@@ -223,6 +231,16 @@ namespace Silex
     // パイプライン
     struct VulkanPipeline : public PipelineHandle
     {
-        VkPipeline pipeline = nullptr;
+        VkPipeline          pipeline  = nullptr;
+        VkPipelineBindPoint bindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    };
+
+    // クエリプール
+    struct VulkanQueryPool : public QueryPoolHandle
+    {
+        VkQueryPool pool      = nullptr;
+        VkQueryType type      = VK_QUERY_TYPE_TIMESTAMP;
+        uint32      numQuery  = 0;
+        uint64      validMask = UINT64_MAX;
     };
 }
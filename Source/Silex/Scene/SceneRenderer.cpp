@@ -3,8 +3,12 @@
 #include "Scene/SceneRenderer.h"
 #include "Core/Window.h"
 #include "Core/Engine.h"
-#include "Asset/TextureReader.h"
+#include "Core/ThreadPool.h"
+#include "Core/ParallelFor.h"
+#include "Core/Profiler.h"
+#include "Core/Timer.h"
 #include "Rendering/ShaderCompiler.h"
+#include "Rendering/TextureCooker.h"
 #include "Rendering/Renderer.h"
 #include "Rendering/RenderingUtility.h"
 
@@ -20,16 +24,10 @@ namespace Silex
 
         struct Transform
         {
-            glm::mat4 world = glm::mat4(1.0f);
             glm::mat4 view = glm::mat4(1.0f);
             glm::mat4 projection = glm::mat4(1.0f);
         };
 
-        struct ShadowTransformData
-        {
-            glm::mat4 world = glm::mat4(1.0f);
-        };
-
         struct LightSpaceTransformData
         {
             glm::mat4 cascade[4];
@@ -59,15 +57,6 @@ namespace Silex
             glm::mat4 projection;
         };
 
-        struct MaterialUBO
-        {
-            glm::vec3 albedo;
-            float     metallic;
-            glm::vec3 emission;
-            float     roughness;
-            glm::vec2 textureTiling;
-        };
-
         struct SceneUBO
         {
             glm::vec4 lightDir;
@@ -109,6 +98,56 @@ namespace Silex
         };
     }
 
+    // GPU 計測区間名 (計測結果の判別にポインタを使用する)
+    namespace GPUZone
+    {
+        static const char* Shadow    = "Shadow";
+        static const char* Geometry  = "Geometry";
+        static const char* Lighting  = "Lighting";
+        static const char* Sky       = "Sky";
+        static const char* Bloom     = "Bloom";
+        static const char* Composite = "Composite";
+    }
+
+    // ディレクショナルライトの方向 (現状は固定)
+    static const glm::vec3 SceneLightDirection = { 0.5, 0.7, 0.1 };
+
+    // インスタンスバッファの初期容量 (超過した場合は倍に拡張する)
+    static constexpr uint32 DefaultInstanceCapacity = 1024;
+
+    // マテリアルテーブルの初期容量 (超過した場合は倍に拡張する)
+    static constexpr uint32 DefaultMaterialCapacity = 256;
+
+    // エンティティID 読み戻しバッファの初期容量 (超過した場合は倍に拡張する / 64KB = 128x128 ピクセル)
+    static constexpr uint64 DefaultEntityPickReadbackSize = 64 * 1024;
+
+    // 間接描画引数バッファの先頭に置く描画数の領域 (引数の配置を 16 バイト境界に揃える)
+    static constexpr uint64 IndirectDrawCountOffset = 16;
+
+    // セカンダリコマンドバッファ 1つあたりの最小描画単位数 (これ以下の描画数ではプライマリに直接記録する)
+    static constexpr uint32 MinDrawsPerSecondaryCommand = 32;
+
+    // シーンレンダラーが使用するシェーダー (初期化時に一括でコンパイルし、キャッシュを生成しておく)
+    static const std::vector<std::string> SceneShaderPaths =
+    {
+        "Assets/Shaders/IBL/EquirectangularToCubeMap.glsl",
+        "Assets/Shaders/IBL/Irradiance.glsl",
+        "Assets/Shaders/IBL/Prefilter.glsl",
+        "Assets/Shaders/IBL/BRDF.glsl",
+        "Assets/Shaders/DirectionalLight.glsl",
+        "Assets/Shaders/DeferredPrimitive.glsl",
+        "Assets/Shaders/DeferredLighting.glsl",
+        "Assets/Shaders/Environment.glsl",
+        "Assets/Shaders/Grid.glsl",
+        "Assets/Shaders/Composit.glsl",
+        "Assets/Shaders/Bloom.glsl",
+        "Assets/Shaders/BloomPrefiltering.glsl",
+        "Assets/Shaders/BloomDownSampling.glsl",
+        "Assets/Shaders/BloomUpSampling.glsl",
+        "Assets/Shaders/HiZ.glsl",
+        "Assets/Shaders/OcclusionCulling.glsl",
+    };
+
     SceneRenderer::SceneRenderer()
     {
         api = Renderer::Get()->GetAPI();
@@ -160,40 +199,78 @@ namespace Silex
 
     SceneRenderStats SceneRenderer::GetRenderStats()
     {
-        return stats;
+        SceneRenderStats result = stats;
+
+        for (const GPUTimestampResult& zone : Renderer::Get()->GetGPUTimestampResults())
+        {
+            if      (zone.name == GPUZone::Shadow)    result.gpuShadowPass    = zone.milliseconds;
+            else if (zone.name == GPUZone::Geometry)  result.gpuGeometryPass  = zone.milliseconds;
+            else if (zone.name == GPUZone::Lighting)  result.gpuLightingPass  = zone.milliseconds;
+            else if (zone.name == GPUZone::Sky)       result.gpuSkyPass       = zone.milliseconds;
+            else if (zone.name == GPUZone::Bloom)     result.gpuBloomPass     = zone.milliseconds;
+            else if (zone.name == GPUZone::Composite) result.gpuCompositePass = zone.milliseconds;
+        }
+
+        const RenderGraphStats& graphStats = renderGraph->GetStats();
+        result.numGraphPass             = graphStats.numPass;
+        result.numGraphCulledPass       = graphStats.numCulledPass;
+        result.graphTargetMemory        = graphStats.memorySize;
+        result.graphTargetMemoryNoAlias = graphStats.unaliasedMemorySize;
+
+        result.numRecordThread = _GetRecordThreadCount();
+
+        return result;
     }
 
     void SceneRenderer::_InitializePasses()
     {
         auto size = Window::Get()->GetSize();
 
+        // メッシュ読み込みと並行して全シェーダーを並列コンパイルし、以降の各パスの Compile をキャッシュヒットさせる
+        JobHandle shaderJob = ThreadPool::Schedule([]()
+        {
+            std::vector<ShaderCompiledData> compiledData;
+            ShaderCompiler::Get()->CompileAll(SceneShaderPaths, compiledData);
+        });
+
         cubeMesh   = MeshFactory::Cube();
         sponzaMesh = MeshFactory::Sponza();
 
-        defaultLayout.Binding(0);
-        defaultLayout.Attribute(0, VERTEX_BUFFER_FORMAT_R32G32B32);
-        defaultLayout.Attribute(1, VERTEX_BUFFER_FORMAT_R32G32B32);
-        defaultLayout.Attribute(2, VERTEX_BUFFER_FORMAT_R32G32);
-        defaultLayout.Attribute(3, VERTEX_BUFFER_FORMAT_R32G32B32);
-        defaultLayout.Attribute(4, VERTEX_BUFFER_FORMAT_R32G32B32);
+        ThreadPool::Wait(shaderJob);
+
+        // 座標 (量子化時は snorm16x4 / 逆量子化はインスタンスの変換行列で行う)
+        vertexLayouts[0].Binding(0);
+        vertexLayouts[0].Attribute(0, QuantizeVertexPosition? VERTEX_BUFFER_FORMAT_R16G16B16A16_SNORM : VERTEX_BUFFER_FORMAT_R32G32B32);
+
+        // 法線 (八面体) ・UV・接線 (八面体 + 従法線の符号)
+        vertexLayouts[1].Binding(1);
+        vertexLayouts[1].Attribute(1, VERTEX_BUFFER_FORMAT_R16G16_SNORM);
+        vertexLayouts[1].Attribute(2, VERTEX_BUFFER_FORMAT_R16G16_SFLOAT);
+        vertexLayouts[1].Attribute(3, VERTEX_BUFFER_FORMAT_R16G16_SNORM);
 
         linearSampler = Renderer::Get()->CreateSampler(SAMPLER_FILTER_LINEAR, SAMPLER_REPEAT_MODE_CLAMP_TO_EDGE);
         shadowSampler = Renderer::Get()->CreateSampler(SAMPLER_FILTER_LINEAR, SAMPLER_REPEAT_MODE_CLAMP_TO_EDGE, true, COMPARE_OP_LESS_OR_EQUAL);
 
-        TextureReader reader;
-        byte* pixels;
-
-        pixels = reader.Read("Assets/Textures/default.png");
-        defaultTexture     = Renderer::Get()->CreateTextureFromMemory(pixels, reader.data.byteSize, reader.data.width, reader.data.height, true);
+        defaultTexture     = TextureCooker::Load("Assets/Textures/default.png");
         defaultTextureView = Renderer::Get()->CreateTextureView(defaultTexture, TEXTURE_TYPE_2D, TEXTURE_ASPECT_COLOR_BIT);
-        reader.Unload(pixels);
+
+        // マテリアルテーブルの代替テクスチャとして常に参照されるので、転送完了を待機する
+        Renderer::Get()->WaitUpload(defaultTexture->GetUploadToken());
 
         // ID リードバック
-        pixelIDBuffer = Renderer::Get()->CreateBuffer(nullptr, sizeof(int32));
+        picking = slnew(EntityPickData);
+        _PrepareEntityPick();
 
         // IBL
         _PrepareIBL("Assets/Textures/cloud.png");
 
+        // インスタンスバッファ (シャドウ・Gバッファのデスクリプターから参照する)
+        instanceCapacity = DefaultInstanceCapacity;
+        instanceSBO      = Renderer::Get()->CreateStorageBuffer(nullptr, sizeof(InstanceParameter) * instanceCapacity);
+
+        // マテリアルテーブル
+        _PrepareMaterialTable();
+
         // シャドウマップ
         shadow = slnew(ShadowData);
         _PrepareShadowBuffer();
@@ -212,7 +289,23 @@ namespace Silex
 
         // ブルーム
         bloom = slnew(BloomData);
-        _PrepareBloomBuffer(size.x, size.y);
+        _PrepareBloomBuffer();
+
+        // 間接描画
+        indirect = slnew(IndirectDrawData);
+        _PrepareIndirectDraw();
+
+        // 視錐台カリング
+        culling = slnew(CullingData);
+        _PrepareCulling();
+
+        // オクルージョンカリング (Gバッファの深度と 間接描画の統合ジオメトリを参照する)
+        occlusion = slnew(OcclusionCullingData);
+        _PrepareOcclusionCulling(size.x, size.y);
+
+        // 並列記録用 セカンダリコマンドバッファ
+        secondary = slnew(SecondaryCommandData);
+        _PrepareSecondaryCommands();
 
         {
             // グリッド
@@ -225,19 +318,18 @@ namespace Silex
             ShaderCompiledData compiledData;
             ShaderCompiler::Get()->Compile("Assets/Shaders/Grid.glsl", compiledData);
             gridShader   = api->CreateShader(compiledData);
-            gridPipeline = api->CreateGraphicsPipeline(gridShader, &pipelineInfo, environment->pass);
-            gridUBO      = Renderer::Get()->CreateUniformBuffer(nullptr, sizeof(UBO::GridData));
+            gridPipeline = PipelineCompiler::CompileGraphics(gridShader, pipelineInfo, environment->pass);
 
             gridSet = Renderer::Get()->CreateDescriptorSet(gridShader, 0);
-            gridSet->SetResource(0, gridUBO);
+            gridSet->SetResource(0, Renderer::Get()->GetDynamicUniformBuffer(), sizeof(UBO::GridData));
             gridSet->Flush();
         }
 
         {
             // コンポジット
             Attachment color = {};
-            color.initialLayout = TEXTURE_LAYOUT_UNDEFINED;
-            color.finalLayout = TEXTURE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            color.initialLayout = TEXTURE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+            color.finalLayout = TEXTURE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
             color.loadOp = ATTACHMENT_LOAD_OP_CLEAR;
             color.storeOp = ATTACHMENT_STORE_OP_STORE;
             color.samples = TEXTURE_SAMPLES_1;
@@ -253,12 +345,8 @@ namespace Silex
             RenderPassClearValue clear = {};
             clear.SetFloat(0, 0, 0, 1);
 
-            compositePass    = api->CreateRenderPass(1, &color, 1, &subpass, 0, nullptr, 1, &clear);
-            compositeTexture = Renderer::Get()->CreateTexture2D(RENDERING_FORMAT_R8G8B8A8_UNORM, size.x, size.y);
-
-            auto hcomposite      = compositeTexture->GetHandle();
-            compositeTextureView = Renderer::Get()->CreateTextureView(compositeTexture, TEXTURE_TYPE_2D, TEXTURE_ASPECT_COLOR_BIT);
-            compositeFB          = Renderer::Get()->CreateFramebuffer(compositePass, 1, &hcomposite, size.x, size.y);
+            // パイプライン生成用 レンダーパス (描画時はレンダーグラフが生成したレンダーパスを使用する)
+            compositePass = api->CreateRenderPass(1, &color, 1, &subpass, 0, nullptr, 1, &clear);
 
             PipelineStateInfoBuilder builder;
             PipelineStateInfo pipelineInfo = builder
@@ -268,23 +356,22 @@ namespace Silex
             ShaderCompiledData compiledData;
             ShaderCompiler::Get()->Compile("Assets/Shaders/Composit.glsl", compiledData);
             compositeShader = api->CreateShader(compiledData);
-            compositePipeline = api->CreateGraphicsPipeline(compositeShader, &pipelineInfo, compositePass);
-
-            compositeSet = Renderer::Get()->CreateDescriptorSet(compositeShader, 0);
-            compositeSet->SetResource(0, bloom->bloomView, linearSampler);
-            compositeSet->Flush();
+            compositePipeline = PipelineCompiler::CompileGraphics(compositeShader, pipelineInfo, compositePass);
         }
 
-        // ImGui ビューポート用 デスクリプターセット
-        imageSet = Renderer::Get()->CreateDescriptorSet(compositeShader, 0);
-        imageSet->SetResource(0, compositeTextureView, linearSampler);
-        imageSet->Flush();
+        // レンダーグラフ (ブルーム・コンポジット / ImGui ビューポート用 デスクリプターセットも構築時に生成する)
+        renderGraph = slnew(RenderGraph);
+        renderGraph->Initialize(api);
+        _BuildRenderGraph();
     }
 
     void SceneRenderer::_FinalizeePasses()
     {
         api->WaitDevice();
 
+        // 生成中のパイプラインがシェーダー・レンダーパスを参照しているので、先に完了を待つ
+        PipelineCompiler::WaitAll();
+
         sldelete(cubeMesh);
         sldelete(sponzaMesh);
 
@@ -294,21 +381,32 @@ namespace Silex
         _CleanupLightingBuffer();
         _CleanupEnvironmentBuffer();
         _CleanupBloomBuffer();
+        _CleanupIndirectDraw();
+        _CleanupOcclusionCulling();
+
+        renderGraph->Finalize();
+        sldelete(renderGraph);
 
         sldelete(shadow);
         sldelete(gbuffer);
         sldelete(lighting);
         sldelete(environment);
         sldelete(bloom);
+        sldelete(indirect);
+        sldelete(culling);
+        sldelete(occlusion);
 
-        Renderer::Get()->DestroyBuffer(gridUBO);
-        Renderer::Get()->DestroyBuffer(pixelIDBuffer);
+        _CleanupEntityPick();
+        sldelete(picking);
 
-        Renderer::Get()->DestroyTexture(defaultTexture);
-        Renderer::Get()->DestroyTexture(compositeTexture);
+        _CleanupSecondaryCommands();
+        sldelete(secondary);
 
+        Renderer::Get()->DestroyBuffer(instanceSBO);
+        _CleanupMaterialTable();
+
+        Renderer::Get()->DestroyTexture(defaultTexture);
         Renderer::Get()->DestroyTextureView(defaultTextureView);
-        Renderer::Get()->DestroyTextureView(compositeTextureView);
         api->DestroyShader(gridShader);
         api->DestroyShader(compositeShader);
 
@@ -316,21 +414,17 @@ namespace Silex
         Renderer::Get()->DestroyDescriptorSet(compositeSet);
         Renderer::Get()->DestroyDescriptorSet(imageSet);
 
-        api->DestroyPipeline(gridPipeline);
-        api->DestroyPipeline(compositePipeline);
+        PipelineCompiler::Destroy(gridPipeline);
+        PipelineCompiler::Destroy(compositePipeline);
         api->DestroyRenderPass(compositePass);
-        api->DestroyFramebuffer(compositeFB);
         Renderer::Get()->DestroySampler(linearSampler);
         Renderer::Get()->DestroySampler(shadowSampler);
     }
 
     void SceneRenderer::_PrepareIBL(const char* environmentTexturePath)
     {
-        TextureReader reader;
-        byte* pixels;
-
-        pixels = reader.Read(environmentTexturePath);
-        envTexture     = Renderer::Get()->CreateTextureFromMemory(pixels, reader.data.byteSize, reader.data.width, reader.data.height, true);
+        // HDR の環境マップは BC6H、LDR は BC1 / BC7 でクックされる
+        envTexture     = TextureCooker::Load(environmentTexturePath);
         envTextureView = Renderer::Get()->CreateTextureView(envTexture, TEXTURE_TYPE_2D, TEXTURE_ASPECT_COLOR_BIT);
 
         // 環境マップ変換 レンダーパス
@@ -379,7 +473,7 @@ namespace Silex
 
         PipelineStateInfoBuilder builder;
         PipelineStateInfo pipelineInfo = builder
-            .InputLayout(1, &defaultLayout)
+            .InputLayout(1, &vertexLayouts[0])
             .Rasterizer(POLYGON_CULL_BACK, POLYGON_FRONT_FACE_CLOCKWISE)
             .Depth(false, false)
             .Blend(false, 1)
@@ -431,7 +525,7 @@ namespace Silex
             api->Cmd_BeginRenderPass(cmd, IBLProcessPass, IBLProcessFB, 1, &view);
             api->Cmd_BindPipeline(cmd, equirectangularPipeline);
             api->Cmd_BindDescriptorSet(cmd, equirectangularSet->GetHandle(Renderer::Get()->GetCurrentFrameIndex()), 0);
-            api->Cmd_BindVertexBuffer(cmd, ms->GetVertexBuffer()->GetHandle(), 0);
+            api->Cmd_BindVertexBuffer(cmd, ms->GetPositionBuffer()->GetHandle(), 0);
             api->Cmd_BindIndexBuffer(cmd, ms->GetIndexBuffer()->GetHandle(), INDEX_BUFFER_FORMAT_UINT32, 0);
             api->Cmd_DrawIndexed(cmd, ms->GetIndexCount(), 1, 0, 0, 0);
             api->Cmd_EndRenderPass(cmd);
@@ -471,7 +565,7 @@ namespace Silex
 
         PipelineStateInfoBuilder builder;
         PipelineStateInfo pipelineInfo = builder
-            .InputLayout(1, &defaultLayout)
+            .InputLayout(1, &vertexLayouts[0])
             .Rasterizer(POLYGON_CULL_BACK, POLYGON_FRONT_FACE_CLOCKWISE)
             .Depth(false, false)
             .Blend(false, 1)
@@ -506,7 +600,7 @@ namespace Silex
             api->Cmd_BeginRenderPass(cmd, IBLProcessPass, IBLProcessFB, 1, &view);
             api->Cmd_BindPipeline(cmd, irradiancePipeline);
             api->Cmd_BindDescriptorSet(cmd, irradianceSet->GetHandle(Renderer::Get()->GetCurrentFrameIndex()), 0);
-            api->Cmd_BindVertexBuffer(cmd, ms->GetVertexBuffer()->GetHandle(), 0);
+            api->Cmd_BindVertexBuffer(cmd, ms->GetPositionBuffer()->GetHandle(), 0);
             api->Cmd_BindIndexBuffer(cmd, ms->GetIndexBuffer()->GetHandle(), INDEX_BUFFER_FORMAT_UINT32, 0);
             api->Cmd_DrawIndexed(cmd, ms->GetIndexCount(), 1, 0, 0, 0);
             api->Cmd_EndRenderPass(cmd);
@@ -526,7 +620,7 @@ namespace Silex
 
         PipelineStateInfoBuilder builder;
         PipelineStateInfo pipelineInfo = builder
-            .InputLayout(1, &defaultLayout)
+            .InputLayout(1, &vertexLayouts[0])
             .Rasterizer(POLYGON_CULL_BACK, POLYGON_FRONT_FACE_CLOCKWISE)
             .Depth(false, false)
             .Blend(false, 1)
@@ -565,7 +659,7 @@ namespace Silex
         Renderer::Get()->ImmidiateExcute([&](CommandBufferHandle* cmd)
         {
             MeshSource* ms = cubeMesh->GetMeshSource();
-            api->Cmd_BindVertexBuffer(cmd, ms->GetVertexBuffer()->GetHandle(), 0);
+            api->Cmd_BindVertexBuffer(cmd, ms->GetPositionBuffer()->GetHandle(), 0);
             api->Cmd_BindIndexBuffer(cmd, ms->GetIndexBuffer()->GetHandle(), INDEX_BUFFER_FORMAT_UINT32, 0);
 
             for (uint32 i = 0; i < prefilterMipCount; i++)
@@ -682,14 +776,10 @@ namespace Silex
         shadow->depthView   = Renderer::Get()->CreateTextureView(shadow->depth, TEXTURE_TYPE_2D_ARRAY, TEXTURE_ASPECT_DEPTH_BIT);
         shadow->framebuffer = Renderer::Get()->CreateFramebuffer(shadow->pass, 1, &hdepth, shadowMapResolution, shadowMapResolution);
 
-        shadow->transformUBO      = Renderer::Get()->CreateUniformBuffer(nullptr, sizeof(UBO::ShadowTransformData));
-        shadow->lightTransformUBO = Renderer::Get()->CreateUniformBuffer(nullptr, sizeof(UBO::LightSpaceTransformData));
-        shadow->cascadeUBO        = Renderer::Get()->CreateUniformBuffer(nullptr, sizeof(UBO::CascadeData));
-
         // パイプライン
         PipelineStateInfoBuilder builder;
         PipelineStateInfo pipelineInfo = builder
-            .InputLayout(1, &defaultLayout)
+            .InputLayout(1, &vertexLayouts[0])
             .Depth(true, true)
             .RasterizerDepthBias(true, 1.0, 2.0)
             .Blend(false, 1)
@@ -698,26 +788,23 @@ namespace Silex
         ShaderCompiledData compiledData;
         ShaderCompiler::Get()->Compile("Assets/Shaders/DirectionalLight.glsl", compiledData);
         shadow->shader   = api->CreateShader(compiledData);
-        shadow->pipeline = api->CreateGraphicsPipeline(shadow->shader, &pipelineInfo, shadow->pass);
+        shadow->pipeline = PipelineCompiler::CompileGraphics(shadow->shader, pipelineInfo, shadow->pass);
 
         // デスクリプター
         shadow->set = Renderer::Get()->CreateDescriptorSet(shadow->shader, 0);
-        shadow->set->SetResource(0, shadow->transformUBO);
-        shadow->set->SetResource(1, shadow->lightTransformUBO);
+        shadow->set->SetResource(0, instanceSBO);
+        shadow->set->SetResource(1, Renderer::Get()->GetDynamicUniformBuffer(), sizeof(UBO::LightSpaceTransformData));
         shadow->set->Flush();
     }
 
     void SceneRenderer::_CleanupShadowBuffer()
     {
-        Renderer::Get()->DestroyBuffer(shadow->transformUBO);
-        Renderer::Get()->DestroyBuffer(shadow->lightTransformUBO);
-        Renderer::Get()->DestroyBuffer(shadow->cascadeUBO);
         Renderer::Get()->DestroyTexture(shadow->depth);
 
         Renderer::Get()->DestroyTextureView(shadow->depthView);
 
         api->DestroyShader(shadow->shader);
-        api->DestroyPipeline(shadow->pipeline);
+        PipelineCompiler::Destroy(shadow->pipeline);
         Renderer::Get()->DestroyDescriptorSet(shadow->set);
         api->DestroyRenderPass(shadow->pass);
         api->DestroyFramebuffer(shadow->framebuffer);
@@ -884,7 +971,7 @@ namespace Silex
 
             subpass.colorReferences.push_back(idRef);
             attachments[3] = id;
-            clearvalues[3].SetInt(10, 0, 0, 1);
+            clearvalues[3].SetInt(-1, 0, 0, 1); // エンティティなし
 
             // 深度
             Attachment depth = {};
@@ -904,6 +991,16 @@ namespace Silex
             clearvalues[4].SetDepthStencil(1.0f, 0);
 
             gbuffer->pass = api->CreateRenderPass(std::size(attachments), attachments, 1, &subpass, 0, nullptr, std::size(clearvalues), clearvalues);
+
+            // 追加描画用 (クリアせずに読み込む / 開始前にバリアでアタッチメント用のレイアウトに遷移しておく)
+            for (Attachment& attachment : attachments)
+            {
+                const bool isDepth = attachment.format == RENDERING_FORMAT_D32_SFLOAT;
+                attachment.loadOp        = ATTACHMENT_LOAD_OP_LOAD;
+                attachment.initialLayout = isDepth? TEXTURE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL : TEXTURE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+            }
+
+            gbuffer->loadPass = api->CreateRenderPass(std::size(attachments), attachments, 1, &subpass, 0, nullptr, std::size(clearvalues), clearvalues);
         }
 
         {
@@ -922,7 +1019,7 @@ namespace Silex
             // Gバッファ―
             PipelineStateInfoBuilder builder;
             PipelineStateInfo pipelineInfo = builder
-                .InputLayout(1, &defaultLayout)
+                .InputLayout(std::size(vertexLayouts), vertexLayouts)
                 .Depth(true, true, COMPARE_OP_LESS)
                 .Blend(false, 4)
                 .Value();
@@ -930,23 +1027,16 @@ namespace Silex
             ShaderCompiledData compiledData;
             ShaderCompiler::Get()->Compile("Assets/Shaders/DeferredPrimitive.glsl", compiledData);
             gbuffer->shader   = api->CreateShader(compiledData);
-            gbuffer->pipeline = api->CreateGraphicsPipeline(gbuffer->shader, &pipelineInfo, gbuffer->pass);
+            gbuffer->pipeline = PipelineCompiler::CompileGraphics(gbuffer->shader, pipelineInfo, gbuffer->pass);
         }
 
-        // ユニフォームバッファ
-        gbuffer->transformUBO = Renderer::Get()->CreateUniformBuffer(nullptr, sizeof(UBO::Transform));
-        gbuffer->materialUBO  = Renderer::Get()->CreateUniformBuffer(nullptr, sizeof(UBO::MaterialUBO));
-
         // トランスフォーム
         gbuffer->transformSet = Renderer::Get()->CreateDescriptorSet(gbuffer->shader, 0);
-        gbuffer->transformSet->SetResource(0, gbuffer->transformUBO);
+        gbuffer->transformSet->SetResource(0, Renderer::Get()->GetDynamicUniformBuffer(), sizeof(UBO::Transform));
+        gbuffer->transformSet->SetResource(1, instanceSBO);
         gbuffer->transformSet->Flush();
 
-        // マテリアル
-        gbuffer->materialSet = Renderer::Get()->CreateDescriptorSet(gbuffer->shader, 1);
-        gbuffer->materialSet->SetResource(0, gbuffer->materialUBO);
-        gbuffer->materialSet->SetResource(1, defaultTextureView, linearSampler);
-        gbuffer->materialSet->Flush();
+        // マテリアルはバインドレスセットを使用するので、セットの生成は不要
     }
 
     void SceneRenderer::_PrepareLightingBuffer(uint32 width, uint32 height)
@@ -990,8 +1080,7 @@ namespace Silex
         ShaderCompiledData compiledData;
         ShaderCompiler::Get()->Compile("Assets/Shaders/DeferredLighting.glsl", compiledData);
         lighting->shader   = api->CreateShader(compiledData);
-        lighting->pipeline = api->CreateGraphicsPipeline(lighting->shader, &pipelineInfo, lighting->pass);
-        lighting->sceneUBO = Renderer::Get()->CreateUniformBuffer(nullptr, sizeof(UBO::SceneUBO));
+        lighting->pipeline = PipelineCompiler::CompileGraphics(lighting->shader, pipelineInfo, lighting->pass);
 
         // セット
         lighting->set = Renderer::Get()->CreateDescriptorSet(lighting->shader, 0);
@@ -1003,9 +1092,9 @@ namespace Silex
         lighting->set->SetResource( 5, prefilterTextureView, linearSampler);
         lighting->set->SetResource( 6, brdflutTextureView, linearSampler);
         lighting->set->SetResource( 7, shadow->depthView, shadowSampler);
-        lighting->set->SetResource( 8, lighting->sceneUBO);
-        lighting->set->SetResource( 9, shadow->cascadeUBO);
-        lighting->set->SetResource(10, shadow->lightTransformUBO);
+        lighting->set->SetResource( 8, Renderer::Get()->GetDynamicUniformBuffer(), sizeof(UBO::SceneUBO));
+        lighting->set->SetResource( 9, Renderer::Get()->GetDynamicUniformBuffer(), sizeof(UBO::CascadeData));
+        lighting->set->SetResource(10, Renderer::Get()->GetDynamicUniformBuffer(), sizeof(UBO::LightSpaceTransformData));
         lighting->set->Flush();
     }
 
@@ -1054,7 +1143,7 @@ namespace Silex
         {
             PipelineStateInfoBuilder builder;
             PipelineStateInfo pipelineInfo = builder
-                .InputLayout(1, &defaultLayout)
+                .InputLayout(1, &vertexLayouts[0])
                 .Rasterizer(POLYGON_CULL_BACK, POLYGON_FRONT_FACE_CLOCKWISE)
                 .Depth(true, false, COMPARE_OP_LESS_OR_EQUAL)
                 .Blend(false, 1)
@@ -1063,11 +1152,10 @@ namespace Silex
             ShaderCompiledData compiledData;
             ShaderCompiler::Get()->Compile("Assets/Shaders/Environment.glsl", compiledData);
             environment->shader   = api->CreateShader(compiledData);
-            environment->pipeline = api->CreateGraphicsPipeline(environment->shader, &pipelineInfo, environment->pass);
-            environment->ubo      = Renderer::Get()->CreateUniformBuffer(nullptr, sizeof(UBO::EnvironmentUBO));
+            environment->pipeline = PipelineCompiler::CompileGraphics(environment->shader, pipelineInfo, environment->pass);
 
             environment->set = Renderer::Get()->CreateDescriptorSet(environment->shader, 0);
-            environment->set->SetResource(0, environment->ubo);
+            environment->set->SetResource(0, Renderer::Get()->GetDynamicUniformBuffer(), sizeof(UBO::EnvironmentUBO));
             environment->set->SetResource(1, cubemapTextureView, linearSampler);
             environment->set->Flush();
         }
@@ -1109,8 +1197,9 @@ namespace Silex
     void SceneRenderer::_CleanupGBuffer()
     {
         api->DestroyShader(gbuffer->shader);
-        api->DestroyPipeline(gbuffer->pipeline);
+        PipelineCompiler::Destroy(gbuffer->pipeline);
         api->DestroyRenderPass(gbuffer->pass);
+        api->DestroyRenderPass(gbuffer->loadPass);
         api->DestroyFramebuffer(gbuffer->framebuffer);
 
         Renderer::Get()->DestroyTexture(gbuffer->albedo);
@@ -1126,34 +1215,28 @@ namespace Silex
         Renderer::Get()->DestroyTextureView(gbuffer->depthView);
 
         Renderer::Get()->DestroyDescriptorSet(gbuffer->transformSet);
-        Renderer::Get()->DestroyDescriptorSet(gbuffer->materialSet);
-
-        Renderer::Get()->DestroyBuffer(gbuffer->materialUBO);
-        Renderer::Get()->DestroyBuffer(gbuffer->transformUBO);
     }
 
     void SceneRenderer::_CleanupLightingBuffer()
     {
         api->DestroyShader(lighting->shader);
-        api->DestroyPipeline(lighting->pipeline);
+        PipelineCompiler::Destroy(lighting->pipeline);
         api->DestroyRenderPass(lighting->pass);
         api->DestroyFramebuffer(lighting->framebuffer);
 
         Renderer::Get()->DestroyTextureView(lighting->view);
         Renderer::Get()->DestroyTexture(lighting->color);
         Renderer::Get()->DestroyDescriptorSet(lighting->set);
-        Renderer::Get()->DestroyBuffer(lighting->sceneUBO);
     }
 
     void SceneRenderer::_CleanupEnvironmentBuffer()
     {
         api->DestroyShader(environment->shader);
-        api->DestroyPipeline(environment->pipeline);
+        PipelineCompiler::Destroy(environment->pipeline);
         api->DestroyRenderPass(environment->pass);
         api->DestroyFramebuffer(environment->framebuffer);
 
         Renderer::Get()->DestroyDescriptorSet(environment->set);
-        Renderer::Get()->DestroyBuffer(environment->ubo);
     }
 
     void SceneRenderer::_ResizeGBuffer(uint32 width, uint32 height)
@@ -1217,9 +1300,9 @@ namespace Silex
         lighting->set->SetResource( 5, prefilterTextureView, linearSampler);
         lighting->set->SetResource( 6, brdflutTextureView, linearSampler);
         lighting->set->SetResource( 7, shadow->depthView, shadowSampler);
-        lighting->set->SetResource( 8, lighting->sceneUBO);
-        lighting->set->SetResource( 9, shadow->cascadeUBO);
-        lighting->set->SetResource(10, shadow->lightTransformUBO);
+        lighting->set->SetResource( 8, Renderer::Get()->GetDynamicUniformBuffer(), sizeof(UBO::SceneUBO));
+        lighting->set->SetResource( 9, Renderer::Get()->GetDynamicUniformBuffer(), sizeof(UBO::CascadeData));
+        lighting->set->SetResource(10, Renderer::Get()->GetDynamicUniformBuffer(), sizeof(UBO::LightSpaceTransformData));
         lighting->set->Flush();
     }
 
@@ -1244,13 +1327,13 @@ namespace Silex
         return miplevels;
     }
 
-    void SceneRenderer::_PrepareBloomBuffer(uint32 width, uint32 height)
+    void SceneRenderer::_PrepareBloomBuffer()
     {
         {
             Attachment color = {};
-            color.initialLayout = TEXTURE_LAYOUT_UNDEFINED;
+            color.initialLayout = TEXTURE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
             color.loadOp = ATTACHMENT_LOAD_OP_CLEAR;
-            color.finalLayout = TEXTURE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            color.finalLayout = TEXTURE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
             color.storeOp = ATTACHMENT_STORE_OP_STORE;
             color.samples = TEXTURE_SAMPLES_1;
             color.format = RENDERING_FORMAT_R16G16B16A16_SFLOAT;
@@ -1262,51 +1345,13 @@ namespace Silex
             Subpass subpass = {};
             subpass.colorReferences.push_back(colorRef);
 
-            SubpassDependency dep = {};
-            dep.srcSubpass = RENDER_AUTO_ID;
-            dep.dstSubpass = 0;
-            dep.srcStages = PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-            dep.dstStages = PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-            dep.srcAccess = BARRIER_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-            dep.dstAccess = BARRIER_ACCESS_SHADER_READ_BIT;
-
             RenderPassClearValue clear;
             clear.SetFloat(0, 0, 0, 1);
 
-            // レンダーパス
-            bloom->pass = api->CreateRenderPass(1, &color, 1, &subpass, 1, &dep, 1, &clear);
+            // パイプライン生成用 レンダーパス (描画時はレンダーグラフが生成したレンダーパスを使用する)
+            bloom->pass = api->CreateRenderPass(1, &color, 1, &subpass, 0, nullptr, 1, &clear);
         }
 
-        bloom->resolutions.clear();
-        bloom->resolutions = _CalculateBlomSampling(width, height);
-        bloom->sampling.resize(bloom->resolutions.size());
-        bloom->samplingView.resize(bloom->resolutions.size());
-        bloom->samplingFB.resize(bloom->resolutions.size());
-        bloom->downSamplingSet.resize(bloom->resolutions.size());
-        bloom->upSamplingSet.resize(bloom->resolutions.size() - 1);
-
-        // サンプリングイメージ
-        for (uint32 i = 0; i < bloom->resolutions.size(); i++)
-        {
-            const Extent extent = bloom->resolutions[i];
-            bloom->sampling[i]  = Renderer::Get()->CreateTexture2D(RENDERING_FORMAT_R16G16B16A16_SFLOAT, extent.width, extent.height);
-
-            auto hsampling = bloom->sampling[i]->GetHandle();
-            bloom->samplingView[i] = Renderer::Get()->CreateTextureView(bloom->sampling[i], TEXTURE_TYPE_2D, TEXTURE_ASPECT_COLOR_BIT);
-            bloom->samplingFB[i]   = Renderer::Get()->CreateFramebuffer(bloom->pass, 1, &hsampling, extent.width, extent.height);
-        }
-
-        // ブルーム プリフィルター/ブレンド イメージ
-        bloom->prefilter     = Renderer::Get()->CreateTexture2D(RENDERING_FORMAT_R16G16B16A16_SFLOAT, width, height);
-        bloom->prefilterView = Renderer::Get()->CreateTextureView(bloom->prefilter, TEXTURE_TYPE_2D, TEXTURE_ASPECT_COLOR_BIT);
-        bloom->bloom         = Renderer::Get()->CreateTexture2D(RENDERING_FORMAT_R16G16B16A16_SFLOAT, width, height);
-        bloom->bloomView     = Renderer::Get()->CreateTextureView(bloom->bloom, TEXTURE_TYPE_2D, TEXTURE_ASPECT_COLOR_BIT);
-
-        // フレームバッファ
-        auto hbloom = bloom->bloom->GetHandle();
-        bloom->bloomFB = Renderer::Get()->CreateFramebuffer(bloom->pass, 1, &hbloom, width, height);
-
-
         // パイプライン
         ShaderCompiledData compiledData;
         PipelineStateInfoBuilder builder;
@@ -1323,304 +1368,490 @@ namespace Silex
 
         ShaderCompiler::Get()->Compile("Assets/Shaders/Bloom.glsl", compiledData);
         bloom->bloomShader   = api->CreateShader(compiledData);
-        bloom->bloomPipeline = api->CreateGraphicsPipeline(bloom->bloomShader, &pipelineInfo, bloom->pass);
+        bloom->bloomPipeline = PipelineCompiler::CompileGraphics(bloom->bloomShader, pipelineInfo, bloom->pass);
 
         ShaderCompiler::Get()->Compile("Assets/Shaders/BloomPrefiltering.glsl", compiledData);
         bloom->prefilterShader   = api->CreateShader(compiledData);
-        bloom->prefilterPipeline = api->CreateGraphicsPipeline(bloom->prefilterShader, &pipelineInfo, bloom->pass);
+        bloom->prefilterPipeline = PipelineCompiler::CompileGraphics(bloom->prefilterShader, pipelineInfo, bloom->pass);
 
         ShaderCompiler::Get()->Compile("Assets/Shaders/BloomDownSampling.glsl", compiledData);
         bloom->downSamplingShader   = api->CreateShader(compiledData);
-        bloom->downSamplingPipeline = api->CreateGraphicsPipeline(bloom->downSamplingShader, &pipelineInfo, bloom->pass);
+        bloom->downSamplingPipeline = PipelineCompiler::CompileGraphics(bloom->downSamplingShader, pipelineInfo, bloom->pass);
 
         ShaderCompiler::Get()->Compile("Assets/Shaders/BloomUpSampling.glsl", compiledData);
         bloom->upSamplingShader   = api->CreateShader(compiledData);
-        bloom->upSamplingPipeline = api->CreateGraphicsPipeline(bloom->upSamplingShader, &pipelineInfoUpSampling, bloom->pass);
+        bloom->upSamplingPipeline = PipelineCompiler::CompileGraphics(bloom->upSamplingShader, pipelineInfoUpSampling, bloom->pass);
+    }
 
+    void SceneRenderer::_CleanupBloomBuffer()
+    {
+        _DestroyBloomSets();
 
-        // プリフィルター
-        bloom->prefilterSet = Renderer::Get()->CreateDescriptorSet(bloom->prefilterShader, 0);
-        bloom->prefilterSet->SetResource(0, lighting->view, linearSampler);
-        bloom->prefilterSet->Flush();
+        api->DestroyRenderPass(bloom->pass);
 
-        // ダウンサンプリング (source)  - (target)
-        // prefilter - sample[0]
-        // sample[0] - sample[1]
-        // sample[1] - sample[2]
-        // sample[2] - sample[3]
-        // sample[3] - sample[4]
-        // sample[4] - sample[5]
-        bloom->downSamplingSet[0] = Renderer::Get()->CreateDescriptorSet(bloom->downSamplingShader, 0);
-        bloom->downSamplingSet[0]->SetResource(0, bloom->prefilterView, linearSampler);
-        bloom->downSamplingSet[0]->Flush();
+        api->DestroyShader(bloom->bloomShader);
+        PipelineCompiler::Destroy(bloom->bloomPipeline);
+        api->DestroyShader(bloom->prefilterShader);
+        PipelineCompiler::Destroy(bloom->prefilterPipeline);
+        api->DestroyShader(bloom->downSamplingShader);
+        PipelineCompiler::Destroy(bloom->downSamplingPipeline);
+        api->DestroyShader(bloom->upSamplingShader);
+        PipelineCompiler::Destroy(bloom->upSamplingPipeline);
+    }
+
+    RenderGraphTexture SceneRenderer::_AddBloomPasses(RenderGraphTexture sceneColor, uint32 width, uint32 height)
+    {
+        bloom->resolutions = _CalculateBlomSampling(width, height);
 
-        for (uint32 i = 1; i < bloom->downSamplingSet.size(); i++)
+        // 縮小バッファが取れない解像度ではブルームを行わない
+        if (bloom->resolutions.empty())
         {
-            bloom->downSamplingSet[i] = Renderer::Get()->CreateDescriptorSet(bloom->downSamplingShader, 0);
-            bloom->downSamplingSet[i]->SetResource(0, bloom->samplingView[i - 1], linearSampler);
-            bloom->downSamplingSet[i]->Flush();
+            bloom->downSamplingSource.clear();
+            bloom->upSamplingSource.clear();
+            return sceneColor;
         }
 
-        // アップサンプリング (source)  - (target)
-        // sample[5] - sample[4]
-        // sample[4] - sample[3]
-        // sample[3] - sample[2]
-        // sample[2] - sample[1]
-        // sample[1] - sample[0]
-        uint32 upSamplingIndex = bloom->upSamplingSet.size();
-        for (uint32 i = 0; i < bloom->upSamplingSet.size(); i++)
+        const uint32 numSampling = uint32(bloom->resolutions.size());
+        bloom->downSamplingSource.resize(numSampling);
+        bloom->upSamplingSource.resize(numSampling - 1);
+
+        auto Desc = [](uint32 w, uint32 h) -> RenderGraphTextureDesc
         {
-            bloom->upSamplingSet[i] = Renderer::Get()->CreateDescriptorSet(bloom->upSamplingShader, 0);
-            bloom->upSamplingSet[i]->SetResource(0, bloom->samplingView[upSamplingIndex], linearSampler);
-            bloom->upSamplingSet[i]->Flush();
+            return { RENDERING_FORMAT_R16G16B16A16_SFLOAT, w, h };
+        };
 
-            upSamplingIndex--;
-        }
+        // プリフィルタリング
+        RenderGraphTexture prefilter = renderGraph->CreateTexture("BloomPrefilter", Desc(width, height));
+        bloom->prefilterSource = sceneColor;
 
-        // ブルームコンポジット
-        bloom->bloomSet = Renderer::Get()->CreateDescriptorSet(bloom->bloomShader, 0);
-        bloom->bloomSet->SetResource(0, lighting->view, linearSampler);
-        bloom->bloomSet->SetResource(1, bloom->samplingView[0], linearSampler);
-        bloom->bloomSet->Flush();
-    }
+        renderGraph->AddPass("BloomPrefilter", [this](CommandBufferHandle* commandBuffer)
+        {
+            if (bloom->prefilterPipeline->IsReady())
+            {
+                api->Cmd_BindPipeline(commandBuffer, bloom->prefilterPipeline->Get());
 
-    void SceneRenderer::_ResizeBloomBuffer(uint32 width, uint32 height)
-    {
-        for (uint32 i = 0; i < bloom->resolutions.size(); i++)
+                float threshold = postProcess.bloomThreshold;
+                api->Cmd_PushConstants(commandBuffer, bloom->prefilterShader, &threshold, 1);
+                api->Cmd_BindDescriptorSet(commandBuffer, bloom->prefilterSet->GetHandle(Renderer::Get()->GetCurrentFrameIndex()), 0);
+                api->Cmd_Draw(commandBuffer, 3, 1, 0, 0);
+            }
+        })
+        .Read(sceneColor)
+        .Write(prefilter)
+        .GPUZone(GPUZone::Bloom);
+
+        // ダウンサンプリング (source)  - (target)
+        // prefilter - sample[0]
+        // sample[0] - sample[1]
+        // ...
+        RenderGraphTexture source = prefilter;
+        for (uint32 i = 0; i < numSampling; i++)
         {
-            Renderer::Get()->DestroyTexture(bloom->sampling[i]);
-            Renderer::Get()->DestroyTextureView(bloom->samplingView[i]);
-            Renderer::Get()->DestroyFramebuffer(bloom->samplingFB[i]);
-        }
+            RenderGraphTexture target = renderGraph->CreateTexture("BloomDownSampling", Desc(bloom->resolutions[i].width, bloom->resolutions[i].height));
+            bloom->downSamplingSource[i] = source;
+
+            renderGraph->AddPass("BloomDownSampling", [this, i](CommandBufferHandle* commandBuffer)
+            {
+                if (bloom->downSamplingPipeline->IsReady())
+                {
+                    api->Cmd_BindPipeline(commandBuffer, bloom->downSamplingPipeline->Get());
 
-        Renderer::Get()->DestroyFramebuffer(bloom->bloomFB);
-        Renderer::Get()->DestroyTexture(bloom->prefilter);
-        Renderer::Get()->DestroyTextureView(bloom->prefilterView);
-        Renderer::Get()->DestroyTexture(bloom->bloom);
-        Renderer::Get()->DestroyTextureView(bloom->bloomView);
+                    glm::ivec2 srcResolution = i == 0 ? sceneViewportSize : glm::ivec2(bloom->resolutions[i - 1].width, bloom->resolutions[i - 1].height);
+                    api->Cmd_PushConstants(commandBuffer, bloom->downSamplingShader, &srcResolution[0], sizeof(srcResolution) / sizeof(uint32));
 
-        Renderer::Get()->DestroyDescriptorSet(bloom->prefilterSet);
-        Renderer::Get()->DestroyDescriptorSet(bloom->bloomSet);
+                    api->Cmd_BindDescriptorSet(commandBuffer, bloom->downSamplingSet[i]->GetHandle(Renderer::Get()->GetCurrentFrameIndex()), 0);
+                    api->Cmd_Draw(commandBuffer, 3, 1, 0, 0);
+                }
+            })
+            .Read(source)
+            .Write(target)
+            .GPUZone(GPUZone::Bloom);
 
-        for (uint32 i = 0; i < bloom->upSamplingSet.size(); i++)
-        {
-            Renderer::Get()->DestroyDescriptorSet(bloom->upSamplingSet[i]);
+            source = target;
         }
 
-        for (uint32 i = 0; i < bloom->downSamplingSet.size(); i++)
+        // アップサンプリング (source)  - (target)
+        // sample[5] - sample[4]
+        // sample[4] - sample[3]
+        // ...
+        // 書き込み先は新しいテクスチャとし、寿命の終わったダウンサンプリング結果の物理テクスチャを共有させる
+        for (uint32 i = 0; i < bloom->upSamplingSource.size(); i++)
         {
-            Renderer::Get()->DestroyDescriptorSet(bloom->downSamplingSet[i]);
+            const uint32 level = numSampling - 2 - i;
+
+            RenderGraphTexture target = renderGraph->CreateTexture("BloomUpSampling", Desc(bloom->resolutions[level].width, bloom->resolutions[level].height));
+            bloom->upSamplingSource[i] = source;
+
+            renderGraph->AddPass("BloomUpSampling", [this, i](CommandBufferHandle* commandBuffer)
+            {
+                if (bloom->upSamplingPipeline->IsReady())
+                {
+                    api->Cmd_BindPipeline(commandBuffer, bloom->upSamplingPipeline->Get());
+
+                    float filterRadius = 0.01f;
+                    api->Cmd_PushConstants(commandBuffer, bloom->upSamplingShader, &filterRadius, 1);
+
+                    api->Cmd_BindDescriptorSet(commandBuffer, bloom->upSamplingSet[i]->GetHandle(Renderer::Get()->GetCurrentFrameIndex()), 0);
+                    api->Cmd_Draw(commandBuffer, 3, 1, 0, 0);
+                }
+            })
+            .Read(source)
+            .Write(target)
+            .GPUZone(GPUZone::Bloom);
+
+            source = target;
         }
 
-        bloom->resolutions.clear();
-        bloom->resolutions = _CalculateBlomSampling(width, height);
-        bloom->sampling.resize(bloom->resolutions.size());
-        bloom->samplingView.resize(bloom->resolutions.size());
-        bloom->samplingFB.resize(bloom->resolutions.size());
-        bloom->downSamplingSet.resize(bloom->resolutions.size());
-        bloom->upSamplingSet.resize(bloom->resolutions.size() - 1);
+        // マージ (プリフィルターの物理テクスチャを共有する)
+        RenderGraphTexture result = renderGraph->CreateTexture("Bloom", Desc(width, height));
+        bloom->bloomSource = source;
 
-        // イメージ
-        for (uint32 i = 0; i < bloom->resolutions.size(); i++)
+        renderGraph->AddPass("BloomMerge", [this](CommandBufferHandle* commandBuffer)
         {
-            const Extent extent = bloom->resolutions[i];
-            bloom->sampling[i]  = Renderer::Get()->CreateTexture2D(RENDERING_FORMAT_R16G16B16A16_SFLOAT, extent.width, extent.height);
+            if (bloom->bloomPipeline->IsReady())
+            {
+                api->Cmd_BindPipeline(commandBuffer, bloom->bloomPipeline->Get());
 
-            auto hsample = bloom->sampling[i]->GetHandle();
-            bloom->samplingView[i] = Renderer::Get()->CreateTextureView(bloom->sampling[i], TEXTURE_TYPE_2D, TEXTURE_ASPECT_COLOR_BIT);
-            bloom->samplingFB[i]   = Renderer::Get()->CreateFramebuffer(bloom->pass, 1, &hsample, extent.width, extent.height);
-        }
+                float intencity = postProcess.bloomIntencity;
+                api->Cmd_PushConstants(commandBuffer, bloom->bloomShader, &intencity, 1);
 
-        bloom->prefilter     = Renderer::Get()->CreateTexture2D(RENDERING_FORMAT_R16G16B16A16_SFLOAT, width, height);
-        bloom->prefilterView = Renderer::Get()->CreateTextureView(bloom->prefilter, TEXTURE_TYPE_2D, TEXTURE_ASPECT_COLOR_BIT);
-        bloom->bloom         = Renderer::Get()->CreateTexture2D(RENDERING_FORMAT_R16G16B16A16_SFLOAT, width, height);
+                api->Cmd_BindDescriptorSet(commandBuffer, bloom->bloomSet->GetHandle(Renderer::Get()->GetCurrentFrameIndex()), 0);
+                api->Cmd_Draw(commandBuffer, 3, 1, 0, 0);
+            }
+        })
+        .Read(sceneColor)
+        .Read(source)
+        .Write(result)
+        .GPUZone(GPUZone::Bloom);
 
-        auto hbloom = bloom->bloom->GetHandle();
-        bloom->bloomView = Renderer::Get()->CreateTextureView(bloom->bloom, TEXTURE_TYPE_2D, TEXTURE_ASPECT_COLOR_BIT);
-        bloom->bloomFB   = Renderer::Get()->CreateFramebuffer(bloom->pass, 1, &hbloom, width, height);
+        return result;
+    }
 
-        // プリフィルター
+    void SceneRenderer::_CreateBloomSets()
+    {
         bloom->prefilterSet = Renderer::Get()->CreateDescriptorSet(bloom->prefilterShader, 0);
-        bloom->prefilterSet->SetResource(0, lighting->view, linearSampler);
+        bloom->prefilterSet->SetResource(0, renderGraph->GetView(bloom->prefilterSource), linearSampler);
         bloom->prefilterSet->Flush();
 
-        // ダウンサンプリング (source)  - (target)
-        // prefilter - sample[0]
-        // sample[0] - sample[1]
-        // sample[1] - sample[2]
-        // sample[2] - sample[3]
-        // sample[3] - sample[4]
-        // sample[4] - sample[5]
-        bloom->downSamplingSet[0] = Renderer::Get()->CreateDescriptorSet(bloom->downSamplingShader, 0);
-        bloom->downSamplingSet[0]->SetResource(0, bloom->prefilterView, linearSampler);
-        bloom->downSamplingSet[0]->Flush();
-
-        for (uint32 i = 1; i < bloom->downSamplingSet.size(); i++)
+        bloom->downSamplingSet.resize(bloom->downSamplingSource.size());
+        for (uint32 i = 0; i < bloom->downSamplingSet.size(); i++)
         {
             bloom->downSamplingSet[i] = Renderer::Get()->CreateDescriptorSet(bloom->downSamplingShader, 0);
-            bloom->downSamplingSet[i]->SetResource(0, bloom->samplingView[i - 1], linearSampler);
+            bloom->downSamplingSet[i]->SetResource(0, renderGraph->GetView(bloom->downSamplingSource[i]), linearSampler);
             bloom->downSamplingSet[i]->Flush();
         }
 
-        // アップサンプリング (source)  - (target)
-        // sample[5] - sample[4]
-        // sample[4] - sample[3]
-        // sample[3] - sample[2]
-        // sample[2] - sample[1]
-        // sample[1] - sample[0]
-        uint32 upSamplingIndex = bloom->upSamplingSet.size();
+        bloom->upSamplingSet.resize(bloom->upSamplingSource.size());
         for (uint32 i = 0; i < bloom->upSamplingSet.size(); i++)
         {
             bloom->upSamplingSet[i] = Renderer::Get()->CreateDescriptorSet(bloom->upSamplingShader, 0);
-            bloom->upSamplingSet[i]->SetResource(0, bloom->samplingView[upSamplingIndex], linearSampler);
+            bloom->upSamplingSet[i]->SetResource(0, renderGraph->GetView(bloom->upSamplingSource[i]), linearSampler);
             bloom->upSamplingSet[i]->Flush();
-
-            upSamplingIndex--;
         }
 
         bloom->bloomSet = Renderer::Get()->CreateDescriptorSet(bloom->bloomShader, 0);
-        bloom->bloomSet->SetResource(0, lighting->view, linearSampler);
-        bloom->bloomSet->SetResource(1, bloom->samplingView[0], linearSampler);
+        bloom->bloomSet->SetResource(0, renderGraph->GetView(bloom->prefilterSource), linearSampler);
+        bloom->bloomSet->SetResource(1, renderGraph->GetView(bloom->bloomSource), linearSampler);
         bloom->bloomSet->Flush();
     }
 
-    void SceneRenderer::_CleanupBloomBuffer()
+    void SceneRenderer::_DestroyBloomSets()
     {
-        api->DestroyRenderPass(bloom->pass);
-
-        for (uint32 i = 0; i < bloom->resolutions.size(); i++)
+        for (DescriptorSet* set : bloom->downSamplingSet)
         {
-            api->DestroyFramebuffer(bloom->samplingFB[i]);
-            Renderer::Get()->DestroyTextureView(bloom->samplingView[i]);
-            Renderer::Get()->DestroyTexture(bloom->sampling[i]);
+            Renderer::Get()->DestroyDescriptorSet(set);
         }
 
-        for (uint32 i = 0; i < bloom->upSamplingSet.size(); i++)
+        for (DescriptorSet* set : bloom->upSamplingSet)
         {
-            Renderer::Get()->DestroyDescriptorSet(bloom->upSamplingSet[i]);
+            Renderer::Get()->DestroyDescriptorSet(set);
         }
 
-        for (uint32 i = 0; i < bloom->downSamplingSet.size(); i++)
+        if (bloom->prefilterSet) Renderer::Get()->DestroyDescriptorSet(bloom->prefilterSet);
+        if (bloom->bloomSet)     Renderer::Get()->DestroyDescriptorSet(bloom->bloomSet);
+
+        bloom->downSamplingSet.clear();
+        bloom->upSamplingSet.clear();
+        bloom->prefilterSet = nullptr;
+        bloom->bloomSet     = nullptr;
+    }
+
+    void SceneRenderer::_BuildRenderGraph()
+    {
+        SL_SCOPE_PROFILE("SceneRenderer::BuildRenderGraph");
+
+        const uint32 width  = sceneViewportSize.x;
+        const uint32 height = sceneViewportSize.y;
+
+        _DestroyBloomSets();
+
+        if (compositeSet) Renderer::Get()->DestroyDescriptorSet(compositeSet);
+        if (imageSet)     Renderer::Get()->DestroyDescriptorSet(imageSet);
+
+        renderGraph->Reset();
+
+        // ライティング結果 (スカイパスで描画され、シェーダーリードに移行済み)
+        RenderGraphTextureState lightingState = {};
+        lightingState.layout = TEXTURE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        lightingState.stage  = PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        lightingState.access = BARRIER_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+        RenderGraphTexture sceneColor = renderGraph->ImportTexture("Lighting", lighting->color, lighting->view, RENDERING_FORMAT_R16G16B16A16_SFLOAT, width, height, lightingState);
+
+        // ブルームのパスは常に宣言し、無効時はコンポジットが読み取らないのでカリングされる
+        RenderGraphTexture bloomResult     = _AddBloomPasses(sceneColor, width, height);
+        const bool         enableBloom     = postProcess.enableBloom && !bloom->resolutions.empty();
+        RenderGraphTexture compositeSource = enableBloom? bloomResult : sceneColor;
+
+        // コンポジット (ImGui のビューポートで表示するので、グラフ外に出力する)
+        RenderGraphTexture composite = renderGraph->CreateTexture("Composite", { RENDERING_FORMAT_R8G8B8A8_UNORM, width, height });
+
+        renderGraph->AddPass("Composite", [this](CommandBufferHandle* commandBuffer)
+        {
+            if (compositePipeline->IsReady())
+            {
+                api->Cmd_BindPipeline(commandBuffer, compositePipeline->Get());
+                api->Cmd_BindDescriptorSet(commandBuffer, compositeSet->GetHandle(Renderer::Get()->GetCurrentFrameIndex()), 0);
+                api->Cmd_Draw(commandBuffer, 3, 1, 0, 0);
+            }
+        })
+        .Read(compositeSource)
+        .Write(composite)
+        .GPUZone(GPUZone::Composite);
+
+        RenderGraphTextureState viewportState = {};
+        viewportState.layout = TEXTURE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        viewportState.stage  = PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+        viewportState.access = BARRIER_ACCESS_SHADER_READ_BIT;
+
+        renderGraph->Export(composite, viewportState);
+
+        if (!renderGraph->Compile())
         {
-            Renderer::Get()->DestroyDescriptorSet(bloom->downSamplingSet[i]);
+            SL_LOG_LOCATION_ERROR("レンダーグラフのコンパイルに失敗しました");
         }
 
-        Renderer::Get()->DestroyTexture(bloom->bloom);
-        Renderer::Get()->DestroyTexture(bloom->prefilter);
+        // 割り当てられた物理テクスチャを参照するデスクリプターセット
+        if (enableBloom)
+        {
+            _CreateBloomSets();
+        }
 
-        Renderer::Get()->DestroyTextureView(bloom->bloomView);
-        Renderer::Get()->DestroyTextureView(bloom->prefilterView);
-        api->DestroyFramebuffer(bloom->bloomFB);
+        compositeSet = Renderer::Get()->CreateDescriptorSet(compositeShader, 0);
+        compositeSet->SetResource(0, renderGraph->GetView(compositeSource), linearSampler);
+        compositeSet->Flush();
 
-        api->DestroyShader(bloom->bloomShader);
-        api->DestroyPipeline(bloom->bloomPipeline);
-        api->DestroyShader(bloom->prefilterShader);
-        api->DestroyPipeline(bloom->prefilterPipeline);
-        api->DestroyShader(bloom->downSamplingShader);
-        api->DestroyPipeline(bloom->downSamplingPipeline);
-        api->DestroyShader(bloom->upSamplingShader);
-        api->DestroyPipeline(bloom->upSamplingPipeline);
+        imageSet = Renderer::Get()->CreateDescriptorSet(compositeShader, 0);
+        imageSet->SetResource(0, renderGraph->GetView(composite), linearSampler);
+        imageSet->Flush();
 
-        Renderer::Get()->DestroyDescriptorSet(bloom->bloomSet);
-        Renderer::Get()->DestroyDescriptorSet(bloom->prefilterSet);
+        renderGraphBloom = postProcess.enableBloom;
     }
 
-    int32 SceneRenderer::ReadEntityIDFromPixel(uint32 x, uint32 y)
+    void SceneRenderer::RequestEntityPick(uint32 x, uint32 y, EntityPickCallback&& callback)
     {
-        Renderer::Get()->ImmidiateExcute([&](CommandBufferHandle* cmd)
-        {
-            TextureBarrierInfo info = {};
-            info.texture      = gbuffer->id->GetHandle();
-            info.subresources = {};
-            info.srcAccess    = BARRIER_ACCESS_MEMORY_WRITE_BIT;
-            info.dstAccess    = BARRIER_ACCESS_MEMORY_WRITE_BIT;
-            info.oldLayout    = TEXTURE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-            info.newLayout    = TEXTURE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-            api->Cmd_PipelineBarrier(cmd, PIPELINE_STAGE_ALL_COMMANDS_BIT, PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, nullptr, 0, nullptr, 1, &info);
+        RequestEntityPickRect(x, y, x, y, std::move(callback));
+    }
 
-            BufferTextureCopyRegion region = {};
-            region.bufferOffset = 0;
-            region.textureSubresources = {};
-            region.textureRegionSize   = { 1, 1, 1 };
-            region.textureOffset       = { x, y, 0 };
+    void SceneRenderer::RequestEntityPickRect(uint32 x0, uint32 y0, uint32 x1, uint32 y1, EntityPickCallback&& callback)
+    {
+        // 両端を含む矩形 (ドラッグ方向に依らない)
+        EntityPickRequest& request = picking->pending.emplace_back();
+        request.x        = std::min(x0, x1);
+        request.y        = std::min(y0, y1);
+        request.width    = std::max(x0, x1) - request.x + 1;
+        request.height   = std::max(y0, y1) - request.y + 1;
+        request.callback = std::move(callback);
+    }
 
-            api->Cmd_CopyTextureToBuffer(cmd, gbuffer->id->GetHandle(), TEXTURE_LAYOUT_TRANSFER_SRC_OPTIMAL, pixelIDBuffer->GetHandle(0), 1, &region);
+    void SceneRenderer::_PrepareEntityPick()
+    {
+        const uint32 numFrame = Renderer::Get()->GetFrameCountInFlight();
+        picking->readbackBuffers.resize(numFrame);
+        picking->readbackCapacity.resize(numFrame);
+        picking->inFlight.resize(numFrame);
 
-            info.oldLayout = TEXTURE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-            info.newLayout = TEXTURE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-            api->Cmd_PipelineBarrier(cmd, PIPELINE_STAGE_ALL_COMMANDS_BIT, PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, nullptr, 0, nullptr, 1, &info);
-        });
+        // クリック選択 (1ピクセル) は常に収まり、矩形選択は必要に応じて拡張する
+        for (uint32 i = 0; i < numFrame; i++)
+        {
+            picking->readbackCapacity[i] = DefaultEntityPickReadbackSize;
+            picking->readbackBuffers[i]  = api->CreateBuffer(DefaultEntityPickReadbackSize, BUFFER_USAGE_TRANSFER_DST_BIT, MEMORY_ALLOCATION_TYPE_CPU);
+            api->MapBuffer(picking->readbackBuffers[i]);
+        }
+    }
 
-        int32* outID = (int32*)pixelIDBuffer->GetMappedPointer();
-        return *outID;
+    void SceneRenderer::_CleanupEntityPick()
+    {
+        for (BufferHandle* buffer : picking->readbackBuffers)
+        {
+            api->UnmapBuffer(buffer);
+            Renderer::Get()->DestroyNativeHandle(buffer);
+        }
     }
 
-    void SceneRenderer::ResizeFramebuffer(uint32 width, uint32 height)
+    void SceneRenderer::_RecordEntityPicks(CommandBufferHandle* commandBuffer, uint32 frameIndex)
     {
-        if (width == 0 || height == 0)
+        if (picking->pending.empty())
             return;
 
-        sceneViewportSize = { width, height };
+        std::vector<EntityPickRequest>& requests = picking->inFlight[frameIndex];
+        SL_ASSERT(requests.empty());
 
-        _ResizeGBuffer(width, height);
-        _ResizeLightingBuffer(width, height);
-        _ResizeEnvironmentBuffer(width, height);
-        _ResizeBloomBuffer(width, height);
+        // 要求をフレームバッファ内に制限し、読み戻しバッファ内の配置を決める (範囲外の要求は空の結果を返す)
+        const uint32 width  = sceneViewportSize.x;
+        const uint32 height = sceneViewportSize.y;
 
+        uint64 totalSize = 0;
+        uint32 numRegion = 0;
+        for (EntityPickRequest& request : picking->pending)
         {
-            Renderer::Get()->DestroyFramebuffer(compositeFB);
-            Renderer::Get()->DestroyTexture(compositeTexture);
-            Renderer::Get()->DestroyTextureView(compositeTextureView);
+            if (request.x >= width || request.y >= height)
+            {
+                request.width  = 0;
+                request.height = 0;
+            }
+            else
+            {
+                request.width  = std::min(request.width,  width  - request.x);
+                request.height = std::min(request.height, height - request.y);
+            }
 
-            compositeTexture = Renderer::Get()->CreateTexture2D(RENDERING_FORMAT_R8G8B8A8_UNORM, width, height);
+            request.offset = totalSize;
+            totalSize += (uint64)request.width * request.height * sizeof(int32);
+            numRegion += (request.width > 0)? 1 : 0;
+        }
 
-            auto hcomposite = compositeTexture->GetHandle();
-            compositeTextureView = Renderer::Get()->CreateTextureView(compositeTexture, TEXTURE_TYPE_2D, TEXTURE_ASPECT_COLOR_BIT);
-            compositeFB          = Renderer::Get()->CreateFramebuffer(compositePass, 1, &hcomposite, width, height);
+        // 読み戻し先の拡張 (このフレームインデックスのバッファは GPU の使用が完了している)
+        if (totalSize > picking->readbackCapacity[frameIndex])
+        {
+            BufferHandle*& buffer = picking->readbackBuffers[frameIndex];
+            api->UnmapBuffer(buffer);
+            Renderer::Get()->DestroyNativeHandle(buffer);
 
-            Renderer::Get()->DestroyDescriptorSet(compositeSet);
-            compositeSet = Renderer::Get()->CreateDescriptorSet(compositeShader, 0);
-            compositeSet->SetResource(0, bloom->bloomView, linearSampler);
-            compositeSet->Flush();
+            picking->readbackCapacity[frameIndex] = std::max(totalSize, picking->readbackCapacity[frameIndex] * 2);
+            buffer = api->CreateBuffer(picking->readbackCapacity[frameIndex], BUFFER_USAGE_TRANSFER_DST_BIT, MEMORY_ALLOCATION_TYPE_CPU);
+            api->MapBuffer(buffer);
         }
 
+        if (numRegion > 0)
         {
-            Renderer::Get()->DestroyDescriptorSet(imageSet);
-            imageSet = Renderer::Get()->CreateDescriptorSet(compositeShader, 0);
-            imageSet->SetResource(0, compositeTextureView, linearSampler);
-            imageSet->Flush();
+            // 全要求を 1回のコピーで読み戻す
+            BufferTextureCopyRegion* regions = Renderer::Get()->GetFrameAllocator()->AllocateArray<BufferTextureCopyRegion>(numRegion);
+
+            uint32 regionIndex = 0;
+            for (const EntityPickRequest& request : picking->pending)
+            {
+                if (request.width == 0)
+                    continue;
+
+                BufferTextureCopyRegion& region = regions[regionIndex++];
+                region.bufferOffset        = request.offset;
+                region.textureSubresources = {};
+                region.textureOffset       = { request.x, request.y, 0 };
+                region.textureRegionSize   = { request.width, request.height, 1 };
+            }
+
+            TextureBarrierInfo info = {};
+            info.texture   = gbuffer->id->GetHandle();
+            info.srcAccess = BARRIER_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+            info.dstAccess = BARRIER_ACCESS_TRANSFER_READ_BIT;
+            info.oldLayout = TEXTURE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            info.newLayout = TEXTURE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+
+            const PipelineStageBits attachmentStage = (PipelineStageBits)(PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+            api->Cmd_PipelineBarrier(commandBuffer, attachmentStage, PIPELINE_STAGE_TRANSFER_BIT, 0, nullptr, 0, nullptr, 1, &info);
+
+            api->Cmd_CopyTextureToBuffer(commandBuffer, gbuffer->id->GetHandle(), TEXTURE_LAYOUT_TRANSFER_SRC_OPTIMAL, picking->readbackBuffers[frameIndex], numRegion, regions);
+
+            info.srcAccess = BARRIER_ACCESS_TRANSFER_READ_BIT;
+            info.dstAccess = BARRIER_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | BARRIER_ACCESS_SHADER_READ_BIT;
+            info.oldLayout = TEXTURE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+            info.newLayout = TEXTURE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            api->Cmd_PipelineBarrier(commandBuffer, PIPELINE_STAGE_TRANSFER_BIT, attachmentStage, 0, nullptr, 0, nullptr, 1, &info);
+
+            // フェンス待機後に CPU から読み取る
+            BufferBarrierInfo readback = {};
+            readback.buffer    = picking->readbackBuffers[frameIndex];
+            readback.srcAccess = BARRIER_ACCESS_TRANSFER_WRITE_BIT;
+            readback.dstAccess = BARRIER_ACCESS_HOST_READ_BIT;
+            readback.offset    = 0;
+            readback.size      = totalSize;
+            api->Cmd_PipelineBarrier(commandBuffer, PIPELINE_STAGE_TRANSFER_BIT, PIPELINE_STAGE_HOST_BIT, 0, nullptr, 1, &readback, 0, nullptr);
         }
+
+        requests.swap(picking->pending);
+        picking->pending.clear();
     }
 
-    void SceneRenderer::_UpdateUniformBuffer()
+    void SceneRenderer::_ResolveEntityPicks(uint32 frameIndex)
     {
-        Camera* camera = sceneCamera;
+        std::vector<EntityPickRequest>& requests = picking->inFlight[frameIndex];
+        if (requests.empty())
+            return;
+
+        const uint8* mapped = (const uint8*)Renderer::Get()->GetMappedPointer(picking->readbackBuffers[frameIndex]);
 
+        std::vector<int32> entityIDs;
+        for (EntityPickRequest& request : requests)
         {
-            UBO::ShadowTransformData shadowData;
-            shadowData.world = glm::mat4(1.0);
+            // 矩形内の ID を重複なしで集める (同じエンティティは隣接するピクセルに連続しやすいので、直前の値で先に弾く)
+            const int32* ids   = (const int32*)(mapped + request.offset);
+            const uint64 count = (uint64)request.width * request.height;
+
+            entityIDs.clear();
+
+            int32 prev = -1;
+            for (uint64 i = 0; i < count; i++)
+            {
+                if (ids[i] >= 0 && ids[i] != prev)
+                {
+                    entityIDs.push_back(ids[i]);
+                }
+
+                prev = ids[i];
+            }
+
+            std::sort(entityIDs.begin(), entityIDs.end());
+            entityIDs.erase(std::unique(entityIDs.begin(), entityIDs.end()), entityIDs.end());
 
-            shadow->transformUBO->SetData(&shadowData, sizeof(UBO::ShadowTransformData));
+            if (request.callback)
+            {
+                request.callback(entityIDs);
+            }
         }
 
+        requests.clear();
+    }
+
+    void SceneRenderer::ResizeFramebuffer(uint32 width, uint32 height)
+    {
+        if (width == 0 || height == 0)
+            return;
+
+        sceneViewportSize = { width, height };
+
+        _ResizeGBuffer(width, height);
+        _ResizeOcclusionCulling(width, height);
+        _ResizeLightingBuffer(width, height);
+        _ResizeEnvironmentBuffer(width, height);
+
+        // ブルーム・コンポジットのテクスチャは 次の描画でレンダーグラフごと再構築する
+        renderGraph->Invalidate();
+    }
+
+    bool SceneRenderer::_UpdateUniformBuffer()
+    {
+        // フレーム毎のリングバッファに書き込み、描画時にそのオフセットを動的オフセットとして渡す
+        // (以前のフレームが参照している領域は上書きされないので、デスクリプターの更新・同期は不要)
+        DynamicUniformBuffer* ubo = Renderer::Get()->GetDynamicUniformBuffer();
+        Camera* camera = sceneCamera;
+
         {
             UBO::Transform sceneData;
             sceneData.projection = camera->GetProjectionMatrix();
             sceneData.view       = camera->GetViewMatrix();
-            sceneData.world      = glm::mat4(1.0);
-
-            gbuffer->transformUBO->SetData(&sceneData, sizeof(UBO::Transform));
-        }
 
-        {
-            UBO::MaterialUBO matData = {};
-            matData.albedo        = glm::vec3(1.0);
-            matData.emission      = glm::vec3(0.0);
-            matData.metallic      = 0.0f;
-            matData.roughness     = 0.5f;
-            matData.textureTiling = glm::vec2(1.0, 1.0);
-
-            gbuffer->materialUBO->SetData(&matData, sizeof(UBO::MaterialUBO));
+            gbuffer->transformOffset = ubo->Allocate(&sceneData, sizeof(UBO::Transform));
         }
 
         {
@@ -1629,22 +1860,19 @@ namespace Silex
             gridData.view       = camera->GetViewMatrix();
             gridData.pos        = glm::vec4(camera->GetPosition(), camera->GetFarPlane());
 
-            gridUBO->SetData(&gridData, sizeof(UBO::GridData));
+            gridOffset = ubo->Allocate(&gridData, sizeof(UBO::GridData));
         }
 
         {
-            // ライト
-            glm::vec3 sceneLightDir = { 0.5, 0.7, 0.1 };
-
-            std::array<glm::mat4, 4> outLightMatrices;
-            _CalculateLightSapceMatrices(sceneLightDir, camera, outLightMatrices);
+            // ライト (カスケード行列はカリング時に計算済み)
+            glm::vec3 sceneLightDir = SceneLightDirection;
 
             UBO::LightSpaceTransformData lightData = {};
-            lightData.cascade[0] = outLightMatrices[0];
-            lightData.cascade[1] = outLightMatrices[1];
-            lightData.cascade[2] = outLightMatrices[2];
-            lightData.cascade[3] = outLightMatrices[3];
-            shadow->lightTransformUBO->SetData(&lightData, sizeof(UBO::LightSpaceTransformData));
+            lightData.cascade[0] = lightSpaceMatrices[0];
+            lightData.cascade[1] = lightSpaceMatrices[1];
+            lightData.cascade[2] = lightSpaceMatrices[2];
+            lightData.cascade[3] = lightSpaceMatrices[3];
+            shadow->lightTransformOffset = ubo->Allocate(&lightData, sizeof(UBO::LightSpaceTransformData));
 
             UBO::SceneUBO sceneUBO = {};
             sceneUBO.lightColor        = glm::vec4(1.0, 1.0, 1.0, 1.0);
@@ -1652,22 +1880,35 @@ namespace Silex
             sceneUBO.cameraPosition    = glm::vec4(camera->GetPosition(), camera->GetFarPlane());
             sceneUBO.view              = camera->GetViewMatrix();
             sceneUBO.invViewProjection = glm::inverse(camera->GetProjectionMatrix() * camera->GetViewMatrix());
-            lighting->sceneUBO->SetData(&sceneUBO, sizeof(UBO::SceneUBO));
+            lighting->sceneOffset = ubo->Allocate(&sceneUBO, sizeof(UBO::SceneUBO));
 
             UBO::CascadeData cascadeData;
             cascadeData.cascadePlaneDistances[0].x = shadowCascadeLevels[0];
             cascadeData.cascadePlaneDistances[1].x = shadowCascadeLevels[1];
             cascadeData.cascadePlaneDistances[2].x = shadowCascadeLevels[2];
             cascadeData.cascadePlaneDistances[3].x = shadowCascadeLevels[3];
-            shadow->cascadeUBO->SetData(&cascadeData, sizeof(UBO::CascadeData));
+            shadow->cascadeOffset = ubo->Allocate(&cascadeData, sizeof(UBO::CascadeData));
         }
 
         {
             UBO::EnvironmentUBO environmentUBO = {};
             environmentUBO.view       = camera->GetViewMatrix();
             environmentUBO.projection = camera->GetProjectionMatrix();
-            environment->ubo->SetData(&environmentUBO, sizeof(UBO::EnvironmentUBO));
+            environment->uboOffset = ubo->Allocate(&environmentUBO, sizeof(UBO::EnvironmentUBO));
         }
+
+        // 容量不足の場合は無効なオフセットが返るので、そのままバインドしないように呼び出し側に伝える
+        const uint32 offsets[] =
+        {
+            gbuffer->transformOffset,
+            gridOffset,
+            shadow->lightTransformOffset,
+            lighting->sceneOffset,
+            shadow->cascadeOffset,
+            environment->uboOffset,
+        };
+
+        return std::none_of(std::begin(offsets), std::end(offsets), [](uint32 offset) { return offset == RENDER_INVALID_ID; });
     }
 
     void SceneRenderer::Reset(Scene* scene, Camera* camera)
@@ -1680,6 +1921,16 @@ namespace Silex
         stats.numRenderMesh       = 0;
         stats.numGeometryDrawCall = 0;
         stats.numShadowDrawCall   = 0;
+        stats.numVisibleGeometry  = 0;
+        stats.numCulledGeometry   = 0;
+        stats.numVisibleShadow    = 0;
+        stats.numCulledShadow     = 0;
+        stats.numOcclusionEarly   = 0;
+        stats.numOcclusionLate    = 0;
+        stats.numOcclusionCulled  = 0;
+        stats.cpuRecordTime       = 0.0f;
+        stats.numRecordDraw       = 0;
+        stats.numSecondaryBuffer  = 0;
 
         // ステートをリセット
         shouldRenderShadow = false;
@@ -1693,261 +1944,1259 @@ namespace Silex
         directionalLight   = {};
 
         // 描画リストリセット
-        meshDrawList.clear();
+        // 前フレームのメモリはフレームアロケータごと破棄されるので、現在フレームのアロケータで再構築する
+        // 容量は前フレームの要素数を目安に予約し、伸長による再確保を避ける
+        const uint64 prevDrawCount = meshDrawList.size();
+        meshDrawList = LinearVector<MeshDrawData>(Renderer::Get()->GetFrameAllocator());
+        meshDrawList.reserve(prevDrawCount);
 
         // シャドウインスタンスデータクリア
-        //shadowDrawData.clear();
-        //ShadowParameterData.clear();
+        shadowBatches = LinearVector<InstanceBatch>(Renderer::Get()->GetFrameAllocator());
 
         // メッシュインスタンスデータクリア
-        //meshDrawData.clear();
-        //meshParameterData.clear();
+        geometryBatches = LinearVector<InstanceBatch>(Renderer::Get()->GetFrameAllocator());
     }
 
     void SceneRenderer::Render()
     {
-        _UpdateUniformBuffer();
-        _ExcutePasses();
+        // このフレームインデックスで前回記録した読み取りは BeginFrame のフェンス待機で完了している
+        _ResolveEntityPicks(Renderer::Get()->GetCurrentFrameIndex());
+
+        _CullSceneObjects();
+        _BuildInstanceBatches();
+
+        if (!_UpdateUniformBuffer()) SL_UNLIKELY
+        {
+            // UBO を確保できないフレームはシーンを描画しない (表示は前回の描画結果のまま)
+            // コマンドバッファはフレーム終了時に送信されるので、記録の開始だけ行っておく
+            api->BeginCommandBuffer(Renderer::Get()->GetFrameData().commandBuffer);
+            return;
+        }
+
+        _ExcutePasses();
+
+        DrawModeStats& mode = drawModeStats[useIndirectDraw];
+        mode.numFrame++;
+        mode.numDrawCall += stats.numGeometryDrawCall + stats.numShadowDrawCall;
+        mode.recordTime  += stats.cpuRecordTime;
     }
 
-    void SceneRenderer::_ExcutePasses()
+    void SceneRenderer::SetIndirectDrawEnabled(bool enable)
     {
-        const FrameData& frame   = Renderer::Get()->GetFrameData();
-        const uint32 frameIndex  = Renderer::Get()->GetCurrentFrameIndex();
-        const auto& viewportSize = sceneViewportSize;
+        if (useIndirectDraw == enable)
+            return;
 
-        // コマンドバッファ開始
-        api->BeginCommandBuffer(frame.commandBuffer);
+        // 切り替え前の方式の計測結果を出力し、切り替え後の方式は計測し直す
+        const DrawModeStats& prev = drawModeStats[useIndirectDraw];
+        SL_LOG_INFO("描画方式 [{}]: {} フレーム, 平均 {:.1f} 描画コール, 記録 {:.3f} ms",
+            useIndirectDraw? "間接描画" : "メッシュソース毎", prev.numFrame, prev.GetAverageDrawCall(), prev.GetAverageRecordTime());
 
-        //===================================================================================================
-        // memcopy mapped buffer in-between command buffer calls?
-        // https://www.reddit.com/r/vulkan/comments/110ygxu/memcopy_mapped_buffer_inbetween_command_buffer/
-        //---------------------------------------------------------------------------------------------------
-        // UBO のマルチバッファリング化が実装されるまで、パイプラインバリアで同期するようにする
-        // ただし、マルチバッファリングを使用しない限り、即時書き込みのUBOの同期をとる方法はないので、現状効果はない
-        //===================================================================================================
+        useIndirectDraw       = enable;
+        drawModeStats[enable] = {};
+    }
 
-        // HOST_COHERENT フラグ: 明示的にフラッシュしなくても、コマンドバッファが転送された時点でGPUと同期される
-        // メモリバリア         : GPU側が読み取るタイミングの動機
+    void SceneRenderer::_PrepareIndirectDraw()
+    {
+        // スポンザの全メッシュソースを統合
+        indirect->geometry = slnew(GeometryBuffer);
+        indirect->geometry->Build(sponzaMesh->GetMeshSources());
 
-        // マルチバッファリングを実装できれば、前フレームの実行がフェンスで完了している状態でUBOの更新が可能なので、この待機は不必要となる
-        // MemoryBarrierInfo mb = {};
-        // mb.srcAccess = BARRIER_ACCESS_HOST_WRITE_BIT;
-        // mb.dstAccess = BARRIER_ACCESS_UNIFORM_READ_BIT;
-        // api->PipelineBarrier(frame.commandBuffer, PIPELINE_STAGE_HOST_BIT, PIPELINE_STAGE_VERTEX_SHADER_BIT, 1, &mb, 0, nullptr, 0, nullptr);
+        indirect->maxDrawCount = indirect->geometry->GetCount();
 
+        const uint32 numFrame = Renderer::Get()->GetFrameCountInFlight();
+        const uint64 byteSize = IndirectDrawCountOffset + sizeof(DrawIndexedIndirectCommand) * std::max(indirect->maxDrawCount, 1u);
 
-        // シャドウパス
-        if (1)
+        indirect->commandBuffers.resize(numFrame);
+        indirect->shadowCommandBuffers.resize(numFrame);
+        for (uint32 i = 0; i < numFrame; i++)
         {
-            api->Cmd_SetViewport(frame.commandBuffer, 0, 0, shadowMapResolution, shadowMapResolution);
-            api->Cmd_SetScissor(frame.commandBuffer, 0, 0, shadowMapResolution, shadowMapResolution);
+            indirect->commandBuffers[i]       = Renderer::Get()->CreateIndirectBuffer(nullptr, byteSize);
+            indirect->shadowCommandBuffers[i] = Renderer::Get()->CreateIndirectBuffer(nullptr, byteSize);
+        }
+    }
 
-            auto* view = shadow->depthView->GetHandle();
-            api->Cmd_BeginRenderPass(frame.commandBuffer, shadow->pass, shadow->framebuffer, 1, &view);
+    void SceneRenderer::_CleanupIndirectDraw()
+    {
+        for (BufferHandle* buffer : indirect->commandBuffers)
+        {
+            api->UnmapBuffer(buffer);
+            Renderer::Get()->DestroyNativeHandle(buffer);
+        }
 
-            api->Cmd_BindPipeline(frame.commandBuffer, shadow->pipeline);
-            api->Cmd_BindDescriptorSet(frame.commandBuffer, shadow->set->GetHandle(frameIndex), 0);
+        for (BufferHandle* buffer : indirect->shadowCommandBuffers)
+        {
+            api->UnmapBuffer(buffer);
+            Renderer::Get()->DestroyNativeHandle(buffer);
+        }
+
+        sldelete(indirect->geometry);
+    }
+
+    void SceneRenderer::_BuildIndirectCommands(uint32 frameIndex)
+    {
+        SL_SCOPE_PROFILE("SceneRenderer::BuildIndirectCommands");
+
+        // 可視のメッシュソースのみ引数を書き込み、描画数を返す
+        auto WriteCommands = [&](BufferHandle* buffer, const std::vector<uint8>& visible)
+        {
+            byte* mapped = (byte*)Renderer::Get()->GetMappedPointer(buffer);
+            DrawIndexedIndirectCommand* commands = (DrawIndexedIndirectCommand*)(mapped + IndirectDrawCountOffset);
+
+            const std::vector<GeometryRange>& ranges = indirect->geometry->GetRanges();
 
-            // スポンザ
-            for (MeshSource* source : sponzaMesh->GetMeshSources())
+            uint32 numDraw = 0;
+            for (uint32 i = 0; i < ranges.size(); i++)
             {
-                BufferHandle* vb  = source->GetVertexBuffer()->GetHandle();
-                BufferHandle* ib  = source->GetIndexBuffer()->GetHandle();
-                uint32 indexCount = source->GetIndexCount();
-                api->Cmd_BindVertexBuffer(frame.commandBuffer, vb, 0);
-                api->Cmd_BindIndexBuffer(frame.commandBuffer, ib, INDEX_BUFFER_FORMAT_UINT32, 0);
-                api->Cmd_DrawIndexed(frame.commandBuffer, indexCount, 1, 0, 0, 0);
+                if (!visible[i])
+                    continue;
+
+                DrawIndexedIndirectCommand& command = commands[numDraw++];
+                command.indexCount    = ranges[i].indexCount;
+                command.instanceCount = 1;
+                command.firstIndex    = ranges[i].firstIndex;
+                command.vertexOffset  = ranges[i].vertexOffset;
+                command.firstInstance = 0;
             }
 
-            api->Cmd_EndRenderPass(frame.commandBuffer);
+            *(uint32*)mapped = numDraw;
+            return numDraw;
+        };
+
+        indirect->numDraw       = WriteCommands(indirect->commandBuffers[frameIndex],       culling->staticCameraVisible);
+        indirect->numShadowDraw = WriteCommands(indirect->shadowCommandBuffers[frameIndex], culling->staticShadowVisible);
+    }
+
+    uint32 SceneRenderer::_DrawSceneGeometry(CommandBufferHandle* commandBuffer, uint32 frameIndex, bool shadowPass, uint32 begin, uint32 end)
+    {
+        if (useIndirectDraw)
+        {
+            BufferHandle* commands = shadowPass? indirect->shadowCommandBuffers[frameIndex] : indirect->commandBuffers[frameIndex];
+            const uint32  numDraw  = shadowPass? indirect->numShadowDraw : indirect->numDraw;
+            const uint32  stride   = sizeof(DrawIndexedIndirectCommand);
+
+            // シャドウパスは座標ストリームのみ
+            BufferHandle* vbs[]     = { indirect->geometry->GetPositionBuffer(), indirect->geometry->GetAttributeBuffer() };
+            uint64        offsets[] = { 0, 0 };
+            api->Cmd_BindVertexBuffers(commandBuffer, shadowPass? 1 : 2, vbs, offsets);
+            api->Cmd_BindIndexBuffer(commandBuffer, indirect->geometry->GetIndexBuffer(), INDEX_BUFFER_FORMAT_UINT32, 0);
+
+            // 描画数もバッファから読み取る (描画数を GPU 側で書き込む場合も、同じコマンドのまま使用できる)
+            if (api->IsDrawIndirectCountSupported())
+            {
+                api->Cmd_DrawIndexedIndirectCount(commandBuffer, commands, IndirectDrawCountOffset, commands, 0, indirect->maxDrawCount, stride);
+            }
+            else
+            {
+                api->Cmd_DrawIndexedIndirect(commandBuffer, commands, IndirectDrawCountOffset, numDraw, stride);
+            }
+
+            return 1;
         }
 
-        // メッシュパス
-        if (1)
+        // メッシュソース毎にバインド・描画
+        const std::vector<uint8>& visible = shadowPass? culling->staticShadowVisible : culling->staticCameraVisible;
+        const std::vector<MeshSource*>& sources = sponzaMesh->GetMeshSources();
+
+        // 並列記録時は メッシュソースの範囲 [begin, end) のみ描画する
+        const uint32 last = std::min(end, (uint32)sources.size());
+
+        uint32 numDrawCall = 0;
+        for (uint32 i = begin; i < last; i++)
         {
-            api->Cmd_SetViewport(frame.commandBuffer, 0, 0, viewportSize.x, viewportSize.y);
-            api->Cmd_SetScissor(frame.commandBuffer, 0, 0, viewportSize.x, viewportSize.y);
+            if (!visible[i])
+                continue;
+
+            MeshSource* source = sources[i];
+            BufferHandle* vbs[]     = { source->GetPositionBuffer()->GetHandle(), source->GetAttributeBuffer()->GetHandle() };
+            uint64        offsets[] = { 0, 0 };
+            BufferHandle* ib        = source->GetIndexBuffer()->GetHandle();
+            uint32        indexCount = source->GetIndexCount();
+            api->Cmd_BindVertexBuffers(commandBuffer, shadowPass? 1 : 2, vbs, offsets);
+            api->Cmd_BindIndexBuffer(commandBuffer, ib, INDEX_BUFFER_FORMAT_UINT32, 0);
+            api->Cmd_DrawIndexed(commandBuffer, indexCount, 1, 0, 0, 0);
+
+            numDrawCall++;
+        }
 
-            TextureViewHandle* views[] = {
-                gbuffer->albedoView->GetHandle(),
-                gbuffer->normalView->GetHandle(),
-                gbuffer->emissionView->GetHandle(),
-                gbuffer->idView->GetHandle(),
-                gbuffer->depthView->GetHandle(),
-            };
+        return numDrawCall;
+    }
 
-            api->Cmd_BeginRenderPass(frame.commandBuffer, gbuffer->pass, gbuffer->framebuffer, 5, views);
-            api->Cmd_BindPipeline(frame.commandBuffer, gbuffer->pipeline);
-            api->Cmd_BindDescriptorSet(frame.commandBuffer, gbuffer->transformSet->GetHandle(frameIndex), 0);
-            api->Cmd_BindDescriptorSet(frame.commandBuffer, gbuffer->materialSet->GetHandle(frameIndex), 1);
+    void SceneRenderer::_PrepareCulling()
+    {
+        // スポンザはワールド変換を持たないので、ローカル境界をそのまま使用する
+        const std::vector<MeshSource*>& sources = sponzaMesh->GetMeshSources();
 
-            //========================================================================
-            // TODO: バインドレスとインスタンシング描画のためのストレージバッファの設計までに...
-            //------------------------------------------------------------------------
-            // 設計が完了するまでは毎度ドローコールすることになるので、ワールド行列はプッシュ定数で
-            // 渡すように変更する。現在は定数バッファで渡しているので、シーンで一律なカメラの
-            // ビュー・プロジェクション行列とは分離させる
-            // 
-            // ※本来は描画パス全体で使用する共通パラメータ(View/Projection)として1回だけバインド
-            //========================================================================
+        culling->staticBounds.Reserve(sources.size());
+        for (MeshSource* source : sources)
+        {
+            culling->staticBounds.Add(source->GetBounds());
+        }
+
+        culling->staticCameraVisible.resize(sources.size(), 1);
+        culling->staticShadowVisible.resize(sources.size(), 1);
+    }
+
+    void SceneRenderer::_CullSceneObjects()
+    {
+        SL_SCOPE_PROFILE("SceneRenderer::CullSceneObjects");
+
+        Camera* camera = sceneCamera;
+
+        // カスケード行列はシャドウの描画にも使用する
+        _CalculateLightSapceMatrices(SceneLightDirection, camera, lightSpaceMatrices);
+
+        // シーンメッシュのワールド境界
+        culling->instanceBounds.Clear();
+        culling->instanceBounds.Reserve(meshDrawList.size());
+        for (const MeshDrawData& data : meshDrawList)
+        {
+            Mesh* mesh = data.mesh.mesh? data.mesh.mesh->Get() : nullptr;
+            culling->instanceBounds.Add(mesh? mesh->GetBounds().Transform(data.transform) : AABB{ glm::vec3(0.0f), glm::vec3(0.0f) });
+        }
+
+        culling->instanceCameraVisible.resize(meshDrawList.size());
+        culling->instanceShadowVisible.resize(meshDrawList.size());
+
+        if (enableCulling)
+        {
+            const Frustum cameraFrustum = Frustum::FromMatrix(camera->GetProjectionMatrix() * camera->GetViewMatrix());
 
-            // スポンザ
-            for (MeshSource* source : sponzaMesh->GetMeshSources())
+            std::array<Frustum, 4> cascadeFrustums;
+            for (uint32 i = 0; i < cascadeFrustums.size(); i++)
             {
-                BufferHandle* vb = source->GetVertexBuffer()->GetHandle();
-                BufferHandle* ib = source->GetIndexBuffer()->GetHandle();
-                uint32 indexCount = source->GetIndexCount();
-                api->Cmd_BindVertexBuffer(frame.commandBuffer, vb, 0);
-                api->Cmd_BindIndexBuffer(frame.commandBuffer, ib, INDEX_BUFFER_FORMAT_UINT32, 0);
-                api->Cmd_DrawIndexed(frame.commandBuffer, indexCount, 1, 0, 0, 0);
+                cascadeFrustums[i] = Frustum::FromMatrix(lightSpaceMatrices[i]);
             }
 
-            api->Cmd_EndRenderPass(frame.commandBuffer);
+            FrustumCulling::Cull(culling->staticBounds,   &cameraFrustum,         1,                      culling->staticCameraVisible.data());
+            FrustumCulling::Cull(culling->staticBounds,   cascadeFrustums.data(), cascadeFrustums.size(), culling->staticShadowVisible.data());
+            FrustumCulling::Cull(culling->instanceBounds, &cameraFrustum,         1,                      culling->instanceCameraVisible.data());
+            FrustumCulling::Cull(culling->instanceBounds, cascadeFrustums.data(), cascadeFrustums.size(), culling->instanceShadowVisible.data());
+        }
+        else
+        {
+            std::fill(culling->staticCameraVisible.begin(),   culling->staticCameraVisible.end(),   1);
+            std::fill(culling->staticShadowVisible.begin(),   culling->staticShadowVisible.end(),   1);
+            std::fill(culling->instanceCameraVisible.begin(), culling->instanceCameraVisible.end(), 1);
+            std::fill(culling->instanceShadowVisible.begin(), culling->instanceShadowVisible.end(), 1);
         }
 
-        // ライティングパス
-        if (1)
+        // 統計
+        const uint32 numStatic = culling->staticBounds.GetCount();
+        for (uint32 i = 0; i < numStatic; i++)
         {
-            auto* view = lighting->view->GetHandle();
-            api->Cmd_BeginRenderPass(frame.commandBuffer, lighting->pass, lighting->framebuffer, 1, &view);
+            stats.numVisibleGeometry += culling->staticCameraVisible[i];
+            stats.numVisibleShadow   += culling->staticShadowVisible[i];
+        }
 
-            api->Cmd_BindPipeline(frame.commandBuffer, lighting->pipeline);
-            api->Cmd_BindDescriptorSet(frame.commandBuffer, lighting->set->GetHandle(frameIndex), 0);
-            api->Cmd_Draw(frame.commandBuffer, 3, 1, 0, 0);
+        stats.numCulledGeometry += numStatic - stats.numVisibleGeometry;
+        stats.numCulledShadow   += numStatic - stats.numVisibleShadow;
 
-            api->Cmd_EndRenderPass(frame.commandBuffer);
+        for (uint32 i = 0; i < meshDrawList.size(); i++)
+        {
+            const bool cameraVisible = culling->instanceCameraVisible[i];
+            stats.numVisibleGeometry += cameraVisible;
+            stats.numCulledGeometry  += !cameraVisible;
+
+            if (meshDrawList[i].mesh.castShadow)
+            {
+                const bool shadowVisible = culling->instanceShadowVisible[i];
+                stats.numVisibleShadow += shadowVisible;
+                stats.numCulledShadow  += !shadowVisible;
+            }
         }
+    }
 
-        // スカイパス
-        if (1)
+    void SceneRenderer::_PrepareOcclusionCulling(uint32 width, uint32 height)
+    {
+        // スポンザのメッシュソース単位で判定する (シーンメッシュはインスタンシングで描画するので CPU の視錐台カリングのみ)
+        const std::vector<GeometryRange>& ranges  = indirect->geometry->GetRanges();
+        const std::vector<MeshSource*>&   sources = sponzaMesh->GetMeshSources();
+
+        occlusion->numObject = ranges.size();
+        if (occlusion->numObject == 0)
+            return;
+
+        // シェーダーの ObjectBounds と同じレイアウト
+        struct ObjectBounds
         {
-            TextureViewHandle* views[] = { lighting->view->GetHandle(), gbuffer->depthView->GetHandle() };
-            api->Cmd_BeginRenderPass(frame.commandBuffer, environment->pass, environment->framebuffer, 2, views);
+            glm::vec4 center;
+            glm::vec4 extent;
+        };
+
+        std::vector<ObjectBounds>               bounds(occlusion->numObject);
+        std::vector<DrawIndexedIndirectCommand> draws(occlusion->numObject);
+        std::vector<uint32>                     visibility(occlusion->numObject, 1); // 初回は全て可視として扱う
+
+        for (uint32 i = 0; i < occlusion->numObject; i++)
+        {
+            const AABB& aabb = sources[i]->GetBounds();
+            bounds[i].center = glm::vec4(aabb.GetCenter(), 0.0f);
+            bounds[i].extent = glm::vec4(aabb.GetExtent(), 0.0f);
+
+            draws[i].indexCount    = ranges[i].indexCount;
+            draws[i].instanceCount = 1;
+            draws[i].firstIndex    = ranges[i].firstIndex;
+            draws[i].vertexOffset  = ranges[i].vertexOffset;
+            draws[i].firstInstance = 0;
+        }
+
+        const uint64 commandByteSize = IndirectDrawCountOffset + sizeof(DrawIndexedIndirectCommand) * occlusion->numObject;
+        const BufferUsageFlags commandUsage = BUFFER_USAGE_STORAGE_BIT | BUFFER_USAGE_INDIRECT_BIT | BUFFER_USAGE_TRANSFER_SRC_BIT;
 
-            if (1) // スカイ
+        occlusion->boundsBuffer     = Renderer::Get()->CreateDeviceBuffer(bounds.data(),     sizeof(ObjectBounds) * bounds.size(),               BUFFER_USAGE_STORAGE_BIT);
+        occlusion->drawBuffer       = Renderer::Get()->CreateDeviceBuffer(draws.data(),      sizeof(DrawIndexedIndirectCommand) * draws.size(), BUFFER_USAGE_STORAGE_BIT);
+        occlusion->visibilityBuffer = Renderer::Get()->CreateDeviceBuffer(visibility.data(), sizeof(uint32) * visibility.size(),                BUFFER_USAGE_STORAGE_BIT);
+        occlusion->earlyCommands    = Renderer::Get()->CreateDeviceBuffer(nullptr, commandByteSize, commandUsage);
+        occlusion->lateCommands     = Renderer::Get()->CreateDeviceBuffer(nullptr, commandByteSize, commandUsage);
+
+        // 描画数の読み戻し先 [0]: フェーズ0 / [1]: フェーズ1
+        const uint32 numFrame = Renderer::Get()->GetFrameCountInFlight();
+        occlusion->readbackBuffers.resize(numFrame);
+        for (uint32 i = 0; i < numFrame; i++)
+        {
+            occlusion->readbackBuffers[i] = api->CreateBuffer(sizeof(uint32) * 2, BUFFER_USAGE_TRANSFER_DST_BIT, MEMORY_ALLOCATION_TYPE_CPU);
+            std::memset(api->MapBuffer(occlusion->readbackBuffers[i]), 0, sizeof(uint32) * 2);
+        }
+
+        // シェーダー
+        ShaderCompiledData hizCompiledData;
+        ShaderCompiler::Get()->Compile("Assets/Shaders/HiZ.glsl", hizCompiledData);
+        occlusion->hizShader   = api->CreateShader(hizCompiledData);
+        occlusion->hizPipeline = PipelineCompiler::CompileCompute(occlusion->hizShader);
+
+        ShaderCompiledData cullingCompiledData;
+        ShaderCompiler::Get()->Compile("Assets/Shaders/OcclusionCulling.glsl", cullingCompiledData);
+        occlusion->shader   = api->CreateShader(cullingCompiledData);
+        occlusion->pipeline = PipelineCompiler::CompileCompute(occlusion->shader);
+
+        // Hi-Z はテクセルを直接読み取るので補間しない
+        occlusion->hizSampler = Renderer::Get()->CreateSampler(SAMPLER_FILTER_NEAREST, SAMPLER_REPEAT_MODE_CLAMP_TO_EDGE);
+
+        _CreateHiZ(width, height);
+    }
+
+    void SceneRenderer::_ResizeOcclusionCulling(uint32 width, uint32 height)
+    {
+        if (occlusion->numObject == 0)
+            return;
+
+        // Gバッファの深度ビューを参照しているので、Gバッファのリサイズ後に再生成する
+        _DestroyHiZ();
+        _CreateHiZ(width, height);
+    }
+
+    void SceneRenderer::_CleanupOcclusionCulling()
+    {
+        if (occlusion->numObject == 0)
+            return;
+
+        _DestroyHiZ();
+
+        api->DestroyShader(occlusion->hizShader);
+        api->DestroyShader(occlusion->shader);
+        PipelineCompiler::Destroy(occlusion->hizPipeline);
+        PipelineCompiler::Destroy(occlusion->pipeline);
+        Renderer::Get()->DestroySampler(occlusion->hizSampler);
+
+        Renderer::Get()->DestroyNativeHandle(occlusion->boundsBuffer);
+        Renderer::Get()->DestroyNativeHandle(occlusion->drawBuffer);
+        Renderer::Get()->DestroyNativeHandle(occlusion->visibilityBuffer);
+        Renderer::Get()->DestroyNativeHandle(occlusion->earlyCommands);
+        Renderer::Get()->DestroyNativeHandle(occlusion->lateCommands);
+
+        for (BufferHandle* buffer : occlusion->readbackBuffers)
+        {
+            api->UnmapBuffer(buffer);
+            Renderer::Get()->DestroyNativeHandle(buffer);
+        }
+    }
+
+    void SceneRenderer::_CreateHiZ(uint32 width, uint32 height)
+    {
+        // ミップ0 は深度バッファと同じ解像度
+        occlusion->hizMipSizes = RenderingUtility::CalculateMipmap(width, height);
+        occlusion->hiz         = Renderer::Get()->CreateTexture2D(RENDERING_FORMAT_R32_SFLOAT, width, height, true, TEXTURE_USAGE_STORAGE_BIT);
+        occlusion->hizView     = Renderer::Get()->CreateTextureView(occlusion->hiz, TEXTURE_TYPE_2D, TEXTURE_ASPECT_COLOR_BIT);
+
+        const uint32 numMip = occlusion->hizMipSizes.size();
+        occlusion->hizMipViews.resize(numMip);
+        occlusion->hizSets.resize(numMip);
+
+        for (uint32 i = 0; i < numMip; i++)
+        {
+            occlusion->hizMipViews[i] = Renderer::Get()->CreateTextureView(occlusion->hiz, TEXTURE_TYPE_2D, TEXTURE_ASPECT_COLOR_BIT, 0, 1, i, 1);
+        }
+
+        // ミップ毎に 1つ上のミップ (ミップ0 は深度バッファ) から縮小する
+        for (uint32 i = 0; i < numMip; i++)
+        {
+            DescriptorSet* set = Renderer::Get()->CreateDescriptorSet(occlusion->hizShader, 0);
+            set->SetResource(0, gbuffer->depthView, occlusion->hizSampler);
+            set->SetStorageImage(1, occlusion->hizMipViews[i == 0? 0 : i - 1]);
+            set->SetStorageImage(2, occlusion->hizMipViews[i]);
+            set->Flush();
+
+            occlusion->hizSets[i] = set;
+        }
+
+        occlusion->set = Renderer::Get()->CreateDescriptorSet(occlusion->shader, 0);
+        occlusion->set->SetStorageBuffer(0, occlusion->boundsBuffer);
+        occlusion->set->SetStorageBuffer(1, occlusion->drawBuffer);
+        occlusion->set->SetStorageBuffer(2, occlusion->visibilityBuffer);
+        occlusion->set->SetStorageBuffer(3, occlusion->earlyCommands);
+        occlusion->set->SetStorageBuffer(4, occlusion->lateCommands);
+        occlusion->set->SetResource(5, occlusion->hizView, occlusion->hizSampler);
+        occlusion->set->Flush();
+    }
+
+    void SceneRenderer::_DestroyHiZ()
+    {
+        Renderer::Get()->DestroyDescriptorSet(occlusion->set);
+
+        for (DescriptorSet* set : occlusion->hizSets)
+        {
+            Renderer::Get()->DestroyDescriptorSet(set);
+        }
+
+        for (TextureView* view : occlusion->hizMipViews)
+        {
+            Renderer::Get()->DestroyTextureView(view);
+        }
+
+        Renderer::Get()->DestroyTextureView(occlusion->hizView);
+        Renderer::Get()->DestroyTexture(occlusion->hiz);
+
+        occlusion->hizSets.clear();
+        occlusion->hizMipViews.clear();
+        occlusion->hizMipSizes.clear();
+    }
+
+    bool SceneRenderer::_IsOcclusionCullingReady()
+    {
+        if (!enableOcclusionCulling || !useIndirectDraw || occlusion->numObject == 0)
+            return false;
+
+        // パイプラインの生成が完了するまでは、CPU の視錐台カリング結果で描画する
+        return occlusion->hizPipeline->IsReady() && occlusion->pipeline->IsReady();
+    }
+
+    void SceneRenderer::_DispatchOcclusionCulling(CommandBufferHandle* commandBuffer, uint32 phase)
+    {
+        // シェーダーのプッシュ定数と同じレイアウト
+        struct Constant
+        {
+            glm::mat4 viewProjection;
+            glm::vec4 hizSize;
+            uint32    numObject;
+            uint32    phase;
+            uint32    compact;
+        };
+
+        const Extent& hizSize = occlusion->hizMipSizes[0];
+
+        Constant constant;
+        constant.viewProjection = sceneCamera->GetProjectionMatrix() * sceneCamera->GetViewMatrix();
+        constant.hizSize        = glm::vec4(hizSize.width, hizSize.height, occlusion->hizMipSizes.size(), 0.0f);
+        constant.numObject      = occlusion->numObject;
+        constant.phase          = phase;
+        constant.compact        = api->IsDrawIndirectCountSupported();
+
+        if (phase == 0)
+        {
+            // 前フレームの 間接描画・読み戻し・判定結果の書き込み が完了してから描画数をクリアする
+            MemoryBarrierInfo before = {};
+            before.srcAccess = BARRIER_ACCESS_SHADER_WRITE_BIT;
+            before.dstAccess = BARRIER_ACCESS_TRANSFER_WRITE_BIT | BARRIER_ACCESS_SHADER_READ_BIT | BARRIER_ACCESS_SHADER_WRITE_BIT;
+            api->Cmd_PipelineBarrier(commandBuffer, (PipelineStageBits)(PIPELINE_STAGE_DRAW_INDIRECT_BIT | PIPELINE_STAGE_COMPUTE_SHADER_BIT | PIPELINE_STAGE_TRANSFER_BIT), (PipelineStageBits)(PIPELINE_STAGE_TRANSFER_BIT | PIPELINE_STAGE_COMPUTE_SHADER_BIT), 1, &before, 0, nullptr, 0, nullptr);
+
+            api->Cmd_ClearBuffer(commandBuffer, occlusion->earlyCommands, 0, IndirectDrawCountOffset);
+            api->Cmd_ClearBuffer(commandBuffer, occlusion->lateCommands,  0, IndirectDrawCountOffset);
+
+            MemoryBarrierInfo clear = {};
+            clear.srcAccess = BARRIER_ACCESS_TRANSFER_WRITE_BIT;
+            clear.dstAccess = BARRIER_ACCESS_SHADER_READ_BIT | BARRIER_ACCESS_SHADER_WRITE_BIT;
+            api->Cmd_PipelineBarrier(commandBuffer, PIPELINE_STAGE_TRANSFER_BIT, PIPELINE_STAGE_COMPUTE_SHADER_BIT, 1, &clear, 0, nullptr, 0, nullptr);
+        }
+
+        api->Cmd_BindPipeline(commandBuffer, occlusion->pipeline->Get());
+        api->Cmd_BindDescriptorSet(commandBuffer, occlusion->set->GetHandle(Renderer::Get()->GetCurrentFrameIndex()), 0);
+        api->Cmd_PushConstants(commandBuffer, occlusion->shader, &constant, sizeof(Constant) / sizeof(uint32));
+        api->Cmd_Dispatch(commandBuffer, (occlusion->numObject + 63) / 64, 1, 1);
+
+        // 描画引数として読み取る前に書き込みを完了させる
+        MemoryBarrierInfo after = {};
+        after.srcAccess = BARRIER_ACCESS_SHADER_WRITE_BIT;
+        after.dstAccess = BARRIER_ACCESS_INDIRECT_COMMAND_READ_BIT | BARRIER_ACCESS_TRANSFER_READ_BIT;
+        api->Cmd_PipelineBarrier(commandBuffer, PIPELINE_STAGE_COMPUTE_SHADER_BIT, (PipelineStageBits)(PIPELINE_STAGE_DRAW_INDIRECT_BIT | PIPELINE_STAGE_TRANSFER_BIT), 1, &after, 0, nullptr, 0, nullptr);
+
+        if (phase == 1)
+        {
+            // 統計用に描画数を読み戻す (このフレームのバッファを次に使用する時点で GPU の書き込みは完了している)
+            BufferHandle* readback = occlusion->readbackBuffers[Renderer::Get()->GetCurrentFrameIndex()];
+
+            BufferCopyRegion region = {};
+            region.size      = sizeof(uint32);
+            region.dstOffset = 0;
+            api->Cmd_CopyBuffer(commandBuffer, occlusion->earlyCommands, readback, 1, &region);
+
+            region.dstOffset = sizeof(uint32);
+            api->Cmd_CopyBuffer(commandBuffer, occlusion->lateCommands, readback, 1, &region);
+        }
+    }
+
+    void SceneRenderer::_BuildHiZ(CommandBufferHandle* commandBuffer)
+    {
+        // 深度の書き込み完了を待ち、Hi-Z は前フレームの内容を破棄して書き込み用のレイアウトに遷移する
+        TextureBarrierInfo barriers[2] = {};
+        barriers[0].texture             = gbuffer->depth->GetHandle();
+        barriers[0].srcAccess           = BARRIER_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        barriers[0].dstAccess           = BARRIER_ACCESS_SHADER_READ_BIT;
+        barriers[0].oldLayout           = TEXTURE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+        barriers[0].newLayout           = TEXTURE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+        barriers[0].subresources.aspect = TEXTURE_ASPECT_DEPTH_BIT;
+
+        barriers[1].texture   = occlusion->hiz->GetHandle();
+        barriers[1].srcAccess = BARRIER_ACCESS_SHADER_READ_BIT;
+        barriers[1].dstAccess = BARRIER_ACCESS_SHADER_WRITE_BIT;
+        barriers[1].oldLayout = TEXTURE_LAYOUT_UNDEFINED;
+        barriers[1].newLayout = TEXTURE_LAYOUT_GENERAL;
+
+        api->Cmd_PipelineBarrier(commandBuffer, (PipelineStageBits)(PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT | PIPELINE_STAGE_COMPUTE_SHADER_BIT), PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, nullptr, 0, nullptr, 2, barriers);
+
+        struct Constant
+        {
+            glm::ivec2 srcSize;
+            glm::ivec2 dstSize;
+            int32      level;
+        };
+
+        const uint32 frameIndex = Renderer::Get()->GetCurrentFrameIndex();
+        const uint32 numMip     = occlusion->hizMipSizes.size();
+
+        api->Cmd_BindPipeline(commandBuffer, occlusion->hizPipeline->Get());
+
+        for (uint32 i = 0; i < numMip; i++)
+        {
+            const Extent& src = occlusion->hizMipSizes[i == 0? 0 : i - 1];
+            const Extent& dst = occlusion->hizMipSizes[i];
+
+            Constant constant;
+            constant.srcSize = glm::ivec2(src.width, src.height);
+            constant.dstSize = glm::ivec2(dst.width, dst.height);
+            constant.level   = i;
+
+            api->Cmd_BindDescriptorSet(commandBuffer, occlusion->hizSets[i]->GetHandle(frameIndex), 0);
+            api->Cmd_PushConstants(commandBuffer, occlusion->hizShader, &constant, sizeof(Constant) / sizeof(uint32));
+            api->Cmd_Dispatch(commandBuffer, (dst.width + 7) / 8, (dst.height + 7) / 8, 1);
+
+            // 次のミップは このミップを読み取る
+            MemoryBarrierInfo mip = {};
+            mip.srcAccess = BARRIER_ACCESS_SHADER_WRITE_BIT;
+            mip.dstAccess = BARRIER_ACCESS_SHADER_READ_BIT;
+            api->Cmd_PipelineBarrier(commandBuffer, PIPELINE_STAGE_COMPUTE_SHADER_BIT, PIPELINE_STAGE_COMPUTE_SHADER_BIT, 1, &mip, 0, nullptr, 0, nullptr);
+        }
+
+        // カリングではサンプラー経由で全ミップを参照する
+        TextureBarrierInfo readable = {};
+        readable.texture   = occlusion->hiz->GetHandle();
+        readable.srcAccess = BARRIER_ACCESS_SHADER_WRITE_BIT;
+        readable.dstAccess = BARRIER_ACCESS_SHADER_READ_BIT;
+        readable.oldLayout = TEXTURE_LAYOUT_GENERAL;
+        readable.newLayout = TEXTURE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        api->Cmd_PipelineBarrier(commandBuffer, PIPELINE_STAGE_COMPUTE_SHADER_BIT, PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, nullptr, 0, nullptr, 1, &readable);
+    }
+
+    uint32 SceneRenderer::_DrawOcclusionCulledGeometry(CommandBufferHandle* commandBuffer, BufferHandle* commands)
+    {
+        const uint32 stride = sizeof(DrawIndexedIndirectCommand);
+
+        BufferHandle* vbs[]     = { indirect->geometry->GetPositionBuffer(), indirect->geometry->GetAttributeBuffer() };
+        uint64        offsets[] = { 0, 0 };
+        api->Cmd_BindVertexBuffers(commandBuffer, 2, vbs, offsets);
+        api->Cmd_BindIndexBuffer(commandBuffer, indirect->geometry->GetIndexBuffer(), INDEX_BUFFER_FORMAT_UINT32, 0);
+
+        if (api->IsDrawIndirectCountSupported())
+        {
+            // 可視オブジェクトのみ詰めて書き込まれている
+            api->Cmd_DrawIndexedIndirectCount(commandBuffer, commands, IndirectDrawCountOffset, commands, 0, occlusion->numObject, stride);
+        }
+        else
+        {
+            // オブジェクト毎の位置に書き込まれ、不可視は instanceCount = 0
+            api->Cmd_DrawIndexedIndirect(commandBuffer, commands, IndirectDrawCountOffset, occlusion->numObject, stride);
+        }
+
+        return 1;
+    }
+
+    void SceneRenderer::_ResizeInstanceBuffer(uint32 capacity)
+    {
+        Renderer::Get()->DestroyBuffer(instanceSBO);
+
+        instanceCapacity = capacity;
+        instanceSBO      = Renderer::Get()->CreateStorageBuffer(nullptr, sizeof(InstanceParameter) * instanceCapacity);
+
+        // 参照しているデスクリプターセットを再生成 (実行中フレームのセットは破棄キューで GPU 完了後に破棄される)
+        Renderer::Get()->DestroyDescriptorSet(shadow->set);
+        shadow->set = Renderer::Get()->CreateDescriptorSet(shadow->shader, 0);
+        shadow->set->SetResource(0, instanceSBO);
+        shadow->set->SetResource(1, Renderer::Get()->GetDynamicUniformBuffer(), sizeof(UBO::LightSpaceTransformData));
+        shadow->set->Flush();
+
+        Renderer::Get()->DestroyDescriptorSet(gbuffer->transformSet);
+        gbuffer->transformSet = Renderer::Get()->CreateDescriptorSet(gbuffer->shader, 0);
+        gbuffer->transformSet->SetResource(0, Renderer::Get()->GetDynamicUniformBuffer(), sizeof(UBO::Transform));
+        gbuffer->transformSet->SetResource(1, instanceSBO);
+        gbuffer->transformSet->Flush();
+    }
+
+    void SceneRenderer::_BuildInstanceBatches()
+    {
+        SL_SCOPE_PROFILE("SceneRenderer::BuildInstanceBatches");
+
+        struct SortKey
+        {
+            Mesh*  mesh;
+            uint64 material;
+            uint32 index;
+        };
+
+        // メッシュ・マテリアル で並べ替え、同一キーを連続させる
+        LinearVector<SortKey> keys(Renderer::Get()->GetFrameAllocator());
+        keys.reserve(meshDrawList.size());
+
+        uint32 numShadowCaster = 0;
+        for (uint32 i = 0; i < meshDrawList.size(); i++)
+        {
+            const MeshComponent& mc = meshDrawList[i].mesh;
+            if (!mc.mesh || !mc.mesh->Get())
+                continue;
+
+            // 頂点データの転送が完了するまでは描画しない
+            if (!mc.mesh->Get()->IsReady())
+                continue;
+
+            // マテリアルスロットの組み合わせで識別する
+            uint64 material = 0;
+            for (const Ref<MaterialAsset>& slot : mc.materials)
             {
-                api->Cmd_BindPipeline(frame.commandBuffer, environment->pipeline);
-                api->Cmd_BindDescriptorSet(frame.commandBuffer, environment->set->GetHandle(frameIndex), 0);
+                MaterialAsset* asset = slot.Get();
+                material = Hash::FNV(&asset, sizeof(asset), material);
+            }
 
-                MeshSource* ms = cubeMesh->GetMeshSource();
-                api->Cmd_BindVertexBuffer(frame.commandBuffer, ms->GetVertexBuffer()->GetHandle(), 0);
-                api->Cmd_BindIndexBuffer(frame.commandBuffer, ms->GetIndexBuffer()->GetHandle(), INDEX_BUFFER_FORMAT_UINT32, 0);
-                api->Cmd_DrawIndexed(frame.commandBuffer, ms->GetIndexCount(), 1, 0, 0, 0);
+            keys.push_back({ mc.mesh->Get(), material, i });
+            numShadowCaster += mc.castShadow? 1 : 0;
+        }
+
+        std::sort(keys.begin(), keys.end(), [](const SortKey& a, const SortKey& b)
+        {
+            if (a.mesh     != b.mesh)     return a.mesh     < b.mesh;
+            if (a.material != b.material) return a.material < b.material;
+            return a.index < b.index;
+        });
+
+        // 使用されているマテリアルにテーブル内のインデックスを割り当てる ([0] はデフォルトマテリアル)
+        using MaterialIndexMap = std::unordered_map<Material*, uint32, std::hash<Material*>, std::equal_to<Material*>, LinearSTLAllocator<std::pair<Material* const, uint32>>>;
+        MaterialIndexMap materialIndices(Renderer::Get()->GetFrameAllocator());
+        LinearVector<Material*> materials(Renderer::Get()->GetFrameAllocator());
+        materials.push_back(nullptr);
+
+        for (const SortKey& key : keys)
+        {
+            for (const Ref<MaterialAsset>& slot : meshDrawList[key.index].mesh.materials)
+            {
+                Material* material = slot? slot->Get() : nullptr;
+                if (material && materialIndices.emplace(material, (uint32)materials.size()).second)
+                {
+                    materials.push_back(material);
+                }
             }
+        }
+
+        if (materials.size() > materialCapacity)
+        {
+            _ResizeMaterialTable(std::max((uint32)materials.size(), materialCapacity * 2));
+        }
 
-            if (1) // グリッド
+        // [0]: スポンザ (単位行列) | [1 ~]: ジオメトリ | [~ 末尾]: シャドウキャスター
+        const uint32 numInstance = 1 + keys.size() + numShadowCaster;
+        if (numInstance > instanceCapacity)
+        {
+            _ResizeInstanceBuffer(std::max(numInstance, instanceCapacity * 2));
+        }
+
+        const uint32 frameIndex = Renderer::Get()->GetCurrentFrameIndex();
+        InstanceParameter* instances = (InstanceParameter*)instanceSBO->GetMappedPointer(frameIndex);
+
+        // マテリアルテーブル書き込み
+        MaterialParameter* table = (MaterialParameter*)materialSBO->GetMappedPointer(frameIndex);
+        for (uint32 i = 0; i < materials.size(); i++)
+        {
+            const Material* material = materials[i];
+            MaterialParameter& param = table[i];
+
+            if (!material)
             {
-                api->Cmd_BindPipeline(frame.commandBuffer, gridPipeline);
-                api->Cmd_BindDescriptorSet(frame.commandBuffer, gridSet->GetHandle(frameIndex), 0);
-                api->Cmd_Draw(frame.commandBuffer, 6, 1, 0, 0);
+                param.albedo        = glm::vec4(1.0f, 1.0f, 1.0f, 0.0f);
+                param.emission      = glm::vec4(0.0f, 0.0f, 0.0f, 0.5f);
+                param.textureTiling = glm::vec2(1.0f, 1.0f);
+                param.albedoTexture = defaultTextureSlot;
+                continue;
             }
 
-            api->Cmd_EndRenderPass(frame.commandBuffer);
+            // テクスチャは初回参照時にバインドレステーブルへ登録される
+            uint32 albedoTexture = defaultTextureSlot;
+            if (material->albedoMap && material->albedoMap->Get())
+            {
+                uint32 index = Renderer::Get()->RegisterBindlessTexture(material->albedoMap->Get());
+                albedoTexture = (index != RENDER_INVALID_ID)? index : defaultTextureSlot;
+            }
+
+            param.albedo        = glm::vec4(material->albedo,   material->metallic);
+            param.emission      = glm::vec4(material->emission, material->roughness);
+            param.textureTiling = material->textureTiling;
+            param.albedoTexture = albedoTexture;
         }
 
-        // ブルーム
-        if (1)
+        uint32 numWrite = 0;
+        auto WriteInstance = [&](const glm::mat4& transform, const Mesh* mesh, int32 entityID)
+        {
+            // 頂点座標の逆量子化は座標にのみ適用する (法線は量子化範囲の影響を受けない)
+            InstanceParameter& param = instances[numWrite++];
+            param.transformMatrix = transform * mesh->GetDequantizeMatrix();
+            param.normalMatrix    = glm::transpose(glm::inverse(transform));
+            param.pixelID         = glm::ivec4(entityID, 0, 0, 0);
+        };
+
+        // 連続する同一キーを 1つのバッチにまとめる (カリングされたインスタンスは書き込まない)
+        auto BuildBatches = [&](LinearVector<InstanceBatch>& out_batches, bool shadowPass)
         {
-            // プリフィルタリング
-            if (1)
+            const std::vector<uint8>& visible = shadowPass? culling->instanceShadowVisible : culling->instanceCameraVisible;
+
+            const SortKey* prev = nullptr;
+            for (const SortKey& key : keys)
             {
-                api->Cmd_SetViewport(frame.commandBuffer, 0, 0, viewportSize.x, viewportSize.y);
-                api->Cmd_SetScissor(frame.commandBuffer, 0, 0, viewportSize.x, viewportSize.y);
+                const MeshDrawData& data = meshDrawList[key.index];
+                if (shadowPass && !data.mesh.castShadow)
+                    continue;
 
-                auto* view = bloom->prefilterView->GetHandle();
-                api->Cmd_BeginRenderPass(frame.commandBuffer, bloom->pass, bloom->bloomFB, 1, &view);
-                api->Cmd_BindPipeline(frame.commandBuffer, bloom->prefilterPipeline);
+                if (!visible[key.index])
+                    continue;
 
-                float threshold = 10.0f;
-                api->Cmd_PushConstants(frame.commandBuffer, bloom->prefilterShader, &threshold, 1);
-                api->Cmd_BindDescriptorSet(frame.commandBuffer, bloom->prefilterSet->GetHandle(frameIndex), 0);
-                api->Cmd_Draw(frame.commandBuffer, 3, 1, 0, 0);
+                if (!prev || prev->mesh != key.mesh || prev->material != key.material)
+                {
+                    InstanceBatch& batch = out_batches.emplace_back();
+                    batch.mesh          = key.mesh;
+                    batch.firstInstance = numWrite;
+                    batch.instanceCount = 0;
+
+                    // バッチ内のインスタンスはマテリアルスロットの組み合わせが同じなので、先頭のものから解決する
+                    if (!shadowPass)
+                    {
+                        const std::vector<Ref<MaterialAsset>>& slots = data.mesh.materials;
+                        uint32* indices = Renderer::Get()->GetFrameAllocator()->AllocateArray<uint32>(slots.size());
+
+                        for (uint32 i = 0; i < slots.size(); i++)
+                        {
+                            Material* material = slots[i]? slots[i]->Get() : nullptr;
+                            indices[i] = material? materialIndices.at(material) : 0;
+                        }
+
+                        batch.materialIndices = indices;
+                        batch.numMaterial     = slots.size();
+                    }
+                }
 
-                api->Cmd_EndRenderPass(frame.commandBuffer);
+                WriteInstance(data.transform, key.mesh, data.entityID);
+                out_batches.back().instanceCount++;
+
+                prev = &key;
             }
+        };
+
+        // スポンザは エンティティを持たないので無効なIDを書き込む
+        WriteInstance(glm::mat4(1.0f), sponzaMesh, -1);
+
+        BuildBatches(geometryBatches, false);
+        BuildBatches(shadowBatches,   true);
+    }
+
+    uint32 SceneRenderer::_DrawInstanceBatches(CommandBufferHandle* commandBuffer, const LinearVector<InstanceBatch>& batches, bool shadowPass, uint32 begin, uint32 end)
+    {
+        const uint32 last = std::min(end, (uint32)batches.size());
+
+        uint32 numDrawCall = 0;
+
+        for (uint32 i = begin; i < last; i++)
+        {
+            const InstanceBatch& batch = batches[i];
 
-            // ダウンサンプリング
-            if (1)
+            for (MeshSource* source : batch.mesh->GetMeshSources())
             {
-                for (uint32 i = 0; i < bloom->downSamplingSet.size(); i++)
+                if (batch.materialIndices)
                 {
-                    auto* view = bloom->samplingView[i]->GetHandle();
-                    api->Cmd_BeginRenderPass(frame.commandBuffer, bloom->pass, bloom->samplingFB[i], 1, &view);
-                    api->Cmd_BindPipeline(frame.commandBuffer, bloom->downSamplingPipeline);
+                    const uint32 slot = source->GetMaterialIndex();
+                    _PushMaterialConstant(commandBuffer, slot < batch.numMaterial? batch.materialIndices[slot] : 0);
+                }
 
-                    api->Cmd_SetViewport(frame.commandBuffer, 0, 0, bloom->resolutions[i].width, bloom->resolutions[i].height);
-                    api->Cmd_SetScissor(frame.commandBuffer, 0, 0, bloom->resolutions[i].width, bloom->resolutions[i].height);
+                BufferHandle* vbs[]      = { source->GetPositionBuffer()->GetHandle(), source->GetAttributeBuffer()->GetHandle() };
+                uint64        offsets[]  = { 0, 0 };
+                BufferHandle* ib         = source->GetIndexBuffer()->GetHandle();
+                uint32        indexCount = source->GetIndexCount();
+                api->Cmd_BindVertexBuffers(commandBuffer, shadowPass? 1 : 2, vbs, offsets);
+                api->Cmd_BindIndexBuffer(commandBuffer, ib, INDEX_BUFFER_FORMAT_UINT32, 0);
+                api->Cmd_DrawIndexed(commandBuffer, indexCount, batch.instanceCount, 0, 0, batch.firstInstance);
 
-                    glm::ivec2 srcResolution = i == 0 ? sceneViewportSize : glm::ivec2(bloom->resolutions[i - 1].width, bloom->resolutions[i - 1].height);
-                    api->Cmd_PushConstants(frame.commandBuffer, bloom->downSamplingShader, &srcResolution[0], sizeof(srcResolution) / sizeof(uint32));
+                numDrawCall++;
+            }
+        }
 
-                    api->Cmd_BindDescriptorSet(frame.commandBuffer, bloom->downSamplingSet[i]->GetHandle(frameIndex), 0);
-                    api->Cmd_Draw(frame.commandBuffer, 3, 1, 0, 0);
+        return numDrawCall;
+    }
 
-                    api->Cmd_EndRenderPass(frame.commandBuffer);
-                }
+    void SceneRenderer::_PrepareMaterialTable()
+    {
+        defaultTextureSlot = Renderer::Get()->RegisterBindlessTexture(defaultTexture);
+        _ResizeMaterialTable(DefaultMaterialCapacity);
+    }
+
+    void SceneRenderer::_CleanupMaterialTable()
+    {
+        for (uint32 slot : materialTableSlots)
+        {
+            Renderer::Get()->UnregisterBindlessBuffer(slot);
+        }
+
+        materialTableSlots.clear();
+
+        if (materialSBO)
+        {
+            Renderer::Get()->DestroyBuffer(materialSBO);
+            materialSBO = nullptr;
+        }
+    }
+
+    void SceneRenderer::_ResizeMaterialTable(uint32 capacity)
+    {
+        // 実行中フレームが参照しているバッファ・スロットは、破棄キューで GPU 完了後に解放される
+        _CleanupMaterialTable();
+
+        materialCapacity = capacity;
+        materialSBO      = Renderer::Get()->CreateStorageBuffer(nullptr, sizeof(MaterialParameter) * materialCapacity);
+
+        const uint32 numFrame = Renderer::Get()->GetFrameCountInFlight();
+        materialTableSlots.resize(numFrame);
+
+        for (uint32 i = 0; i < numFrame; i++)
+        {
+            materialTableSlots[i] = Renderer::Get()->RegisterBindlessBuffer(materialSBO->GetHandle(i));
+        }
+    }
+
+    void SceneRenderer::_PushMaterialConstant(CommandBufferHandle* commandBuffer, uint32 materialIndex)
+    {
+        MaterialConstant constant;
+        constant.materialTable = materialTableSlots[Renderer::Get()->GetCurrentFrameIndex()];
+        constant.materialIndex = materialIndex;
+
+        api->Cmd_PushConstants(commandBuffer, gbuffer->shader, &constant, sizeof(MaterialConstant) / sizeof(uint32));
+    }
+
+    uint32 SceneRenderer::_GetStaticDrawCount(bool occlusionCulled) const
+    {
+        // 間接描画 (オクルージョンカリングを含む) ではスポンザ全体が 1回の描画になる
+        return (useIndirectDraw || occlusionCulled)? 1 : (uint32)sponzaMesh->GetMeshSources().size();
+    }
+
+    uint32 SceneRenderer::_DrawSceneRange(CommandBufferHandle* commandBuffer, uint32 frameIndex, bool shadowPass, BufferHandle* occlusionCommands, uint32 begin, uint32 end)
+    {
+        const LinearVector<InstanceBatch>& batches = shadowPass? shadowBatches : geometryBatches;
+        const uint32 numStatic = _GetStaticDrawCount(occlusionCommands != nullptr);
+
+        uint32 numDrawCall = 0;
+
+        // スポンザ
+        if (begin < numStatic)
+        {
+            if (occlusionCommands)
+            {
+                numDrawCall += _DrawOcclusionCulledGeometry(commandBuffer, occlusionCommands);
+            }
+            else
+            {
+                numDrawCall += _DrawSceneGeometry(commandBuffer, frameIndex, shadowPass, begin, std::min(end, numStatic));
+            }
+        }
+
+        // シーンのメッシュ (インスタンシング)
+        if (end > numStatic)
+        {
+            numDrawCall += _DrawInstanceBatches(commandBuffer, batches, shadowPass, std::max(begin, numStatic) - numStatic, end - numStatic);
+        }
+
+        return numDrawCall;
+    }
+
+    void SceneRenderer::_PrepareSecondaryCommands()
+    {
+        const uint32  numFrame  = Renderer::Get()->GetFrameCountInFlight();
+        const uint32  numThread = ThreadPool::GetThreadCount() + 1;
+        const QueueID queueID   = Renderer::Get()->GetGraphicsQueueID();
+
+        secondary->contexts.resize(numFrame);
+        for (std::vector<SecondaryCommandData::ThreadContext>& contexts : secondary->contexts)
+        {
+            contexts.resize(numThread);
+            for (SecondaryCommandData::ThreadContext& context : contexts)
+            {
+                context.pool = api->CreateCommandPool(queueID, COMMAND_BUFFER_TYPE_SECONDARY);
             }
+        }
+    }
 
-            // アップサンプリング
-            if (1)
+    void SceneRenderer::_CleanupSecondaryCommands()
+    {
+        for (std::vector<SecondaryCommandData::ThreadContext>& contexts : secondary->contexts)
+        {
+            for (SecondaryCommandData::ThreadContext& context : contexts)
             {
-                uint32 upSamplingIndex = bloom->upSamplingSet.size();
-                for (uint32 i = 0; i < bloom->upSamplingSet.size(); i++)
+                for (CommandBufferHandle* buffer : context.buffers)
                 {
-                    auto* view = bloom->samplingView[upSamplingIndex - 1]->GetHandle();
-                    api->Cmd_BeginRenderPass(frame.commandBuffer, bloom->pass, bloom->samplingFB[upSamplingIndex - 1], 1, &view);
-                    api->Cmd_BindPipeline(frame.commandBuffer, bloom->upSamplingPipeline);
+                    api->DestroyCommandBuffer(buffer);
+                }
+
+                api->DestroyCommandPool(context.pool);
+            }
+        }
 
-                    api->Cmd_SetViewport(frame.commandBuffer, 0, 0, bloom->resolutions[upSamplingIndex - 1].width, bloom->resolutions[upSamplingIndex - 1].height);
-                    api->Cmd_SetScissor(frame.commandBuffer, 0, 0, bloom->resolutions[upSamplingIndex - 1].width, bloom->resolutions[upSamplingIndex - 1].height);
+        secondary->contexts.clear();
+    }
 
-                    float filterRadius = 0.01f;
-                    api->Cmd_PushConstants(frame.commandBuffer, bloom->upSamplingShader, &filterRadius, 1);
+    void SceneRenderer::_ResetSecondaryCommands(uint32 frameIndex)
+    {
+        // このフレームインデックスで前回記録したバッファは BeginFrame のフェンス待機で GPU の使用が完了している
+        for (SecondaryCommandData::ThreadContext& context : secondary->contexts[frameIndex])
+        {
+            if (context.numUsed > 0)
+            {
+                api->ResetCommandPool(context.pool);
+                context.numUsed = 0;
+            }
+        }
+    }
 
-                    api->Cmd_BindDescriptorSet(frame.commandBuffer, bloom->upSamplingSet[i]->GetHandle(frameIndex), 0);
-                    api->Cmd_Draw(frame.commandBuffer, 3, 1, 0, 0);
+    uint32 SceneRenderer::_GetRecordThreadCount() const
+    {
+        if (!enableParallelRecording)
+            return 1;
 
-                    api->Cmd_EndRenderPass(frame.commandBuffer);
-                    upSamplingIndex--;
-                }
+        const uint32 maxThread = ThreadPool::GetThreadCount() + 1;
+        return recordThreadLimit != 0? std::min(recordThreadLimit, maxThread) : maxThread;
+    }
+
+    uint32 SceneRenderer::_RecordSecondaryCommands(RenderPassHandle* renderpass, uint32 width, uint32 height, uint32 numDraw, const DrawRangeRecordFunc& record)
+    {
+        const uint32 frameIndex = Renderer::Get()->GetCurrentFrameIndex();
+        const uint32 numThread  = _GetRecordThreadCount();
+
+        // スレッド毎に 1チャンクを割り当てる (描画数が少ない場合はチャンク数を減らし、1バッファあたりの描画数を確保する)
+        const uint32 drawsPerChunk = std::max(MinDrawsPerSecondaryCommand, (numDraw + numThread - 1) / numThread);
+        const uint32 numChunk      = (numDraw + drawsPerChunk - 1) / drawsPerChunk;
+
+        secondary->recorded.resize(numChunk);
+        secondary->numDrawCall.resize(numChunk);
+
+        ParallelFor(numChunk, 1, [&](uint32 chunk)
+        {
+            SL_SCOPE_PROFILE("SceneRenderer::RecordSecondary");
+
+            // 記録を実行しているスレッドのコマンドプールから割り当てる
+            const uint32 workerIndex = ThreadPool::GetCurrentWorkerIndex();
+            SL_ASSERT(workerIndex != JobHandle::InvalidIndex);
+
+            SecondaryCommandData::ThreadContext& context = secondary->contexts[frameIndex][workerIndex];
+            if (context.numUsed == context.buffers.size())
+            {
+                context.buffers.push_back(api->CreateCommandBuffer(context.pool));
+            }
+
+            CommandBufferHandle* commandBuffer = context.buffers[context.numUsed++];
+            api->BeginSecondaryCommandBuffer(commandBuffer, renderpass);
+
+            // 動的ステートはセカンダリに継承されないので、バッファ毎に設定する
+            api->Cmd_SetViewport(commandBuffer, 0, 0, width, height);
+            api->Cmd_SetScissor(commandBuffer, 0, 0, width, height);
+
+            const uint32 begin = chunk * drawsPerChunk;
+            const uint32 end   = std::min(begin + drawsPerChunk, numDraw);
+            secondary->numDrawCall[chunk] = record(commandBuffer, begin, end);
+
+            api->EndCommandBuffer(commandBuffer);
+            secondary->recorded[chunk] = commandBuffer;
+
+        }, numThread);
+
+        stats.numSecondaryBuffer += numChunk;
+
+        uint32 numDrawCall = 0;
+        for (uint32 count : secondary->numDrawCall)
+        {
+            numDrawCall += count;
+        }
+
+        return numDrawCall;
+    }
+
+    uint32 SceneRenderer::_RecordRenderPass(CommandBufferHandle* commandBuffer, RenderPassHandle* renderpass, FramebufferHandle* framebuffer, uint32 numView, TextureViewHandle** views, uint32 width, uint32 height, uint32 numDraw, const DrawRangeRecordFunc& record)
+    {
+        Timer timer;
+        uint32 numDrawCall = 0;
+
+        // 1チャンクに満たない描画数では 並列化のオーバーヘッドの方が大きいので、プライマリに直接記録する
+        if (enableParallelRecording && numDraw > MinDrawsPerSecondaryCommand)
+        {
+            api->Cmd_BeginRenderPass(commandBuffer, renderpass, framebuffer, numView, views, COMMAND_BUFFER_TYPE_SECONDARY);
+
+            numDrawCall = _RecordSecondaryCommands(renderpass, width, height, numDraw, record);
+            api->Cmd_ExecuteCommands(commandBuffer, secondary->recorded.size(), secondary->recorded.data());
+
+            api->Cmd_EndRenderPass(commandBuffer);
+
+            // セカンダリの実行後はプライマリの動的ステートが未定義になるので、後続のパスのために再設定する
+            api->Cmd_SetViewport(commandBuffer, 0, 0, width, height);
+            api->Cmd_SetScissor(commandBuffer, 0, 0, width, height);
+        }
+        else
+        {
+            api->Cmd_SetViewport(commandBuffer, 0, 0, width, height);
+            api->Cmd_SetScissor(commandBuffer, 0, 0, width, height);
+
+            api->Cmd_BeginRenderPass(commandBuffer, renderpass, framebuffer, numView, views);
+
+            if (numDraw > 0)
+            {
+                numDrawCall = record(commandBuffer, 0, numDraw);
             }
 
-            // マージ
-            if (1)
+            api->Cmd_EndRenderPass(commandBuffer);
+        }
+
+        stats.cpuRecordTime += timer.ElapsedMilli();
+        stats.numRecordDraw += numDraw;
+
+        return numDrawCall;
+    }
+
+    void SceneRenderer::_ExcutePasses()
+    {
+        const FrameData& frame   = Renderer::Get()->GetFrameData();
+        const uint32 frameIndex  = Renderer::Get()->GetCurrentFrameIndex();
+        const auto& viewportSize = sceneViewportSize;
+
+        // コマンドバッファ開始
+        api->BeginCommandBuffer(frame.commandBuffer);
+
+        // このフレームインデックスのセカンダリコマンドバッファを再利用する
+        _ResetSecondaryCommands(frameIndex);
+
+        // 描画リストから間接描画引数を生成 (このフレームのバッファは BeginFrame のフェンス待機で GPU の使用が完了している)
+        _BuildIndirectCommands(frameIndex);
+
+        //===================================================================================================
+        // memcopy mapped buffer in-between command buffer calls?
+        // https://www.reddit.com/r/vulkan/comments/110ygxu/memcopy_mapped_buffer_inbetween_command_buffer/
+        //---------------------------------------------------------------------------------------------------
+        // UBO はフレーム毎の動的ユニフォームバッファ (リングバッファ) から確保しているので、
+        // 書き込み先は BeginFrame のフェンス待機で GPU の使用が完了している
+        // HOST_COHERENT なので、コマンドバッファの送信時点で GPU から可視となり、追加のバリアは不要
+        //===================================================================================================
+
+
+        // シャドウパス
+        if (1)
+        {
+            SL_SCOPE_PROFILE("SceneRenderer::ShadowPass");
+            ScopedGPUTimestamp gpuZone(GPUZone::Shadow);
+
+            // パイプラインの生成が完了するまでは、レンダーパス (クリア・レイアウト遷移) のみ実行する
+            const uint32 numDraw = shadow->pipeline->IsReady()? _GetStaticDrawCount(false) + (uint32)shadowBatches.size() : 0;
+
+            // 全カスケードを 1パスで描画するので、カスケード単位ではなく描画単位で分割して並列記録する
+            auto record = [&](CommandBufferHandle* commandBuffer, uint32 begin, uint32 end)
             {
-                auto* view = bloom->bloomView->GetHandle();
-                api->Cmd_BeginRenderPass(frame.commandBuffer, bloom->pass, bloom->bloomFB, 1, &view);
-                api->Cmd_BindPipeline(frame.commandBuffer, bloom->bloomPipeline);
+                api->Cmd_BindPipeline(commandBuffer, shadow->pipeline->Get());
+                api->Cmd_BindDescriptorSet(commandBuffer, shadow->set->GetHandle(frameIndex), 0, 1, &shadow->lightTransformOffset);
+
+                return _DrawSceneRange(commandBuffer, frameIndex, true, nullptr, begin, end);
+            };
 
-                api->Cmd_SetViewport(frame.commandBuffer, 0, 0, viewportSize.x, viewportSize.y);
-                api->Cmd_SetScissor(frame.commandBuffer, 0, 0, viewportSize.x, viewportSize.y);
+            auto* view = shadow->depthView->GetHandle();
+            stats.numShadowDrawCall += _RecordRenderPass(frame.commandBuffer, shadow->pass, shadow->framebuffer, 1, &view, shadowMapResolution, shadowMapResolution, numDraw, record);
+        }
 
-                float intencity = 0.1f;
-                api->Cmd_PushConstants(frame.commandBuffer, bloom->bloomShader, &intencity, 1);
+        // メッシュパス
+        if (1)
+        {
+            SL_SCOPE_PROFILE("SceneRenderer::GeometryPass");
+            ScopedGPUTimestamp gpuZone(GPUZone::Geometry);
 
-                api->Cmd_BindDescriptorSet(frame.commandBuffer, bloom->bloomSet->GetHandle(frameIndex), 0);
-                api->Cmd_Draw(frame.commandBuffer, 3, 1, 0, 0);
+            //========================================================================
+            // オクルージョンカリング (スポンザ)
+            //------------------------------------------------------------------------
+            // [フェーズ0] 前フレームで可視だったオブジェクトを描画
+            // [Hi-Z]      フェーズ0 の深度から階層深度を構築
+            // [フェーズ1] Hi-Z で全オブジェクトを判定し、新たに可視になったオブジェクトを追加描画
+            //========================================================================
+            const bool occlusionCulling = _IsOcclusionCullingReady();
+            if (occlusionCulling)
+            {
+                // このフレームインデックスで前回記録した描画数 (フェンス待機済み)
+                const uint32* counts = (const uint32*)Renderer::Get()->GetMappedPointer(occlusion->readbackBuffers[frameIndex]);
+                stats.numOcclusionEarly  = counts[0];
+                stats.numOcclusionLate   = counts[1];
+                stats.numOcclusionCulled = occlusion->numObject - std::min(counts[0] + counts[1], occlusion->numObject);
+
+                _DispatchOcclusionCulling(frame.commandBuffer, 0);
+            }
+
+            TextureViewHandle* views[] = {
+                gbuffer->albedoView->GetHandle(),
+                gbuffer->normalView->GetHandle(),
+                gbuffer->emissionView->GetHandle(),
+                gbuffer->idView->GetHandle(),
+                gbuffer->depthView->GetHandle(),
+            };
+
+            // スポンザは オクルージョンカリング時はフェーズ0 の描画引数で描画する
+            BufferHandle* staticCommands = occlusionCulling? occlusion->earlyCommands : nullptr;
+            const uint32  numDraw        = gbuffer->pipeline->IsReady()? _GetStaticDrawCount(occlusionCulling) + (uint32)geometryBatches.size() : 0;
+
+            auto record = [&](CommandBufferHandle* commandBuffer, uint32 begin, uint32 end)
+            {
+                api->Cmd_BindPipeline(commandBuffer, gbuffer->pipeline->Get());
+                api->Cmd_BindDescriptorSet(commandBuffer, gbuffer->transformSet->GetHandle(frameIndex), 0, 1, &gbuffer->transformOffset);
+                api->Cmd_BindBindlessDescriptorSet(commandBuffer, gbuffer->shader, 1);
+
+                // マテリアルはテーブル内のインデックスをプッシュ定数で切り替える (デスクリプターの再バインドは不要)
+                // マテリアルを持たない描画 (スポンザ等) はデフォルトマテリアルを使用するので、記録するバッファ毎に初期値を設定する
+                _PushMaterialConstant(commandBuffer, 0);
+
+                return _DrawSceneRange(commandBuffer, frameIndex, false, staticCommands, begin, end);
+            };
+
+            stats.numGeometryDrawCall += _RecordRenderPass(frame.commandBuffer, gbuffer->pass, gbuffer->framebuffer, 5, views, viewportSize.x, viewportSize.y, numDraw, record);
+
+            if (occlusionCulling)
+            {
+                SL_SCOPE_PROFILE("SceneRenderer::OcclusionCulling");
+
+                _BuildHiZ(frame.commandBuffer);
+                _DispatchOcclusionCulling(frame.commandBuffer, 1);
+
+                // フェーズ0 の描画結果を保持したまま追加描画するため、アタッチメント用のレイアウトに戻す
+                TextureBarrierInfo barriers[5] = {};
+                TextureHandle* colors[] = { gbuffer->albedo->GetHandle(), gbuffer->normal->GetHandle(), gbuffer->emission->GetHandle(), gbuffer->id->GetHandle() };
+                for (uint32 i = 0; i < std::size(colors); i++)
+                {
+                    barriers[i].texture   = colors[i];
+                    barriers[i].srcAccess = BARRIER_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+                    barriers[i].dstAccess = BARRIER_ACCESS_COLOR_ATTACHMENT_READ_BIT | BARRIER_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+                    barriers[i].oldLayout = TEXTURE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+                    barriers[i].newLayout = TEXTURE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+                }
+
+                barriers[4].texture             = gbuffer->depth->GetHandle();
+                barriers[4].srcAccess           = BARRIER_ACCESS_SHADER_READ_BIT;
+                barriers[4].dstAccess           = BARRIER_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | BARRIER_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+                barriers[4].oldLayout           = TEXTURE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+                barriers[4].newLayout           = TEXTURE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+                barriers[4].subresources.aspect = TEXTURE_ASPECT_DEPTH_BIT;
+
+                const PipelineStageBits srcStage = (PipelineStageBits)(PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+                const PipelineStageBits dstStage = (PipelineStageBits)(PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT);
+                api->Cmd_PipelineBarrier(frame.commandBuffer, srcStage, dstStage, 0, nullptr, 0, nullptr, std::size(barriers), barriers);
+
+                api->Cmd_BeginRenderPass(frame.commandBuffer, gbuffer->loadPass, gbuffer->framebuffer, 5, views);
+                if (gbuffer->pipeline->IsReady())
+                {
+                    api->Cmd_BindPipeline(frame.commandBuffer, gbuffer->pipeline->Get());
+                    api->Cmd_BindDescriptorSet(frame.commandBuffer, gbuffer->transformSet->GetHandle(frameIndex), 0, 1, &gbuffer->transformOffset);
+                    api->Cmd_BindBindlessDescriptorSet(frame.commandBuffer, gbuffer->shader, 1);
+                    _PushMaterialConstant(frame.commandBuffer, 0);
+
+                    stats.numGeometryDrawCall += _DrawOcclusionCulledGeometry(frame.commandBuffer, occlusion->lateCommands);
+                }
 
                 api->Cmd_EndRenderPass(frame.commandBuffer);
             }
         }
 
-        // コンポジットパス
+        // ライティングパス
+        if (1)
+        {
+            ScopedGPUTimestamp gpuZone(GPUZone::Lighting);
+
+            auto* view = lighting->view->GetHandle();
+            api->Cmd_BeginRenderPass(frame.commandBuffer, lighting->pass, lighting->framebuffer, 1, &view);
+
+            if (lighting->pipeline->IsReady())
+            {
+                // 動的オフセットはバインディング番号順 (8: Scene, 9: Cascade, 10: ShadowData)
+                const uint32 offsets[] = { lighting->sceneOffset, shadow->cascadeOffset, shadow->lightTransformOffset };
+
+                api->Cmd_BindPipeline(frame.commandBuffer, lighting->pipeline->Get());
+                api->Cmd_BindDescriptorSet(frame.commandBuffer, lighting->set->GetHandle(frameIndex), 0, std::size(offsets), offsets);
+                api->Cmd_Draw(frame.commandBuffer, 3, 1, 0, 0);
+            }
+
+            api->Cmd_EndRenderPass(frame.commandBuffer);
+        }
+
+        // スカイパス
         if (1)
         {
-            auto* view = compositeTextureView->GetHandle();
-            api->Cmd_BeginRenderPass(frame.commandBuffer, compositePass, compositeFB, 1, &view);
+            ScopedGPUTimestamp gpuZone(GPUZone::Sky);
+
+            TextureViewHandle* views[] = { lighting->view->GetHandle(), gbuffer->depthView->GetHandle() };
+            api->Cmd_BeginRenderPass(frame.commandBuffer, environment->pass, environment->framebuffer, 2, views);
+
+            if (environment->pipeline->IsReady()) // スカイ
+            {
+                api->Cmd_BindPipeline(frame.commandBuffer, environment->pipeline->Get());
+                api->Cmd_BindDescriptorSet(frame.commandBuffer, environment->set->GetHandle(frameIndex), 0, 1, &environment->uboOffset);
 
-            api->Cmd_SetViewport(frame.commandBuffer, 0, 0, viewportSize.x, viewportSize.y);
-            api->Cmd_SetScissor(frame.commandBuffer, 0, 0, viewportSize.x, viewportSize.y);
+                MeshSource* ms = cubeMesh->GetMeshSource();
+                api->Cmd_BindVertexBuffer(frame.commandBuffer, ms->GetPositionBuffer()->GetHandle(), 0);
+                api->Cmd_BindIndexBuffer(frame.commandBuffer, ms->GetIndexBuffer()->GetHandle(), INDEX_BUFFER_FORMAT_UINT32, 0);
+                api->Cmd_DrawIndexed(frame.commandBuffer, ms->GetIndexCount(), 1, 0, 0, 0);
+            }
 
-            api->Cmd_BindPipeline(frame.commandBuffer, compositePipeline);
-            api->Cmd_BindDescriptorSet(frame.commandBuffer, compositeSet->GetHandle(frameIndex), 0);
-            api->Cmd_Draw(frame.commandBuffer, 3, 1, 0, 0);
+            if (gridPipeline->IsReady()) // グリッド
+            {
+                api->Cmd_BindPipeline(frame.commandBuffer, gridPipeline->Get());
+                api->Cmd_BindDescriptorSet(frame.commandBuffer, gridSet->GetHandle(frameIndex), 0, 1, &gridOffset);
+                api->Cmd_Draw(frame.commandBuffer, 6, 1, 0, 0);
+            }
 
             api->Cmd_EndRenderPass(frame.commandBuffer);
         }
+
+        // ポストプロセス (ブルーム・コンポジット)
+        // ブルームの有効状態が変わった場合は再構築し、無効時のブルームパスはカリングされる
+        if (renderGraphBloom != postProcess.enableBloom)
+        {
+            renderGraph->Invalidate();
+        }
+
+        if (renderGraph->IsInvalid())
+        {
+            _BuildRenderGraph();
+        }
+
+        renderGraph->Execute(frame.commandBuffer);
+
+        // エンティティID 読み取り
+        _RecordEntityPicks(frame.commandBuffer, frameIndex);
     }
 
 }
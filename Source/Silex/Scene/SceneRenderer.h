@@ -1,8 +1,13 @@
 
 #pragma once
 #include "Core/CoreType.h"
+#include "Core/LinearAllocator.h"
 #include "Scene/Scene.h"
 #include "Rendering/RenderingAPI.h"
+#include "Rendering/PipelineCompiler.h"
+#include "Rendering/GeometryBuffer.h"
+#include "Rendering/FrustumCulling.h"
+#include "Rendering/RenderGraph.h"
 
 
 namespace Silex
@@ -12,13 +17,56 @@ namespace Silex
         uint32 numRenderMesh       = 0;
         uint64 numGeometryDrawCall = 0;
         uint64 numShadowDrawCall   = 0;
+
+        // 視錐台カリング (スポンザはメッシュソース単位、シーンメッシュはエンティティ単位)
+        uint32 numVisibleGeometry = 0;
+        uint32 numCulledGeometry  = 0;
+        uint32 numVisibleShadow   = 0;
+        uint32 numCulledShadow    = 0;
+
+        // GPU オクルージョンカリング (スポンザのメッシュソース単位 / フレームインフライト数だけ前のフレームの結果)
+        uint32 numOcclusionEarly  = 0;
+        uint32 numOcclusionLate   = 0;
+        uint32 numOcclusionCulled = 0;
+
+        // パス毎の GPU 処理時間 [ms] (フレームインフライト数だけ前のフレームの計測値)
+        float gpuShadowPass    = 0.0f;
+        float gpuGeometryPass  = 0.0f;
+        float gpuLightingPass  = 0.0f;
+        float gpuSkyPass       = 0.0f;
+        float gpuBloomPass     = 0.0f;
+        float gpuCompositePass = 0.0f;
+
+        // レンダーグラフ (メモリーはフォーマットとサイズからの概算)
+        uint32 numGraphPass             = 0;
+        uint32 numGraphCulledPass       = 0;
+        uint64 graphTargetMemory        = 0; // 共有後の物理テクスチャの合計
+        uint64 graphTargetMemoryNoAlias = 0; // 共有しなかった場合の合計
+
+        // 描画コマンドの記録 (シャドウ・ジオメトリパス / 描画単位はスポンザのメッシュソース (間接描画時は 1) とインスタンスバッチ)
+        float  cpuRecordTime      = 0.0f; // 記録にかかった CPU 時間 [ms]
+        uint32 numRecordDraw      = 0;    // 記録した描画単位数
+        uint32 numSecondaryBuffer = 0;    // 並列記録したセカンダリコマンドバッファ数
+        uint32 numRecordThread    = 0;    // 記録に参加できるスレッド数 (呼び出しスレッドを含む)
+    };
+
+    // 描画方式毎の累計 (間接描画の有効・無効を切り替えて、描画コール数と記録時間を比較する)
+    struct DrawModeStats
+    {
+        uint64 numFrame    = 0;
+        uint64 numDrawCall = 0;   // シャドウ + ジオメトリパス
+        double recordTime  = 0.0; // 記録にかかった CPU 時間 [ms]
+
+        float GetAverageDrawCall()   const { return numFrame? (float)numDrawCall / numFrame          : 0.0f; }
+        float GetAverageRecordTime() const { return numFrame? (float)(recordTime / (double)numFrame) : 0.0f; }
     };
 
     struct GBufferData
     {
         RenderPassHandle*  pass        = nullptr;
+        RenderPassHandle*  loadPass    = nullptr; // 描画済みの内容を保持して追加描画する (オクルージョンカリングの 2フェーズ目)
         FramebufferHandle* framebuffer = nullptr;
-        PipelineHandle*    pipeline    = nullptr;
+        AsyncPipeline*     pipeline    = nullptr;
         ShaderHandle*      shader      = nullptr;
 
         Texture2D* albedo   = nullptr;
@@ -33,11 +81,11 @@ namespace Silex
         TextureView* idView       = nullptr;
         TextureView* depthView    = nullptr;
 
-        UniformBuffer* materialUBO;
-        UniformBuffer* transformUBO;
+        // 動的ユニフォームバッファ内のオフセット (毎フレーム確保)
+        uint32 transformOffset = 0;
 
+        // マテリアルはバインドレスセット (set 1) から参照する
         DescriptorSet* transformSet;
-        DescriptorSet* materialSet;
     };
 
     struct LightingData
@@ -47,10 +95,10 @@ namespace Silex
         Texture2D*         color       = nullptr;
         TextureView*       view        = nullptr;
 
-        PipelineHandle* pipeline = nullptr;
+        AsyncPipeline*  pipeline = nullptr;
         ShaderHandle*   shader   = nullptr;
 
-        UniformBuffer* sceneUBO;
+        uint32         sceneOffset = 0;
         DescriptorSet* set;
     };
 
@@ -60,10 +108,10 @@ namespace Silex
         FramebufferHandle* framebuffer = nullptr;
         TextureHandle*     depth       = nullptr;
         TextureViewHandle* view        = nullptr;
-        PipelineHandle*    pipeline    = nullptr;
+        AsyncPipeline*     pipeline    = nullptr;
         ShaderHandle*      shader      = nullptr;
 
-        UniformBuffer*     ubo;
+        uint32             uboOffset = 0;
         DescriptorSet*     set;
     };
 
@@ -73,12 +121,11 @@ namespace Silex
         FramebufferHandle* framebuffer = nullptr;
         Texture2DArray*    depth       = nullptr;
         TextureView*       depthView   = nullptr;
-        PipelineHandle*    pipeline    = nullptr;
+        AsyncPipeline*     pipeline    = nullptr;
         ShaderHandle*      shader      = nullptr;
 
-        UniformBuffer* transformUBO;
-        UniformBuffer* lightTransformUBO;
-        UniformBuffer* cascadeUBO;
+        uint32         lightTransformOffset = 0;
+        uint32         cascadeOffset        = 0;
         DescriptorSet* set;
     };
 
@@ -87,34 +134,176 @@ namespace Silex
         const uint32 numDefaultSampling = 6;
         std::vector<Extent> resolutions = {};
 
+        // パイプライン生成用 (レンダーグラフが生成するレンダーパスとフォーマットが互換)
+        // テクスチャ・フレームバッファはレンダーグラフのトランジェントテクスチャとして確保される
         RenderPassHandle* pass = nullptr;
 
-        std::vector<FramebufferHandle*> samplingFB    = {};
-        std::vector<Texture2D*>         sampling      = {};
-        std::vector<TextureView*>       samplingView  = {};
-        Texture2D*                      prefilter     = {};
-        TextureView*                    prefilterView = {};
-        Texture2D*                      bloom         = {};
-        TextureView*                    bloomView     = {};
-        FramebufferHandle*              bloomFB       = {};
+        // 各パスの読み取り元 (グラフのコンパイル後に デスクリプターセットを生成する)
+        RenderGraphTexture              prefilterSource    = {};
+        std::vector<RenderGraphTexture> downSamplingSource = {};
+        std::vector<RenderGraphTexture> upSamplingSource   = {};
+        RenderGraphTexture              bloomSource        = {};
 
-        PipelineHandle* prefilterPipeline = nullptr;
+        AsyncPipeline*  prefilterPipeline = nullptr;
         ShaderHandle*   prefilterShader   = nullptr;
         DescriptorSet*  prefilterSet      = nullptr;
 
-        PipelineHandle*             downSamplingPipeline = nullptr;
+        AsyncPipeline*              downSamplingPipeline = nullptr;
         ShaderHandle*               downSamplingShader   = nullptr;
         std::vector<DescriptorSet*> downSamplingSet      = {};
 
-        PipelineHandle*             upSamplingPipeline = nullptr;
+        AsyncPipeline*              upSamplingPipeline = nullptr;
         ShaderHandle*               upSamplingShader   = nullptr;
         std::vector<DescriptorSet*> upSamplingSet      = {};
 
-        PipelineHandle* bloomPipeline = nullptr;
+        AsyncPipeline*  bloomPipeline = nullptr;
         ShaderHandle*   bloomShader   = nullptr;
         DescriptorSet*  bloomSet      = nullptr;
     };
 
+    // インスタンス毎のパラメーター (シェーダーの InstanceParameter と一致させる / std430)
+    struct InstanceParameter
+    {
+        glm::mat4  transformMatrix;
+        glm::mat4  normalMatrix;
+        glm::ivec4 pixelID;
+    };
+
+    // マテリアルテーブルの要素 (シェーダーの MaterialParameter と一致させる / std430)
+    struct MaterialParameter
+    {
+        glm::vec4 albedo;        // w: メタリック
+        glm::vec4 emission;      // w: ラフネス
+        glm::vec2 textureTiling;
+        uint32    albedoTexture; // バインドレステクスチャのインデックス
+        uint32    padding;
+    };
+
+    // マテリアル参照用プッシュ定数 (描画毎に更新する)
+    struct MaterialConstant
+    {
+        uint32 materialTable; // マテリアルテーブルのバインドレスバッファインデックス
+        uint32 materialIndex; // テーブル内のインデックス
+    };
+
+    // 同一 メッシュ・マテリアル のインスタンスをまとめた描画単位
+    // gl_InstanceIndex は firstInstance を含むので、インスタンスバッファの先頭オフセットは描画引数で渡す
+    struct InstanceBatch
+    {
+        Mesh*  mesh          = nullptr;
+        uint32 firstInstance = 0;
+        uint32 instanceCount = 0;
+
+        // マテリアルスロット毎のテーブル内インデックス (フレームアロケータから確保 / シャドウバッチは nullptr)
+        const uint32* materialIndices = nullptr;
+        uint32        numMaterial     = 0;
+    };
+
+    struct IndirectDrawData
+    {
+        // 描画対象の全メッシュソースを統合したジオメトリ
+        GeometryBuffer* geometry = nullptr;
+
+        // フレーム毎の間接描画引数バッファ (先頭 IndirectDrawCountOffset バイトに描画数、以降に DrawIndexedIndirectCommand を並べる)
+        // カリング結果がパス毎に異なるので、Gバッファ用とシャドウ用を分ける
+        std::vector<BufferHandle*> commandBuffers       = {};
+        std::vector<BufferHandle*> shadowCommandBuffers = {};
+        uint32                     maxDrawCount         = 0;
+        uint32                     numDraw              = 0;
+        uint32                     numShadowDraw        = 0;
+    };
+
+    struct CullingData
+    {
+        // スポンザ (静的なので初期化時に1回だけ構築 / GeometryRange と同じ並び)
+        CullingBounds staticBounds;
+
+        // シーンメッシュ (毎フレーム構築 / meshDrawList と同じ並び)
+        CullingBounds instanceBounds;
+
+        // 判定結果 (1: 可視) / シャドウはいずれかのカスケードと交差すれば可視
+        std::vector<uint8> staticCameraVisible;
+        std::vector<uint8> staticShadowVisible;
+        std::vector<uint8> instanceCameraVisible;
+        std::vector<uint8> instanceShadowVisible;
+    };
+
+    struct OcclusionCullingData
+    {
+        // 階層深度 (Hi-Z) / ミップ毎にストレージイメージとして書き込み、カリングでは全ミップを参照する
+        Texture2D*                  hiz         = nullptr;
+        TextureView*                hizView     = nullptr;
+        std::vector<TextureView*>   hizMipViews = {};
+        std::vector<Extent>         hizMipSizes = {};
+        std::vector<DescriptorSet*> hizSets     = {};
+        ShaderHandle*               hizShader   = nullptr;
+        AsyncPipeline*              hizPipeline = nullptr;
+        Sampler*                    hizSampler  = nullptr;
+
+        // カリング
+        ShaderHandle*  shader   = nullptr;
+        AsyncPipeline* pipeline = nullptr;
+        DescriptorSet* set      = nullptr;
+
+        // GPU 専用バッファ (フレーム間で共有し、同期はバリアで取る)
+        BufferHandle* boundsBuffer     = nullptr; // ワールド境界 (GeometryRange と同じ並び)
+        BufferHandle* drawBuffer       = nullptr; // 描画引数の元データ
+        BufferHandle* visibilityBuffer = nullptr; // 前フレームの判定結果
+        BufferHandle* earlyCommands    = nullptr; // フェーズ0 の描画引数 (先頭 IndirectDrawCountOffset バイトに描画数)
+        BufferHandle* lateCommands     = nullptr; // フェーズ1 の描画引数 (同上)
+
+        // 描画数の読み戻し (統計用 / フレーム毎)
+        std::vector<BufferHandle*> readbackBuffers = {};
+
+        uint32 numObject = 0;
+    };
+
+    // エンティティID の読み取り結果 (要求した矩形内の ID を重複なしで返す / 背景 (-1) は含まない)
+    using EntityPickCallback = std::function<void(const std::vector<int32>& entityIDs)>;
+
+    struct EntityPickRequest
+    {
+        uint32             x        = 0;
+        uint32             y        = 0;
+        uint32             width    = 1;
+        uint32             height   = 1;
+        uint64             offset   = 0; // 読み戻しバッファ内の位置
+        EntityPickCallback callback = nullptr;
+    };
+
+    struct EntityPickData
+    {
+        // 次の Render でフレームのコマンドバッファに記録する要求
+        std::vector<EntityPickRequest> pending = {};
+
+        // フレーム毎の読み戻し先と そのフレームで記録した要求 (同じフレームインデックスのフェンス待機後に結果を返す)
+        std::vector<BufferHandle*>                  readbackBuffers  = {};
+        std::vector<uint64>                         readbackCapacity = {};
+        std::vector<std::vector<EntityPickRequest>> inFlight         = {};
+    };
+
+    // 描画単位 [begin, end) をコマンドバッファに記録し、発行した描画コール数を返す
+    using DrawRangeRecordFunc = std::function<uint32(CommandBufferHandle* commandBuffer, uint32 begin, uint32 end)>;
+
+    struct SecondaryCommandData
+    {
+        // コマンドプールは 1スレッドからのみ記録できるので、フレーム毎・スレッド毎に持つ
+        // バッファはフレーム間で再利用し、フレーム開始時にプールごとリセットする
+        struct ThreadContext
+        {
+            CommandPoolHandle*                pool    = nullptr;
+            std::vector<CommandBufferHandle*> buffers = {};
+            uint32                            numUsed = 0;
+        };
+
+        // [フレームインデックス][ワーカーインデックス]
+        std::vector<std::vector<ThreadContext>> contexts = {};
+
+        // 記録結果 (チャンク順にプライマリから実行する)
+        std::vector<CommandBufferHandle*> recorded    = {};
+        std::vector<uint32>               numDrawCall = {};
+    };
+
     class SceneRenderer
     {
     public:
@@ -139,8 +328,10 @@ namespace Silex
         // メッシュデータを描画リストに追加
         void AddMeshDrawList(const MeshDrawData& data);
 
-        // ピクセルのエンティティIDを取得
-        int32 ReadEntityIDFromPixel(uint32 x, uint32 y);
+        // ピクセル (矩形) のエンティティIDを取得
+        // 要求はフレームのコマンドバッファに記録され、GPU の完了後 (フレームインフライト数だけ後の Render) にコールバックされる
+        void RequestEntityPick(uint32 x, uint32 y, EntityPickCallback&& callback);
+        void RequestEntityPickRect(uint32 x0, uint32 y0, uint32 x1, uint32 y1, EntityPickCallback&& callback);
 
         // シーンの最終描画結果を取得
         DescriptorSet* GetSceneFinalOutput();
@@ -148,11 +339,35 @@ namespace Silex
         // 描画の統計データを取得
         SceneRenderStats GetRenderStats();
 
+        // 間接描画の有効化 (無効時はメッシュソース毎にバッファをバインドして描画する / 比較用)
+        // 切り替え時に、それまでの方式の平均をログに出力する
+        void SetIndirectDrawEnabled(bool enable);
+        bool IsIndirectDrawEnabled() const { return useIndirectDraw; }
+
+        // 描画方式毎の累計 (最後に切り替えてからの計測値)
+        const DrawModeStats& GetDrawModeStats(bool indirect) const { return drawModeStats[indirect]; }
+
+        // 視錐台カリングの有効化 (無効時は全て可視として扱う / 比較用)
+        void SetCullingEnabled(bool enable) { enableCulling = enable; }
+        bool IsCullingEnabled() const       { return enableCulling;   }
+
+        // GPU オクルージョンカリングの有効化 (無効時は CPU の視錐台カリング結果で間接描画する / 比較用)
+        void SetOcclusionCullingEnabled(bool enable) { enableOcclusionCulling = enable; }
+        bool IsOcclusionCullingEnabled() const       { return enableOcclusionCulling;   }
+
+        // 描画コマンドの並列記録の有効化 (無効時はプライマリコマンドバッファに直接記録する / 比較用)
+        void SetParallelRecordingEnabled(bool enable) { enableParallelRecording = enable; }
+        bool IsParallelRecordingEnabled() const       { return enableParallelRecording;   }
+
+        // 並列記録に参加するスレッド数の上限 (呼び出しスレッドを含む / 0 で制限なし)
+        void   SetRecordThreadLimit(uint32 count) { recordThreadLimit = count; }
+        uint32 GetRecordThreadLimit() const       { return recordThreadLimit;  }
+
     private:
 
         void _InitializePasses();
         void _FinalizeePasses();
-        void _UpdateUniformBuffer();
+        bool _UpdateUniformBuffer();
         void _ExcutePasses();
 
         // Gバッファ
@@ -190,13 +405,72 @@ namespace Silex
 
         // ブルーム
         std::vector<Extent> _CalculateBlomSampling(uint32 width, uint32 height);
-        void                _PrepareBloomBuffer(uint32 width, uint32 height);
-        void                _ResizeBloomBuffer(uint32 width, uint32 height);
+        void                _PrepareBloomBuffer();
         void                _CleanupBloomBuffer();
+        RenderGraphTexture  _AddBloomPasses(RenderGraphTexture sceneColor, uint32 width, uint32 height);
+        void                _CreateBloomSets();
+        void                _DestroyBloomSets();
         BloomData* bloom;
 
+        // レンダーグラフ (ブルーム・コンポジット / リサイズ・パス構成の変更時は Invalidate して再構築する)
+        void _BuildRenderGraph();
+        RenderGraph* renderGraph;
+        bool         renderGraphBloom = false; // 構築時のブルームの有効状態
+
+        // 間接描画
+        void _PrepareIndirectDraw();
+        void _CleanupIndirectDraw();
+        void _BuildIndirectCommands(uint32 frameIndex);
+        uint32 _DrawSceneGeometry(CommandBufferHandle* commandBuffer, uint32 frameIndex, bool shadowPass, uint32 begin = 0, uint32 end = UINT32_MAX);
+        IndirectDrawData* indirect;
+
+        // 視錐台カリング
+        void _PrepareCulling();
+        void _CullSceneObjects();
+        CullingData* culling;
+
+        // オクルージョンカリング
+        void   _PrepareOcclusionCulling(uint32 width, uint32 height);
+        void   _ResizeOcclusionCulling(uint32 width, uint32 height);
+        void   _CleanupOcclusionCulling();
+        void   _CreateHiZ(uint32 width, uint32 height);
+        void   _DestroyHiZ();
+        bool   _IsOcclusionCullingReady();
+        void   _DispatchOcclusionCulling(CommandBufferHandle* commandBuffer, uint32 phase);
+        void   _BuildHiZ(CommandBufferHandle* commandBuffer);
+        uint32 _DrawOcclusionCulledGeometry(CommandBufferHandle* commandBuffer, BufferHandle* commands);
+        OcclusionCullingData* occlusion;
+
+        // インスタンシング
+        void   _ResizeInstanceBuffer(uint32 capacity);
+        void   _BuildInstanceBatches();
+        uint32 _DrawInstanceBatches(CommandBufferHandle* commandBuffer, const LinearVector<InstanceBatch>& batches, bool shadowPass, uint32 begin = 0, uint32 end = UINT32_MAX);
+
+        // 描画単位 (スポンザ → インスタンスバッチの通し番号) の範囲記録
+        uint32 _GetStaticDrawCount(bool occlusionCulled) const;
+        uint32 _DrawSceneRange(CommandBufferHandle* commandBuffer, uint32 frameIndex, bool shadowPass, BufferHandle* occlusionCommands, uint32 begin, uint32 end);
+
+        // 描画コマンドの並列記録 (描画単位をスレッド毎のチャンクに分け、セカンダリコマンドバッファに記録してプライマリから実行する)
+        void   _PrepareSecondaryCommands();
+        void   _CleanupSecondaryCommands();
+        void   _ResetSecondaryCommands(uint32 frameIndex);
+        uint32 _GetRecordThreadCount() const;
+        uint32 _RecordSecondaryCommands(RenderPassHandle* renderpass, uint32 width, uint32 height, uint32 numDraw, const DrawRangeRecordFunc& record);
+        uint32 _RecordRenderPass(CommandBufferHandle* commandBuffer, RenderPassHandle* renderpass, FramebufferHandle* framebuffer, uint32 numView, TextureViewHandle** views, uint32 width, uint32 height, uint32 numDraw, const DrawRangeRecordFunc& record);
+        SecondaryCommandData* secondary;
+
+        // マテリアルテーブル
+        void _PrepareMaterialTable();
+        void _CleanupMaterialTable();
+        void _ResizeMaterialTable(uint32 capacity);
+        void _PushMaterialConstant(CommandBufferHandle* commandBuffer, uint32 materialIndex);
+
         // エンティティID リードバック
-        Buffer* pixelIDBuffer = nullptr;
+        void _PrepareEntityPick();
+        void _CleanupEntityPick();
+        void _RecordEntityPicks(CommandBufferHandle* commandBuffer, uint32 frameIndex);
+        void _ResolveEntityPicks(uint32 frameIndex);
+        EntityPickData* picking = nullptr;
 
     private:
 
@@ -232,27 +506,25 @@ namespace Silex
         Texture2D*      brdflutTexture     = nullptr;
         TextureView*    brdflutTextureView = nullptr;
 
-        // シーンBlit
-        FramebufferHandle* compositeFB          = nullptr;
-        Texture2D*         compositeTexture     = nullptr;
-        TextureView*       compositeTextureView = nullptr;
-        RenderPassHandle*  compositePass        = nullptr;
-        ShaderHandle*      compositeShader      = nullptr;
-        PipelineHandle*    compositePipeline    = nullptr;
-        DescriptorSet*     compositeSet;
+        // シーンBlit (出力テクスチャはレンダーグラフがエクスポートする / レンダーパスはパイプライン生成用)
+        RenderPassHandle*  compositePass     = nullptr;
+        ShaderHandle*      compositeShader   = nullptr;
+        AsyncPipeline*     compositePipeline = nullptr;
+        DescriptorSet*     compositeSet      = nullptr;
 
         // グリッド
         ShaderHandle*   gridShader   = nullptr;
-        PipelineHandle* gridPipeline = nullptr;
+        AsyncPipeline*  gridPipeline = nullptr;
         DescriptorSet*  gridSet      = nullptr;
-        UniformBuffer*  gridUBO      = nullptr;
+        uint32          gridOffset   = 0;
 
         // ImGui::Image
-        DescriptorSet* imageSet;
+        DescriptorSet* imageSet = nullptr;
 
         // シャドウマップ
         static const uint32  shadowMapResolution = 2048;
         std::array<float, 4> shadowCascadeLevels = { 10.0f, 40.0f, 100.0f, 200.0f };
+        std::array<glm::mat4, 4> lightSpaceMatrices;
 
         // メッシュ
         Mesh* cubeMesh   = nullptr;
@@ -262,8 +534,8 @@ namespace Silex
         Sampler* linearSampler = nullptr;
         Sampler* shadowSampler = nullptr;
 
-        // 頂点レイアウト
-        InputLayout defaultLayout;
+        // 頂点レイアウト ([0]: 座標ストリーム [1]: 属性ストリーム / 深度のみのパスは [0] だけを使用する)
+        InputLayout vertexLayouts[2];
 
         // テクスチャ
         Texture2D*   defaultTexture     = nullptr;
@@ -281,27 +553,40 @@ namespace Silex
         Scene*     renderScene       = nullptr;
         Camera*    sceneCamera       = nullptr;
 
-        // 描画要求されたメッシュコンポーネントリスト
-        std::vector<MeshDrawData> meshDrawList;
+        // 描画要求されたメッシュコンポーネントリスト (フレームアロケータから確保)
+        LinearVector<MeshDrawData> meshDrawList;
+
+        // インスタンシング用パラメーター (フレーム毎のストレージバッファ / 先頭はスポンザ用の単位行列)
+        StorageBuffer* instanceSBO      = nullptr;
+        uint32         instanceCapacity = 0;
 
-        // インスタンシング用トランスフォーム
-        //MeshParameter* meshParameters = nullptr;
-        //Shared<StorageBuffer> meshParameterSBO;
+        // マテリアルテーブル (フレーム毎のストレージバッファ / 先頭はデフォルトマテリアル)
+        // 各フレームのバッファをバインドレスバッファとして登録し、描画時はプッシュ定数のインデックスで参照する
+        StorageBuffer*      materialSBO        = nullptr;
+        uint32              materialCapacity   = 0;
+        std::vector<uint32> materialTableSlots = {};
+        uint32              defaultTextureSlot = 0;
 
-        // シャドウインスタンシングデータ
-        //std::unordered_map<InstancingUnitID, InstancingUnitData>      shadowDrawData;
-        //std::unordered_map<InstancingUnitID, InstancingUnitParameter> ShadowParameterData;
+        // シャドウインスタンシングデータ (castShadow のインスタンスのみ)
+        LinearVector<InstanceBatch> shadowBatches;
 
         // ジオメトリインスタンシングデータ
-        //std::unordered_map<InstancingUnitID, InstancingUnitData>      meshDrawData;
-        //std::unordered_map<InstancingUnitID, InstancingUnitParameter> meshParameterData;
+        LinearVector<InstanceBatch> geometryBatches;
 
         // 描画フラグ
-        bool enablePostProcess  = true;
-        bool shouldRenderShadow = true;
+        bool enablePostProcess       = true;
+        bool useIndirectDraw         = true;
+        bool enableCulling           = true;
+        bool enableOcclusionCulling  = true;
+        bool enableParallelRecording = true;
+        bool shouldRenderShadow      = true;
+
+        // 並列記録のスレッド数上限 (0 で制限なし)
+        uint32 recordThreadLimit = 0;
 
         // 計測
         SceneRenderStats stats;
+        DrawModeStats    drawModeStats[2]; // [メッシュソース毎, 間接描画]
 
         // 描画API
         RenderingAPI* api = nullptr;
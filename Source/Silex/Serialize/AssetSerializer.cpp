@@ -36,13 +36,13 @@ namespace Silex
     }
 
     template<>
-    Ref<MaterialAsset> AssetSerializer<MaterialAsset>::Deserialize(const std::string& filePath)
+    Ref<MaterialAsset> AssetSerializer<MaterialAsset>::DeserializeFromText(const std::string& text, std::vector<uint64>& out_dependencies)
     {
         Material* material = slnew(Material);
         Ref<MaterialAsset> asset = CreateRef<MaterialAsset>(material);
 
 
-        YAML::Node data = YAML::LoadFile(filePath);
+        YAML::Node data = YAML::Load(text);
 
         auto shadingModel  = data["shadingModel"].as<int32>();
         auto albedo        = data["albedo"].as<glm::vec3>();
@@ -59,10 +59,32 @@ namespace Silex
         asset->Get()->textureTiling = textureTiling;
         asset->Get()->albedo        = albedo;
 
-        // テクスチャ読み込み完了を前提とする
-        const Ref<Texture2DAsset>& texture = AssetManager::Get()->GetAssetAs<Texture2DAsset>(albedoMap);
+        // [0]: アルベドテクスチャ
+        out_dependencies = { albedoMap };
+
+        return asset;
+    }
+
+    template<>
+    void AssetSerializer<MaterialAsset>::ResolveDependencies(const Ref<MaterialAsset>& asset, const std::vector<uint64>& dependencies)
+    {
+        const Ref<Texture2DAsset>& texture = AssetManager::Get()->GetAssetAs<Texture2DAsset>(dependencies[0]);
         asset->Get()->albedoMap = texture;
+    }
+
+    template<>
+    Ref<MaterialAsset> AssetSerializer<MaterialAsset>::Deserialize(const std::string& filePath)
+    {
+        std::ifstream stream(filePath);
+        std::stringstream strStream;
+        strStream << stream.rdbuf();
+
+        std::vector<uint64> dependencies;
+        Ref<MaterialAsset> asset = DeserializeFromText(strStream.str(), dependencies);
+
+        // テクスチャ読み込み完了を前提とする
+        ResolveDependencies(asset, dependencies);
 
         return asset;
     }
-}
\ No newline at end of file
+}
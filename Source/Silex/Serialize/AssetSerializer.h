@@ -17,5 +17,10 @@ namespace Silex
 
         static void   Serialize(const Ref<T>& aseet, const std::string& filePath);
         static Ref<T> Deserialize(const std::string& filePath);
+
+        // 段階的な読み込み用: 読み込み済みのテキストから生成し、参照するアセットID を返す (任意のスレッドから呼び出し可能)
+        // 参照の解決は、参照先アセットの読み込み完了後にメインスレッドで ResolveDependencies を呼び出して行う
+        static Ref<T> DeserializeFromText(const std::string& text, std::vector<uint64>& out_dependencies);
+        static void   ResolveDependencies(const Ref<T>& asset, const std::vector<uint64>& dependencies);
     };
 }
\ No newline at end of file
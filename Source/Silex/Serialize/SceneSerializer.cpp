@@ -199,8 +199,9 @@ namespace Silex
 
                     mc.castShadow = mesh["castShadow"].as<bool>();
 
+                    // メッシュは非同期に読み込まれるので、スロット数は保存されたマテリアル数から決める
                     auto material = mesh["material"];
-                    auto numSlots = mc.mesh->Get()->GetMaterialSlotCount();
+                    auto numSlots = material.size();
 
                     for (uint32 i = 0; i < numSlots; i++)
                     {